@@ -18,8 +18,11 @@
 
 #include <TH1.h>
 
+#include <algorithm>
 #include <cstdlib>
+#include <fstream>
 #include <memory>
+#include <sstream>
 
 using namespace std;
 
@@ -30,6 +33,11 @@ Fun4AllDstInputManager::Fun4AllDstInputManager(const string &name, const string
   events_total(0),
   events_thisfile(0),
   events_skipped_during_sync(0),
+  cachesize(0),
+  unzipahead(false),
+  usesyncindex(0),
+  syncindexbuilt(0),
+  eventlistbuilt(0),
   fname(NULL),
   RunNode("RUN"),
   dstNode(NULL),
@@ -102,6 +110,10 @@ Fun4AllDstInputManager::fileopen(const string &filenam)
   IManager = new PHNodeIOManager(frog.location(filename.c_str()), PHReadOnly);
   if (IManager->isFunctional())
     {
+      if (cachesize > 0)
+	{
+	  IManager->SetCacheSize(cachesize, unzipahead);
+	}
       isopen = 1;
       events_thisfile = 0;
       setBranches(); // set branch selections
@@ -145,6 +157,19 @@ int Fun4AllDstInputManager::run(const int nevents)
       cout << "Getting Event from " << Name() << endl;
     }
  readagain:
+  if (!eventlist.empty())
+    {
+      // position on the next selected entry, the file is done if there is none
+      if (SeekEventList())
+	{
+	  fileclose();
+	  if (!OpenNextFile())
+	    {
+	      goto readagain;
+	    }
+	  return -1;
+	}
+    }
   PHCompositeNode *dummy;
   int ncount = 0;
   dummy = IManager->read(dstNode);
@@ -184,9 +209,17 @@ int Fun4AllDstInputManager::fileclose()
       cout << Name() << ": fileclose: No Input file open" << endl;
       return -1;
     }
+  if (cachesize > 0)
+    {
+      IManager->PrintReadStats(events_thisfile);
+    }
   delete IManager;
   IManager = 0;
   isopen = 0;
+  syncindex.clear();
+  syncindexbuilt = 0;
+  eventlistentries.clear();
+  eventlistbuilt = 0;
   if (!filelist.empty())
     {
       if (repeat)
@@ -252,85 +285,14 @@ Fun4AllDstInputManager::SyncIt(const SyncObject *mastersync)
               cout << "mastersync run number: " << mastersync->RunNumber()
                    << ", this run number: " << syncobject->RunNumber() << endl;
             }
-          while (syncobject->RunNumber() < mastersync->RunNumber())
-
-            {
-              events_skipped_during_sync++;
-              if (verbosity > 2)
-                {
-                  cout << ThisName << " Run Number: " << syncobject->RunNumber()
-                       << ", master: " << mastersync->RunNumber()
-                       << endl;
-                }
-              int iret = ReadNextEventSyncObject();
-              if (iret)
-                {
-                  return iret;
-                }
-            }
-          int igood = 0;
-          if (syncobject->RunNumber() == mastersync->RunNumber())
-            {
-              igood = 1;
-            }
-          // only run up the Segment Number if run numbers are identical
-          while (syncobject->SegmentNumber() < mastersync->SegmentNumber() && igood)
-            {
-              events_skipped_during_sync++;
-              if (verbosity > 2)
-                {
-                  cout << ThisName << " Segment Number: " << syncobject->SegmentNumber()
-                       << ", master: " << mastersync->SegmentNumber()
-                       << endl;
-                }
-              int iret = ReadNextEventSyncObject();
-              if (iret)
-                {
-                  return iret;
-                }
-            }
-          // only run up the Event Counter if run number and segment number are identical
-          if ( syncobject->SegmentNumber() == mastersync->SegmentNumber() && syncobject->RunNumber() == mastersync->RunNumber())
-            {
-              igood = 1;
-            }
-          else
+          if (!SeekSyncIndex(mastersync))
             {
-              igood = 0;
-            }
-          while (syncobject->EventCounter() < mastersync->EventCounter() && igood)
-            {
-              events_skipped_during_sync++;
-              if (verbosity > 2)
-                {
-                  cout << ThisName
-                       << ", EventCounter: " << syncobject->EventCounter()
-                       << ", master: " << mastersync->EventCounter()
-                       << endl;
-                }
-              int iret = ReadNextEventSyncObject();
+              int iret = ScanToSync(mastersync);
               if (iret)
                 {
                   return iret;
                 }
             }
-          // Since up to here we only read the sync object we need to push
-          // the current event back inot the root file (subtract one from the
-          // local root file event counter) so we can read the full event
-          // if it syncs, if it does not sync we also read one event too many
-          // (otherwise we cannot determine that we are "too far")
-          // and also have to push this one back
-          PushBackEvents(1);
-          if (syncobject->RunNumber() > mastersync->RunNumber() ||	// check if run number too large
-              syncobject->EventCounter() > mastersync->EventCounter() ||	// check if event counter too large
-              syncobject->SegmentNumber() > mastersync->SegmentNumber()) // check segment number too large
-            {
-              // the event from first file which determines the mastersync
-              // and which we are trying to find on this file does not exist on this file
-              // so: return failure. This will cause the input managers to read
-              // the next event from the input files file
-              return Fun4AllReturnCodes::SYNC_FAIL;
-            }
           // Here the event counter and segment number and run number do agree - we found the right match
           // now read the full event (previously we only read the sync object)
           PHCompositeNode *dummy;
@@ -619,3 +581,348 @@ Fun4AllDstInputManager::PushBackEvents(const int i)
        << " probably the dst is not open yet (you need to call fileopen or run 1 event for lists)" << endl;
   return -1;
 }
+
+void
+Fun4AllDstInputManager::Prefetch(const long long size, const bool unzip)
+{
+  // takes effect for the next opened file, the cache is created when
+  // the node tree is set up from the first event
+  cachesize = size;
+  unzipahead = unzip;
+  return;
+}
+
+int
+Fun4AllDstInputManager::ScanToSync(const SyncObject *mastersync)
+{
+  // step through the sync objects of this file until we reach the
+  // run, segment and event counter of the mastersync
+  while (syncobject->RunNumber() < mastersync->RunNumber())
+
+    {
+      events_skipped_during_sync++;
+      if (verbosity > 2)
+        {
+          cout << ThisName << " Run Number: " << syncobject->RunNumber()
+               << ", master: " << mastersync->RunNumber()
+               << endl;
+        }
+      int iret = ReadNextEventSyncObject();
+      if (iret)
+        {
+          return iret;
+        }
+    }
+  int igood = 0;
+  if (syncobject->RunNumber() == mastersync->RunNumber())
+    {
+      igood = 1;
+    }
+  // only run up the Segment Number if run numbers are identical
+  while (syncobject->SegmentNumber() < mastersync->SegmentNumber() && igood)
+    {
+      events_skipped_during_sync++;
+      if (verbosity > 2)
+        {
+          cout << ThisName << " Segment Number: " << syncobject->SegmentNumber()
+               << ", master: " << mastersync->SegmentNumber()
+               << endl;
+        }
+      int iret = ReadNextEventSyncObject();
+      if (iret)
+        {
+          return iret;
+        }
+    }
+  // only run up the Event Counter if run number and segment number are identical
+  if ( syncobject->SegmentNumber() == mastersync->SegmentNumber() && syncobject->RunNumber() == mastersync->RunNumber())
+    {
+      igood = 1;
+    }
+  else
+    {
+      igood = 0;
+    }
+  while (syncobject->EventCounter() < mastersync->EventCounter() && igood)
+    {
+      events_skipped_during_sync++;
+      if (verbosity > 2)
+        {
+          cout << ThisName
+               << ", EventCounter: " << syncobject->EventCounter()
+               << ", master: " << mastersync->EventCounter()
+               << endl;
+        }
+      int iret = ReadNextEventSyncObject();
+      if (iret)
+        {
+          return iret;
+        }
+    }
+  // Since up to here we only read the sync object we need to push
+  // the current event back inot the root file (subtract one from the
+  // local root file event counter) so we can read the full event
+  // if it syncs, if it does not sync we also read one event too many
+  // (otherwise we cannot determine that we are "too far")
+  // and also have to push this one back
+  PushBackEvents(1);
+  if (syncobject->RunNumber() > mastersync->RunNumber() ||	// check if run number too large
+      syncobject->EventCounter() > mastersync->EventCounter() ||	// check if event counter too large
+      syncobject->SegmentNumber() > mastersync->SegmentNumber()) // check segment number too large
+    {
+      // the event from first file which determines the mastersync
+      // and which we are trying to find on this file does not exist on this file
+      // so: return failure. This will cause the input managers to read
+      // the next event from the input files file
+      return Fun4AllReturnCodes::SYNC_FAIL;
+    }
+  return Fun4AllReturnCodes::SYNC_OK;
+}
+
+void
+Fun4AllDstInputManager::UseSyncIndex(const int i)
+{
+  usesyncindex = i;
+  return;
+}
+
+int
+Fun4AllDstInputManager::BuildSyncIndex()
+{
+  syncindex.clear();
+  syncindexbuilt = 1;
+  string branchname = GetSyncBranchName();
+  if (branchname.empty() || !syncobject)
+    {
+      if (verbosity > 0)
+        {
+          cout << ThisName << ": no Sync branch, cannot build sync index" << endl;
+        }
+      return -1;
+    }
+  // only the sync branch is read, this is cheap compared to reading
+  // full events during resynchronization
+  IManager->RestrictCache(branchname.c_str());
+  size_t entry = 0;
+  while (IManager->readSpecific(entry, branchname.c_str()) > 0)
+    {
+      // first occurence wins like for the sequential search
+      syncindex.insert(make_pair(make_tuple(syncobject->RunNumber(), syncobject->SegmentNumber(), syncobject->EventCounter()), entry));
+      entry++;
+    }
+  IManager->RestrictCache(0);
+  // restore the sync object of the current event
+  if (IManager->getEventNumber() > 0)
+    {
+      IManager->readSpecific(IManager->getEventNumber() - 1, branchname.c_str());
+    }
+  if (verbosity > 1)
+    {
+      cout << ThisName << ": sync index with " << syncindex.size()
+           << " entries for " << entry << " events" << endl;
+    }
+  return 0;
+}
+
+bool
+Fun4AllDstInputManager::SeekSyncIndex(const SyncObject *mastersync)
+{
+  if (!usesyncindex || !IManager)
+    {
+      return false;
+    }
+  if (!syncindexbuilt)
+    {
+      BuildSyncIndex();
+    }
+  map<tuple<int, int, int>, size_t>::const_iterator iter =
+    syncindex.find(make_tuple(mastersync->RunNumber(), mastersync->SegmentNumber(), mastersync->EventCounter()));
+  size_t nextevent = IManager->getEventNumber();
+  // only seek forward, the sequential search never goes back either.
+  // If the event is not in the index, the sequential search decides
+  // whether it is in one of the next files or does not exist
+  if (iter == syncindex.end() || iter->second < nextevent)
+    {
+      return false;
+    }
+  events_skipped_during_sync += iter->second - nextevent + 1;
+  if (verbosity > 2)
+    {
+      cout << ThisName << ": sync index jump from entry " << nextevent - 1
+           << " to " << iter->second << endl;
+    }
+  // the full event is read by the caller
+  IManager->setEventNumber(iter->second);
+  return true;
+}
+
+string
+Fun4AllDstInputManager::GetSyncBranchName()
+{
+  map<string, TBranch*>::const_iterator bIter;
+  for (bIter = IManager->GetBranchMap()->begin(); bIter != IManager->GetBranchMap()->end(); ++bIter)
+    {
+      if (bIter->first.find("/Sync") != string::npos)
+        {
+          return bIter->first;
+        }
+    }
+  return "";
+}
+
+int
+Fun4AllDstInputManager::skip(const int nevt)
+{
+  if (nevt < 0)
+    {
+      return PushBackEvents(-nevt);
+    }
+  if (!IManager && OpenNextFile())
+    {
+      cout << PHWHERE << ThisName << ": could not skip events, no input file open" << endl;
+      return -1;
+    }
+  size_t nskip = nevt;
+  while (IManager)
+    {
+      size_t entries = IManager->getEntries();
+      size_t nextevent = IManager->getEventNumber();
+      size_t nleft = (entries > nextevent) ? entries - nextevent : 0;
+      if (nevt == 0 || nskip < nleft)
+	{
+	  if (nevt == 0)
+	    {
+	      nskip = nleft;
+	    }
+	  // only the entry counter moves, the next read() gets the entry after the skipped ones
+	  IManager->setEventNumber(nextevent + nskip);
+	  if (verbosity > 0)
+	    {
+	      cout << ThisName << ": skipped to entry " << nextevent + nskip
+		   << " of " << filename << endl;
+	    }
+	  return 0;
+	}
+      // not enough events left in this file, continue with the next one
+      nskip -= nleft;
+      fileclose();
+      if (OpenNextFile())
+	{
+	  break;
+	}
+    }
+  if (nskip > 0)
+    {
+      cout << ThisName << ": input exhausted with " << nskip << " events left to skip" << endl;
+      return -1;
+    }
+  return 0;
+}
+
+void
+Fun4AllDstInputManager::AddEventToRead(const int runno, const int evtno)
+{
+  eventlist.insert(make_pair(runno, evtno));
+  eventlistbuilt = 0; // rescan the current file
+  return;
+}
+
+int
+Fun4AllDstInputManager::ReadEventList(const string &listfile)
+{
+  ifstream infile(listfile.c_str());
+  if (!infile.is_open())
+    {
+      cout << PHWHERE << ThisName << ": could not open event list " << listfile << endl;
+      return -1;
+    }
+  string line;
+  int nadded = 0;
+  while (getline(infile, line))
+    {
+      if (line.empty() || line[0] == '#')
+	{
+	  continue;
+	}
+      istringstream linestream(line);
+      int runno;
+      int evtno;
+      if (!(linestream >> runno >> evtno))
+	{
+	  cout << PHWHERE << ThisName << ": bad line in " << listfile
+	       << ": " << line << endl;
+	  continue;
+	}
+      AddEventToRead(runno, evtno);
+      nadded++;
+    }
+  if (verbosity > 0)
+    {
+      cout << ThisName << ": read " << nadded << " events from " << listfile << endl;
+    }
+  return nadded;
+}
+
+void
+Fun4AllDstInputManager::ClearEventList()
+{
+  eventlist.clear();
+  eventlistentries.clear();
+  eventlistbuilt = 0;
+  return;
+}
+
+int
+Fun4AllDstInputManager::BuildEventList()
+{
+  eventlistentries.clear();
+  eventlistbuilt = 1;
+  // connect the branches so the Sync branch is read into our sync object
+  if (!IManager->readNodeTree(dstNode))
+    {
+      return -1;
+    }
+  syncobject = findNode::getClass<SyncObject>(dstNode, "Sync");
+  string branchname = GetSyncBranchName();
+  if (branchname.empty() || !syncobject)
+    {
+      cout << PHWHERE << ThisName << ": no Sync branch in " << filename
+           << ", cannot select events" << endl;
+      return -1;
+    }
+  // only the sync branch is read, the entries come out sorted
+  IManager->RestrictCache(branchname.c_str());
+  size_t entry = 0;
+  while (IManager->readSpecific(entry, branchname.c_str()) > 0)
+    {
+      if (eventlist.find(make_pair(syncobject->RunNumber(), syncobject->EventNumber())) != eventlist.end())
+	{
+	  eventlistentries.push_back(entry);
+	}
+      entry++;
+    }
+  IManager->RestrictCache(0);
+  if (verbosity > 0)
+    {
+      cout << ThisName << ": " << eventlistentries.size() << " of " << entry
+           << " events in " << filename << " are selected" << endl;
+    }
+  return 0;
+}
+
+int
+Fun4AllDstInputManager::SeekEventList()
+{
+  if (!eventlistbuilt)
+    {
+      BuildEventList();
+    }
+  size_t nextevent = IManager->getEventNumber();
+  vector<size_t>::const_iterator iter = lower_bound(eventlistentries.begin(), eventlistentries.end(), nextevent);
+  if (iter == eventlistentries.end())
+    {
+      return -1;
+    }
+  IManager->setEventNumber(*iter);
+  return 0;
+}
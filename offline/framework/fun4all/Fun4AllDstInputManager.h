@@ -5,6 +5,10 @@
 
 #include <string>
 #include <map>
+#include <set>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 class PHCompositeNode;
 class PHNodeIOManager;
@@ -25,15 +29,52 @@ class Fun4AllDstInputManager : public Fun4AllInputManager
   virtual int setSyncBranches(PHNodeIOManager *IManager);
   void Print(const std::string &what = "ALL") const;
   int PushBackEvents(const int i);
+  /*! \brief
+    skip nevt events by moving the entry counter, nothing is read.
+    Continues in the next files of the list if the current file
+    has fewer events left, nevt = 0 skips the rest of the current file
+  */
+  int skip(const int nevt);
+  /*! \brief
+    only read the events with the given (run number, event number).
+    The Sync branch of each file is scanned once to find the matching
+    entries, run() then jumps from one selected entry to the next
+  */
+  void AddEventToRead(const int runno, const int evtno);
+  //! read (run number, event number) pairs from a text file, one pair per line
+  int ReadEventList(const std::string &listfile);
+  void ClearEventList();
+  //! read through a TTreeCache of cachesize bytes, unzip baskets ahead in a separate thread
+  void Prefetch(const long long cachesize = 30000000, const bool unzip = true);
+  /*! \brief
+    resynchronize by looking up the (run, segment, event counter) of
+    the mastersync in an index of the Sync branch which is built when
+    the first resync on a file is needed, instead of reading event by event
+  */
+  void UseSyncIndex(const int i = 1);
 
  protected:
   int ReadNextEventSyncObject();
+  int ScanToSync(const SyncObject *mastersync);
+  int BuildSyncIndex();
+  bool SeekSyncIndex(const SyncObject *mastersync);
+  std::string GetSyncBranchName();
+  int BuildEventList();
+  int SeekEventList();
   int OpenNextFile();
   int readrunttree;
   int isopen;
   int events_total;
   int events_thisfile;
   int events_skipped_during_sync;
+  long long cachesize;
+  bool unzipahead;
+  int usesyncindex;
+  int syncindexbuilt;
+  std::map<std::tuple<int, int, int>, size_t> syncindex;  // (run, segment, event counter) -> entry
+  std::set<std::pair<int, int> > eventlist;  // (run, event number) to read
+  int eventlistbuilt;
+  std::vector<size_t> eventlistentries;  // entries of the current file which are in the eventlist
   const char *fname;
   std::string RunNode;
   std::map<const std::string, int> branchread;
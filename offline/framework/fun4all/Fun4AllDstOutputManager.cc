@@ -13,7 +13,8 @@
 using namespace std;
 
 Fun4AllDstOutputManager::Fun4AllDstOutputManager(const string &myname, const string &fname): 
- Fun4AllOutputManager( myname )
+ Fun4AllOutputManager( myname ),
+ asyncdepth(0)
 {
   outfilename = fname;
   dstOut = new PHNodeIOManager(fname.c_str(), PHWrite);
@@ -81,6 +82,10 @@ Fun4AllDstOutputManager::outfileopen(const string &fname)
     }
 
   dstOut->SetCompressionLevel(3);
+  if (asyncdepth && !dstOut->SetAsync(asyncdepth))
+    {
+      asyncdepth = 0;
+    }
   return 0;
 }
 
@@ -220,6 +225,7 @@ Fun4AllDstOutputManager::Write(PHCompositeNode *startNode)
 int
 Fun4AllDstOutputManager::WriteNode(PHCompositeNode *thisNode)
 {
+  // deleting an asynchronous io manager waits until all events are written
   delete dstOut;
 
   dstOut = new PHNodeIOManager(outfilename.c_str(), PHUpdate, PHRunTree);
@@ -229,3 +235,15 @@ Fun4AllDstOutputManager::WriteNode(PHCompositeNode *thisNode)
   return 0;
 }
 
+
+void
+Fun4AllDstOutputManager::AsyncWrite(const unsigned int queuedepth)
+{
+  asyncdepth = queuedepth;
+  if (dstOut && !dstOut->SetAsync(asyncdepth))
+    {
+      // not possible (ROOT 5), later files are written synchronously too
+      asyncdepth = 0;
+    }
+  return;
+}
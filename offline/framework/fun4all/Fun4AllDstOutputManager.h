@@ -26,10 +26,24 @@ class Fun4AllDstOutputManager: public Fun4AllOutputManager
   int Write(PHCompositeNode *startNode);
   int WriteNode(PHCompositeNode *thisNode);
 
+  /*! \brief
+    fill the output tree (streaming and compression) in a separate
+    thread, up to queuedepth events are buffered. Event order is kept,
+    the queue is drained when the file is closed. 0 means synchronous
+    writing (default). Needs ROOT 6, with ROOT 5 the writing stays synchronous.
+    The objects of the written nodes go to the writer thread and the nodes
+    get reset spare objects (see PHNodeIOManager::SetAsync), modules must
+    not keep pointers to node objects from one event to the next. Only one
+    output manager of a job can write asynchronously
+  */
+  void AsyncWrite(const unsigned int queuedepth = 4);
+  bool SwapsNodeObjects() const {return asyncdepth > 0;}
+
  protected:
   std::vector <std::string> savenodes;
   std::vector <std::string> stripnodes;
   PHNodeIOManager *dstOut;
+  unsigned int asyncdepth;
 };
 
 #endif /* __FUN4ALLDSTOUTPUTMANAGER_H__ */
@@ -0,0 +1,221 @@
+#include "Fun4AllModuleMetrics.h"
+
+#include <phool/PHTimer.h>
+#include <phool/PHTrace.h>
+
+#include <malloc.h>
+#include <unistd.h>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <string>
+
+using namespace std;
+
+Fun4AllModuleMetrics::Fun4AllModuleMetrics(const string &name, PHTimer *tim)
+  : modulename(name)
+  , tracelabel(PHTrace::Label(name))
+  , timer(tim)
+  , cpustart(0)
+  , ncall(0)
+  , cputime(0)
+  , maxtime(0)
+  , nodes_added(0)
+  , heap_event(0)
+  , heap_reset(0)
+  , rss_event(0)
+  , heap_maxdelta(0)
+  , retained_event(0)
+  , retained(0)
+  , retained_slope(0)
+  , leak(false)
+{
+}
+
+void Fun4AllModuleMetrics::start()
+{
+  cpustart = clock();
+  timer->restart();
+  return;
+}
+
+void Fun4AllModuleMetrics::stop(const int retcode)
+{
+  timer->stop();
+  cputime += 1000. * (clock() - cpustart) / CLOCKS_PER_SEC;
+  double elapsed = timer->elapsed();
+  if (elapsed > maxtime)
+  {
+    maxtime = elapsed;
+  }
+  retcodes[retcode]++;
+  ncall++;
+  return;
+}
+
+void Fun4AllModuleMetrics::add_memory(const long heapdelta, const long rssdelta, const bool reset)
+{
+  retained_event += heapdelta;
+  if (reset)
+  {
+    heap_reset += heapdelta;
+    return;
+  }
+  heap_event += heapdelta;
+  rss_event += rssdelta;
+  if (heapdelta > heap_maxdelta)
+  {
+    heap_maxdelta = heapdelta;
+  }
+  return;
+}
+
+void Fun4AllModuleMetrics::end_event(const bool count, const unsigned int window, const double jobslope)
+{
+  if (count)
+  {
+    retained += retained_event;
+    retained_series.push_back(retained);
+    if (retained_series.size() > window)
+    {
+      retained_series.pop_front();
+    }
+    if (retained_series.size() == window)
+    {
+      // a module which allocates once (or only in the skipped events) has a
+      // flat series, one which leaks keeps going up. The fitted growth over the
+      // window has to exceed a page so malloc bookkeeping noise is not flagged.
+      // Objects of the module freed by the node tree reset instead of its own
+      // ResetEvent also give a rising series, the job heap going up with it
+      // separates those from real leaks
+      retained_slope = Slope(retained_series);
+      leak = (retained_slope * window > 4096 && jobslope > 0);
+    }
+  }
+  retained_event = 0;
+  return;
+}
+
+double
+Fun4AllModuleMetrics::Slope(const deque<long> &series)
+{
+  const double n = series.size();
+  if (n < 2)
+  {
+    return 0;
+  }
+  // x = 0..n-1, fit relative to the first entry to keep the sums small
+  double sumx = 0;
+  double sumy = 0;
+  double sumxy = 0;
+  double sumxx = 0;
+  for (unsigned int i = 0; i < series.size(); i++)
+  {
+    const double y = series[i] - series[0];
+    sumx += i;
+    sumy += y;
+    sumxy += i * y;
+    sumxx += static_cast<double>(i) * i;
+  }
+  return (n * sumxy - sumx * sumy) / (n * sumxx - sumx * sumx);
+}
+
+long Fun4AllModuleMetrics::HeapInUse()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+  struct mallinfo2 mi = mallinfo2();
+#else
+  // the int fields of mallinfo wrap above 2GB, differences stay valid
+  // as long as a single call does not allocate more than that
+  struct mallinfo mi = mallinfo();
+#endif
+  // arena allocations plus mmapped chunks
+  return static_cast<long>(mi.uordblks) + static_cast<long>(mi.hblkhd);
+}
+
+long Fun4AllModuleMetrics::ResidentSize()
+{
+  long pages = 0;
+  FILE *f = fopen("/proc/self/statm", "r");
+  if (f)
+  {
+    long size;
+    if (fscanf(f, "%ld %ld", &size, &pages) != 2)
+    {
+      pages = 0;
+    }
+    fclose(f);
+  }
+  return pages * sysconf(_SC_PAGESIZE);
+}
+
+double
+Fun4AllModuleMetrics::wall_time() const
+{
+  return timer->get_accumulated_time();
+}
+
+void Fun4AllModuleMetrics::PrintCsvHeader(ostream &os)
+{
+  os << "events,module,calls,wall_ms,cpu_ms,max_wall_ms,nodes_added,"
+     << "heap_event_kb,heap_reset_kb,rss_event_kb,heap_max_delta_kb,retained_kb,retained_slope_b,leak_suspect,retcodes" << endl;
+  return;
+}
+
+void Fun4AllModuleMetrics::PrintCsv(ostream &os, const unsigned long nevents) const
+{
+  os << nevents << ","
+     << modulename << ","
+     << ncall << ","
+     << wall_time() << ","
+     << cputime << ","
+     << maxtime << ","
+     << nodes_added << ","
+     << heap_event / 1024 << ","
+     << heap_reset / 1024 << ","
+     << rss_event / 1024 << ","
+     << heap_maxdelta / 1024 << ","
+     << retained / 1024 << ","
+     << retained_slope << ","
+     << leak_suspect() << ",";
+  // return codes as code:count pairs separated by ; to keep it one column
+  for (map<int, unsigned long>::const_iterator iter = retcodes.begin(); iter != retcodes.end(); ++iter)
+  {
+    if (iter != retcodes.begin())
+    {
+      os << ";";
+    }
+    os << iter->first << ":" << iter->second;
+  }
+  os << endl;
+  return;
+}
+
+void Fun4AllModuleMetrics::PrintJson(ostream &os) const
+{
+  os << "{\"module\": \"" << modulename << "\""
+     << ", \"calls\": " << ncall
+     << ", \"wall_ms\": " << wall_time()
+     << ", \"cpu_ms\": " << cputime
+     << ", \"max_wall_ms\": " << maxtime
+     << ", \"nodes_added\": " << nodes_added
+     << ", \"heap_event_kb\": " << heap_event / 1024
+     << ", \"heap_reset_kb\": " << heap_reset / 1024
+     << ", \"rss_event_kb\": " << rss_event / 1024
+     << ", \"heap_max_delta_kb\": " << heap_maxdelta / 1024
+     << ", \"retained_kb\": " << retained / 1024
+     << ", \"retained_slope_b\": " << retained_slope
+     << ", \"leak_suspect\": " << (leak_suspect() ? "true" : "false")
+     << ", \"retcodes\": {";
+  for (map<int, unsigned long>::const_iterator iter = retcodes.begin(); iter != retcodes.end(); ++iter)
+  {
+    if (iter != retcodes.begin())
+    {
+      os << ", ";
+    }
+    os << "\"" << iter->first << "\": " << iter->second;
+  }
+  os << "}}";
+  return;
+}
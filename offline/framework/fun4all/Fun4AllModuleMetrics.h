@@ -0,0 +1,87 @@
+#ifndef FUN4ALLMODULEMETRICS_H__
+#define FUN4ALLMODULEMETRICS_H__
+
+#include <ctime>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <string>
+
+class PHTimer;
+
+/*! \brief
+  per module bookkeeping of the event loop: wall and cpu time,
+  return codes, number of nodes added to the node tree and
+  (with Fun4AllServer::MemoryCheck) heap and rss changes.
+  Fun4AllServer creates one for each registered SubsysReco, the
+  timer itself is owned by the server (timer_map)
+*/
+class Fun4AllModuleMetrics
+{
+ public:
+  Fun4AllModuleMetrics(const std::string &name, PHTimer *timer);
+  virtual ~Fun4AllModuleMetrics() {}
+
+  //! start timing of one process_event call
+  void start();
+
+  //! stop timing of one process_event call and record its return code
+  void stop(const int retcode);
+
+  //! record the change in the number of nodes during one call
+  void add_nodes(const int n) { nodes_added += n; }
+
+  //! record the heap and rss change (bytes) of one process_event or ResetEvent call
+  void add_memory(const long heapdelta, const long rssdelta, const bool reset);
+
+  //! close the memory bookkeeping of one event: the heap retained by this module
+  //! (process_event plus ResetEvent deltas) is added to its retained series if count
+  //! is set (the first events are skipped). Once window events are collected the
+  //! slope of the series is fitted, jobslope is the slope of the heap in use after
+  //! the node tree reset over the same events
+  void end_event(const bool count, const unsigned int window, const double jobslope);
+
+  //! the retained heap of the module grew steadily over the last window and the
+  //! heap of the job grew with it
+  bool leak_suspect() const { return leak; }
+
+  //! least squares slope of the series over its index (bytes per event)
+  static double Slope(const std::deque<long> &series);
+
+  //! heap in use and resident set size of this process in bytes
+  static long HeapInUse();
+  static long ResidentSize();
+
+  const std::string &name() const { return modulename; }
+  //! module name for PHTrace zones, valid for the whole job
+  const char *trace_label() const { return tracelabel; }
+  unsigned long ncalls() const { return ncall; }
+  double wall_time() const;
+  double cpu_time() const { return cputime; }
+
+  static void PrintCsvHeader(std::ostream &os);
+  void PrintCsv(std::ostream &os, const unsigned long nevents) const;
+  void PrintJson(std::ostream &os) const;
+
+ protected:
+  std::string modulename;
+  const char *tracelabel;
+  PHTimer *timer;
+  std::clock_t cpustart;
+  unsigned long ncall;
+  double cputime;  // ms
+  double maxtime;  // ms
+  long nodes_added;
+  std::map<int, unsigned long> retcodes;
+  long heap_event;  // summed heap deltas of process_event
+  long heap_reset;  // summed heap deltas of ResetEvent
+  long rss_event;
+  long heap_maxdelta;
+  long retained_event;   // heap retained in the current event
+  long retained;         // summed over the counted events
+  std::deque<long> retained_series;  // retained after each of the last events
+  double retained_slope;  // bytes/event of the last complete window
+  bool leak;
+};
+
+#endif /* FUN4ALLMODULEMETRICS_H__ */
@@ -64,6 +64,10 @@ class Fun4AllOutputManager: public Fun4AllBase
   //! decides if event is to be written or not
   virtual int DoNotWriteEvent(std::vector <int> *retcodes) const;
 
+  //! the manager takes the objects of the written nodes and leaves reset ones
+  //! (asynchronous DST output), Fun4AllServer lets it write after all others
+  virtual bool SwapsNodeObjects() const {return false;}
+
   //! get number of Events
   virtual size_t EventsWritten() const {return nEvents;}
 
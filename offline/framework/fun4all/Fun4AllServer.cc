@@ -1,9 +1,11 @@
 #include "Fun4AllServer.h"
 #include "Fun4AllHistoBinDefs.h"
 #include "Fun4AllInputManager.h"
+#include "Fun4AllModuleMetrics.h"
 #include "Fun4AllOutputManager.h"
 #include "Fun4AllReturnCodes.h"
 #include "Fun4AllSyncManager.h"
+#include "Fun4AllWorker.h"
 #include "SubsysReco.h"
 
 #include <phool/PHCompositeNode.h>
@@ -14,6 +16,7 @@
 #include <phool/PHObject.h>
 #include <phool/PHPointerListIterator.h>
 #include <phool/PHTimeStamp.h>
+#include <phool/PHTrace.h>
 #include <phool/PHTypedNodeIterator.h>
 #include <phool/getClass.h>
 #include <phool/phool.h>
@@ -23,6 +26,7 @@
 #include <TFile.h>
 #include <TH1D.h>
 #include <TNamed.h>
+#include <RVersion.h>
 #include <TROOT.h>
 #include <TSystem.h>
 
@@ -33,6 +37,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <exception>
+#include <fstream>
 #include <iostream>
 #include <sstream>
 
@@ -58,15 +63,33 @@ Fun4AllServer::Fun4AllServer(const std::string &name)
   , unregistersubsystem(0)
   , runnumber(0)
   , eventnumber(0)
+  , first_run_call(true)
+  , run_number_forced(false)
+  , first_write(true)
+  , metrics_every(0)
+  , metrics_events(0)
+  , metrics_csvheader(true)
+  , memory_check(0)
+  , mem_skip(10)
+  , mem_window(100)
+  , mem_retained(0)
+  , mem_events(0)
   , beginruntimestamp(nullptr)
   , keep_db_connected(0)
+  , nworkers(0)
 {
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 0, 0)
+  // has to be on before ROOT objects are used from other threads (asynchronous
+  // DST output), switching it on later in the job is not safe
+  ROOT::EnableThreadSafety();
+#endif
   InitAll();
   return;
 }
 
 Fun4AllServer::~Fun4AllServer()
 {
+  DeleteWorkers();  // they point to objects in our node trees
   Reset();
   delete beginruntimestamp;
   while (Subsystems.begin() != Subsystems.end())
@@ -78,6 +101,11 @@ Fun4AllServer::~Fun4AllServer()
     delete Subsystems.back().first;
     Subsystems.pop_back();
   }
+  while (SubsysMetrics.begin() != SubsysMetrics.end())
+  {
+    delete SubsysMetrics.back();
+    SubsysMetrics.pop_back();
+  }
   while (HistoManager.begin() != HistoManager.end())
   {
     if (verbosity >= VERBOSITY_MORE)
@@ -218,6 +246,8 @@ int Fun4AllServer::registerSubsystem(SubsysReco *subsystem, const string &topnod
   PHCompositeNode *subsystopNode = se->topNode(topnodename);
   pair<SubsysReco *, PHCompositeNode *> newsubsyspair(subsystem, subsystopNode);
   int iret = 0;
+  set<string> dstnodes;
+  DstNodePaths(dstnodes);
   try
   {
     iret = subsystem->Init(subsystopNode);
@@ -236,6 +266,7 @@ int Fun4AllServer::registerSubsystem(SubsysReco *subsystem, const string &topnod
     exit(1);
   }
   gROOT->cd(currdir.c_str());
+  AddModuleNodes(dstnodes);
   if (iret)
   {
     if (iret == Fun4AllReturnCodes::DONOTREGISTERSUBSYSTEM)
@@ -262,6 +293,9 @@ int Fun4AllServer::registerSubsystem(SubsysReco *subsystem, const string &topnod
   {
     timer_map[timer_name.str()] = timer;
   }
+  // the timer is resolved here once, map entries do not move so
+  // the pointer stays valid and process_event does not search for it
+  SubsysMetrics.push_back(new Fun4AllModuleMetrics(timer_name.str(), &timer_map[timer_name.str()]));
   RetCodes.push_back(iret);  // vector with return codes
   return 0;
 }
@@ -309,6 +343,8 @@ int Fun4AllServer::unregisterSubsystemsNow()
     delete (*removeiter).first;
     // also update the vector with return codes
     RetCodes.erase(RetCodes.begin() + index);
+    delete SubsysMetrics[index];
+    SubsysMetrics.erase(SubsysMetrics.begin() + index);
     vector<Fun4AllOutputManager *>::iterator outiter;
     for (outiter = OutputManager.begin(); outiter != OutputManager.end(); ++outiter)
     {
@@ -501,6 +537,7 @@ int Fun4AllServer::process_event(PHCompositeNode * /*topNode*/)
 
 int Fun4AllServer::process_event()
 {
+  PHTRACE_ZONE("Fun4AllServer::process_event");
   vector<pair<SubsysReco *, PHCompositeNode *> >::iterator iter;
   unsigned icnt = 0;
   int eventbad = 0;
@@ -525,6 +562,11 @@ int Fun4AllServer::process_event()
   {
     unregisterSubsystemsNow();
   }
+  long heap_event_start = 0;
+  if (memory_check)
+  {
+    heap_event_start = Fun4AllModuleMetrics::HeapInUse();
+  }
   gROOT->cd(default_Tdirectory.c_str());
   string currdir = gDirectory->GetPath();
   for (iter = Subsystems.begin(); iter != Subsystems.end(); ++iter)
@@ -552,25 +594,30 @@ int Fun4AllServer::process_event()
 
     try
     {
-      ostringstream timer_name;
-      timer_name << (*iter).first->Name() << "_" << (*iter).second->getName();
-      std::map<const std::string, PHTimer>::iterator titer = timer_map.find(timer_name.str());
-      bool timer_found = false;
-      if (titer != timer_map.end())
+      PHTRACE_ZONE(SubsysMetrics[icnt]->trace_label());
+      int nodes_before = 0;
+      if (!metrics_file.empty())
       {
-        timer_found = true;
-	titer->second.restart();
+        nodes_before = CountOutNodes((*iter).second);
       }
-      else
+      long heap_before = 0;
+      long rss_before = 0;
+      if (memory_check)
       {
-	cout << "could not find timer for " << timer_name << endl;
+        heap_before = Fun4AllModuleMetrics::HeapInUse();
+        rss_before = Fun4AllModuleMetrics::ResidentSize();
       }
+      SubsysMetrics[icnt]->start();
       RetCodes[icnt] = (*iter).first->process_event((*iter).second);
-      if (timer_found)
+      SubsysMetrics[icnt]->stop(RetCodes[icnt]);
+      if (memory_check)
       {
-	titer->second.stop();
+        MemoryCheckModule(icnt, heap_before, rss_before, false);
+      }
+      if (!metrics_file.empty())
+      {
+        SubsysMetrics[icnt]->add_nodes(CountOutNodes((*iter).second) - nodes_before);
       }
-
     }
     catch (const exception &e)
     {
@@ -635,57 +682,36 @@ int Fun4AllServer::process_event()
   if (!OutputManager.empty() && !eventbad)  // there are registered IO managers and
   // the event is not flagged bad
   {
+    PHTRACE_ZONE("output");
     PHNodeIterator iter(TopNode);
     PHCompositeNode *dstNode = dynamic_cast<PHCompositeNode *>(iter.findFirst("PHCompositeNode", "DST"));
 
     if (dstNode)
     {
-      // check if we have same number of nodes. After first event is
-      // written out root I/O doesn't permit adding nodes, otherwise
-      // events get out of sync
-      static int first = 1;
-      int newcount = CountOutNodes(dstNode);
-      if (first)
-      {
-        first = 0;
-        OutNodeCount = newcount;      // save number of nodes before first write
-        MakeNodesTransient(dstNode);  // make all nodes transient before 1st write in case someone sneaked a node in at the first event
-      }
-
-      if (OutNodeCount != newcount)
-      {
-        iter.print();
-        cout << PHWHERE << " FATAL: Someone changed the number of Output Nodes on the fly, from " << OutNodeCount << " to " << newcount << endl;
-        exit(1);
-      }
-      vector<Fun4AllOutputManager *>::iterator iterOutMan;
-      for (iterOutMan = OutputManager.begin(); iterOutMan != OutputManager.end(); ++iterOutMan)
-      {
-        if (!(*iterOutMan)->DoNotWriteEvent(&RetCodes))
-        {
-          if (verbosity >= VERBOSITY_MORE)
-          {
-            cout << "Writing Event for " << (*iterOutMan)->Name() << endl;
-          }
-          (*iterOutMan)->WriteGeneric(dstNode);
-        }
-        else
-        {
-          if (verbosity >= VERBOSITY_MORE)
-          {
-            cout << "Not Writing Event for " << (*iterOutMan)->Name() << endl;
-          }
-        }
-      }
+      WriteEvent(dstNode, RetCodes, first_write);
     }
   }
+  PHTRACE_ZONE("reset");
+  icnt = 0;
   for (iter = Subsystems.begin(); iter != Subsystems.end(); ++iter)
   {
     if (verbosity >= VERBOSITY_EVEN_MORE)
     {
       cout << "Fun4AllServer::process_event Resetting Event " << (*iter).first->Name() << endl;
     }
+    long heap_before = 0;
+    long rss_before = 0;
+    if (memory_check)
+    {
+      heap_before = Fun4AllModuleMetrics::HeapInUse();
+      rss_before = Fun4AllModuleMetrics::ResidentSize();
+    }
     (*iter).first->ResetEvent((*iter).second);
+    if (memory_check)
+    {
+      MemoryCheckModule(icnt, heap_before, rss_before, true);
+    }
+    icnt++;
   }
   BOOST_FOREACH (Fun4AllSyncManager *syncman, SyncManagers)
   {
@@ -696,6 +722,100 @@ int Fun4AllServer::process_event()
     syncman->ResetEvent();
   }
   ResetNodeTree();
+  if (memory_check)
+  {
+    long heap = Fun4AllModuleMetrics::HeapInUse();
+    mem_events++;
+    mem_retained += heap - heap_event_start;
+    // the first events fill caches and pools, they do not count
+    bool count = (mem_events > mem_skip);
+    double jobslope = 0;
+    if (count)
+    {
+      mem_level.push_back(heap);
+      if (mem_level.size() > mem_window)
+      {
+        mem_level.pop_front();
+      }
+      jobslope = Fun4AllModuleMetrics::Slope(mem_level);
+    }
+    BOOST_FOREACH (Fun4AllModuleMetrics *metrics, SubsysMetrics)
+    {
+      metrics->end_event(count, mem_window, jobslope);
+    }
+  }
+  metrics_events++;
+  if (metrics_every > 0 && (metrics_events % metrics_every) == 0)
+  {
+    DumpMetrics();
+  }
+  return 0;
+}
+
+// writes the event in dstNode with all output managers, firsttreewrite is
+// set for the first event of a node tree (the workers have their own)
+int Fun4AllServer::WriteEvent(PHCompositeNode *dstNode, vector<int> &retcodes, const bool firsttreewrite)
+{
+  // check if we have same number of nodes. After first event is
+  // written out root I/O doesn't permit adding nodes, otherwise
+  // events get out of sync
+  int newcount = CountOutNodes(dstNode);
+  if (first_write)
+  {
+    first_write = false;
+    OutNodeCount = newcount;  // save number of nodes before first write
+  }
+  if (firsttreewrite)
+  {
+    MakeNodesTransient(dstNode);  // make all nodes transient before 1st write in case someone sneaked a node in at the first event
+  }
+
+  if (OutNodeCount != newcount)
+  {
+    PHNodeIterator iter(dstNode);
+    iter.print();
+    cout << PHWHERE << " FATAL: Someone changed the number of Output Nodes on the fly, from " << OutNodeCount << " to " << newcount << endl;
+    exit(1);
+  }
+  // a manager which takes the objects out of the nodes (asynchronous
+  // DST output) leaves reset ones behind, it has to write last and
+  // there can only be one
+  int nswap = 0;
+  vector<Fun4AllOutputManager *>::iterator iterOutMan;
+  for (iterOutMan = OutputManager.begin(); iterOutMan != OutputManager.end(); ++iterOutMan)
+  {
+    nswap += (*iterOutMan)->SwapsNodeObjects();
+  }
+  if (nswap > 1)
+  {
+    cout << PHWHERE << " FATAL: " << nswap << " output managers write asynchronously, only one can" << endl;
+    exit(1);
+  }
+  for (int pass = 0; pass < 2; pass++)
+  {
+    for (iterOutMan = OutputManager.begin(); iterOutMan != OutputManager.end(); ++iterOutMan)
+    {
+      if ((*iterOutMan)->SwapsNodeObjects() != (pass > 0))
+      {
+        continue;
+      }
+      if (!(*iterOutMan)->DoNotWriteEvent(&retcodes))
+      {
+        if (verbosity >= VERBOSITY_MORE)
+        {
+          cout << "Writing Event for " << (*iterOutMan)->Name() << endl;
+        }
+        (*iterOutMan)->WriteGeneric(dstNode);
+      }
+      else
+      {
+        if (verbosity >= VERBOSITY_MORE)
+        {
+          cout << "Not Writing Event for " << (*iterOutMan)->Name() << endl;
+        }
+      }
+    }
+  }
   return 0;
 }
 
@@ -789,6 +909,8 @@ int Fun4AllServer::BeginRun(const int runno)
   // save the current dir, cd to the subsystem name dir (which was
   // created in init) call the InitRun of the module and cd back
 
+  set<string> dstnodes;
+  DstNodePaths(dstnodes);
   gROOT->cd(default_Tdirectory.c_str());
   string currdir = gDirectory->GetPath();
   for (iter = Subsystems.begin(); iter != Subsystems.end(); ++iter)
@@ -844,6 +966,7 @@ int Fun4AllServer::BeginRun(const int runno)
     }
   }
   gROOT->cd(currdir.c_str());
+  AddModuleNodes(dstnodes);
 
   // disconnect from DB to save resources on DB machine
   // PdbCal leaves the DB connection open (PdbCal will reconnect without
@@ -936,6 +1059,10 @@ int Fun4AllServer::MakeNodesPersistent(PHCompositeNode *startNode)
 
 int Fun4AllServer::EndRun(const int runno)
 {
+  BOOST_FOREACH (Fun4AllWorker *worker, workers)
+  {
+    worker->EndRun(runno);
+  }
   vector<pair<SubsysReco *, PHCompositeNode *> >::iterator iter;
   gROOT->cd(default_Tdirectory.c_str());
   string currdir = gDirectory->GetPath();
@@ -990,6 +1117,11 @@ int Fun4AllServer::End()
   recoConsts *rc = recoConsts::instance();
   EndRun(rc->get_IntFlag("RUNNUMBER"));  // call SubsysReco EndRun methods for current run
   int i = 0;
+  BOOST_FOREACH (Fun4AllWorker *worker, workers)
+  {
+    i += worker->End();
+  }
+  DeleteWorkers();
   vector<pair<SubsysReco *, PHCompositeNode *> >::iterator iter;
   gROOT->cd(default_Tdirectory.c_str());
   string currdir = gDirectory->GetPath();
@@ -1055,6 +1187,28 @@ int Fun4AllServer::End()
   // done inside outfileclose())
   outfileclose();
 
+  if (!metrics_file.empty())
+  {
+    DumpMetrics();
+  }
+  if (!trace_file.empty())
+  {
+    PHTrace::Dump(trace_file);
+  }
+  if (memory_check)
+  {
+    cout << "Fun4AllServer memory check: heap grew by " << mem_retained / 1024
+         << " kB over " << mem_events << " events" << endl;
+    BOOST_FOREACH (Fun4AllModuleMetrics *metrics, SubsysMetrics)
+    {
+      if (metrics->leak_suspect())
+      {
+        cout << "Fun4AllServer memory check: " << metrics->name()
+             << " retained heap keeps growing, possible leak" << endl;
+      }
+    }
+  }
+
   if (ScreamEveryEvent)
   {
     cout << "*******************************************************************************" << endl;
@@ -1288,16 +1442,103 @@ int Fun4AllServer::DstEvents() const
 int Fun4AllServer::run(const int nevnts, const bool require_nevents)
 {
   recoConsts *rc = recoConsts::instance();
-  static bool run_number_forced = rc->FlagExist("RUNNUMBER");
-  static int ifirst = 1;
-  if (ifirst && run_number_forced)
+  if (first_run_call)
+  {
+    run_number_forced = rc->FlagExist("RUNNUMBER");
+  }
+  if (first_run_call && run_number_forced)
   {
     runnumber = rc->get_IntFlag("RUNNUMBER");
     cout << "Fun4AllServer: Runnumber forced to " << runnumber << " by RUNNUMBER IntFlag" << endl;
   }
+  if (nworkers > 1)
+  {
+    return RunWorkers(nevnts, require_nevents);
+  }
   int iret = 0;
   int icnt = 0;
   int icnt_good = 0;
+  while (!iret)
+  {
+    iret = ReadEvent();
+    if (iret)
+    {
+      break;
+    }
+    int currentrun = InputRun();
+    if (first_run_call)
+    {
+      if (currentrun != runnumber && !run_number_forced)  // use real run if not forced
+      {
+        runnumber = currentrun;
+      }
+      setRun(runnumber);
+      BeginRun(runnumber);
+      first_run_call = false;
+    }
+    else if (!run_number_forced)
+    {
+      if (currentrun != runnumber)
+      {
+        EndRun(runnumber);
+        runnumber = currentrun;
+        setRun(runnumber);
+        BeginRun(runnumber);
+      }
+    }
+
+    if (verbosity >= VERBOSITY_SOME)
+    {
+      // print event cycle counter in log scale if VERBOSITY_SOME
+
+      const double significand = icnt / pow(10, (int) (log10(icnt)));
+
+      if ((fmod(significand, 1.0) == 0 && significand <= 10) or icnt == 0)
+      {
+        cout << "Fun4AllServer::run - process_event cycle "
+             << icnt << "\t for run " << runnumber;
+        if (require_nevents)
+          cout << ", " << icnt_good << " good event so far";
+        cout << endl;
+      }
+    }
+
+    if (icnt == 0 and verbosity > VERBOSITY_QUIET)
+    {
+      // increase verbosity for the first event in verbose modes
+      ++verbosity;
+    }
+
+    iret = process_event();
+
+    if (icnt == 0 and verbosity > VERBOSITY_QUIET)
+    {
+      // increase verbosity for the first event in verbose modes
+      --verbosity;
+    }
+
+    if (require_nevents)
+    {
+      if (std::find(RetCodes.begin(),
+                    RetCodes.end(),
+                    static_cast<int>(Fun4AllReturnCodes::ABORTEVENT)) == RetCodes.end())
+        icnt_good++;
+      if (iret || (nevnts > 0 && icnt_good >= nevnts))
+        break;
+    }
+    else if (iret || (nevnts > 0 && ++icnt >= nevnts))
+    {
+      break;
+    }
+  }
+  return iret;
+}
+
+// reads the next event with all sync managers into the node trees,
+// returns non zero at the end of the input
+int Fun4AllServer::ReadEvent()
+{
+  int iret = 0;
   vector<Fun4AllSyncManager *>::const_iterator iter;
   while (!iret)
   {
@@ -1308,7 +1549,11 @@ int Fun4AllServer::run(const int nevnts, const bool require_nevents)
       {
         cout << "executing run for input master " << (*iter)->Name() << endl;
       }
-      int retval = (*iter)->run(1);
+      int retval;
+      {
+        PHTRACE_ZONE("input");
+        retval = (*iter)->run(1);
+      }
       // if a new input file is opened during syncing and it contains
       // different nodes
       // as the previous one, the info in the nodes which are only in
@@ -1338,39 +1583,79 @@ int Fun4AllServer::run(const int nevnts, const bool require_nevents)
       }
       continue;
     }
-    if (iret)
-    {
-      break;
-    }
-    int currentrun = 0;
-    for (iter = SyncManagers.begin(); iter != SyncManagers.end(); ++iter)
+    break;
+  }
+  return iret;
+}
+
+// run number of the event the sync managers just read
+int Fun4AllServer::InputRun()
+{
+  int currentrun = 0;
+  vector<Fun4AllSyncManager *>::const_iterator iter;
+  for (iter = SyncManagers.begin(); iter != SyncManagers.end(); ++iter)
+  {
+    int runno = (*iter)->CurrentRun();
+    //	  cout << (*iter)->Name() << " run no: " << runno << endl;
+    if (runno != 0)
     {
-      int runno = (*iter)->CurrentRun();
-      //	  cout << (*iter)->Name() << " run no: " << runno << endl;
-      if (runno != 0)
+      if (currentrun == 0)
       {
-        if (currentrun == 0)
-        {
-          currentrun = runno;
-        }
-        else
+        currentrun = runno;
+      }
+      else
+      {
+        if (currentrun != runno)
         {
-          if (currentrun != runno)
+          cout << "Mixing of Runs within same event is not supported" << endl;
+          cout << "Here is the list of Sync Managers and their runnumbers:" << endl;
+          vector<Fun4AllSyncManager *>::const_iterator syiter;
+          for (syiter = SyncManagers.begin(); syiter != SyncManagers.end(); ++syiter)
           {
-            cout << "Mixing of Runs within same event is not supported" << endl;
-            cout << "Here is the list of Sync Managers and their runnumbers:" << endl;
-            vector<Fun4AllSyncManager *>::const_iterator syiter;
-            for (syiter = SyncManagers.begin(); syiter != SyncManagers.end(); ++syiter)
-            {
-              cout << (*syiter)->Name() << " run number: " << (*syiter)->CurrentRun() << endl;
-            }
-            cout << "Exiting now" << endl;
-            exit(1);
+            cout << (*syiter)->Name() << " run number: " << (*syiter)->CurrentRun() << endl;
           }
+          cout << "Exiting now" << endl;
+          exit(1);
         }
       }
     }
-    if (ifirst)
+  }
+  return currentrun;
+}
+
+// event loop with workers (Workers()): the events are read in this
+// thread and handed to the workers round robin, a worker which gets
+// its next event first has to finish the one it has. The events are
+// finished (written out, reset) in the order they were read
+int Fun4AllServer::RunWorkers(const int nevnts, const bool require_nevents)
+{
+  int iret = 0;
+  int icnt = 0;       // events handed to the workers
+  int icnt_good = 0;  // finished events without ABORTEVENT
+  deque<Fun4AllWorker *> busy;  // in event order
+  while (!iret)
+  {
+    if (nevnts > 0 && (require_nevents ? icnt_good + (int) busy.size() : icnt) >= nevnts)
+    {
+      // enough events are on the way, aborted ones need replacements
+      while (!busy.empty() && !iret)
+      {
+        iret = FinishWorkerEvent(busy.front(), icnt_good);
+        busy.pop_front();
+      }
+      if (iret || !require_nevents || icnt_good >= nevnts)
+      {
+        break;
+      }
+      continue;
+    }
+    iret = ReadEvent();
+    if (iret)
+    {
+      break;
+    }
+    int currentrun = InputRun();
+    if (first_run_call)
     {
       if (currentrun != runnumber && !run_number_forced)  // use real run if not forced
       {
@@ -1378,64 +1663,210 @@ int Fun4AllServer::run(const int nevnts, const bool require_nevents)
       }
       setRun(runnumber);
       BeginRun(runnumber);
-      ifirst = 0;
+      first_run_call = false;
     }
-    else if (!run_number_forced)
+    else if (!run_number_forced && currentrun != runnumber)
     {
-      if (currentrun != runnumber)
+      // the events of the old run are finished first
+      while (!busy.empty() && !iret)
       {
-        EndRun(runnumber);
-        runnumber = currentrun;
-        setRun(runnumber);
-        BeginRun(runnumber);
+        iret = FinishWorkerEvent(busy.front(), icnt_good);
+        busy.pop_front();
+      }
+      if (iret)
+      {
+        break;
       }
+      EndRun(runnumber);
+      runnumber = currentrun;
+      setRun(runnumber);
+      BeginRun(runnumber);
     }
-
-    if (verbosity >= VERBOSITY_SOME)
+    if (workers.empty() && !MakeWorkers())
     {
-      // print event cycle counter in log scale if VERBOSITY_SOME
-
-      const double significand = icnt / pow(10, (int) (log10(icnt)));
-
-      if ((fmod(significand, 1.0) == 0 && significand <= 10) or icnt == 0)
+      // single threaded, starting with the event we just read
+      iret = process_event();
+      int nleft = nevnts;
+      if (!require_nevents || std::find(RetCodes.begin(), RetCodes.end(), static_cast<int>(Fun4AllReturnCodes::ABORTEVENT)) == RetCodes.end())
       {
-        cout << "Fun4AllServer::run - process_event cycle "
-             << icnt << "\t for run " << runnumber;
-        if (require_nevents)
-          cout << ", " << icnt_good << " good event so far";
-        cout << endl;
+        nleft--;
+      }
+      if (iret || (nevnts > 0 && nleft <= 0))
+      {
+        return iret;
       }
+      return run((nevnts > 0) ? nleft : 0, require_nevents);
     }
-
-    if (icnt == 0 and verbosity > VERBOSITY_QUIET)
+    if (busy.size() == workers.size())
     {
-      // increase verbosity for the first event in verbose modes
-      ++verbosity;
+      iret = FinishWorkerEvent(busy.front(), icnt_good);
+      busy.pop_front();
+      if (iret)
+      {
+        break;
+      }
     }
+    Fun4AllWorker *worker = workers[icnt % workers.size()];
+    PHNodeIterator iter(TopNode);
+    PHCompositeNode *dstNode = dynamic_cast<PHCompositeNode *>(iter.findFirst("PHCompositeNode", "DST"));
+    worker->TakeEvent(dstNode, module_nodes);
+    if (worker->NeedsInitRun() && worker->InitRun())
+    {
+      cout << PHWHERE << worker->Name() << " failed InitRun, exiting" << endl;
+      exit(-2);
+    }
+    BOOST_FOREACH (Fun4AllSyncManager *syncman, SyncManagers)
+    {
+      syncman->ResetEvent();
+    }
+    ResetNodeTree();
+    worker->Start();
+    busy.push_back(worker);
+    icnt++;
+    if (verbosity >= VERBOSITY_MORE)
+    {
+      cout << "Fun4AllServer::run - event " << icnt << " to " << worker->Name() << endl;
+    }
+  }
+  // end of input, the events on the way are finished. After an abort
+  // run the later events are dropped as in the single threaded loop
+  bool abortrun = (iret == Fun4AllReturnCodes::ABORTRUN);
+  while (!busy.empty())
+  {
+    if (abortrun)
+    {
+      busy.front()->Wait();
+      busy.front()->ResetEvent();
+    }
+    else
+    {
+      int ret = FinishWorkerEvent(busy.front(), icnt_good);
+      if (ret)
+      {
+        iret = ret;
+        abortrun = true;
+      }
+    }
+    busy.pop_front();
+  }
+  return iret;
+}
 
-    iret = process_event();
-
-    if (icnt == 0 and verbosity > VERBOSITY_QUIET)
+// waits for the event of the worker, writes it out and resets the
+// worker tree, returns ABORTRUN if a module aborted the run
+int Fun4AllServer::FinishWorkerEvent(Fun4AllWorker *worker, int &icnt_good)
+{
+  int iret = worker->Wait();
+  if (iret == Fun4AllReturnCodes::ABORTRUN)
+  {
+    retcodesmap[Fun4AllReturnCodes::ABORTRUN]++;
+  }
+  else if (iret == Fun4AllReturnCodes::ABORTEVENT)
+  {
+    retcodesmap[Fun4AllReturnCodes::ABORTEVENT]++;
+  }
+  else
+  {
+    retcodesmap[Fun4AllReturnCodes::EVENT_OK]++;
+    icnt_good++;
+    if (!OutputManager.empty())
     {
-      // increase verbosity for the first event in verbose modes
-      --verbosity;
+      PHTRACE_ZONE("output");
+      WriteEvent(worker->dstNode(), worker->RetCodes(), worker->FirstWrite());
     }
+  }
+  worker->ResetEvent();
+  return (iret == Fun4AllReturnCodes::ABORTRUN) ? iret : 0;
+}
 
-    if (require_nevents)
+// the workers are made after the first BeginRun, the modules of the
+// server have made their run nodes by then
+bool Fun4AllServer::MakeWorkers()
+{
+  if (topnodemap.size() > 1)
+  {
+    cout << "Fun4AllServer: workers only run with the TOP node tree, running single threaded" << endl;
+    nworkers = 0;
+    return false;
+  }
+  vector<SubsysReco *> clones;
+  vector<pair<SubsysReco *, PHCompositeNode *> >::const_iterator iter;
+  for (iter = Subsystems.begin(); iter != Subsystems.end(); ++iter)
+  {
+    SubsysReco *clone = ((*iter).second == TopNode) ? (*iter).first->clone() : nullptr;
+    if (!clone)
     {
-      if (std::find(RetCodes.begin(),
-                    RetCodes.end(),
-                    static_cast<int>(Fun4AllReturnCodes::ABORTEVENT)) == RetCodes.end())
-        icnt_good++;
-      if (iret || (nevnts > 0 && icnt_good >= nevnts))
-        break;
+      cout << "Fun4AllServer: " << (*iter).first->Name()
+           << " cannot run in a worker, running single threaded" << endl;
+      BOOST_FOREACH (SubsysReco *subsys, clones)
+      {
+        delete subsys;
+      }
+      nworkers = 0;
+      return false;
     }
-    else if (iret || (nevnts > 0 && ++icnt >= nevnts))
+    clones.push_back(clone);
+  }
+  for (int i = 0; i < nworkers; i++)
+  {
+    ostringstream name;
+    name << "Fun4AllWorker_" << i;
+    Fun4AllWorker *worker = new Fun4AllWorker(name.str(), TopNode);
+    worker->Verbosity(verbosity);
+    workers.push_back(worker);
+    for (unsigned int j = 0; j < Subsystems.size(); j++)
     {
-      break;
+      SubsysReco *clone = (i == 0) ? clones[j] : Subsystems[j].first->clone();
+      int iret = worker->registerSubsystem(clone);
+      if (iret)
+      {
+        cout << PHWHERE << " Error initializing " << clone->Name() << " in "
+             << worker->Name() << ", return code: " << iret << endl;
+        exit(1);
+      }
+    }
+  }
+  if (verbosity >= VERBOSITY_SOME)
+  {
+    cout << "Fun4AllServer: running " << Subsystems.size() << " modules in "
+         << nworkers << " workers" << endl;
+  }
+  return true;
+}
+
+void Fun4AllServer::DeleteWorkers()
+{
+  while (!workers.empty())
+  {
+    delete workers.back();
+    workers.pop_back();
+  }
+}
+
+// paths of the data nodes in the DST under TOP
+void Fun4AllServer::DstNodePaths(set<string> &paths)
+{
+  PHNodeIterator iter(TopNode);
+  PHCompositeNode *dstNode = dynamic_cast<PHCompositeNode *>(iter.findFirst("PHCompositeNode", "DST"));
+  if (dstNode)
+  {
+    Fun4AllWorker::DataNodePaths(dstNode, "/DST", paths);
+  }
+}
+
+// the data nodes which are new since before were made by a module (Init,
+// InitRun), the workers do not take them from the DST of the server
+void Fun4AllServer::AddModuleNodes(const set<string> &before)
+{
+  set<string> after;
+  DstNodePaths(after);
+  for (set<string>::const_iterator iter = after.begin(); iter != after.end(); ++iter)
+  {
+    if (before.find(*iter) == before.end())
+    {
+      module_nodes.insert(*iter);
     }
   }
-  return iret;
 }
 
 //_________________________________________________________________
@@ -1668,3 +2099,106 @@ void Fun4AllServer::PrintTimer(const string &name)
   }
   return;
 }
+
+void Fun4AllServer::MetricsOutput(const string &filename, const int every_nevents)
+{
+  metrics_file = filename;
+  metrics_every = every_nevents;
+  metrics_csvheader = true;
+  return;
+}
+
+void Fun4AllServer::TraceOutput(const string &filename)
+{
+  trace_file = filename;
+  PHTrace::Enable(!trace_file.empty());
+  return;
+}
+
+void Fun4AllServer::MemoryCheck(const int i, const unsigned int skip, const unsigned int window)
+{
+  memory_check = i;
+  mem_skip = skip;
+  // the slope needs at least two points
+  mem_window = (window < 2) ? 2 : window;
+  return;
+}
+
+void Fun4AllServer::MemoryCheckModule(const unsigned int icnt, const long heap_before, const long rss_before, const bool reset)
+{
+  SubsysMetrics[icnt]->add_memory(Fun4AllModuleMetrics::HeapInUse() - heap_before, Fun4AllModuleMetrics::ResidentSize() - rss_before, reset);
+  return;
+}
+
+int Fun4AllServer::DumpMetrics(const string &filename)
+{
+  string fname = (filename.empty()) ? metrics_file : filename;
+  if (fname.empty())
+  {
+    cout << PHWHERE << " no metrics output file given" << endl;
+    return -1;
+  }
+  bool csv = (fname.size() > 4 && fname.compare(fname.size() - 4, 4, ".csv") == 0);
+  ofstream fout;
+  if (csv)
+  {
+    // csv files accumulate one block of rows per dump
+    bool header = (fname != metrics_file || metrics_csvheader);
+    fout.open(fname.c_str(), (header) ? ios::out : ios::app);
+    if (fout && header)
+    {
+      Fun4AllModuleMetrics::PrintCsvHeader(fout);
+      if (fname == metrics_file)
+      {
+        metrics_csvheader = false;
+      }
+    }
+  }
+  else
+  {
+    // json files contain the latest snapshot
+    fout.open(fname.c_str());
+  }
+  if (!fout)
+  {
+    cout << PHWHERE << " could not open metrics output file " << fname << endl;
+    return -1;
+  }
+  if (csv)
+  {
+    BOOST_FOREACH (Fun4AllModuleMetrics *metrics, SubsysMetrics)
+    {
+      metrics->PrintCsv(fout, metrics_events);
+    }
+  }
+  else
+  {
+    fout << "{\"events\": " << metrics_events << "," << endl
+         << " \"heap_retained_kb\": " << mem_retained / 1024 << "," << endl
+         << " \"retcodes\": {";
+    for (map<int, int>::const_iterator iter = retcodesmap.begin(); iter != retcodesmap.end(); ++iter)
+    {
+      if (iter != retcodesmap.begin())
+      {
+        fout << ", ";
+      }
+      fout << "\"" << iter->first << "\": " << iter->second;
+    }
+    fout << "}," << endl
+         << " \"modules\": [" << endl;
+    for (vector<Fun4AllModuleMetrics *>::const_iterator iter = SubsysMetrics.begin(); iter != SubsysMetrics.end(); ++iter)
+    {
+      fout << "  ";
+      (*iter)->PrintJson(fout);
+      if (iter + 1 != SubsysMetrics.end())
+      {
+        fout << ",";
+      }
+      fout << endl;
+    }
+    fout << " ]" << endl
+         << "}" << endl;
+  }
+  fout.close();
+  return 0;
+}
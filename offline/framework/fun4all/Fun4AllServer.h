@@ -6,14 +6,18 @@
 
 #include <phool/PHTimer.h>
 
+#include <deque>
 #include <iostream>
 #include <map>
+#include <set>
 #include <string>
 #include <vector>
 
 class Fun4AllInputManager;
+class Fun4AllModuleMetrics;
 class Fun4AllSyncManager;
 class Fun4AllOutputManager;
+class Fun4AllWorker;
 class PHCompositeNode;
 class PHTimeStamp;
 class SubsysReco;
@@ -78,7 +82,7 @@ class Fun4AllServer : public Fun4AllBase
 
   /*! 
     \brief skip n events (0 means up to the end of file). 
-    Skip means read, don't process.
+    Skip means don't process, DSTs jump over the skipped entries without reading them.
   */
   int skip(const int nevnts = 0);
 
@@ -104,6 +108,46 @@ class Fun4AllServer : public Fun4AllBase
   void KeepDBConnection(const int i = 1) { keep_db_connected = i; }
   void PrintTimer(const std::string &name = "");
 
+  /*! \brief
+    write per module metrics (time, cpu, return codes, nodes added) to
+    filename at End() and every every_nevents events if > 0.
+    Files ending in .csv get one block of rows per dump, otherwise
+    the latest snapshot is written as json
+  */
+  void MetricsOutput(const std::string &filename, const int every_nevents = 0);
+  int DumpMetrics(const std::string &filename = "");
+
+  /*! \brief
+    record trace zones (PHTrace) for the event loop, every module's
+    process_event and the instrumented code inside the modules and
+    write them in chrome trace format to filename at End()
+  */
+  void TraceOutput(const std::string &filename);
+
+  /*! \brief
+    record heap (mallinfo) and rss changes around every module's
+    process_event and ResetEvent. After the first skip events the heap
+    each module retains per event is followed over a sliding window of
+    window events, modules whose retained heap keeps growing while the
+    heap of the job grows are flagged as leak suspects in the metrics
+    output (MetricsOutput) and at End()
+  */
+  void MemoryCheck(const int i = 1, const unsigned int skip = 10, const unsigned int window = 100);
+
+  /*! \brief
+    process the events with n worker threads (opt in, n > 1). Every worker
+    has its own node tree (DST, RUN, PAR) and runs clones of the registered
+    modules (SubsysReco::clone()), the run nodes of the server (geometry,
+    field) are shared read only. The input managers read into the DST of
+    the server, the objects are handed to the next free worker and the
+    output managers write the events in the order they were read.
+    If a module cannot be cloned or something is registered under
+    another top node than TOP the job runs single threaded.
+    Module metrics and the memory check are not recorded by the workers
+  */
+  void Workers(const int n) { nworkers = n; }
+  int Workers() const { return nworkers; }
+
  protected:
   Fun4AllServer(const std::string &name = "Fun4AllServer");
   int InitNodeTree(PHCompositeNode *topNode);
@@ -111,7 +155,17 @@ class Fun4AllServer : public Fun4AllBase
   int CountOutNodesRecursive(PHCompositeNode *startNode, const int icount);
   int UpdateEventSelector(Fun4AllOutputManager *manager);
   int unregisterSubsystemsNow();
+  void MemoryCheckModule(const unsigned int icnt, const long heap_before, const long rss_before, const bool reset);
   int setRun(const int runnumber);
+  int ReadEvent();
+  int InputRun();
+  int WriteEvent(PHCompositeNode *dstNode, std::vector<int> &retcodes, const bool firsttreewrite);
+  void DstNodePaths(std::set<std::string> &paths);
+  void AddModuleNodes(const std::set<std::string> &before);
+  bool MakeWorkers();
+  int RunWorkers(const int nevnts, const bool require_nevents);
+  int FinishWorkerEvent(Fun4AllWorker *worker, int &icnt_good);
+  void DeleteWorkers();
   static Fun4AllServer *__instance;
   int OutNodeCount;
   int bortime_override;
@@ -119,6 +173,11 @@ class Fun4AllServer : public Fun4AllBase
   int unregistersubsystem;
   int runnumber;
   int eventnumber;
+  // per instance bookkeeping which used to live in function statics,
+  // keeps the event loop state out of process wide storage
+  bool first_run_call;
+  bool run_number_forced;
+  bool first_write;
   std::vector<std::string> ComplaintList;
   PHCompositeNode *TopNode;
   std::vector<std::pair<SubsysReco *, PHCompositeNode *> > Subsystems;
@@ -135,8 +194,23 @@ class Fun4AllServer : public Fun4AllBase
   std::vector<Fun4AllSyncManager *> SyncManagers;
   std::map<int, int> retcodesmap;
   std::map<const std::string, PHTimer> timer_map;
+  std::vector<Fun4AllModuleMetrics *> SubsysMetrics;  // parallel to Subsystems
+  std::string metrics_file;
+  int metrics_every;
+  unsigned long metrics_events;
+  bool metrics_csvheader;
+  std::string trace_file;
+  int memory_check;
+  unsigned int mem_skip;
+  unsigned int mem_window;
+  std::deque<long> mem_level;  // heap in use after the node tree reset, last mem_window events
+  long mem_retained;   // heap growth over complete events (after the node tree reset)
+  unsigned long mem_events;
   TH1 *FrameWorkVars;
   int keep_db_connected;
+  int nworkers;
+  std::vector<Fun4AllWorker *> workers;
+  std::set<std::string> module_nodes;  // paths of the data nodes the modules made in the DST under TOP
 };
 
 #endif /* __FUN4ALLSERVER_H */
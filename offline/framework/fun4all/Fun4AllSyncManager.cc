@@ -247,12 +247,11 @@ Fun4AllSyncManager::skip(const int nevnts)
 {
   if (!InManager.empty())
     {
-      int Npushback = -nevnts;
-      // the PushBackEvents(const int nevents) "pushes back" events events into the root file
-      // (technically it just decrements the local counter in the PHNodeIOManager)
-      // giving it a negative argument will skip events
-      // this is much faster than actually reading the events in
-      int iret = InManager[0]->PushBackEvents(Npushback);
+      // the input managers skip by moving their entry counter
+      // (for DSTs the local counter in the PHNodeIOManager) without
+      // reading the skipped events, the other input managers catch up
+      // when they resynchronize on the next event
+      int iret = InManager[0]->skip(nevnts);
       if (!iret)
         {
           return 0;
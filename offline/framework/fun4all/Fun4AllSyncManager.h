@@ -26,7 +26,7 @@ class Fun4AllSyncManager: public Fun4AllBase
   
   /*! 
     \brief skip n events (0 means up to the end of file). 
-    Skip means read, don't process.
+    Skip means don't process, DSTs jump over the skipped entries without reading them.
   */
   int skip(const int nevnts = 0);
 
@@ -0,0 +1,408 @@
+#include "Fun4AllWorker.h"
+#include "Fun4AllReturnCodes.h"
+#include "SubsysReco.h"
+
+#include <phool/PHCompositeNode.h>
+#include <phool/PHDataNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHNodeIterator.h>
+#include <phool/PHNodeReset.h>
+#include <phool/PHObject.h>
+#include <phool/PHPointerListIterator.h>
+#include <phool/phool.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+// data nodes whose objects can be handed around (swapped or shared)
+static bool
+IsObjectNode(const PHNode *node)
+{
+  return (node->getType() == "PHIODataNode" || node->getType() == "PHDataNode") &&
+         node->getObjectType() == "PHObject";
+}
+
+static PHObject *
+NodeObject(PHNode *node)
+{
+  return static_cast<PHDataNode<PHObject> *>(node)->getData();
+}
+
+Fun4AllWorker::Fun4AllWorker(const string &name, PHCompositeNode *mastertop)
+  : Fun4AllBase(name)
+  , MasterTopNode(mastertop)
+  , TopNode(new PHCompositeNode("TOP"))
+  , DstNode(new PHCompositeNode("DST"))
+  , needinitrun(true)
+  , first_write(true)
+  , result(0)
+  , state(IDLE)
+  , worker(&Fun4AllWorker::run, this)
+{
+  TopNode->addNode(DstNode);
+  TopNode->addNode(new PHCompositeNode("RUN"));
+  TopNode->addNode(new PHCompositeNode("PAR"));
+}
+
+Fun4AllWorker::~Fun4AllWorker()
+{
+  {
+    lock_guard<mutex> lock(mtx);
+    state = QUIT;
+  }
+  cond.notify_all();
+  worker.join();
+  while (!Subsystems.empty())
+  {
+    delete Subsystems.back();
+    Subsystems.pop_back();
+  }
+  // the shared objects belong to the node tree of the server
+  for (vector<PHNode *>::iterator iter = shared.begin(); iter != shared.end(); ++iter)
+  {
+    static_cast<PHDataNode<PHObject> *>(*iter)->setData(nullptr);
+  }
+  delete TopNode;
+}
+
+int Fun4AllWorker::registerSubsystem(SubsysReco *subsystem)
+{
+  Subsystems.push_back(subsystem);
+  retcodes.push_back(0);
+  int iret = 0;
+  try
+  {
+    iret = subsystem->Init(TopNode);
+  }
+  catch (const exception &e)
+  {
+    cout << PHWHERE << " caught exception thrown during SubsysReco::Init() from "
+         << subsystem->Name() << " in " << Name() << endl;
+    cout << "error: " << e.what() << endl;
+    exit(1);
+  }
+  return iret;
+}
+
+int Fun4AllWorker::InitRun()
+{
+  PHNodeIterator masteriter(MasterTopNode);
+  PHNodeIterator iter(TopNode);
+  const char *runnodes[] = {"RUN", "PAR"};
+  for (int i = 0; i < 2; i++)
+  {
+    PHCompositeNode *master = dynamic_cast<PHCompositeNode *>(masteriter.findFirst("PHCompositeNode", runnodes[i]));
+    PHCompositeNode *mine = dynamic_cast<PHCompositeNode *>(iter.findFirst("PHCompositeNode", runnodes[i]));
+    if (master && mine)
+    {
+      ShareNodes(master, mine);
+    }
+  }
+  int iret = 0;
+  for (vector<SubsysReco *>::iterator siter = Subsystems.begin(); siter != Subsystems.end(); ++siter)
+  {
+    try
+    {
+      iret = (*siter)->InitRun(TopNode);
+    }
+    catch (const exception &e)
+    {
+      cout << PHWHERE << " caught exception thrown during SubsysReco::InitRun() from "
+           << (*siter)->Name() << " in " << Name() << endl;
+      cout << "error: " << e.what() << endl;
+      exit(1);
+    }
+    if (iret)
+    {
+      cout << PHWHERE << " Module " << (*siter)->Name()
+           << " issued non ok return code " << iret << " in InitRun() of " << Name() << endl;
+      return iret;
+    }
+  }
+  needinitrun = false;
+  return 0;
+}
+
+int Fun4AllWorker::EndRun(const int runno)
+{
+  int iret = 0;
+  if (!needinitrun)
+  {
+    for (vector<SubsysReco *>::iterator iter = Subsystems.begin(); iter != Subsystems.end(); ++iter)
+    {
+      iret += (*iter)->EndRun(runno);
+    }
+  }
+  needinitrun = true;
+  return iret;
+}
+
+int Fun4AllWorker::End()
+{
+  int iret = 0;
+  for (vector<SubsysReco *>::iterator iter = Subsystems.begin(); iter != Subsystems.end(); ++iter)
+  {
+    iret += (*iter)->End(TopNode);
+  }
+  return iret;
+}
+
+void Fun4AllWorker::TakeEvent(PHCompositeNode *masterdst, const set<string> &modulenodes)
+{
+  SwapNodes(masterdst, DstNode, "/DST", modulenodes);
+}
+
+void Fun4AllWorker::Start()
+{
+  {
+    lock_guard<mutex> lock(mtx);
+    state = QUEUED;
+  }
+  cond.notify_all();
+}
+
+int Fun4AllWorker::Wait()
+{
+  unique_lock<mutex> lock(mtx);
+  cond.wait(lock, [this] { return state == DONE; });
+  state = IDLE;
+  if (!error.empty())
+  {
+    // the same as an exception in the serial event loop
+    cout << PHWHERE << " " << Name() << ": " << error << endl;
+    exit(1);
+  }
+  return result;
+}
+
+void Fun4AllWorker::ResetEvent()
+{
+  for (vector<SubsysReco *>::iterator iter = Subsystems.begin(); iter != Subsystems.end(); ++iter)
+  {
+    (*iter)->ResetEvent(TopNode);
+  }
+  PHNodeReset reset;
+  PHNodeIterator iter(DstNode);
+  iter.forEach(reset);
+}
+
+bool Fun4AllWorker::FirstWrite()
+{
+  bool first = first_write;
+  first_write = false;
+  return first;
+}
+
+void Fun4AllWorker::run()
+{
+  unique_lock<mutex> lock(mtx);
+  while (true)
+  {
+    cond.wait(lock, [this] { return state == QUEUED || state == QUIT; });
+    if (state == QUIT)
+    {
+      return;
+    }
+    lock.unlock();
+    int iret = ProcessEvent();
+    lock.lock();
+    result = iret;
+    state = DONE;
+    cond.notify_all();
+  }
+}
+
+// same return code handling as Fun4AllServer::process_event()
+int Fun4AllWorker::ProcessEvent()
+{
+  for (vector<int>::iterator iter = retcodes.begin(); iter != retcodes.end(); ++iter)
+  {
+    *iter = Fun4AllReturnCodes::EVENT_OK;
+  }
+  for (unsigned int i = 0; i < Subsystems.size(); i++)
+  {
+    try
+    {
+      retcodes[i] = Subsystems[i]->process_event(TopNode);
+    }
+    catch (const exception &e)
+    {
+      error = "caught exception thrown during process_event from " + Subsystems[i]->Name() + ", error: " + e.what();
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
+    catch (...)
+    {
+      error = "caught unknown type exception thrown during process_event from " + Subsystems[i]->Name();
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
+    if (retcodes[i] == Fun4AllReturnCodes::EVENT_OK ||
+        retcodes[i] == Fun4AllReturnCodes::DISCARDEVENT)
+    {
+      continue;
+    }
+    if (retcodes[i] == Fun4AllReturnCodes::ABORTEVENT)
+    {
+      return Fun4AllReturnCodes::ABORTEVENT;
+    }
+    if (retcodes[i] == Fun4AllReturnCodes::ABORTRUN)
+    {
+      cout << Name() << ": Abort Run by " << Subsystems[i]->Name() << endl;
+    }
+    else
+    {
+      cout << Name() << ": Unknown return code: " << retcodes[i]
+           << " from process_event method of " << Subsystems[i]->Name() << endl;
+      cout << "This smells like an uninitialized return code and" << endl;
+      cout << "it is too dangerous to continue, this Run will be aborted" << endl;
+    }
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+// the worker gets its own nodes pointing to the objects of the server,
+// they are updated for every run in case the server replaced an object
+void Fun4AllWorker::ShareNodes(PHCompositeNode *master, PHCompositeNode *mine)
+{
+  PHNodeIterator nodeiter(master);
+  PHPointerListIterator<PHNode> iterat(nodeiter.ls());
+  PHNode *thisNode;
+  while ((thisNode = iterat()))
+  {
+    PHNode *myNode = FindChild(mine, thisNode->getName());
+    if (thisNode->getType() == "PHCompositeNode")
+    {
+      if (!myNode)
+      {
+        myNode = new PHCompositeNode(thisNode->getName());
+        mine->addNode(myNode);
+      }
+      if (myNode->getType() == "PHCompositeNode")
+      {
+        ShareNodes(static_cast<PHCompositeNode *>(thisNode), static_cast<PHCompositeNode *>(myNode));
+      }
+    }
+    else if (IsObjectNode(thisNode) && NodeObject(thisNode))
+    {
+      if (!myNode)
+      {
+        if (thisNode->getType() == "PHIODataNode")
+        {
+          myNode = new PHIODataNode<PHObject>(NodeObject(thisNode), thisNode->getName(), "PHObject");
+        }
+        else
+        {
+          myNode = new PHDataNode<PHObject>(NodeObject(thisNode), thisNode->getName(), "PHObject");
+        }
+        mine->addNode(myNode);
+        shared.push_back(myNode);
+      }
+      else if (find(shared.begin(), shared.end(), myNode) != shared.end())
+      {
+        static_cast<PHDataNode<PHObject> *>(myNode)->setData(NodeObject(thisNode));
+      }
+    }
+    else if (verbosity > 0 && !myNode)
+    {
+      cout << Name() << ": cannot share " << thisNode->getType() << " "
+           << thisNode->getName() << " (" << thisNode->getObjectType() << ")" << endl;
+    }
+  }
+}
+
+// the input manager reads the next event into the objects the worker
+// leaves behind. A node the worker does not have yet gets a reset clone
+// which keeps the persistent settings of the object
+void Fun4AllWorker::SwapNodes(PHCompositeNode *master, PHCompositeNode *mine, const string &path, const set<string> &modulenodes)
+{
+  PHNodeIterator nodeiter(master);
+  PHPointerListIterator<PHNode> iterat(nodeiter.ls());
+  PHNode *thisNode;
+  while ((thisNode = iterat()))
+  {
+    string nodepath = path + "/" + thisNode->getName();
+    PHNode *myNode = FindChild(mine, thisNode->getName());
+    if (thisNode->getType() == "PHCompositeNode")
+    {
+      if (!myNode)
+      {
+        myNode = new PHCompositeNode(thisNode->getName());
+        mine->addNode(myNode);
+      }
+      if (myNode->getType() == "PHCompositeNode")
+      {
+        SwapNodes(static_cast<PHCompositeNode *>(thisNode), static_cast<PHCompositeNode *>(myNode), nodepath, modulenodes);
+      }
+      continue;
+    }
+    if (!IsObjectNode(thisNode) || !NodeObject(thisNode) || modulenodes.find(nodepath) != modulenodes.end())
+    {
+      continue;
+    }
+    PHObject *obj = NodeObject(thisNode);
+    if (!myNode)
+    {
+      PHObject *spare = static_cast<PHObject *>(obj->Clone());
+      spare->Reset();
+      if (thisNode->getType() == "PHIODataNode")
+      {
+        myNode = new PHIODataNode<PHObject>(spare, thisNode->getName(), "PHObject");
+      }
+      else
+      {
+        myNode = new PHDataNode<PHObject>(spare, thisNode->getName(), "PHObject");
+      }
+      if (!thisNode->isPersistent())
+      {
+        myNode->makeTransient();
+      }
+      mine->addNode(myNode);
+    }
+    if (!IsObjectNode(myNode))
+    {
+      continue;
+    }
+    PHDataNode<PHObject> *mydata = static_cast<PHDataNode<PHObject> *>(myNode);
+    static_cast<PHDataNode<PHObject> *>(thisNode)->setData(mydata->getData());
+    mydata->setData(obj);
+  }
+}
+
+void Fun4AllWorker::DataNodePaths(PHCompositeNode *startNode, const string &path, set<string> &paths)
+{
+  PHNodeIterator nodeiter(startNode);
+  PHPointerListIterator<PHNode> iterat(nodeiter.ls());
+  PHNode *thisNode;
+  while ((thisNode = iterat()))
+  {
+    string nodepath = path + "/" + thisNode->getName();
+    if (thisNode->getType() == "PHCompositeNode")
+    {
+      DataNodePaths(static_cast<PHCompositeNode *>(thisNode), nodepath, paths);
+    }
+    else
+    {
+      paths.insert(nodepath);
+    }
+  }
+}
+
+PHNode *
+Fun4AllWorker::FindChild(PHCompositeNode *parent, const string &name)
+{
+  PHNodeIterator nodeiter(parent);
+  PHPointerListIterator<PHNode> iterat(nodeiter.ls());
+  PHNode *thisNode;
+  while ((thisNode = iterat()))
+  {
+    if (thisNode->getName() == name)
+    {
+      return thisNode;
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,98 @@
+#ifndef FUN4ALLWORKER_H__
+#define FUN4ALLWORKER_H__
+
+#include "Fun4AllBase.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+class PHCompositeNode;
+class PHNode;
+class SubsysReco;
+
+// one worker of the multi threaded event loop of the Fun4AllServer
+// (Fun4AllServer::Workers()). It has its own node tree (TOP with DST,
+// RUN and PAR), the clones of the registered modules which run on it
+// and a thread which executes their process_event. The data nodes under
+// RUN and PAR of the server are shared (read only, the worker tree
+// only points to the objects). The input managers keep reading into the
+// DST of the server, the objects of the input nodes are swapped into the
+// DST of the worker for every event (no copy). The server hands out the
+// events, writes the worker DSTs in event order and resets them.
+class Fun4AllWorker : public Fun4AllBase
+{
+ public:
+  Fun4AllWorker(const std::string &name, PHCompositeNode *mastertop);
+  virtual ~Fun4AllWorker();
+
+  //! takes ownership of the clone and runs its Init on the worker tree
+  int registerSubsystem(SubsysReco *subsystem);
+
+  //! shares the run nodes of the server and runs InitRun of the clones
+  int InitRun();
+  int EndRun(const int runno);
+  int End();
+  bool NeedsInitRun() const { return needinitrun; }
+
+  /*! \brief
+    swaps the objects of the input nodes of the DST of the server into
+    the DST of the worker. Nodes whose path is in modulenodes were created
+    by the modules of the server, the clones made their own
+  */
+  void TakeEvent(PHCompositeNode *masterdst, const std::set<std::string> &modulenodes);
+
+  //! the worker thread runs the process_event of the clones
+  void Start();
+
+  //! waits for the event, returns 0, ABORTEVENT or ABORTRUN
+  int Wait();
+
+  //! ResetEvent of the clones and reset of the worker DST
+  void ResetEvent();
+
+  PHCompositeNode *topNode() const { return TopNode; }
+  PHCompositeNode *dstNode() const { return DstNode; }
+  std::vector<int> &RetCodes() { return retcodes; }
+
+  //! true only once, before the first event of this tree is written out
+  bool FirstWrite();
+
+  //! paths (/DST/...) of the data nodes below startNode
+  static void DataNodePaths(PHCompositeNode *startNode, const std::string &path, std::set<std::string> &paths);
+
+ private:
+  enum WorkerState
+  {
+    IDLE,
+    QUEUED,
+    DONE,
+    QUIT
+  };
+
+  void run();
+  int ProcessEvent();
+  void ShareNodes(PHCompositeNode *master, PHCompositeNode *worker);
+  void SwapNodes(PHCompositeNode *master, PHCompositeNode *worker, const std::string &path, const std::set<std::string> &modulenodes);
+  static PHNode *FindChild(PHCompositeNode *parent, const std::string &name);
+
+  PHCompositeNode *MasterTopNode;
+  PHCompositeNode *TopNode;
+  PHCompositeNode *DstNode;
+  std::vector<SubsysReco *> Subsystems;
+  std::vector<int> retcodes;
+  std::vector<PHNode *> shared;  // point to objects of the server, released before the tree is deleted
+  bool needinitrun;
+  bool first_write;
+  std::string error;  // exception caught in the worker thread
+  int result;
+  WorkerState state;
+  std::mutex mtx;
+  std::condition_variable cond;
+  std::thread worker;  // last, it starts running in the ctor
+};
+
+#endif /* FUN4ALLWORKER_H__ */
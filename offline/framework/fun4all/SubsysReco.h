@@ -59,6 +59,17 @@ class SubsysReco: public Fun4AllBase
 
   virtual void Print(const std::string &what = "ALL") const {}
 
+  /** Copy of this module for a worker of the multi threaded event
+      loop (Fun4AllServer::Workers()), which runs Init and InitRun of
+      the copy on the node tree of the worker. A module which can run
+      in a worker only keeps per event state in its nodes and members,
+      looks up its input nodes in process_event() and does not fill
+      job wide objects (histograms, timers, statics).
+      nullptr (the default) means the module cannot run in a worker,
+      the server then runs the job single threaded.
+   */
+  virtual SubsysReco *clone() const {return nullptr;}
+
  protected:
 
   /** ctor.
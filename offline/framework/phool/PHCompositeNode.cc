@@ -14,12 +14,17 @@
 
 using namespace std;
 
-PHCompositeNode::PHCompositeNode() : PHNode("NULL")
+PHCompositeNode::PHCompositeNode() : PHNode("NULL"),
+  deleteMe(0),
+  indexGeneration(0),
+  indexValid(false)
 {}
 
 PHCompositeNode::PHCompositeNode(const string& name) : 
   PHNode(name,"PHCompositeNode"),
-  deleteMe(0)
+  deleteMe(0),
+  indexGeneration(0),
+  indexValid(false)
 {
   type = "PHCompositeNode";
 }
@@ -57,6 +62,14 @@ PHCompositeNode::addNode(PHNode* newNode)
   // No conflict, so we can append the new node.
   //
   newNode->setParent(this);
+  // a sub-tree which was built on its own had its own index, lookups
+  // go through the index of the top node from now on
+  if (newNode->getType() == "PHCompositeNode")
+    {
+      PHCompositeNode *subtop = static_cast<PHCompositeNode *>(newNode);
+      subtop->nameIndex.clear();
+      subtop->indexValid = false;
+    }
   return (subNodes.append(newNode));
 }
 
@@ -136,3 +149,90 @@ PHCompositeNode::print(const string &path)
       thisNode->print(newPath);
     }
 }
+
+PHNode*
+PHCompositeNode::lookup(const string &nodename)
+{
+  PHCompositeNode *top = indexNode();
+  unordered_map<string, vector<PHNode *> >::const_iterator iter = top->nameIndex.find(nodename);
+  if (iter == top->nameIndex.end())
+    {
+      return 0;
+    }
+  // the entries are in pre-order of the whole tree, the first one in
+  // this sub-tree is what a search starting here finds
+  for (vector<PHNode *>::const_iterator niter = iter->second.begin(); niter != iter->second.end(); ++niter)
+    {
+      if (top == this || contains(*niter))
+	{
+	  return *niter;
+	}
+    }
+  return 0;
+}
+
+PHNode*
+PHCompositeNode::lookup(const string &nodetype, const string &nodename)
+{
+  PHCompositeNode *top = indexNode();
+  unordered_map<string, vector<PHNode *> >::const_iterator iter = top->nameIndex.find(nodename);
+  if (iter == top->nameIndex.end())
+    {
+      return 0;
+    }
+  // node names are only unique within one PHCompositeNode, the same
+  // name can show up in different branches with different types
+  for (vector<PHNode *>::const_iterator niter = iter->second.begin(); niter != iter->second.end(); ++niter)
+    {
+      if ((*niter)->getType() == nodetype && (top == this || contains(*niter)))
+	{
+	  return *niter;
+	}
+    }
+  return 0;
+}
+
+PHCompositeNode *
+PHCompositeNode::indexNode()
+{
+  // only PHCompositeNodes have sub nodes, the top node is one
+  PHCompositeNode *top = static_cast<PHCompositeNode *>(getTopNode());
+  if (!top->indexValid || top->indexGeneration != top->generation)
+    {
+      top->nameIndex.clear();
+      top->fillIndex(top);
+      top->indexGeneration = top->generation;
+      top->indexValid = true;
+    }
+  return top;
+}
+
+bool
+PHCompositeNode::contains(const PHNode *node) const
+{
+  for (const PHNode *p = node->getParent(); p; p = p->getParent())
+    {
+      if (p == this)
+	{
+	  return true;
+	}
+    }
+  return false;
+}
+
+void
+PHCompositeNode::fillIndex(PHCompositeNode *node)
+{
+  // pre-order walk, the first entry for each name is what a recursive
+  // findFirst would have returned
+  PHPointerListIterator<PHNode> nodeIter(node->subNodes);
+  PHNode* thisNode;
+  while ((thisNode = nodeIter())) 
+    {
+      nameIndex[thisNode->getName()].push_back(thisNode);
+      if (thisNode->getType() == "PHCompositeNode")
+	{
+	  fillIndex(static_cast<PHCompositeNode *>(thisNode));
+	}
+    }
+}
@@ -8,6 +8,10 @@
 #include "PHNode.h"
 #include "PHPointerList.h"
 
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 class PHIOManager;
 class PHNodeIterator;
 
@@ -37,10 +41,26 @@ public:
    void print(const std::string & = "");
    virtual bool write(PHIOManager *, const std::string & = "");
 
+   //
+   // Find the first node (depth first, same order as PHNodeIterator::findFirst)
+   // in the sub-tree below this node. The lookup goes through the name index
+   // of the top node, which is built on first use and rebuilt when the node
+   // tree changed (see PHNode::treeGeneration()).
+   //
+   PHNode *lookup(const std::string &name);
+   PHNode *lookup(const std::string &type, const std::string &name);
+
 protected:
    virtual void forgetMe(PHNode*);
+   PHCompositeNode *indexNode();
+   bool contains(const PHNode *) const;
+   void fillIndex(PHCompositeNode *);
    PHPointerList<PHNode> subNodes;
    int deleteMe;
+   // name index of the whole tree, only kept in the top node
+   std::unordered_map<std::string, std::vector<PHNode *> > nameIndex;
+   unsigned long indexGeneration;
+   bool indexValid;
 
 private:
    PHCompositeNode();
@@ -11,7 +11,8 @@ PHNode::PHNode() :
   parent(NULL),
   persistent(true),
   type("PHNode"),
-  reset_able(true)
+  reset_able(true),
+  generation(0)
 {
   return;
 }
@@ -20,7 +21,8 @@ PHNode::PHNode(const string& n) :
   parent(NULL),
   persistent(true),
   type("PHNode"),
-  reset_able(true)
+  reset_able(true),
+  generation(0)
 {
   if (n.find(".") != string::npos)
     {
@@ -37,7 +39,8 @@ PHNode::PHNode(const string& n, const string& typ) :
   persistent(true),
   type("PHNode"),
   objecttype(typ),
-  reset_able(true)
+  reset_able(true),
+  generation(0)
 {
   if (n.find(".") != string::npos)
     {
@@ -53,6 +56,7 @@ PHNode::~PHNode()
 {
    if (parent)
      {
+       parent->treeChanged();
        parent->forgetMe(this);
      }
 }
@@ -64,7 +68,8 @@ PHNode::PHNode(const PHNode &phn):
   objecttype(phn.objecttype),
   name(phn.name),
   objectclass(phn.objectclass),
-  reset_able(phn.reset_able)
+  reset_able(phn.reset_able),
+  generation(0)
 {
   cout << "copy ctor not implemented because of pointer to parent" << endl;
   cout << "which needs implementing for this to be reasonable" << endl;
@@ -79,6 +84,56 @@ PHNode::operator=(const PHNode&)
   exit(1);
 }
 
+void
+PHNode::setParent(PHNode *p)
+{
+  // the sub-tree of this node joins the tree of p, the counter of the
+  // joined tree has to differ from the ones both trees had before
+  unsigned long subtreegeneration = treeGeneration();
+  parent = p;
+  PHNode *top = getTopNode();
+  if (top->generation < subtreegeneration)
+    {
+      top->generation = subtreegeneration;
+    }
+  ++top->generation;
+}
+
+void
+PHNode::setName(const string &n)
+{
+  name = n;
+  treeChanged();
+}
+
+PHNode *
+PHNode::getTopNode()
+{
+  PHNode *top = this;
+  while (top->parent)
+    {
+      top = top->parent;
+    }
+  return top;
+}
+
+unsigned long
+PHNode::treeGeneration() const
+{
+  const PHNode *top = this;
+  while (top->parent)
+    {
+      top = top->parent;
+    }
+  return top->generation;
+}
+
+void
+PHNode::treeChanged()
+{
+  ++getTopNode()->generation;
+}
+
 void
 PHNode::setResetFlag(const int val)
 {
@@ -27,13 +27,13 @@ public:
   PHBoolean isPersistent() const { return persistent; }
   void makePersistent() { persistent = True;}
   
-  const std::string getObjectType() const { return objecttype; }
-  const std::string getType() const { return type; }
-  const std::string getName() const { return name; }
-  const std::string getClass() const {return objectclass;}
+  const std::string &getObjectType() const { return objecttype; }
+  const std::string &getType() const { return type; }
+  const std::string &getName() const { return name; }
+  const std::string &getClass() const {return objectclass;}
 
-  void setParent(PHNode *p) { parent = p; }
-  void setName(const std::string &n) {name = n;}
+  void setParent(PHNode *p);
+  void setName(const std::string &n);
   void setObjectType(const std::string &type) {objecttype = type;} 
   virtual void prune() = 0;
   virtual void print(const std::string &) = 0;
@@ -43,6 +43,13 @@ public:
   virtual void setResetFlag(const int val);
   virtual PHBoolean getResetFlag() const;
   void makeTransient()  { persistent = False;}
+
+  // Counter of the node tree this node belongs to, it is kept by the top
+  // node and incremented whenever the tree changes its structure (nodes
+  // added, deleted or renamed). Cached lookups compare it with the value
+  // they were built with to detect stale entries
+  unsigned long treeGeneration() const;
+  PHNode *getTopNode();
   
 protected:
   
@@ -57,6 +64,9 @@ protected:
   std::string name;
   std::string objectclass;
   bool reset_able;
+  unsigned long generation; // only used in the top node
+
+  void treeChanged();
 };
 
 std::ostream & operator << (std::ostream &, const PHNode &);
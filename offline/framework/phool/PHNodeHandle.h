@@ -0,0 +1,83 @@
+#ifndef PHNODEHANDLE_H__
+#define PHNODEHANDLE_H__
+
+//  Declaration of class PHNodeHandle
+//  Purpose: resolve a node once (typically in InitRun) and access its
+//           object every event without searching the node tree again.
+//           The node is looked up again only if its node tree changed
+//           since the last access (see PHNode::treeGeneration()).
+//
+//  Usage:
+//    PHNodeHandle<PHG4HitContainer> hits;      // class member
+//    hits.set(topNode, "G4HIT_SVTX");          // in InitRun
+//    PHG4HitContainer *h = hits.get();         // in process_event
+
+#include "getClass.h"
+#include "PHCompositeNode.h"
+#include "PHNode.h"
+
+#include <string>
+
+template <class T>
+class PHNodeHandle
+{
+ public:
+  PHNodeHandle()
+    : topnode(0)
+    , node(0)
+    , generation(0)
+  {
+  }
+
+  PHNodeHandle(PHCompositeNode *top, const std::string &name)
+    : topnode(0)
+    , node(0)
+    , generation(0)
+  {
+    set(top, name);
+  }
+
+  virtual ~PHNodeHandle() {}
+
+  //! set the node to be tracked, returns the current object or NULL
+  T *set(PHCompositeNode *top, const std::string &name)
+  {
+    topnode = top;
+    nodename = name;
+    resolve();
+    return get();
+  }
+
+  //! object stored in the node, NULL if the node does not exist (yet)
+  T *get()
+  {
+    if (!topnode)
+    {
+      return 0;
+    }
+    if (generation != topnode->treeGeneration())
+    {
+      resolve();
+    }
+    // the object pointer of a node can change (e.g. when reading
+    // input) so only the node itself is cached
+    return findNode::getClass<T>(node);
+  }
+
+  T *operator->() { return get(); }
+  const std::string &name() const { return nodename; }
+
+ protected:
+  void resolve()
+  {
+    node = topnode->lookup(nodename);
+    generation = topnode->treeGeneration();
+  }
+
+  PHCompositeNode *topnode;
+  PHNode *node;
+  unsigned long generation;
+  std::string nodename;
+};
+
+#endif /* PHNODEHANDLE_H__ */
@@ -11,6 +11,7 @@
 
 #include <TFile.h>
 #include <TTree.h>
+#include <TTreeCache.h>
 #include <TBranchObject.h>
 #include <TObject.h>
 #include <TLeafObject.h>
@@ -27,12 +28,141 @@
 #include <boost/foreach.hpp>
 
 #include <cassert>
+#include <condition_variable>
 #include <cstdlib>
+#include <deque>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <thread>
 
 using namespace std;
 
+// queue between the event loop and the writer thread of an
+// asynchronous PHNodeIOManager. The writer thread fills the events
+// in the order they were pushed. It also keeps the spare objects
+// which are swapped into the nodes: an object goes from the node to
+// the writer, after the Fill it is reset and waits here until it is
+// swapped into its node again
+class PHNodeIOManager::AsyncQueue
+{
+public:
+  AsyncQueue(PHNodeIOManager *iomanager, const unsigned int queuedepth):
+    manager(iomanager),
+    maxdepth(queuedepth),
+    done(false),
+    writer(&AsyncQueue::run, this)
+  {}
+
+  ~AsyncQueue()
+  {
+    {
+      lock_guard<mutex> lock(mtx);
+      done = true;
+    }
+    notempty.notify_all();
+    writer.join();
+    for (map<string, vector<TObject *> >::iterator iter = spares.begin(); iter != spares.end(); ++iter)
+      {
+	for (vector<TObject *>::iterator objiter = iter->second.begin(); objiter != iter->second.end(); ++objiter)
+	  {
+	    delete *objiter;
+	  }
+      }
+  }
+
+  void push(AsyncEvent &event)
+  {
+    {
+      unique_lock<mutex> lock(mtx);
+      notfull.wait(lock, [this] { return events.size() < maxdepth; });
+      events.push_back(AsyncEvent());
+      events.back().swap(event);
+    }
+    notempty.notify_one();
+  }
+
+  // a reset object of the class of obj for the node at path
+  TObject *spare(const string &path, const TObject *obj)
+  {
+    {
+      lock_guard<mutex> lock(sparemtx);
+      vector<TObject *> &objs = spares[path];
+      while (!objs.empty())
+	{
+	  TObject *spareobj = objs.back();
+	  objs.pop_back();
+	  if (spareobj->IsA() == obj->IsA())
+	    {
+	      return spareobj;
+	    }
+	  delete spareobj; // the node got an object of another class
+	}
+    }
+    // the first events (up to the queue depth) need new ones. A clone
+    // keeps the persistent settings of the node object which survive
+    // its Reset() (e.g. the layers of a hit container)
+    TObject *spareobj = obj->Clone();
+    Reset(spareobj);
+    return spareobj;
+  }
+
+private:
+  void run()
+  {
+    while (true)
+      {
+	AsyncEvent event;
+	{
+	  unique_lock<mutex> lock(mtx);
+	  notempty.wait(lock, [this] { return done || !events.empty(); });
+	  if (events.empty())
+	    {
+	      return; // done and all events are written
+	    }
+	  event.swap(events.front());
+	  events.pop_front();
+	}
+	notfull.notify_one();
+	manager->fillAsync(event);
+	// the event is on disk, the objects can go back into the nodes
+	for (AsyncEvent::iterator iter = event.begin(); iter != event.end(); ++iter)
+	  {
+	    Reset(iter->obj);
+	  }
+	lock_guard<mutex> lock(sparemtx);
+	for (AsyncEvent::iterator iter = event.begin(); iter != event.end(); ++iter)
+	  {
+	    spares[iter->path].push_back(iter->obj);
+	  }
+      }
+  }
+
+  static void Reset(TObject *obj)
+  {
+    PHObject *phob = dynamic_cast<PHObject *>(obj);
+    if (phob)
+      {
+	phob->Reset();
+      }
+    else
+      {
+	obj->Clear();
+      }
+  }
+
+  PHNodeIOManager *manager;
+  size_t maxdepth;
+  bool done;
+  deque<AsyncEvent> events;
+  mutex mtx;
+  condition_variable notfull;
+  condition_variable notempty;
+  map<string, vector<TObject *> > spares;
+  mutex sparemtx;
+  thread writer; // last, it starts running in the ctor
+};
+
 PHNodeIOManager::PHNodeIOManager ():
   file(NULL),
   tree(NULL),
@@ -41,7 +171,10 @@ PHNodeIOManager::PHNodeIOManager ():
   split(0),
   accessMode(PHReadOnly),
   CompressionLevel(3),
-  isFunctionalFlag(0)
+  isFunctionalFlag(0),
+  cacheSize(0),
+  unzipAhead(false),
+  asyncQueue(NULL)
 {}
 
 PHNodeIOManager::PHNodeIOManager (const string& f,
@@ -49,7 +182,10 @@ PHNodeIOManager::PHNodeIOManager (const string& f,
   file(NULL),
   tree(NULL),
   TreeName("T"),
-  CompressionLevel(3)
+  CompressionLevel(3),
+  cacheSize(0),
+  unzipAhead(false),
+  asyncQueue(NULL)
 {
   isFunctionalFlag = setFile(f, "titled by PHOOL", a) ? 1 : 0;
 }
@@ -59,7 +195,10 @@ PHNodeIOManager::PHNodeIOManager (const string& f, const string& title,
   file(NULL),
   tree(NULL),
   TreeName("T"),
-  CompressionLevel(3)
+  CompressionLevel(3),
+  cacheSize(0),
+  unzipAhead(false),
+  asyncQueue(NULL)
 {
   isFunctionalFlag = setFile(f, title , a) ? 1 : 0;
 }
@@ -69,7 +208,10 @@ PHNodeIOManager::PHNodeIOManager (const string& f, const PHAccessType a,
   file(NULL),
   tree(NULL),
   TreeName("T"),
-  CompressionLevel(3)
+  CompressionLevel(3),
+  cacheSize(0),
+  unzipAhead(false),
+  asyncQueue(NULL)
 {
   if (treeindex != PHEventTree)
     {
@@ -93,6 +235,8 @@ PHNodeIOManager::~PHNodeIOManager ()
 void
 PHNodeIOManager::closeFile ()
 {
+  // all queued events have to be in the tree before it is written
+  stopAsync();
   if (file)
     {
       if (accessMode == PHWrite || accessMode == PHUpdate)
@@ -101,6 +245,8 @@ PHNodeIOManager::closeFile ()
         }
       file->Close();
     }
+  // the branches of the closed tree pointed to these
+  asyncObjects.clear();
 }
 
 PHBoolean
@@ -170,6 +316,20 @@ PHNodeIOManager::write(PHCompositeNode* topNode)
   // recursively call the write functions of its subnodes, thus
   // constructing the path-string which is then stored as name of the
   // Root-branch corresponding to the data of each PHRootIODataNode.
+  if (asyncQueue)
+    {
+      // write(TObject**, path) only swaps the objects out of the
+      // nodes, the tree is filled by the writer thread
+      asyncEvent.clear();
+      topNode->write(this);
+      if (file && tree)
+	{
+	  asyncQueue->push(asyncEvent);
+	  eventNumber++;
+	  return True;
+	}
+      return False;
+    }
   topNode->write(this);
 
 
@@ -189,6 +349,22 @@ PHNodeIOManager::write(PHCompositeNode* topNode)
 PHBoolean
 PHNodeIOManager::write(TObject** data, const string& path)
 {
+  if (asyncQueue)
+    {
+      if (file && tree)
+	{
+	  // the filled object goes to the writer thread as it is, the
+	  // node gets a reset spare object of the same class. The Fill of
+	  // the writer thread is the only serialization
+	  AsyncBranch branch;
+	  branch.path = path;
+	  branch.obj = *data;
+	  *data = asyncQueue->spare(path, *data);
+	  asyncEvent.push_back(branch);
+	  return True;
+	}
+      return False;
+    }
   if (file && tree)
     {
       TBranch *thisBranch = tree->GetBranch(path.c_str());
@@ -258,6 +434,39 @@ PHNodeIOManager::read(PHCompositeNode* topNode, size_t requestedEvent)
     }
 }
 
+PHCompositeNode*
+PHNodeIOManager::readNodeTree(PHCompositeNode* topNode)
+{
+  if (!tree)
+    {
+      topNode = reconstructNodeTree(topNode);
+    }
+  if (!tree)
+    {
+      return 0;
+    }
+  return topNode;
+}
+
+size_t
+PHNodeIOManager::getEntries()
+{
+  if (tree)
+    {
+      return tree->GetEntries();
+    }
+  if (!file)
+    {
+      return 0;
+    }
+  // the tree is not set up yet, look at it without connecting branches
+  TTree *treetmp = static_cast<TTree *>(file->Get(TreeName.c_str()));
+  if (!treetmp)
+    {
+      return 0;
+    }
+  return treetmp->GetEntries();
+}
 
 void
 PHNodeIOManager::print() const
@@ -547,6 +756,18 @@ PHNodeIOManager::reconstructNodeTree(PHCompositeNode* topNode)
 	}
 
     }
+  if (cacheSize > 0)
+    {
+      // only the branches connected to nodes go into the cache, we
+      // know them already so there is no need for a learning phase
+      if (unzipAhead)
+	{
+	  // has to be set before the cache is created
+	  tree->SetParallelUnzip(kTRUE);
+	}
+      tree->SetCacheSize(cacheSize);
+      RestrictCache(0);
+    }
   return topNode;
 }
 
@@ -639,3 +860,133 @@ PHNodeIOManager::FillBranchMap()
     }
   return 0;
 }
+
+PHBoolean
+PHNodeIOManager::SetAsync(const unsigned int queuedepth)
+{
+  if (accessMode == PHReadOnly)
+    {
+      cout << PHWHERE << "asynchronous mode is only possible for writing" << endl;
+      return False;
+    }
+  stopAsync();
+  if (queuedepth > 0)
+    {
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,0,0)
+      // tree filling and the event loop run concurrently, ROOT's
+      // thread safety is switched on when Fun4AllServer is created
+      asyncQueue = new AsyncQueue(this, queuedepth);
+#else
+      cout << PHWHERE << "asynchronous mode needs the thread safety of ROOT 6, writing "
+	   << filename << " synchronously" << endl;
+      return False;
+#endif
+    }
+  return True;
+}
+
+void
+PHNodeIOManager::stopAsync()
+{
+  // the dtor waits for the writer thread to empty the queue
+  delete asyncQueue;
+  asyncQueue = NULL;
+}
+
+void
+PHNodeIOManager::fillAsync(AsyncEvent &event)
+{
+  // runs in the writer thread, the objects of the event belong to it
+  // until it returns
+  for (AsyncEvent::iterator iter = event.begin(); iter != event.end(); ++iter)
+    {
+      TObject *&obj = asyncObjects[iter->path];
+      obj = iter->obj;
+      // the branch may exist from synchronous events before
+      TBranch *thisBranch = tree->GetBranch(iter->path.c_str());
+      if (thisBranch)
+	{
+	  thisBranch->SetAddress(&obj);
+	}
+      else
+	{
+	  // same branch settings as the synchronous write
+	  int splitlevel = 99;
+	  int buffersize = 32000;
+	  if (obj->InheritsFrom("PHObject"))
+	    {
+	      PHObject *phob = dynamic_cast<PHObject *> (obj);
+	      splitlevel = phob->SplitLevel();
+	      buffersize = phob->BufferSize();
+	    }
+	  tree->Branch(iter->path.c_str(), obj->ClassName(),
+		       &obj, buffersize, splitlevel);
+	}
+    }
+  tree->Fill();
+}
+
+PHBoolean
+PHNodeIOManager::SetCacheSize(const long long cachesize, const bool unzip)
+{
+  if (accessMode != PHReadOnly)
+    {
+      cout << PHWHERE << "read cache is only possible for reading" << endl;
+      return False;
+    }
+  if (tree)
+    {
+      cout << PHWHERE << "read cache has to be set before the first event is read" << endl;
+      return False;
+    }
+  cacheSize = cachesize;
+  unzipAhead = unzip;
+  return True;
+}
+
+void
+PHNodeIOManager::RestrictCache(const char *branchname)
+{
+  if (cacheSize <= 0 || !tree)
+    {
+      return;
+    }
+  tree->DropBranchFromCache("*", kTRUE);
+  if (branchname)
+    {
+      tree->AddBranchToCache(branchname, kTRUE);
+    }
+  else
+    {
+      for (map<string, TBranch*>::const_iterator biter = fBranches.begin(); biter != fBranches.end(); ++biter)
+	{
+	  tree->AddBranchToCache(biter->first.c_str(), kTRUE);
+	}
+    }
+  tree->StopCacheLearningPhase();
+  return;
+}
+
+void
+PHNodeIOManager::PrintReadStats(const size_t nevents) const
+{
+  if (!file)
+    {
+      return;
+    }
+  cout << "PHNodeIOManager read statistics for " << filename << endl;
+  cout << "bytes read: " << file->GetBytesRead()
+       << ", read calls: " << file->GetReadCalls() << endl;
+  if (nevents > 0)
+    {
+      cout << "bytes read per event: " << file->GetBytesRead() / nevents << endl;
+    }
+  TTreeCache *cache = (tree) ? dynamic_cast<TTreeCache *> (file->GetCacheRead(tree)) : 0;
+  if (cache)
+    {
+      cout << "read cache size: " << cache->GetBufferSize()
+	   << ", hit rate: " << cache->GetEfficiency()
+	   << ", relative hit rate: " << cache->GetEfficiencyRel() << endl;
+    }
+  return;
+}
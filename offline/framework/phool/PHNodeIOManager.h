@@ -8,6 +8,8 @@
 #include "PHIOManager.h"
 #include <string>
 #include <map>
+#include <utility>
+#include <vector>
 
 
 class TObject;
@@ -32,6 +34,10 @@ public:
    PHCompositeNode * read(PHCompositeNode * = 0, size_t = 0); 
    PHBoolean read(size_t requestedEvent) ;
    int readSpecific(size_t requestedEvent, const char* objectName) ;
+   // sets up the node tree and connects the branches to the nodes
+   // without reading an event, so readSpecific() can be used right away
+   PHCompositeNode * readNodeTree(PHCompositeNode *);
+   size_t getEntries();
    void selectObjectToRead(const char* objectName, PHBoolean readit) ;
    PHBoolean isSelected(const char* objectName) ;
    int isFunctional() const {return isFunctionalFlag;}
@@ -39,6 +45,36 @@ public:
    double GetBytesWritten();
    std::map<std::string,TBranch*> *GetBranchMap();
 
+   // Asynchronous writing: write() hands the objects of the written
+   // nodes to a writer thread which fills the tree (branch streaming
+   // and compression) and puts reset spare objects of the same class
+   // into the nodes. After the Fill the objects are reset and become
+   // the spares of later events, so the objects of a node alternate.
+   // Modules have to get their objects from the node tree in every
+   // event, a pointer kept from an earlier event points to an object
+   // owned by the writer. The spares start as Clone() of the node
+   // objects, settings which are not written (transient members) come
+   // from the class defaults. At most queuedepth events are buffered,
+   // write() blocks if the writer falls behind. Events are filled in
+   // the order they were written, closeFile() waits for all queued
+   // events. queuedepth = 0 switches back to synchronous writing.
+   // Needs ROOT 6 with thread safety enabled before any other ROOT
+   // object is made (Fun4AllServer does it), fails on older versions
+   PHBoolean SetAsync(const unsigned int queuedepth);
+   PHBoolean isAsync() const {return asyncQueue != 0;}
+
+   // Read cache: a TTreeCache of cachesize bytes holding only the
+   // branches which are connected to nodes. The learning phase is
+   // skipped since the branch list is known. unzip enables the
+   // decompression of baskets ahead of the event loop in a separate
+   // thread. Has to be set before the first read
+   PHBoolean SetCacheSize(const long long cachesize, const bool unzip = true);
+   // keep only branchname in the read cache, for scans of one branch
+   // over many entries (readSpecific) which would otherwise fill the
+   // cache with all connected branches. 0 restores the full branch list
+   void RestrictCache(const char *branchname);
+   void PrintReadStats(const size_t nevents = 0) const;
+
 public:
    PHBoolean write(TObject**, const std::string&);
 private:
@@ -46,6 +82,18 @@ private:
    PHCompositeNode * reconstructNodeTree(PHCompositeNode *);
    PHBoolean readEventFromFile(size_t requestedEvent);
    std::string getBranchClassName(TBranch*) ;
+   // one object of an event in the asynchronous mode
+   struct AsyncBranch
+   {
+     std::string path;
+     TObject *obj; // the node object, owned by the writer until it is a spare again
+   };
+   typedef std::vector<AsyncBranch> AsyncEvent;
+   void fillAsync(AsyncEvent &);
+   void stopAsync();
+
+   class AsyncQueue;
+   friend class AsyncQueue;
 
   TFile *file;
   TTree *tree;
@@ -59,6 +107,13 @@ private:
 
   int isFunctionalFlag;  // flag to tell if that object initialized properly
 
+  long long cacheSize;
+  bool unzipAhead;
+
+  AsyncQueue *asyncQueue; // writer thread and its event queue
+  AsyncEvent asyncEvent; // event being collected
+  std::map<std::string, TObject *> asyncObjects; // writer thread: object the branch points to
+
 }; 
 
 #endif /* __PHNODEIOMANAGER_H__ */
@@ -49,52 +49,13 @@ PHNodeIterator::print()
 PHNode*
 PHNodeIterator::findFirst(const string& requiredType, const string& requiredName)
 {
-  PHPointerListIterator<PHNode> iter(currentNode->subNodes);
-  PHNode *thisNode;
-  while ((thisNode = iter()))
-    {
-      if (thisNode->getType() == requiredType && thisNode->getName() == requiredName)
-        {
-          return thisNode;
-        }
-      else
-        {
-          if (thisNode->getType() == "PHCompositeNode")
-            {
-              PHNodeIterator nodeIter(static_cast<PHCompositeNode*>(thisNode));
-              PHNode *nodeFoundInSubTree = nodeIter.findFirst(requiredType.c_str(), requiredName.c_str());
-              if (nodeFoundInSubTree) return nodeFoundInSubTree;
-            }
-        }
-    }
-  return 0;
+  return currentNode->lookup(requiredType, requiredName);
 }
 
 PHNode*
 PHNodeIterator::findFirst(const string& requiredName)
 {
-  PHPointerListIterator<PHNode> iter(currentNode->subNodes);
-  PHNode *thisNode;
-  while ((thisNode = iter()))
-    {
-      if (thisNode->getName() == requiredName)
-        {
-          return thisNode;
-        }
-      else
-        {
-          if (thisNode->getType() == "PHCompositeNode")
-            {
-              PHNodeIterator nodeIter(static_cast<PHCompositeNode*>(thisNode));
-              PHNode *nodeFoundInSubTree = nodeIter.findFirst(requiredName.c_str());
-              if (nodeFoundInSubTree)
-                {
-                  return nodeFoundInSubTree;
-                }
-            }
-        }
-    }
-  return 0;
+  return currentNode->lookup(requiredName);
 }
 
 PHBoolean
@@ -0,0 +1,125 @@
+//  Benchmark of the node lookup: the recursive string compare walk which
+//  PHNodeIterator::findFirst used before versus the name index of the top
+//  node. The tree looks like a simulation DST (a few hundred nodes in
+//  DST/RUN/PAR and per subsystem composite nodes), the lookups are the ones
+//  a module does in process_event.
+//
+//  Usage: PHNodeLookupBenchmark [number of lookups per name]
+
+#include "PHCompositeNode.h"
+#include "PHDataNode.h"
+#include "PHNodeIterator.h"
+#include "PHPointerListIterator.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+  // the old PHNodeIterator::findFirst
+  PHNode *recursiveFind(PHCompositeNode *node, const string &type, const string &name)
+  {
+    PHNodeIterator iter(node);
+    PHPointerListIterator<PHNode> nodeIter(iter.ls());
+    PHNode *thisNode;
+    while ((thisNode = nodeIter()))
+    {
+      if (thisNode->getType() == type && thisNode->getName() == name)
+      {
+        return thisNode;
+      }
+      if (thisNode->getType() == "PHCompositeNode")
+      {
+        PHNode *found = recursiveFind(static_cast<PHCompositeNode *>(thisNode), type, name);
+        if (found)
+        {
+          return found;
+        }
+      }
+    }
+    return 0;
+  }
+
+  PHCompositeNode *makeTree(vector<string> &names)
+  {
+    PHCompositeNode *top = new PHCompositeNode("TOP");
+    const char *branches[] = {"DST", "RUN", "PAR"};
+    for (int ib = 0; ib < 3; ib++)
+    {
+      PHCompositeNode *branch = new PHCompositeNode(branches[ib]);
+      top->addNode(branch);
+      for (int isub = 0; isub < 30; isub++)
+      {
+        ostringstream subname;
+        subname << branches[ib] << "_SUBSYS" << isub;
+        PHCompositeNode *sub = new PHCompositeNode(subname.str());
+        branch->addNode(sub);
+        for (int inode = 0; inode < 10; inode++)
+        {
+          ostringstream nodename;
+          nodename << subname.str() << "_NODE" << inode;
+          sub->addNode(new PHDataNode<int>(new int(inode), nodename.str()));
+          if (inode == 0 || inode == 9)
+          {
+            names.push_back(nodename.str());
+          }
+        }
+      }
+    }
+    return top;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  int nloop = (argc > 1) ? atoi(argv[1]) : 10000;
+  vector<string> names;
+  PHCompositeNode *top = makeTree(names);
+  names.push_back("NOT_IN_THE_TREE");
+
+  unsigned long nfound = 0;
+  chrono::high_resolution_clock::time_point t0 = chrono::high_resolution_clock::now();
+  for (int i = 0; i < nloop; i++)
+  {
+    for (vector<string>::const_iterator iter = names.begin(); iter != names.end(); ++iter)
+    {
+      nfound += (recursiveFind(top, "PHDataNode", *iter) != 0);
+    }
+  }
+  chrono::high_resolution_clock::time_point t1 = chrono::high_resolution_clock::now();
+  PHNodeIterator topIter(top);
+  for (int i = 0; i < nloop; i++)
+  {
+    for (vector<string>::const_iterator iter = names.begin(); iter != names.end(); ++iter)
+    {
+      nfound += (topIter.findFirst("PHDataNode", *iter) != 0);
+    }
+  }
+  chrono::high_resolution_clock::time_point t2 = chrono::high_resolution_clock::now();
+  // lookups below a sub node share the index of the top node
+  PHNodeIterator dstIter(top);
+  dstIter.cd("DST");
+  for (int i = 0; i < nloop; i++)
+  {
+    for (vector<string>::const_iterator iter = names.begin(); iter != names.end(); ++iter)
+    {
+      nfound += (dstIter.findFirst("PHDataNode", *iter) != 0);
+    }
+  }
+  chrono::high_resolution_clock::time_point t3 = chrono::high_resolution_clock::now();
+
+  double nlookups = static_cast<double>(nloop) * names.size();
+  cout << "PHNodeLookupBenchmark: " << nloop << " x " << names.size() << " lookups ("
+       << nfound << " found)" << endl;
+  cout << "  recursive walk:  " << chrono::duration<double, nano>(t1 - t0).count() / nlookups << " ns/lookup" << endl;
+  cout << "  index from top:  " << chrono::duration<double, nano>(t2 - t1).count() / nlookups << " ns/lookup" << endl;
+  cout << "  index from DST:  " << chrono::duration<double, nano>(t3 - t2).count() / nlookups << " ns/lookup" << endl;
+  delete top;
+  return 0;
+}
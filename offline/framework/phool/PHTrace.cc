@@ -0,0 +1,183 @@
+#include "PHTrace.h"
+#include "phool.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace std;
+
+atomic<bool> PHTrace::enabled(false);
+
+namespace
+{
+  struct TraceZone
+  {
+    const char *name;
+    unsigned long long start; // ns since the start of the job
+    unsigned long long duration; // ns
+    int depth;
+  };
+
+  struct ThreadBuffer
+  {
+    int tid;
+    int depth;
+    unsigned long dropped;
+    vector<TraceZone> zones;
+  };
+
+  const chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+
+  // the buffers are never deleted, threads may still hold them
+  mutex buffermutex;
+  vector<ThreadBuffer *> buffers;
+  // with zones per module and main step an event records a few dozen
+  size_t maxzones = 1000000;
+
+  mutex labelmutex;
+  set<string> labels;
+
+  ThreadBuffer *
+  threadbuffer()
+  {
+    static thread_local ThreadBuffer *buffer = 0;
+    if (!buffer)
+      {
+	lock_guard<mutex> lock(buffermutex);
+	buffer = new ThreadBuffer();
+	buffer->tid = buffers.size();
+	buffer->depth = 0;
+	buffer->dropped = 0;
+	buffers.push_back(buffer);
+      }
+    return buffer;
+  }
+
+  unsigned long long
+  now()
+  {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - t0).count();
+  }
+
+  void
+  printname(ostream &os, const char *name)
+  {
+    for (const char *c = name; *c; ++c)
+      {
+	if (*c == '"' || *c == '\\')
+	  {
+	    os << '\\';
+	  }
+	os << *c;
+      }
+  }
+}
+
+unsigned long long
+PHTrace::begin()
+{
+  threadbuffer()->depth++;
+  return now();
+}
+
+void
+PHTrace::end(const char *name, const unsigned long long start)
+{
+  unsigned long long stop = now();
+  ThreadBuffer *buffer = threadbuffer();
+  buffer->depth--;
+  if (buffer->zones.size() >= maxzones)
+    {
+      buffer->dropped++;
+      return;
+    }
+  TraceZone zone;
+  zone.name = name;
+  zone.start = start;
+  zone.duration = stop - start;
+  zone.depth = buffer->depth;
+  buffer->zones.push_back(zone);
+  return;
+}
+
+const char *
+PHTrace::Label(const string &name)
+{
+  // set elements do not move, the pointers stay valid
+  lock_guard<mutex> lock(labelmutex);
+  return labels.insert(name).first->c_str();
+}
+
+void
+PHTrace::SetMaxZones(const size_t n)
+{
+  maxzones = n;
+  return;
+}
+
+void
+PHTrace::Clear()
+{
+  lock_guard<mutex> lock(buffermutex);
+  for (vector<ThreadBuffer *>::const_iterator iter = buffers.begin(); iter != buffers.end(); ++iter)
+    {
+      (*iter)->zones.clear();
+      (*iter)->dropped = 0;
+    }
+  return;
+}
+
+int
+PHTrace::Dump(const string &filename)
+{
+  ofstream fout(filename.c_str());
+  if (!fout)
+    {
+      cout << PHWHERE << " could not open trace file " << filename << endl;
+      return -1;
+    }
+  lock_guard<mutex> lock(buffermutex);
+  int pid = getpid();
+  unsigned long dropped = 0;
+  size_t nzones = 0;
+  fout << "{\"displayTimeUnit\": \"ms\"," << endl
+       << " \"traceEvents\": [";
+  bool first = true;
+  for (vector<ThreadBuffer *>::const_iterator iter = buffers.begin(); iter != buffers.end(); ++iter)
+    {
+      const ThreadBuffer *buffer = *iter;
+      fout << (first ? "" : ",") << endl
+	   << "  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid
+	   << ", \"tid\": " << buffer->tid
+	   << ", \"args\": {\"name\": \"thread " << buffer->tid << "\"}}";
+      first = false;
+      for (vector<TraceZone>::const_iterator ziter = buffer->zones.begin(); ziter != buffer->zones.end(); ++ziter)
+	{
+	  // chrome trace times are in microseconds
+	  fout << "," << endl << "  {\"name\": \"";
+	  printname(fout, ziter->name);
+	  fout << "\", \"ph\": \"X\", \"pid\": " << pid
+	       << ", \"tid\": " << buffer->tid
+	       << ", \"ts\": " << ziter->start / 1000 << "." << ziter->start % 1000 / 100
+	       << ", \"dur\": " << ziter->duration / 1000 << "." << ziter->duration % 1000 / 100
+	       << ", \"args\": {\"depth\": " << ziter->depth << "}}";
+	}
+      nzones += buffer->zones.size();
+      dropped += buffer->dropped;
+    }
+  fout << endl << " ]" << endl << "}" << endl;
+  cout << "PHTrace: wrote " << nzones << " zones of " << buffers.size()
+       << " threads to " << filename << endl;
+  if (dropped)
+    {
+      cout << "PHTrace: " << dropped << " zones were dropped, the limit is "
+	   << maxzones << " zones per thread (PHTrace::SetMaxZones)" << endl;
+    }
+  return 0;
+}
@@ -0,0 +1,75 @@
+#ifndef __PHTRACE_H__
+#define __PHTRACE_H__
+
+// Scoped trace zones which are written in the chrome trace event
+// format, the output can be opened with chrome://tracing or
+// https://ui.perfetto.dev
+//
+//   {
+//     PHTRACE_ZONE("cluster search");
+//     ...
+//   }
+//
+// Zones are only recorded after PHTrace::Enable(), otherwise creating
+// a zone costs the test of one static flag. Every thread records into
+// its own buffer, zones nest within a thread. Zones keep the pointer to
+// their name, use string literals or PHTrace::Label. They are meant for
+// modules and their main steps, not for per track or per layer loops.
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+
+class PHTrace
+{
+ public:
+  static void Enable(const bool b = true) {enabled.store(b);}
+  static bool isEnabled() {return enabled.load(std::memory_order_relaxed);}
+  //! copy of name which stays valid for the whole job, for zone names which are not literals
+  static const char *Label(const std::string &name);
+  //! maximum number of zones kept per thread, later zones are counted as dropped
+  static void SetMaxZones(const size_t n);
+  //! write all recorded zones, must not be called while other threads record zones
+  static int Dump(const std::string &filename);
+  static void Clear();
+
+ private:
+  friend class PHTraceZone;
+  static unsigned long long begin();
+  static void end(const char *name, const unsigned long long start);
+  static std::atomic<bool> enabled;
+};
+
+class PHTraceZone
+{
+ public:
+  //! the name must stay valid until PHTrace::Dump (a literal or PHTrace::Label)
+  explicit PHTraceZone(const char *zname): name(0), start(0)
+  {
+    if (PHTrace::enabled.load(std::memory_order_relaxed))
+      {
+	name = zname;
+	start = PHTrace::begin();
+      }
+  }
+  ~PHTraceZone()
+  {
+    if (name)
+      {
+	PHTrace::end(name, start);
+      }
+  }
+
+ private:
+  PHTraceZone(const PHTraceZone &);
+  PHTraceZone &operator=(const PHTraceZone &);
+
+  const char *name;
+  unsigned long long start;
+};
+
+#define PHTRACE_CONCAT2(a, b) a##b
+#define PHTRACE_CONCAT(a, b) PHTRACE_CONCAT2(a, b)
+#define PHTRACE_ZONE(name) PHTraceZone PHTRACE_CONCAT(phtracezone_, __LINE__)(name)
+
+#endif /* __PHTRACE_H__ */
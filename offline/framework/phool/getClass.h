@@ -15,10 +15,8 @@ class PHCompositeNode;
 namespace findNode
 {
   template <class T>
-    T* getClass(PHCompositeNode *top, const std::string &name)
+    T* getClass(PHNode *FoundNode)
     {
-      PHNodeIterator iter(top);
-      PHNode *FoundNode = iter.findFirst(name.c_str()); // returns pointer to PHNode
       if (!FoundNode)
 	{
 	  return NULL;
@@ -55,6 +53,14 @@ namespace findNode
 
     return NULL;
   }
+
+  template <class T>
+    T* getClass(PHCompositeNode *top, const std::string &name)
+    {
+      PHNodeIterator iter(top);
+      PHNode *FoundNode = iter.findFirst(name.c_str()); // returns pointer to PHNode
+      return getClass<T>(FoundNode);
+    }
 }
 
 #endif /* GETCLASS_H */
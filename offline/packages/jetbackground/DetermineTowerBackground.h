@@ -13,10 +13,15 @@
 #include <phool/PHTimeServer.h>
 
 // standard includes
+#include <string>
+#include <utility>
 #include <vector>
 
 // forward declarations
 class PHCompositeNode;
+class RawTower;
+class RawTowerContainer;
+class RawTowerGeomContainer;
 
 /// \class DetermineTowerBackground
 ///
@@ -44,6 +49,11 @@ class DetermineTowerBackground : public SubsysReco
   int CreateNode(PHCompositeNode *topNode);
   void FillNode(PHCompositeNode *topNode);
 
+  // add the tower energies to the (eta, phi) bins of energies
+  void AddTowers(RawTowerContainer *towers, RawTowerGeomContainer *geom, std::vector< std::pair<int, int> > &bins, std::vector<std::vector<float> > &energies, const std::string &calo);
+  std::pair<int, int> GetBin(RawTower *tower, RawTowerGeomContainer *geom) const;
+  void PrintTower(RawTower *tower, RawTowerGeomContainer *geom, const std::string &calo) const;
+
   float _v2[3];
   float _Psi2[3];
   std::vector< std::vector<float> > _UE;
@@ -55,6 +65,11 @@ class DetermineTowerBackground : public SubsysReco
   std::vector<std::vector<float> > _IHCAL_E;
   std::vector<std::vector<float> > _OHCAL_E;
 
+  // (eta, phi) bin of every grid tower position of the three containers
+  std::vector< std::pair<int, int> > _EMCAL_BIN;
+  std::vector< std::pair<int, int> > _IHCAL_BIN;
+  std::vector< std::pair<int, int> > _OHCAL_BIN;
+
   std::string _backgroundName;
 
   int _seed_type;
@@ -13,6 +13,7 @@
 #include <phool/PHTimeServer.h>
 
 // standard includes
+#include <utility>
 #include <vector>
 
 #include <g4cemc/RawTowerContainer.h>
@@ -45,6 +46,10 @@ class RetowerCEMC : public SubsysReco
   int _NPHI;
   std::vector< std::vector<float> > _EMCAL_RETOWER_E;
 
+  // IH (eta, phi) bin of every CEMC grid tower, and the CEMC energy grid
+  std::vector< std::pair<int, int> > _EM_TO_IH;
+  std::vector<float> _EMCAL_E;
+
 };
 
 #endif  // __RETOWERCEMC_H__
@@ -311,6 +311,7 @@ HcalRawTowerBuilder::CreateNodes(PHCompositeNode *topNode)
 
   // Create the tower nodes on the tree
   _towers = new RawTowerContainer(RawTowerDefs::convert_name_to_caloid(detector));
+  _towers->setGrid(get_int_param("etabins"), get_int_param(PHG4HcalDefs::n_towers));
   if (_sim_tower_node_prefix.length() == 0)
     {
       // no prefix, consistent with older convension
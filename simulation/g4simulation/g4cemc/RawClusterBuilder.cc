@@ -11,6 +11,7 @@
 #include <fun4all/Fun4AllReturnCodes.h>
 #include <phool/getClass.h>
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <vector>
@@ -100,6 +101,72 @@ bool operator<(const twrs& a, const twrs& b)
   return a.get_binphi() < b.get_binphi();
 }
 
+// the groups PHMakeGroups makes, for towers on the grid of the container:
+// the towers above threshold come from the occupancy bitmap in (eta, phi)
+// order and the groups grow over the grid neighbours instead of testing
+// every pair of towers. Groups are numbered by their first tower in that
+// order and filled in that order, which is what PHMakeGroups does with the
+// sorted towers and the connected components of boost
+static void
+MakeGridGroups(RawTowerContainer *towers, const float min_tower_e, const int maxphibin,
+	       std::vector<int> &label, std::multimap<int, twrs> &groups)
+{
+  const int neta = towers->getGridEtaBins();
+  const int nphi = towers->getGridPhiBins();
+  const int unassigned = -2;
+  label.resize(towers->getGridSize(), -1);
+  std::vector<int> above;
+  for (int index = towers->nextGridIndex(0); index >= 0; index = towers->nextGridIndex(index + 1))
+    {
+      if (towers->getGridTower(index)->get_energy() > min_tower_e)
+	{
+	  label[index] = unassigned;
+	  above.push_back(index);
+	}
+    }
+  int ngroups = 0;
+  std::vector<int> stack;
+  for (unsigned int i = 0; i < above.size(); i++)
+    {
+      if (label[above[i]] != unassigned)
+	{
+	  continue;
+	}
+      label[above[i]] = ngroups;
+      stack.push_back(above[i]);
+      while (!stack.empty())
+	{
+	  const int index = stack.back();
+	  stack.pop_back();
+	  const int ieta = index / nphi;
+	  const int iphi = index % nphi;
+	  for (int eta = max(ieta - 1, 0); eta <= min(ieta + 1, neta - 1); eta++)
+	    {
+	      for (int dphi = -1; dphi <= 1; dphi++)
+		{
+		  // phi wraps around, twrs::is_adjacent
+		  const int neighbour = eta * nphi + (iphi + dphi + nphi) % nphi;
+		  if (label[neighbour] == unassigned)
+		    {
+		      label[neighbour] = ngroups;
+		      stack.push_back(neighbour);
+		    }
+		}
+	    }
+	}
+      ngroups++;
+    }
+  for (unsigned int i = 0; i < above.size(); i++)
+    {
+      RawTower *tower = towers->getGridTower(above[i]);
+      twrs twr(tower);
+      twr.set_maxphibin(maxphibin);
+      twr.set_id(tower->get_id());
+      groups.insert(std::make_pair(label[above[i]], twr));
+      label[above[i]] = -1;
+    }
+}
+
 RawClusterBuilder::RawClusterBuilder(const std::string& name):
   SubsysReco( name ),
   _clusters(NULL),
@@ -141,26 +208,34 @@ int RawClusterBuilder::process_event(PHCompositeNode *topNode)
      cout << PHWHERE << ": Could not find node " << towergeomnodename.c_str() << endl;
      return Fun4AllReturnCodes::ABORTEVENT;
    }
-  // make the list of towers above threshold
-  std::vector<twrs> towerVector;
-  RawTowerContainer::ConstRange begin_end  = towers->getTowers();
-  RawTowerContainer::ConstIterator itr = begin_end.first;
-  for (; itr != begin_end.second; ++itr)
+  std::multimap<int, twrs> clusteredTowers;
+  if (towers->allOnGrid() && towers->getGridPhiBins() >= 3 &&
+      (int) towers->getGridPhiBins() == towergeom->get_phibins())
     {
-      RawTower* tower = itr->second;
-      RawTowerDefs::keytype towerid = itr->first;
-      if (tower->get_energy() > _min_tower_e)
-        {
-          twrs twr(tower);
-	  twr.set_maxphibin(towergeom->get_phibins());
-	  twr.set_id(towerid);
-          towerVector.push_back(twr);
-        }
+      MakeGridGroups(towers, _min_tower_e, towergeom->get_phibins(), _grid_label, clusteredTowers);
     }
+  else
+    {
+      // make the list of towers above threshold
+      std::vector<twrs> towerVector;
+      RawTowerContainer::ConstRange begin_end  = towers->getTowers();
+      RawTowerContainer::ConstIterator itr = begin_end.first;
+      for (; itr != begin_end.second; ++itr)
+	{
+	  RawTower* tower = itr->second;
+	  RawTowerDefs::keytype towerid = itr->first;
+	  if (tower->get_energy() > _min_tower_e)
+	    {
+	      twrs twr(tower);
+	      twr.set_maxphibin(towergeom->get_phibins());
+	      twr.set_id(towerid);
+	      towerVector.push_back(twr);
+	    }
+	}
 
-  // cluster the towers
-  std::multimap<int, twrs> clusteredTowers;
-  PHMakeGroups(towerVector, clusteredTowers);
+      // cluster the towers
+      PHMakeGroups(towerVector, clusteredTowers);
+    }
 
   // extract the clusters
   std::vector<float> energy;
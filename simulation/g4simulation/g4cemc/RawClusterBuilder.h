@@ -3,6 +3,7 @@
 
 #include <fun4all/SubsysReco.h>
 #include <string>
+#include <vector>
 
 class PHCompositeNode;
 class RawCluster;
@@ -19,6 +20,8 @@ class RawClusterBuilder : public SubsysReco {
   int InitRun(PHCompositeNode *topNode);
   int process_event(PHCompositeNode *topNode);
   int End(PHCompositeNode *topNode);
+  //! copy for a worker of the multi threaded event loop, it keeps no job wide state
+  SubsysReco *clone() const {return new RawClusterBuilder(*this);}
   void Detector(const std::string &d) {detector = d;}
 
   void set_threshold_energy(const float e) {_min_tower_e = e;}
@@ -36,6 +39,9 @@ class RawClusterBuilder : public SubsysReco {
   std::string detector;
   std::string ClusterNodeName;
 
+  //! group of every tower position when clustering on the grid of the towers (-1: none), kept between events
+  std::vector<int> _grid_label;
+
 };
 
 #endif /* RAWCLUSTERBUILDER_H__ */
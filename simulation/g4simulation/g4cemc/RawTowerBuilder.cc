@@ -154,7 +154,7 @@ RawTowerBuilder::process_event(PHCompositeNode *topNode)
       tower = _towers->getTower(firstpar,secondpar);
       if (!tower)
 	{
-	  tower = new RawTowerv1();
+	  tower = _towers->NewTower();
 	  tower->set_energy(0);
 	  _towers->AddTower(firstpar,secondpar, tower);
 	}
@@ -502,6 +502,7 @@ RawTowerBuilder::CreateNodes(PHCompositeNode *topNode)
 
   // Create the tower nodes on the tree
   _towers = new RawTowerContainer(caloid);
+  _towers->setGrid(rawtowergeom->get_etabins(), rawtowergeom->get_phibins());
   if (_sim_tower_node_prefix.length() == 0)
     {
       // no prefix, consistent with older convension
@@ -75,6 +75,18 @@ RawTowerCalibration::process_event(PHCompositeNode *topNode)
           << "Process event entered" << std::endl;
     }
 
+  // looked up for every event, a worker of the multi threaded event loop
+  // gets the input objects swapped into its nodes
+  _raw_towers = findNode::getClass<RawTowerContainer>(topNode,
+      RawTowerNodeName.c_str());
+  if (!_raw_towers)
+    {
+      std::cout << Name() << "::" << detector << "::" << __PRETTY_FUNCTION__
+          << " " << RawTowerNodeName << " Node missing, doing nothing."
+          << std::endl;
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
+
   RawTowerContainer::ConstRange begin_end = _raw_towers->getTowers();
   RawTowerContainer::ConstIterator rtiter;
   for (rtiter = begin_end.first; rtiter != begin_end.second; ++rtiter)
@@ -156,6 +168,14 @@ RawTowerCalibration::process_event(PHCompositeNode *topNode)
   return Fun4AllReturnCodes::EVENT_OK;
 }
 
+SubsysReco *
+RawTowerCalibration::clone() const
+{
+  RawTowerCalibration *calibration = new RawTowerCalibration(*this);
+  calibration->_timer = PHTimeServer::get()->insert_new(Name());
+  return calibration;
+}
+
 int
 RawTowerCalibration::End(PHCompositeNode *topNode)
 {
@@ -235,6 +255,7 @@ RawTowerCalibration::CreateNodes(PHCompositeNode *topNode)
   if (!_calib_towers)
     {
       _calib_towers = new RawTowerContainer(_raw_towers -> getCalorimeterID());
+      _calib_towers->setGrid(_raw_towers->getGridEtaBins(), _raw_towers->getGridPhiBins());
       PHIODataNode<PHObject> *towerNode = new PHIODataNode<PHObject>(
           _calib_towers, CaliTowerNodeName.c_str(), "PHObject");
       DetNode->addNode(towerNode);
@@ -30,6 +30,9 @@ public:
   process_event(PHCompositeNode *topNode);
   int
   End(PHCompositeNode *topNode);
+  //! copy for a worker of the multi threaded event loop, with its own timer
+  SubsysReco *
+  clone() const;
   void
   Detector(const std::string &d)
   {
@@ -1,11 +1,19 @@
 #include "RawTowerContainer.h"
 #include "RawTower.h"
+#include "RawTowerv1.h"
 
 #include <cstdlib>
 #include <iostream>
 
 using namespace std;
 
+bool RawTowerContainer::_recycle_default = false;
+
+RawTowerContainer::~RawTowerContainer()
+{
+  Recycle(false);
+}
+
 void 
 RawTowerContainer::compress(const double emin)
 {
@@ -20,7 +28,8 @@ RawTowerContainer::compress(const double emin)
       RawTower *tower = (itr->second);
       if (tower->get_energy() < emin)
         {
-	  delete tower;
+	  SetGridTower(itr->first, NULL);
+	  ReleaseTower(tower);
           _towers.erase(itr++);
         }
       else
@@ -50,6 +59,7 @@ RawTowerContainer::AddTower(const unsigned int ieta, const int unsigned iphi, Ra
   RawTowerDefs::keytype key = RawTowerDefs::encode_towerid(_caloid,ieta,iphi);
   _towers[key] = rawtower;
   rawtower->set_id(key); // force tower key to be synced to container key
+  SetGridTower(key, rawtower);
 
   return _towers.find(key);
 }
@@ -66,6 +76,7 @@ RawTowerContainer::AddTower(RawTowerDefs::keytype key, RawTower *twr)
 
   _towers[key] = twr;
   twr->set_id(key); // force tower key to be synced to container key
+  SetGridTower(key, twr);
 
   return _towers.find(key);
 }
@@ -73,6 +84,11 @@ RawTowerContainer::AddTower(RawTowerDefs::keytype key, RawTower *twr)
 RawTower *
 RawTowerContainer::getTower(RawTowerDefs::keytype key)
 {
+  int index = GridIndex(key);
+  if (index >= 0)
+    {
+      return _grid[index];
+    }
   Iterator it = _towers.find(key);
   if (it != _towers.end())
     {
@@ -84,6 +100,10 @@ RawTowerContainer::getTower(RawTowerDefs::keytype key)
 RawTower *
 RawTowerContainer::getTower(const unsigned int ieta, const unsigned int iphi)
 {
+  if (ieta < _neta && iphi < _nphi)
+    {
+      return _grid[ieta * _nphi + iphi];
+    }
   RawTowerDefs::keytype key = RawTowerDefs::encode_towerid(_caloid,ieta,iphi);
   return getTower(key);
 }
@@ -97,10 +117,157 @@ RawTowerContainer::isValid() const
 void
 RawTowerContainer::Reset()
 {
-  while (_towers.begin() != _towers.end())
+  for (Iterator iter = _towers.begin(); iter != _towers.end(); ++iter)
+    {
+      ReleaseTower(iter->second);
+    }
+  _towers.clear();
+  // only the occupied part of the grid needs clearing
+  for (unsigned int iword = 0; iword < _occupied.size(); iword++)
+    {
+      for (unsigned int word = _occupied[iword]; word; word &= word - 1)
+        {
+          _grid[iword * 32 + __builtin_ctz(word)] = NULL;
+        }
+      _occupied[iword] = 0;
+    }
+  _ngrid = 0;
+}
+
+void
+RawTowerContainer::setGrid(const unsigned int neta, const unsigned int nphi)
+{
+  _neta = neta;
+  _nphi = nphi;
+  _grid.assign(_neta * _nphi, NULL);
+  _occupied.assign((_grid.size() + 31) / 32, 0);
+  _ngrid = 0;
+  for (Iterator iter = _towers.begin(); iter != _towers.end(); ++iter)
+    {
+      SetGridTower(iter->first, iter->second);
+    }
+}
+
+int
+RawTowerContainer::GridIndex(const RawTowerDefs::keytype key) const
+{
+  if (_grid.empty() || RawTowerDefs::decode_caloid(key) != _caloid)
+    {
+      return -1;
+    }
+  const unsigned int ieta = RawTowerDefs::decode_index1(key);
+  const unsigned int iphi = RawTowerDefs::decode_index2(key);
+  if (ieta >= _neta || iphi >= _nphi)
+    {
+      return -1;
+    }
+  return ieta * _nphi + iphi;
+}
+
+void
+RawTowerContainer::SetGridTower(const RawTowerDefs::keytype key, RawTower *twr)
+{
+  int index = GridIndex(key);
+  if (index < 0)
+    {
+      return;
+    }
+  const bool occupied = _grid[index];
+  _grid[index] = twr;
+  if (twr)
+    {
+      _occupied[index / 32] |= (1U << (index % 32));
+      _ngrid += !occupied;
+    }
+  else
+    {
+      _occupied[index / 32] &= ~(1U << (index % 32));
+      _ngrid -= occupied;
+    }
+}
+
+int
+RawTowerContainer::nextGridIndex(const unsigned int index) const
+{
+  unsigned int iword = index / 32;
+  if (iword >= _occupied.size())
+    {
+      return -1;
+    }
+  // the bits below index of its word are masked off
+  unsigned int word = _occupied[iword] & (~0U << (index % 32));
+  while (!word)
+    {
+      if (++iword >= _occupied.size())
+        {
+          return -1;
+        }
+      word = _occupied[iword];
+    }
+  return iword * 32 + __builtin_ctz(word);
+}
+
+bool
+RawTowerContainer::getEnergyGrid(std::vector<float> &energy) const
+{
+  if (_grid.empty())
+    {
+      return false;
+    }
+  energy.assign(_grid.size(), 0);
+  for (unsigned int iword = 0; iword < _occupied.size(); iword++)
     {
-      delete _towers.begin()->second;
-      _towers.erase(_towers.begin());
+      for (unsigned int word = _occupied[iword]; word; word &= word - 1)
+        {
+          const unsigned int index = iword * 32 + __builtin_ctz(word);
+          energy[index] = _grid[index]->get_energy();
+        }
+    }
+  return true;
+}
+
+void
+RawTowerContainer::Recycle(const bool b)
+{
+  _recycle = b;
+  if (!_recycle)
+    {
+      while (!_freetowers.empty())
+        {
+          delete _freetowers.back();
+          _freetowers.pop_back();
+        }
+    }
+}
+
+RawTower *
+RawTowerContainer::NewTower()
+{
+  if (!_freetowers.empty())
+    {
+      RawTower *twr = _freetowers.back();
+      _freetowers.pop_back();
+      _nrecycled++;
+      return twr;
+    }
+  _nallocated++;
+  return new RawTowerv1();
+}
+
+void
+RawTowerContainer::ReleaseTower(RawTower *twr)
+{
+  // only our own tower type goes on the free list, NewTower() hands out RawTowerv1.
+  // Producers may still add towers made with new, the free list never holds
+  // more towers than NewTower() allocated so it cannot grow from event to event
+  if (_recycle && twr->IsA() == RawTowerv1::Class() && _freetowers.size() < _nallocated)
+    {
+      twr->Reset();
+      _freetowers.push_back(twr);
+    }
+  else
+    {
+      delete twr;
     }
 }
 
@@ -108,6 +275,14 @@ void
 RawTowerContainer::identify(std::ostream& os) const
 {
   os << "RawTowerContainer, number of towers: " << size() << std::endl;
+  os << "towers allocated: " << _nallocated
+     << ", recycled: " << _nrecycled
+     << ", on free list: " << _freetowers.size()
+     << (_recycle ? "" : " (recycling off)") << std::endl;
+  if (!_grid.empty())
+    {
+      os << "grid of " << _neta << " x " << _nphi << " towers" << std::endl;
+    }
 }
 
 double
@@ -6,6 +6,7 @@
 #include <phool/phool.h>
 #include <iostream>
 #include <map>
+#include <vector>
 
 class RawTower;
 
@@ -21,10 +22,16 @@ class RawTowerContainer : public PHObject
   typedef std::pair<ConstIterator, ConstIterator> ConstRange;
 
  RawTowerContainer( RawTowerDefs::CalorimeterId caloid = RawTowerDefs::NONE ):
-  _caloid(caloid)
+  _caloid(caloid),
+  _recycle(_recycle_default),
+  _nallocated(0),
+  _nrecycled(0),
+  _neta(0),
+  _nphi(0),
+  _ngrid(0)
   {}
 
-  virtual ~RawTowerContainer() {}
+  virtual ~RawTowerContainer();
 
   void Reset();
   int isValid() const;
@@ -45,10 +52,69 @@ class RawTowerContainer : public PHObject
   void compress(const double emin);
   double getTotalEdep() const;
 
+  //! returns an empty RawTowerv1, taken from the free list if recycling is on
+  //! (ownership goes back to the container via AddTower)
+  RawTower *NewTower();
+
+  //! keep the towers of the last event on a free list in Reset() instead of deleting them
+  void Recycle(const bool b = true);
+  bool Recycle() const { return _recycle; }
+  //! recycling mode of containers created after this call
+  static void RecycleDefault(const bool b) { _recycle_default = b; }
+
+  //! number of towers allocated with new by NewTower() and handed out from the free list
+  unsigned long get_nallocated() const { return _nallocated; }
+  unsigned long get_nrecycled() const { return _nrecycled; }
+
+  //! dense (ieta, iphi) index for the module which fills the container: getTower()
+  //! becomes an array lookup and getEnergyGrid() does not go through the map.
+  //! Towers outside of the grid are still kept (map only), existing towers are indexed.
+  //! The index is transient, containers read from a DST have none
+  void setGrid(const unsigned int neta, const unsigned int nphi);
+  bool hasGrid() const { return !_grid.empty(); }
+  unsigned int getGridEtaBins() const { return _neta; }
+  unsigned int getGridPhiBins() const { return _nphi; }
+
+  //! energies of the towers on the grid at ieta * nphi + iphi, 0 for empty towers,
+  //! returns false (energy untouched) without grid
+  bool getEnergyGrid(std::vector<float> &energy) const;
+
+  //! every tower of the container is on the grid, the grid iteration sees all of them
+  bool allOnGrid() const { return !_grid.empty() && _ngrid == _towers.size(); }
+
+  //! iteration over the non empty grid positions (ieta * nphi + iphi) in map order by
+  //! walking the occupancy bitmap, an empty grid costs one bit per tower position:
+  //!   for (int i = towers->nextGridIndex(0); i >= 0; i = towers->nextGridIndex(i + 1))
+  //!     towers->getGridTower(i) ...
+  //! returns the first occupied position at or after index, -1 if there is none
+  int nextGridIndex(const unsigned int index) const;
+  //! tower at grid position index, NULL if the position is empty
+  RawTower *getGridTower(const unsigned int index) const { return _grid[index]; }
+  unsigned int getGridSize() const { return _grid.size(); }
+
  protected:
+  void ReleaseTower(RawTower *twr);
+
+  //! position of key in _grid, -1 if it is not on the grid
+  int GridIndex(const RawTowerDefs::keytype key) const;
+  void SetGridTower(const RawTowerDefs::keytype key, RawTower *twr);
+
   RawTowerDefs::CalorimeterId _caloid;
   Map _towers;
 
+  bool _recycle; //! transient, recycling mode
+  std::vector<RawTower *> _freetowers; //! transient, towers kept from previous events
+  unsigned long _nallocated; //! transient
+  unsigned long _nrecycled; //! transient
+
+  unsigned int _neta; //! transient
+  unsigned int _nphi; //! transient
+  std::vector<RawTower *> _grid; //! transient, tower at ieta * _nphi + iphi
+  std::vector<unsigned int> _occupied; //! transient, one bit per grid entry
+  unsigned int _ngrid; //! transient, number of towers on the grid
+
+  static bool _recycle_default;
+
   ClassDef(RawTowerContainer,1)
 };
 
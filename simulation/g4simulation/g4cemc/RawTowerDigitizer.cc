@@ -300,6 +300,7 @@ RawTowerDigitizer::CreateNodes(PHCompositeNode *topNode)
   if (!_raw_towers)
     {
       _raw_towers = new RawTowerContainer( _sim_towers -> getCalorimeterID()  );
+      _raw_towers->setGrid(_sim_towers->getGridEtaBins(), _sim_towers->getGridPhiBins());
       PHIODataNode<PHObject> *towerNode = new PHIODataNode<PHObject>(_raw_towers,
 								     RawTowerNodeName.c_str(), "PHObject");
       DetNode->addNode(towerNode);
@@ -3,7 +3,6 @@
 #include "PHG4BlockGeom.h"
 #include "PHG4BlockCellGeomContainer.h"
 #include "PHG4BlockCellGeom.h"
-#include "PHG4Cellv1.h"
 #include "PHG4CellContainer.h"
 #include "PHG4CellDefs.h"
 #include "PHG4ParametersContainer.h"
@@ -428,7 +427,7 @@ PHG4BlockCellReco::process_event(PHCompositeNode *topNode)
           if (!cellptarray[ibin])
           {
             PHG4CellDefs::keytype key = PHG4CellDefs::EtaXsizeBinning::genkey(*layer, ixbin, ietabin);
-            cellptarray[ibin] = new PHG4Cellv1(key);
+            cellptarray[ibin] = cells->NewCell(key);
           }
           cellptarray[ibin]->add_edep(hiter->first, hiter->second->get_edep()*vdedx[i1]);
 	  cellptarray[ibin]->add_edep(hiter->second->get_edep()*vdedx[i1]);
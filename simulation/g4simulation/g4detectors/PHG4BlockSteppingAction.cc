@@ -44,6 +44,17 @@ PHG4BlockSteppingAction::~PHG4BlockSteppingAction()
   delete hit;
 }
 
+//____________________________________________________________________________..
+int PHG4BlockSteppingAction::IsInDetector(G4VPhysicalVolume* volume) const
+{
+  // same check as at the start of UserSteppingAction
+  if (detector_->IsInBlock(volume))
+  {
+    return VOLUME_OWNED;
+  }
+  return VOLUME_OTHER;
+}
+
 //____________________________________________________________________________..
 bool PHG4BlockSteppingAction::UserSteppingAction(const G4Step* aStep, bool)
 {
@@ -22,6 +22,9 @@ class PHG4BlockSteppingAction : public PHG4SteppingAction
   //! stepping action
   virtual bool UserSteppingAction(const G4Step *, bool);
 
+  //! reimplemented from base class, steps in other volumes are not passed to this action
+  virtual int IsInDetector(G4VPhysicalVolume *) const;
+
   //! reimplemented from base class
   virtual void SetInterfacePointers(PHCompositeNode *);
 
@@ -56,6 +56,9 @@ class PHG4Cell: public PHObject
     return std::make_pair(dummy.begin(), dummy.end());
   }
 
+  //! keep only the n g4hits and the n showers with the largest energy deposition, 0 drops the truth association
+  virtual void keep_top_truth(const unsigned int n) {return;}
+
   virtual short int get_detid() const {return -1;}
   // for backward compatibility, layers and detector ids are identical
   short int get_layer() const {return get_detid();}
@@ -155,6 +158,18 @@ class PHG4Cell: public PHObject
   PHG4Cell() {}
   virtual unsigned int get_property_nocheck(const PROPERTY prop_id) const {return UINT_MAX;}
   virtual void set_property_nocheck(const PROPERTY prop_id,const unsigned int) {return;}
+#ifndef __CINT__
+  //! order of keep_top_truth: largest energy first, ties by id to be independent of the fill order
+  template <class T>
+  static bool larger_edep(const std::pair<T, float> &a, const std::pair<T, float> &b)
+  {
+    if (a.second != b.second)
+      {
+	return a.second > b.second;
+      }
+    return a.first < b.first;
+  }
+#endif
   ClassDef(PHG4Cell,1)
 };
 
@@ -1,22 +1,108 @@
 #include "PHG4CellContainer.h"
 #include "PHG4Cellv1.h"
+#include "PHG4Cellv2.h"
 #include "PHG4CellDefs.h"
 
 #include <cstdlib>
 
 using namespace std;
 
-PHG4CellContainer::PHG4CellContainer()
+bool PHG4CellContainer::recycle_default = false;
+bool PHG4CellContainer::compact_default = false;
+int PHG4CellContainer::maxtruth_default = -1;
+
+PHG4CellContainer::PHG4CellContainer():
+  recycle(recycle_default),
+  nallocated(0),
+  nrecycled(0),
+  compact(compact_default),
+  maxtruth(maxtruth_default)
 {}
 
+PHG4CellContainer::~PHG4CellContainer()
+{
+  Recycle(false);
+}
+
 void
 PHG4CellContainer::Reset()
 {
-   while(cellmap.begin() != cellmap.end())
-     {
-       delete cellmap.begin()->second;
-       cellmap.erase(cellmap.begin());
-     }
+  for (Iterator iter = cellmap.begin(); iter != cellmap.end(); ++iter)
+    {
+      PHG4Cell *cell = iter->second;
+      // only our own cell type goes on the free list, NewCell() hands out PHG4Cellv1 or PHG4Cellv2.
+      // Cells made with new are not counted in nallocated, the free list
+      // never holds more cells than NewCell() allocated
+      if (recycle && cell->IsA() == (compact ? PHG4Cellv2::Class() : PHG4Cellv1::Class())
+	  && freecells.size() < nallocated)
+	{
+	  cell->Reset();
+	  freecells.push_back(cell);
+	}
+      else
+	{
+	  delete cell;
+	}
+    }
+  cellmap.clear();
+  return;
+}
+
+void
+PHG4CellContainer::Recycle(const bool b)
+{
+  recycle = b;
+  if (!recycle)
+    {
+      while (!freecells.empty())
+	{
+	  delete freecells.back();
+	  freecells.pop_back();
+	}
+    }
+  return;
+}
+
+void
+PHG4CellContainer::Compact(const bool b)
+{
+  // the free list has cells of the other version
+  if (b != compact)
+    {
+      bool r = recycle;
+      Recycle(false);
+      recycle = r;
+    }
+  compact = b;
+  return;
+}
+
+PHG4Cell *
+PHG4CellContainer::NewCell(const PHG4CellDefs::keytype key)
+{
+  if (!freecells.empty())
+    {
+      PHG4Cell *cell = freecells.back();
+      freecells.pop_back();
+      cell->set_cellid(key);
+      nrecycled++;
+      return cell;
+    }
+  nallocated++;
+  if (compact)
+    {
+      return new PHG4Cellv2(key);
+    }
+  return new PHG4Cellv1(key);
+}
+
+void
+PHG4CellContainer::PrintAllocStats(ostream& os) const
+{
+  os << "cells allocated: " << nallocated
+     << ", recycled: " << nrecycled
+     << ", on free list: " << freecells.size()
+     << (recycle ? "" : " (recycling off)") << endl;
   return;
 }
 
@@ -30,6 +116,7 @@ PHG4CellContainer::identify(ostream& os) const
        os << "cell key 0x" << hex << iter->first << dec << endl;
        (iter->second)->identify();
      }
+   PrintAllocStats(os);
   return;
 }
 
@@ -42,6 +129,10 @@ PHG4CellContainer::AddCell(PHG4Cell *newcell)
       cout << "overwriting cell 0x" << hex << key << dec << endl;
       cout << "layer: " << PHG4CellDefs::get_detid(key) << endl;
     }
+  if (maxtruth >= 0)
+    {
+      newcell->keep_top_truth(maxtruth);
+    }
   cellmap[key] = newcell;
   return cellmap.find(key);
 }
@@ -55,6 +146,10 @@ PHG4CellContainer::AddCellSpecifyKey(const PHG4CellDefs::keytype key, PHG4Cell *
      exit(1);
    }
   newcell->set_cellid(key);
+  if (maxtruth >= 0)
+    {
+      newcell->keep_top_truth(maxtruth);
+    }
   cellmap[key] = newcell;
   return cellmap.find(key);
 }
@@ -84,10 +179,8 @@ PHG4CellContainer::findOrAddCell(PHG4CellDefs::keytype key)
   PHG4CellContainer::Iterator it = cellmap.find(key);
   if(it == cellmap.end())
   {
-    cellmap[key] = new PHG4Cellv1();
+    cellmap[key] = NewCell(key);
     it = cellmap.find(key);
-    PHG4Cell* mcell = it->second;
-    mcell->set_cellid(key);
   }
   return it;
 }
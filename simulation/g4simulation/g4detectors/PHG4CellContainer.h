@@ -7,6 +7,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 class PHG4CellContainer: public PHObject
 {
@@ -20,7 +21,7 @@ class PHG4CellContainer: public PHObject
 
   PHG4CellContainer();
 
-  virtual ~PHG4CellContainer() {}
+  virtual ~PHG4CellContainer();
 
   void Reset();
 
@@ -68,8 +69,48 @@ class PHG4CellContainer: public PHObject
 
   double getTotalEdep() const;
 
+  //! returns an empty PHG4Cellv1 (PHG4Cellv2 in compact mode) with the given key, taken from the free list
+  //! if recycling is on (ownership goes back to the container via AddCell)
+  PHG4Cell *NewCell(const PHG4CellDefs::keytype key);
+
+  //! keep the cells of the last event on a free list in Reset() instead of deleting them
+  void Recycle(const bool b = true);
+  bool Recycle() const {return recycle;}
+  //! recycling mode of containers created after this call
+  static void RecycleDefault(const bool b) {recycle_default = b;}
+
+  //! NewCell() hands out PHG4Cellv2 (compact storage) instead of PHG4Cellv1
+  void Compact(const bool b);
+  bool Compact() const {return compact;}
+  //! compact mode of containers created after this call
+  static void CompactDefault(const bool b) {compact_default = b;}
+
+  //! AddCell() keeps only the n g4hits and showers with the largest energy deposition
+  //! of each cell (0: none, negative: all) - for productions which do not run the evaluators
+  void MaxTruth(const int n) {maxtruth = n;}
+  int MaxTruth() const {return maxtruth;}
+  //! truth association of containers created after this call
+  static void MaxTruthDefault(const int n) {maxtruth_default = n;}
+
+  //! number of cells allocated with new by NewCell() and handed out from the free list
+  unsigned long get_nallocated() const {return nallocated;}
+  unsigned long get_nrecycled() const {return nrecycled;}
+  void PrintAllocStats(std::ostream& os = std::cout) const;
+
  protected:
   Map cellmap;
+
+  bool recycle; //! transient, recycling mode
+  std::vector<PHG4Cell *> freecells; //! transient, cells kept from previous events
+  unsigned long nallocated; //! transient
+  unsigned long nrecycled; //! transient
+  bool compact; //! transient
+  int maxtruth; //! transient
+
+  static bool recycle_default;
+  static bool compact_default;
+  static int maxtruth_default;
+
   ClassDef(PHG4CellContainer,1)
 };
 
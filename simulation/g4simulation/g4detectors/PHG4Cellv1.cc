@@ -2,10 +2,13 @@
 
 #include <phool/phool.h>
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
 using namespace std;
 
+
 PHG4Cellv1::PHG4Cellv1():
   cellid(~0x0)
 {}
@@ -36,6 +39,29 @@ PHG4Cellv1::add_shower_edep(const int g4showerid, const float edep)
   return;
 }
 
+template <class T>
+void
+PHG4Cellv1::keep_top(map<T, float> &edeps, const unsigned int n)
+{
+  if (edeps.size() <= n)
+    {
+      return;
+    }
+  vector<pair<T, float> > sorted(edeps.begin(), edeps.end());
+  partial_sort(sorted.begin(), sorted.begin() + n, sorted.end(), larger_edep<T>);
+  edeps.clear();
+  edeps.insert(sorted.begin(), sorted.begin() + n);
+  return;
+}
+
+void
+PHG4Cellv1::keep_top_truth(const unsigned int n)
+{
+  keep_top(hitedeps, n);
+  keep_top(showeredeps, n);
+  return;
+}
+
 bool
 PHG4Cellv1::has_binning(const PHG4CellDefs::CellBinning binning) const
 {
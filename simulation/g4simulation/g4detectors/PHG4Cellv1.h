@@ -37,6 +37,8 @@ class PHG4Cellv1: public PHG4Cell
     return std::make_pair(showeredeps.begin(),showeredeps.end());
   } 
 
+  void keep_top_truth(const unsigned int n);
+
 
   void add_edep(const float f) {add_property(prop_edep,f);}
   double get_edep() const {return get_property_float(prop_edep);}
@@ -93,6 +95,10 @@ class PHG4Cellv1: public PHG4Cell
  protected:
   unsigned int get_property_nocheck(const PROPERTY prop_id) const;
   void set_property_nocheck(const PROPERTY prop_id,const unsigned int ui) {prop_map[prop_id]=ui;}
+#ifndef __CINT__
+  template <class T>
+  static void keep_top(std::map<T, float> &edeps, const unsigned int n);
+#endif
 
   PHG4CellDefs::keytype cellid;
   EdepMap hitedeps;
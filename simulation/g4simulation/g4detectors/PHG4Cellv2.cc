@@ -0,0 +1,362 @@
+#include "PHG4Cellv2.h"
+
+#include <phool/phool.h>
+
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+namespace
+{
+  template <class T>
+  bool smaller_id(const pair<T, float> &a, const T id)
+  {
+    return a.first < id;
+  }
+}
+
+PHG4Cellv2::PHG4Cellv2():
+  cellid(~0x0),
+  edep(NAN),
+  eion(NAN),
+  light_yield(NAN),
+  hitmapvalid(false),
+  showermapvalid(false)
+{}
+
+PHG4Cellv2::PHG4Cellv2(const PHG4CellDefs::keytype g4cellid):
+  cellid(g4cellid),
+  edep(NAN),
+  eion(NAN),
+  light_yield(NAN),
+  hitmapvalid(false),
+  showermapvalid(false)
+{}
+
+void
+PHG4Cellv2::add_edep(const PHG4HitDefs::keytype g4hitid, const float e)
+{
+  // same as PHG4Cellv1: a g4hit has one entry, the last one counts
+  vector<pair<PHG4HitDefs::keytype, float> >::iterator iter =
+    lower_bound(hitedeps.begin(), hitedeps.end(), g4hitid, smaller_id<PHG4HitDefs::keytype>);
+  if (iter != hitedeps.end() && iter->first == g4hitid)
+    {
+      iter->second = e;
+    }
+  else
+    {
+      hitedeps.insert(iter, make_pair(g4hitid, e));
+    }
+  // a map handed out keeps its iterators, it gets the same change
+  if (hitmapvalid)
+    {
+      hitedepmap[g4hitid] = e;
+    }
+  return;
+}
+
+void
+PHG4Cellv2::add_shower_edep(const int g4showerid, const float e)
+{
+  vector<pair<int, float> >::iterator iter =
+    lower_bound(showeredeps.begin(), showeredeps.end(), g4showerid, smaller_id<int>);
+  if (iter != showeredeps.end() && iter->first == g4showerid)
+    {
+      iter->second += e;
+    }
+  else
+    {
+      iter = showeredeps.insert(iter, make_pair(g4showerid, e));
+    }
+  if (showermapvalid)
+    {
+      showeredepmap[g4showerid] = iter->second;
+    }
+  return;
+}
+
+PHG4Cell::EdepConstRange
+PHG4Cellv2::get_g4hits()
+{
+  // built once, the range stays valid until keep_top_truth() or Reset()
+  if (!hitmapvalid)
+    {
+      hitedepmap.clear();
+      hitedepmap.insert(hitedeps.begin(), hitedeps.end());
+      hitmapvalid = true;
+    }
+  return make_pair(hitedepmap.begin(), hitedepmap.end());
+}
+
+PHG4Cell::ShowerEdepConstRange
+PHG4Cellv2::get_g4showers()
+{
+  if (!showermapvalid)
+    {
+      showeredepmap.clear();
+      showeredepmap.insert(showeredeps.begin(), showeredeps.end());
+      showermapvalid = true;
+    }
+  return make_pair(showeredepmap.begin(), showeredepmap.end());
+}
+
+void
+PHG4Cellv2::keep_top_truth(const unsigned int n)
+{
+  if (hitedeps.size() > n)
+    {
+      partial_sort(hitedeps.begin(), hitedeps.begin() + n, hitedeps.end(), larger_edep<PHG4HitDefs::keytype>);
+      hitedeps.resize(n);
+      // back to id order for add_edep
+      sort(hitedeps.begin(), hitedeps.end());
+      vector<pair<PHG4HitDefs::keytype, float> >(hitedeps).swap(hitedeps);
+      hitedepmap.clear();
+      hitmapvalid = false;
+    }
+  if (showeredeps.size() > n)
+    {
+      partial_sort(showeredeps.begin(), showeredeps.begin() + n, showeredeps.end(), larger_edep<int>);
+      showeredeps.resize(n);
+      sort(showeredeps.begin(), showeredeps.end());
+      vector<pair<int, float> >(showeredeps).swap(showeredeps);
+      showeredepmap.clear();
+      showermapvalid = false;
+    }
+  return;
+}
+
+bool
+PHG4Cellv2::has_binning(const PHG4CellDefs::CellBinning binning) const
+{
+  return PHG4CellDefs::has_binning(cellid, binning);
+}
+
+short int
+PHG4Cellv2::get_detid() const
+{
+  return PHG4CellDefs::get_detid(cellid);
+}
+
+float *
+PHG4Cellv2::get_float_member(const PROPERTY prop_id)
+{
+  switch (prop_id)
+    {
+    case prop_edep:
+      return &edep;
+    case prop_eion:
+      return &eion;
+    case prop_light_yield:
+      return &light_yield;
+    default:
+      return nullptr;
+    }
+}
+
+const float *
+PHG4Cellv2::get_float_member(const PROPERTY prop_id) const
+{
+  return const_cast<PHG4Cellv2 *>(this)->get_float_member(prop_id);
+}
+
+bool
+PHG4Cellv2::has_property(const PROPERTY prop_id) const
+{
+  const float *member = get_float_member(prop_id);
+  if (member)
+    {
+      return !std::isnan(*member);
+    }
+  for (prop_vector_t::const_iterator i = props.begin(); i != props.end(); ++i)
+    {
+      if (i->first == prop_id)
+	{
+	  return true;
+	}
+    }
+  return false;
+}
+
+float
+PHG4Cellv2::get_property_float(const PROPERTY prop_id) const
+{
+  if (!check_property(prop_id,type_float))
+    {
+      pair<const string,PROPERTY_TYPE> property_info =get_property_info(prop_id);
+      cout << PHWHERE << " Property " << property_info.first << " with id "
+           << prop_id << " is of type " << get_property_type(property_info.second)
+	   << " not " << get_property_type(type_float) << endl;
+      exit(1);
+    }
+  if (!has_property(prop_id))
+    {
+      return NAN;
+    }
+  return u_property(get_property_nocheck(prop_id)).fdata;
+}
+
+int
+PHG4Cellv2::get_property_int(const PROPERTY prop_id) const
+{
+  if (!check_property(prop_id,type_int))
+    {
+      pair<const string,PROPERTY_TYPE> property_info =get_property_info(prop_id);
+      cout << PHWHERE << " Property " << property_info.first << " with id "
+           << prop_id << " is of type " << get_property_type(property_info.second)
+	   << " not " << get_property_type(type_int) << endl;
+      exit(1);
+    }
+  if (!has_property(prop_id))
+    {
+      return INT_MIN;
+    }
+  return u_property(get_property_nocheck(prop_id)).idata;
+}
+
+unsigned int
+PHG4Cellv2::get_property_uint(const PROPERTY prop_id) const
+{
+  if (!check_property(prop_id,type_uint))
+    {
+      pair<const string,PROPERTY_TYPE> property_info =get_property_info(prop_id);
+      cout << PHWHERE << " Property " << property_info.first << " with id "
+           << prop_id << " is of type " << get_property_type(property_info.second)
+	   << " not " << get_property_type(type_uint) << endl;
+      exit(1);
+    }
+  if (!has_property(prop_id))
+    {
+      return UINT_MAX;
+    }
+  return u_property(get_property_nocheck(prop_id)).uidata;
+}
+
+void
+PHG4Cellv2::set_property(const PROPERTY prop_id, const float value)
+{
+  if (!check_property(prop_id,type_float))
+    {
+      pair<const string,PROPERTY_TYPE> property_info = get_property_info(prop_id);
+      cout << PHWHERE << " Property " << property_info.first << " with id "
+           << prop_id << " is of type " << get_property_type(property_info.second)
+	   << " not " << get_property_type(type_float) << endl;
+      exit(1);
+    }
+  set_property_nocheck(prop_id, u_property(value).get_storage());
+}
+
+void
+PHG4Cellv2::set_property(const PROPERTY prop_id, const int value)
+{
+  if (!check_property(prop_id,type_int))
+    {
+      pair<const string,PROPERTY_TYPE> property_info = get_property_info(prop_id);
+      cout << PHWHERE << " Property " << property_info.first << " with id "
+           << prop_id << " is of type " << get_property_type(property_info.second)
+	   << " not " << get_property_type(type_int) << endl;
+      exit(1);
+    }
+  set_property_nocheck(prop_id, u_property(value).get_storage());
+}
+
+void
+PHG4Cellv2::set_property(const PROPERTY prop_id, const unsigned int value)
+{
+  if (!check_property(prop_id,type_uint))
+    {
+      pair<const string,PROPERTY_TYPE> property_info = get_property_info(prop_id);
+      cout << PHWHERE << " Property " << property_info.first << " with id "
+           << prop_id << " is of type " << get_property_type(property_info.second)
+	   << " not " << get_property_type(type_uint) << endl;
+      exit(1);
+    }
+  set_property_nocheck(prop_id, u_property(value).get_storage());
+}
+
+unsigned int
+PHG4Cellv2::get_property_nocheck(const PROPERTY prop_id) const
+{
+  const float *member = get_float_member(prop_id);
+  if (member)
+    {
+      return u_property(*member).get_storage();
+    }
+  for (prop_vector_t::const_iterator i = props.begin(); i != props.end(); ++i)
+    {
+      if (i->first == prop_id)
+	{
+	  return i->second;
+	}
+    }
+  return UINT_MAX;
+}
+
+void
+PHG4Cellv2::set_property_nocheck(const PROPERTY prop_id, const unsigned int ui)
+{
+  float *member = get_float_member(prop_id);
+  if (member)
+    {
+      u_property u(ui);
+      *member = u.fdata;
+      return;
+    }
+  for (prop_vector_t::iterator i = props.begin(); i != props.end(); ++i)
+    {
+      if (i->first == prop_id)
+	{
+	  i->second = ui;
+	  return;
+	}
+    }
+  props.push_back(make_pair(static_cast<prop_id_t>(prop_id), static_cast<prop_storage_t>(ui)));
+  return;
+}
+
+void
+PHG4Cellv2::print() const {
+  std::cout<<"New Cellv2  0x"<< hex << cellid << dec << endl;
+  for (unsigned char ic = 0; ic < UCHAR_MAX; ic++)
+    {
+      PROPERTY prop_id = static_cast<PROPERTY>(ic);
+      if (!has_property(prop_id))
+	{
+	  continue;
+	}
+      pair<const string, PROPERTY_TYPE> property_info = get_property_info(prop_id);
+      cout << "\t" << prop_id << ":\t" << property_info.first << " = \t";
+      switch(property_info.second)
+	{
+	case type_int:
+	  cout << get_property_int(prop_id);
+	  break;
+	case type_uint:
+	  cout << get_property_uint(prop_id);
+	  break;
+	case type_float:
+	  cout << get_property_float(prop_id);
+	  break;
+	default:
+	  cout << " unknown type ";
+	}
+      cout <<endl;
+    }
+  cout << "\t" << hitedeps.size() << " g4hits, " << showeredeps.size() << " showers" << endl;
+}
+
+void
+PHG4Cellv2::Reset()
+{
+  edep = NAN;
+  eion = NAN;
+  light_yield = NAN;
+  hitedeps.clear();
+  showeredeps.clear();
+  props.clear();
+  hitedepmap.clear();
+  showeredepmap.clear();
+  hitmapvalid = false;
+  showermapvalid = false;
+  return;
+}
@@ -0,0 +1,132 @@
+#ifndef PHG4Cellv2_h__
+#define PHG4Cellv2_h__
+
+#include "PHG4Cell.h"
+#include "PHG4CellDefs.h"
+#ifdef __CINT__
+#include <stdint.h>
+#else
+#include <cstdint>
+#endif
+#include <iostream>
+#include <utility>
+#include <vector>
+
+//! compact cell: the summed energies are plain members, the g4hit and
+//! shower contributions (sorted by id) and the other properties are short
+//! vectors instead of maps. get_g4hits()/get_g4showers() build a transient
+//! map on the first call, later add_edep()/add_shower_edep() update it so
+//! the iterators stay valid as for PHG4Cellv1
+class PHG4Cellv2: public PHG4Cell
+{
+ public:
+  PHG4Cellv2();
+  PHG4Cellv2(const PHG4CellDefs::keytype g4cellid);
+  virtual ~PHG4Cellv2() {}
+
+  void Reset();
+
+  void set_cellid(const PHG4CellDefs::keytype i) {cellid = i;}
+
+  PHG4CellDefs::keytype get_cellid() const {return cellid;}
+  bool has_binning(const PHG4CellDefs::CellBinning binning) const;
+  short int get_detid() const;
+
+  void add_edep(const PHG4HitDefs::keytype g4hitid, const float edep);
+  void add_shower_edep(const int g4showerid, const float edep);
+
+  EdepConstRange get_g4hits();
+  ShowerEdepConstRange get_g4showers();
+
+  void keep_top_truth(const unsigned int n);
+
+  void add_edep(const float f) {edep = std::isnan(edep) ? f : edep + f;}
+  double get_edep() const {return edep;}
+
+  void add_eion(const float f) {eion = std::isnan(eion) ? f : eion + f;}
+  double get_eion() const {return eion;}
+
+  void add_light_yield(const float f) {light_yield = std::isnan(light_yield) ? f : light_yield + f;}
+  float get_light_yield() const {return light_yield;}
+
+  void set_chip_index(const int i) {set_property(prop_chip_index,i);}
+  int get_chip_index() const {return get_property_int(prop_chip_index);}
+
+  void set_half_stave_index(const int i) {set_property(prop_half_stave_index,i);}
+  int get_half_stave_index() const {return get_property_int(prop_half_stave_index);}
+
+  void set_ladder_phi_index(const int i) {set_property(prop_ladder_phi_index,i);}
+  int get_ladder_phi_index() const {return get_property_int(prop_ladder_phi_index);}
+
+  void set_ladder_z_index(const int i) {set_property(prop_ladder_z_index,i);}
+  int get_ladder_z_index() const {return get_property_int(prop_ladder_z_index);}
+
+  void set_module_index(const int i) {set_property(prop_module_index,i);}
+  int get_module_index() const {return get_property_int(prop_module_index);}
+
+  void set_phibin(const int i) {set_property(prop_phibin,i);}
+  int get_phibin() const {return get_property_int(prop_phibin);}
+
+  void set_pixel_index(const int i) {set_property(prop_pixel_index,i);}
+  int get_pixel_index() const {return get_property_int(prop_pixel_index);}
+
+  void set_stave_index(const int i) {set_property(prop_stave_index,i);}
+  int get_stave_index() const {return get_property_int(prop_stave_index);}
+
+  void set_zbin(const int i) {set_property(prop_zbin,i);}
+  int get_zbin() const {return get_property_int(prop_zbin);}
+
+  void print() const;
+
+  bool  has_property(const PROPERTY prop_id) const;
+  float get_property_float(const PROPERTY prop_id) const;
+  int   get_property_int(const PROPERTY prop_id) const;
+  unsigned int   get_property_uint(const PROPERTY prop_id) const;
+  void  set_property(const PROPERTY prop_id, const float value);
+  void  set_property(const PROPERTY prop_id, const int value);
+  void  set_property(const PROPERTY prop_id, const unsigned int value);
+
+ protected:
+  unsigned int get_property_nocheck(const PROPERTY prop_id) const;
+  void set_property_nocheck(const PROPERTY prop_id,const unsigned int ui);
+
+  //! storage types for additional property
+  typedef uint8_t prop_id_t;
+  typedef uint32_t prop_storage_t;
+  typedef std::vector<std::pair<prop_id_t, prop_storage_t> > prop_vector_t;
+
+  //! convert between 32bit inputs and storage type prop_storage_t
+  union u_property{
+    float fdata;
+    int32_t idata;
+    uint32_t uidata;
+
+    u_property(int32_t in): idata(in) {}
+    u_property(uint32_t in): uidata(in) {}
+    u_property(float in): fdata(in) {}
+    u_property(): uidata(0) {}
+
+    prop_storage_t get_storage() const {return uidata;}
+  };
+
+  //! the summed energies are stored as members, this maps their properties to them
+  float *get_float_member(const PROPERTY prop_id);
+  const float *get_float_member(const PROPERTY prop_id) const;
+
+  PHG4CellDefs::keytype cellid;
+  float edep;
+  float eion;
+  float light_yield;
+  std::vector<std::pair<PHG4HitDefs::keytype, float> > hitedeps;
+  std::vector<std::pair<int, float> > showeredeps;
+  prop_vector_t props;
+
+  EdepMap hitedepmap; //! filled by get_g4hits()
+  ShowerEdepMap showeredepmap; //! filled by get_g4showers()
+  bool hitmapvalid; //! hitedepmap mirrors hitedeps
+  bool showermapvalid; //! showeredepmap mirrors showeredeps
+
+  ClassDef(PHG4Cellv2,1)
+};
+
+#endif
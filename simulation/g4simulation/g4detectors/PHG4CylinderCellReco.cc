@@ -21,11 +21,14 @@
 
 #include <TROOT.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
 #include <limits>       // std::numeric_limits
+#include <thread>
 
 using namespace std;
 
@@ -34,6 +37,7 @@ PHG4CylinderCellReco::PHG4CylinderCellReco(const string &name) :
   PHG4ParameterContainerInterface(name),
   _timer(PHTimeServer::get()->insert_new(name)),
   chkenergyconservation(0),
+  nthreads(1),
   sum_energy_before_cuts(0.),
   sum_energy_g4hit(0.)
 {
@@ -351,15 +355,11 @@ PHG4CylinderCellReco::process_event(PHCompositeNode *topNode)
       exit(1);
     }
 
-  map<int, std::pair <double, double> >::iterator sizeiter;
+  // everything the layers need is looked up here, the workers
+  // must not touch our maps (operator[] inserts)
+  layercells.clear();
   PHG4HitContainer::LayerIter layer;
   pair<PHG4HitContainer::LayerIter, PHG4HitContainer::LayerIter> layer_begin_end = g4hit->getLayers();
-  //   cout << "number of layers: " << g4hit->num_layers() << endl;
-  //   cout << "number of hits: " << g4hit->size() << endl;
-  //   for (layer = layer_begin_end.first; layer != layer_begin_end.second; layer++)
-  //     {
-  //       cout << "layer number: " << *layer << endl;
-  //     }
   for (layer = layer_begin_end.first; layer != layer_begin_end.second; layer++)
     {
       // only handle layers/detector ids which have parameters set
@@ -367,481 +367,259 @@ PHG4CylinderCellReco::process_event(PHCompositeNode *topNode)
 	{
 	  continue;
 	}
-      PHG4HitContainer::ConstIterator hiter;
-      PHG4HitContainer::ConstRange hit_begin_end = g4hit->getHits(*layer);
-      PHG4CylinderCellGeom *geo = seggeo->GetLayerCellGeom(*layer);
-      int nphibins = n_phi_z_bins[*layer].first;
-      int nzbins = n_phi_z_bins[*layer].second;
-
-      // ------- eta/phi binning ------------------------------------------------------------------------
-      if (binning[*layer] == PHG4CellDefs::etaphibinning)
+      LayerCells lc;
+      lc.layer = *layer;
+      lc.etaphi = (binning[*layer] == PHG4CellDefs::etaphibinning);
+      lc.nphibins = n_phi_z_bins[*layer].first;
+      lc.nzbins = n_phi_z_bins[*layer].second;
+      lc.tmin = tmin_max[*layer].first;
+      lc.tmax = tmin_max[*layer].second;
+      lc.geo = seggeo->GetLayerCellGeom(*layer);
+      lc.sum_energy_before_cuts = 0.;
+      lc.sum_energy_g4hit = 0.;
+      layercells.push_back(lc);
+    }
+
+  // finding the fired cells is the expensive part, the layers are independent.
+  // The verbose printout would be interleaved, no threads with verbosity
+  unsigned int nworkers = (verbosity > 0 || nthreads < 1) ? 1 : nthreads;
+  if (nworkers > layercells.size())
+    {
+      nworkers = layercells.size();
+    }
+  if (nworkers > 1)
+    {
+      atomic<unsigned int> next(0);
+      vector<thread> workers;
+      for (unsigned int i = 0; i < nworkers; i++)
 	{
-	  for (hiter = hit_begin_end.first; hiter != hit_begin_end.second; hiter++)
-	    {
-	      sum_energy_before_cuts += hiter->second->get_edep();
-	      // checking ADC timing integration window cut
-	      if (hiter->second->get_t(0) > tmin_max[*layer].second) continue;
-	      if (hiter->second->get_t(1) < tmin_max[*layer].first) continue;
-
-	      pair<double, double> etaphi[2];
-	      double phibin[2];
-	      double etabin[2];
-	      for (int i = 0; i < 2; i++)
-		{
-		  etaphi[i] = get_etaphi(hiter->second->get_x(i), hiter->second->get_y(i), hiter->second->get_z(i));
-		  etabin[i] = geo->get_etabin( etaphi[i].first );
-		  phibin[i] = geo->get_phibin( etaphi[i].second );
-		}
-	      // check bin range
-	      if (phibin[0] < 0 || phibin[0] >= nphibins || phibin[1] < 0 || phibin[1] >= nphibins)
-		{
-		  continue;
-		}
-	      if (etabin[0] < 0 || etabin[0] >= nzbins   || etabin[1] < 0 || etabin[1] >= nzbins)
-		{
-		  continue;
-		}
-
-	      if (etabin[0] < 0)
-		{
-		  if (verbosity > 0)
-		    {
-		      hiter->second->identify();
-		    }
-		  continue;
-		}
-	      sum_energy_g4hit += hiter->second->get_edep();
-	      int intphibin = phibin[0];
-	      int intetabin = etabin[0];
-	      int intphibinout = phibin[1];
-	      int intetabinout = etabin[1];
-
-	      // Determine all fired cells
-
-	      double ax = (etaphi[0]).second; // phi
-	      double ay = (etaphi[0]).first;  // eta
-	      double bx = (etaphi[1]).second;
-	      double by = (etaphi[1]).first;
-	      if (intphibin > intphibinout)
-		{
-		  int tmp = intphibin;
-		  intphibin = intphibinout;
-		  intphibinout = tmp;
-		}
-	      if (intetabin > intetabinout)
-		{
-		  int tmp = intetabin;
-		  intetabin = intetabinout;
-		  intetabinout = tmp;
-		}
-
-	      double trklen = sqrt((ax - bx) * (ax - bx) + (ay - by) * (ay - by));
-	      // if entry and exit hit are the same (seems to happen rarely), trklen = 0
-	      // which leads to a 0/0 and an NaN in edep later on
-	      // this code does for particles in the same cell a trklen/trklen (vdedx[ii]/trklen)
-	      // so setting this to any non zero number will do just fine
-	      // I just pick -1 here to flag those strange hits in case I want t oanalyze them
-	      // later on
-	      if (trklen == 0)
-		{
-		  trklen = -1.;
-		}
-	      vector<int> vphi;
-	      vector<int> veta;
-	      vector<double> vdedx;
-
-	      if (intphibin == intphibinout && intetabin == intetabinout)   // single cell fired
-		{
-		  if (verbosity > 0) cout << "SINGLE CELL FIRED: " << intphibin << " " << intetabin << endl;
-		  vphi.push_back(intphibin);
-		  veta.push_back(intetabin);
-		  vdedx.push_back(trklen);
-		}
-	      else
-		{
-                  double phistep_half = geo->get_phistep() / 2.;
-		  double etastep_half = geo->get_etastep() / 2.;
-		  for (int ibp = intphibin; ibp <= intphibinout; ibp++)
-		    {
-		      double cx = geo->get_phicenter(ibp) - phistep_half;
-		      double dx = geo->get_phicenter(ibp) + phistep_half;
-		      for (int ibz = intetabin; ibz <= intetabinout; ibz++)
-			{
-			  double cy = geo->get_etacenter(ibz) - etastep_half;
-			  double dy = geo->get_etacenter(ibz) + etastep_half;
-			  double rr = 0.;
-			  //cout << "##### line: " << ax << " " << ay << " " << bx << " " << by << endl;
-			  //cout << "####### cell: " << cx << " " << cy << " " << dx << " " << dy << endl;
-			  bool yesno = line_and_rectangle_intersect(ax, ay, bx, by, cx, cy, dx, dy, &rr);
-			  if (yesno)
-			    {
-			      if (verbosity > 0) cout << "CELL FIRED: " << ibp << " " << ibz << " " << rr << endl;
-			      vphi.push_back(ibp);
-			      veta.push_back(ibz);
-			      vdedx.push_back(rr);
-			    }
-			}
-		    }
-		}
-	      if (verbosity > 0) cout << "NUMBER OF FIRED CELLS = " << vphi.size() << endl;
-
-	      double tmpsum = 0.;
-	      for (unsigned int ii = 0; ii < vphi.size(); ii++)
-		{
-		  tmpsum += vdedx[ii];
-		  vdedx[ii] = vdedx[ii] / trklen;
-		  if (verbosity > 0) cout << "  CELL " << ii << "  dE/dX = " <<  vdedx[ii] << endl;
-		}
-	      if (verbosity > 0) cout << "    TOTAL TRACK LENGTH = " << tmpsum << " " << trklen << endl;
-
-	      for (unsigned int i1 = 0; i1 < vphi.size(); i1++)   // loop over all fired cells
-		{
-
-		  int iphibin = vphi[i1];
-		  int ietabin = veta[i1];
-
-		  // This is the key for cellptmap
-		  // It is constructed using the phi and z (or eta) bin index values
-		  // It will be unique for a given phi and z (or eta) bin combination
-		  unsigned long long tmp = iphibin;
-		  unsigned long long key = tmp << 32;
-		  key += ietabin;
-		  if(verbosity > 1)
-		    {
-		      cout << " iphibin " << iphibin << " ietabin " << ietabin << " key 0x" << hex << key << dec << endl;
-		    }
-		  PHG4Cell *cell = nullptr;
-		  it = cellptmap.find(key);
-		  if (it != cellptmap.end())
-		    {
-		      cell = it->second;
-		    }
-		  else
-		    {
-		      PHG4CellDefs::keytype cellkey = PHG4CellDefs::EtaPhiBinning::genkey(*layer, ietabin, iphibin);
-		      cell = new PHG4Cellv1(cellkey);
-		      cellptmap[key] = cell;
-		    }
-		  if (! isfinite(hiter->second->get_edep()*vdedx[i1]))
-		    {
-		      cout << "hit 0x" << hex <<  hiter->first << dec << " not finite, edep: "
-			   << hiter->second->get_edep() << " weight " << vdedx[i1] << endl;
-		    }
-		  cell->add_edep(hiter->first, hiter->second->get_edep()*vdedx[i1]); // add hit with edep to g4hit list
-                  cell->add_edep(hiter->second->get_edep()*vdedx[i1]); // add edep to cell
-		  if (hiter->second->has_property(PHG4Hit::prop_light_yield))
-		    {
-		      cell->add_light_yield(hiter->second->get_light_yield()*vdedx[i1]);
-		    }
-		  cell->add_shower_edep(hiter->second->get_shower_id(), hiter->second->get_edep()*vdedx[i1]);
-		  // just a sanity check - we don't want to mess up by having Nan's or Infs in our energy deposition
-		  if (! isfinite(hiter->second->get_edep()*vdedx[i1]))
-		    {
-		      cout << PHWHERE << " invalid energy dep " << hiter->second->get_edep()
-			   << " or path length: " << vdedx[i1] << endl;
-		    }
-		}
-	      vphi.clear();
-	      veta.clear();
+	  workers.push_back(thread([this, g4hit, &next]()
+				   {
+				     for (unsigned int j = next++; j < layercells.size(); j = next++)
+				       {
+					 FireCells(g4hit, layercells[j]);
+				       }
+				   }));
+	}
+      for (vector<thread>::iterator iter = workers.begin(); iter != workers.end(); ++iter)
+	{
+	  iter->join();
+	}
+    }
+  else
+    {
+      for (vector<LayerCells>::iterator iter = layercells.begin(); iter != layercells.end(); ++iter)
+	{
+	  FireCells(g4hit, *iter);
+	}
+    }
 
-	    } // end loop over g4hits
+  // cells are created and filled in layer and hit order, independent of the threads
+  for (vector<LayerCells>::iterator iter = layercells.begin(); iter != layercells.end(); ++iter)
+    {
+      sum_energy_before_cuts += iter->sum_energy_before_cuts;
+      sum_energy_g4hit += iter->sum_energy_g4hit;
+      FillCells(*iter, cells);
+    }
+  if (chkenergyconservation)
+    {
+      CheckEnergy(topNode);
+    }
+  _timer.get()->stop();
 
-	  int numcells = 0;
+  return Fun4AllReturnCodes::EVENT_OK;
+}
 
-	  for(it = cellptmap.begin(); it != cellptmap.end(); ++it)
+void
+PHG4CylinderCellReco::FireCells(const PHG4HitContainer *g4hit, LayerCells &lc) const
+{
+  PHG4CylinderCellGeom *geo = lc.geo;
+  PHG4HitContainer::ConstIterator hiter;
+  PHG4HitContainer::ConstRange hit_begin_end = g4hit->getHits(lc.layer);
+  // the longitudinal coordinate is eta for eta/phi binning and z for size binning
+  double phistep_half = geo->get_phistep() / 2.;
+  double zstep_half = (lc.etaphi ? geo->get_etastep() : geo->get_zstep()) / 2.;
+  vector<int> vphi;
+  vector<int> vz;
+  vector<double> vdedx;
+  for (hiter = hit_begin_end.first; hiter != hit_begin_end.second; hiter++)
+    {
+      lc.sum_energy_before_cuts += hiter->second->get_edep();
+      // checking ADC timing integration window cut
+      if (hiter->second->get_t(0) > lc.tmax) continue;
+      if (hiter->second->get_t(1) < lc.tmin) continue;
+
+      double phi[2];
+      double z[2];
+      int phibin[2];
+      int zbin[2];
+      if (verbosity > 0) cout << "--------- new hit in layer # " << lc.layer << endl;
+      for (int i = 0; i < 2; i++)
+	{
+	  if (lc.etaphi)
 	    {
-	      cells->AddCell(it->second);
-	      numcells++;
-	      if (verbosity > 1)
-		{
-		  cout << "Adding cell in bin phi: " << PHG4CellDefs::EtaPhiBinning::get_phibin(it->second->get_cellid())
-		       << " phi: " << geo->get_phicenter(PHG4CellDefs::EtaPhiBinning::get_phibin(it->second->get_cellid())) * 180. / M_PI
-		       << ", eta bin: " << PHG4CellDefs::EtaPhiBinning::get_etabin(it->second->get_cellid())
-		       << ", eta: " <<  geo->get_etacenter(PHG4CellDefs::EtaPhiBinning::get_etabin(it->second->get_cellid()))
-		       << ", energy dep: " << it->second->get_edep()
-		       << endl;
-		}
+	      pair<double, double> etaphi = get_etaphi(hiter->second->get_x(i), hiter->second->get_y(i), hiter->second->get_z(i));
+	      z[i] = etaphi.first;
+	      phi[i] = etaphi.second;
+	      zbin[i] = geo->get_etabin(z[i]);
 	    }
-
-	  if (verbosity > 0)
+	  else
 	    {
-	      cout << Name() << ": found " << numcells << " eta/phi cells with energy deposition" << endl;
+	      phi[i] = atan2(hiter->second->get_y(i), hiter->second->get_x(i));
+	      z[i] = hiter->second->get_z(i);
+	      zbin[i] = geo->get_zbin(z[i]);
 	    }
+	  phibin[i] = geo->get_phibin(phi[i]);
+	  if (verbosity > 0) cout << " " << i << "  phibin: " << phibin[i] << ", phi: " << phi[i] << ", zbin: " << zbin[i] << ", z (eta): " << z[i] << endl;
 	}
-
-
-
-      else // ------ size binning ---------------------------------------------------------------
+      // check bin range
+      if (phibin[0] < 0 || phibin[0] >= lc.nphibins || phibin[1] < 0 || phibin[1] >= lc.nphibins)
 	{
-	  sizeiter = cell_size.find(*layer);
-	  if (sizeiter == cell_size.end())
-	    {
-	      cout << "logical screwup!!! no sizes for layer " << *layer << endl;
-	      exit(1);
-	    }
-	  double zstepsize = (sizeiter->second).second;
-	  double phistepsize = phistep[*layer];
+	  continue;
+	}
+      if (zbin[0] < 0 || zbin[0] >= lc.nzbins   || zbin[1] < 0 || zbin[1] >= lc.nzbins)
+	{
+	  continue;
+	}
+      lc.sum_energy_g4hit += hiter->second->get_edep();
+
+      int intphibin = min(phibin[0], phibin[1]);
+      int intphibinout = max(phibin[0], phibin[1]);
+      int intzbin = min(zbin[0], zbin[1]);
+      int intzbinout = max(zbin[0], zbin[1]);
+
+      // Determine all fired cells
+
+      double ax = phi[0];
+      double ay = z[0];
+      double bx = phi[1];
+      double by = z[1];
+      double trklen = sqrt((ax - bx) * (ax - bx) + (ay - by) * (ay - by));
+      // if entry and exit hit are the same (seems to happen rarely), trklen = 0
+      // which leads to a 0/0 and an NaN in edep later on
+      // this code does for particles in the same cell a trklen/trklen (vdedx[ii]/trklen)
+      // so setting this to any non zero number will do just fine
+      // I just pick -1 here to flag those strange hits in case I want to analyze them
+      // later on
+      if (trklen == 0)
+	{
+	  trklen = -1.;
+	}
+      vphi.clear();
+      vz.clear();
+      vdedx.clear();
 
-	  for (hiter = hit_begin_end.first; hiter != hit_begin_end.second; hiter++)
+      if (intphibin == intphibinout && intzbin == intzbinout)   // single cell fired
+	{
+	  if (verbosity > 0) cout << "SINGLE CELL FIRED: " << intphibin << " " << intzbin << endl;
+	  vphi.push_back(intphibin);
+	  vz.push_back(intzbin);
+	  vdedx.push_back(trklen);
+	}
+      else
+	{
+	  for (int ibp = intphibin; ibp <= intphibinout; ibp++)
 	    {
-	      sum_energy_before_cuts += hiter->second->get_edep();
-	      // checking ADC timing integration window cut
-	      if (hiter->second->get_t(0) > tmin_max[*layer].second) continue;
-	      if (hiter->second->get_t(1) < tmin_max[*layer].first) continue;
-
-	      double xinout[2];
-	      double yinout[2];
-	      double px[2];
-	      double py[2];
-	      double phi[2];
-	      double z[2];
-	      double phibin[2];
-	      double zbin[2];
-	      if (verbosity > 0) cout << "--------- new hit in layer # " << *layer << endl;
-
-	      for (int i = 0; i < 2; i++)
-		{
-		  xinout[i] = hiter->second->get_x(i);
-		  yinout[i] = hiter->second->get_y(i);
-		  px[i] = hiter->second->get_px(i);
-		  py[i] = hiter->second->get_py(i);
-		  phi[i] = atan2(hiter->second->get_y(i), hiter->second->get_x(i));
-		  z[i] =  hiter->second->get_z(i);
-		  phibin[i] = geo->get_phibin( phi[i] );
-		  zbin[i] = geo->get_zbin( hiter->second->get_z(i) );
-
-		  if (verbosity > 0) cout << " " << i << "  phibin: " << phibin[i] << ", phi: " << phi[i] << ", stepsize: " << phistepsize << endl;
-		  if (verbosity > 0) cout << " " << i << "  zbin: " << zbin[i] << ", z = " << hiter->second->get_z(i) << ", stepsize: " << zstepsize << " offset: " <<  zmin_max[*layer].first << endl;
-		}
-	      // check bin range
-	      if (phibin[0] < 0 || phibin[0] >= nphibins || phibin[1] < 0 || phibin[1] >= nphibins)
-		{
-		  continue;
-		}
-	      if (zbin[0] < 0 || zbin[0] >= nzbins   || zbin[1] < 0 || zbin[1] >= nzbins)
-		{
-		  continue;
-		}
-
-
-	      if (zbin[0] < 0)
+	      double cx = geo->get_phicenter(ibp) - phistep_half;
+	      double dx = geo->get_phicenter(ibp) + phistep_half;
+	      for (int ibz = intzbin; ibz <= intzbinout; ibz++)
 		{
-		  hiter->second->identify();
-		  continue;
-		}
-	      sum_energy_g4hit += hiter->second->get_edep();
-
-	      int intphibin = phibin[0];
-	      int intzbin = zbin[0];
-	      int intphibinout = phibin[1];
-	      int intzbinout = zbin[1];
-
-	      if (verbosity > 0)
-		{
-		  cout << "    phi bin range: " << intphibin << " to " << intphibinout << " phi: " << phi[0] << " to " << phi[1] << endl;
-		  cout << "    Z bin range: " << intzbin << " to " << intzbinout << " Z: " << z[0] << " to " << z[1] << endl;
-		  cout << "    phi difference: " << (phi[1] - phi[0]) * 1000. << " milliradians." << endl;
-		  cout << "    phi difference: " << 2.5 * (phi[1] - phi[0]) * 10000. << " microns." << endl;
-		  cout << "    path length = " << sqrt((xinout[1] - xinout[0]) * (xinout[1] - xinout[0]) + (yinout[1] - yinout[0]) * (yinout[1] - yinout[0])) << endl;
-		  cout << "       px = " << px[0] << " " << px[1] << endl;
-		  cout << "       py = " << py[0] << " " << py[1] << endl;
-		  cout << "       x = " << xinout[0] << " " << xinout[1] << endl;
-		  cout << "       y = " << yinout[0] << " " << yinout[1] << endl;
-		}
-
-	      // Determine all fired cells
-
-	      double ax = phi[0];
-	      double ay = z[0];
-	      double bx = phi[1];
-	      double by = z[1];
-	      if (intphibin > intphibinout)
-		{
-		  int tmp = intphibin;
-		  intphibin = intphibinout;
-		  intphibinout = tmp;
-		}
-	      if (intzbin > intzbinout)
-		{
-		  int tmp = intzbin;
-		  intzbin = intzbinout;
-		  intzbinout = tmp;
-		}
-
-	      double trklen = sqrt((ax - bx) * (ax - bx) + (ay - by) * (ay - by));
-	      // if entry and exit hit are the same (seems to happen rarely), trklen = 0
-	      // which leads to a 0/0 and an NaN in edep later on
-	      // this code does for particles in the same cell a trklen/trklen (vdedx[ii]/trklen)
-	      // so setting this to any non zero number will do just fine
-	      // I just pick -1 here to flag those strange hits in case I want to analyze them
-	      // later on
-	      if (trklen == 0)
-		{
-		  trklen = -1.;
-		}
-	      vector<int> vphi;
-	      vector<int> vz;
-	      vector<double> vdedx;
-
-	      if (intphibin == intphibinout && intzbin == intzbinout)   // single cell fired
-		{
-		  if (verbosity > 0)
+		  double zcenter = lc.etaphi ? geo->get_etacenter(ibz) : geo->get_zcenter(ibz);
+		  double cy = zcenter - zstep_half;
+		  double dy = zcenter + zstep_half;
+		  double rr = 0.;
+		  bool yesno = line_and_rectangle_intersect(ax, ay, bx, by, cx, cy, dx, dy, &rr);
+		  if (yesno)
 		    {
-		      cout << "SINGLE CELL FIRED: " << intphibin << " " << intzbin << endl;
+		      if (verbosity > 0) cout << "CELL FIRED: " << ibp << " " << ibz << " " << rr << endl;
+		      vphi.push_back(ibp);
+		      vz.push_back(ibz);
+		      vdedx.push_back(rr);
 		    }
-		  vphi.push_back(intphibin);
-		  vz.push_back(intzbin);
-		  vdedx.push_back(trklen);
-		}
-	      else
-		{
-                  double phistep_half = geo->get_phistep() / 2.;
-		  double zstep_half = geo->get_zstep() / 2.;
-		  for (int ibp = intphibin; ibp <= intphibinout; ibp++)
-		    {
-		      double cx = geo->get_phicenter(ibp) - phistep_half;
-		      double dx = geo->get_phicenter(ibp) + phistep_half;
-		      for (int ibz = intzbin; ibz <= intzbinout; ibz++)
-			{
-			  double cy = geo->get_zcenter(ibz) - zstep_half;
-			  double dy = geo->get_zcenter(ibz) + zstep_half;
-			  double rr = 0.;
-			  //cout << "##### line: " << ax << " " << ay << " " << bx << " " << by << endl;
-			  //cout << "####### cell: " << cx << " " << cy << " " << dx << " " << dy << endl;
-			  bool yesno = line_and_rectangle_intersect(ax, ay, bx, by, cx, cy, dx, dy, &rr);
-			  if (yesno)
-			    {
-			      if (verbosity > 0) cout << "CELL FIRED: " << ibp << " " << ibz << " " << rr << endl;
-			      vphi.push_back(ibp);
-			      vz.push_back(ibz);
-			      vdedx.push_back(rr);
-			    }
-			}
-		    }
-		}
-	      if (verbosity > 0) cout << "NUMBER OF FIRED CELLS = " << vz.size() << endl;
-
-	      double tmpsum = 0.;
-	      for (unsigned int ii = 0; ii < vz.size(); ii++)
-		{
-		  tmpsum += vdedx[ii];
-		  vdedx[ii] = vdedx[ii] / trklen;
-		  if (verbosity > 0) cout << "  CELL " << ii << "  dE/dX = " <<  vdedx[ii] << endl;
-		}
-	      if (verbosity > 0) cout << "    TOTAL TRACK LENGTH = " << tmpsum << " " << trklen << endl;
-
-	      for (unsigned int i1 = 0; i1 < vphi.size(); i1++)   // loop over all fired cells
-		{
-		  int iphibin = vphi[i1];
-		  int izbin = vz[i1];
-
-		  unsigned long long tmp = iphibin;
-		  unsigned long long key = tmp << 32;
-		  key += izbin;
-		  if(verbosity > 1)
-		    {
-		      cout << " iphibin " << iphibin << " izbin " << izbin << " key 0x" << hex << key << dec << endl;
-		    }
-		  // check to see if there is already an entry for this cell
-		  PHG4Cell *cell = nullptr;
-		  it = cellptmap.find(key);
-
-		  if(it != cellptmap.end())
-		    {
-		      cell = it->second;
-		      if(verbosity > 1)
-			{
-			  cout << "  add energy to existing cell for key = " << cellptmap.find(key)->first << endl;
-			}
-
-		      if(verbosity > 1 && hiter->second->has_property(PHG4Hit::prop_light_yield) && std::isnan(hiter->second->get_light_yield()*vdedx[i1]))
-			{
-
-			  cout << "    NAN lighy yield with vdedx[i1] = " << vdedx[i1]
-			       << " and hiter->second->get_light_yield() = " << hiter->second->get_light_yield() << endl;
-
-			}
-		    }
-		  else
-		    {
-		      if(verbosity > 1)
-			{
-			  cout << "    did not find a previous entry for key = " << key << " create a new one" << endl;
-			}
-		      PHG4CellDefs::keytype cellkey = PHG4CellDefs::SizeBinning::genkey(*layer, izbin, iphibin);
-		      cell = new PHG4Cellv1(cellkey);
-		      cellptmap[key] = cell;
-		    }
-		  if (! isfinite(hiter->second->get_edep()*vdedx[i1]))
-		    {
-		      cout << "hit 0x" << hex <<  hiter->first << dec << " not finite, edep: "
-			   << hiter->second->get_edep() << " weight " << vdedx[i1] << endl;
-		    }
-		  cell->add_edep(hiter->first, hiter->second->get_edep()*vdedx[i1]);
-                  cell->add_edep(hiter->second->get_edep()*vdedx[i1]); // add edep to cell
-		  if (hiter->second->has_property(PHG4Hit::prop_light_yield))
-		    {
-		      cell->add_light_yield(hiter->second->get_light_yield()*vdedx[i1]);
-		      if(verbosity > 1 && !std::isfinite(hiter->second->get_light_yield()*vdedx[i1]))
-			{
-			  cout << "    NAN lighy yield with vdedx[i1] = " << vdedx[i1]
-			       << " and hiter->second->get_light_yield() = " << hiter->second->get_light_yield() << endl;
-			}
-		    }
-		  cell->add_shower_edep(hiter->second->get_shower_id(), hiter->second->get_edep()*vdedx[i1]);
-
-		}
-	      vphi.clear();
-	      vz.clear();
-
-	    } // end loop over hits
-
-	  int numcells = 0;
-
-	  for(it = cellptmap.begin(); it != cellptmap.end(); ++it)
-	    {
-	      cells->AddCell(it->second);
-	      numcells++;
-	      if (verbosity > 1)
-		{
-		  cout << "Adding cell for key " << it->first << " in bin phi: " << PHG4CellDefs::SizeBinning::get_phibin(it->second->get_cellid())
-		       << " phi: " << geo->get_phicenter(PHG4CellDefs::SizeBinning::get_phibin(it->second->get_cellid())) * 180. / M_PI
-		       << ", z bin: " << PHG4CellDefs::SizeBinning::get_zbin(it->second->get_cellid())
-		       << ", z: " <<  geo->get_zcenter(PHG4CellDefs::SizeBinning::get_zbin(it->second->get_cellid()))
-		       << ", energy dep: " << it->second->get_edep()
-		       << endl;
 		}
 	    }
+	}
+      if (verbosity > 0) cout << "NUMBER OF FIRED CELLS = " << vphi.size() << endl;
 
-	  if (verbosity > 0)
-	    {
-	      cout << "found " << numcells << " z/phi cells with energy deposition" << endl;
-	    }
+      for (unsigned int i1 = 0; i1 < vphi.size(); i1++)   // loop over all fired cells
+	{
+	  Deposit dep;
+	  dep.bin = vphi[i1] * lc.nzbins + vz[i1];
+	  dep.hitkey = hiter->first;
+	  dep.hit = hiter->second;
+	  dep.weight = vdedx[i1] / trklen;
+	  lc.deposits.push_back(dep);
 	}
+    } // end loop over g4hits
+  return;
+}
 
-      //==========================================================
-      // now reset the cell map before moving on to the next layer
-      if(verbosity > 1)
+void
+PHG4CylinderCellReco::FillCells(LayerCells &lc, PHG4CellContainer *cells)
+{
+  // grid entries are reset after use, no clearing of the whole layer
+  vector<int> &grid = cellindex[lc.layer];
+  if (grid.size() != (unsigned int) (lc.nphibins * lc.nzbins))
+    {
+      grid.assign(lc.nphibins * lc.nzbins, -1);
+    }
+  firedcells.clear();
+  firedbins.clear();
+  for (vector<Deposit>::const_iterator iter = lc.deposits.begin(); iter != lc.deposits.end(); ++iter)
+    {
+      int &index = grid[iter->bin];
+      if (index < 0)
 	{
-	  cout << "cellptmap for layer " << *layer << " has final length " << cellptmap.size();
+	  int iphibin = iter->bin / lc.nzbins;
+	  int izbin = iter->bin % lc.nzbins;
+	  PHG4CellDefs::keytype cellkey = lc.etaphi ?
+	    PHG4CellDefs::EtaPhiBinning::genkey(lc.layer, izbin, iphibin) :
+	    PHG4CellDefs::SizeBinning::genkey(lc.layer, izbin, iphibin);
+	  index = firedcells.size();
+	  firedcells.push_back(cells->NewCell(cellkey));
+	  firedbins.push_back(iter->bin);
 	}
-      while(cellptmap.begin() != cellptmap.end())
+      PHG4Cell *cell = firedcells[index];
+      const PHG4Hit *hit = iter->hit;
+      double edep = hit->get_edep() * iter->weight;
+      // just a sanity check - we don't want to mess up by having Nan's or Infs in our energy deposition
+      if (! isfinite(edep))
 	{
-	  // Assumes that memmory is freed by the cylinder cell container when it is destroyed
-	  cellptmap.erase(cellptmap.begin());
+	  cout << "hit 0x" << hex << iter->hitkey << dec << " not finite, edep: "
+	       << hit->get_edep() << " weight " << iter->weight << endl;
 	}
-      if(verbosity > 1)
+      cell->add_edep(iter->hitkey, edep); // add hit with edep to g4hit list
+      cell->add_edep(edep); // add edep to cell
+      if (hit->has_property(PHG4Hit::prop_light_yield))
 	{
-	  cout << " reset it to " << cellptmap.size() << endl;
+	  cell->add_light_yield(hit->get_light_yield() * iter->weight);
 	}
+      cell->add_shower_edep(hit->get_shower_id(), edep);
     }
-  if (chkenergyconservation)
+
+  // emit the cells in bin order (phi major), the order of the old key map
+  sort(firedbins.begin(), firedbins.end());
+  for (vector<int>::const_iterator iter = firedbins.begin(); iter != firedbins.end(); ++iter)
     {
-      CheckEnergy(topNode);
+      PHG4Cell *cell = firedcells[grid[*iter]];
+      grid[*iter] = -1;
+      cells->AddCell(cell);
+      if (verbosity > 1)
+	{
+	  cout << "Adding cell in bin phi: " << *iter / lc.nzbins
+	       << " phi: " << lc.geo->get_phicenter(*iter / lc.nzbins) * 180. / M_PI
+	       << (lc.etaphi ? ", eta bin: " : ", z bin: ") << *iter % lc.nzbins
+	       << ", energy dep: " << cell->get_edep()
+	       << endl;
+	}
     }
-  _timer.get()->stop();
-
-  return Fun4AllReturnCodes::EVENT_OK;
+  if (verbosity > 0)
+    {
+      cout << Name() << ": found " << firedbins.size() << (lc.etaphi ? " eta/phi" : " z/phi")
+	   << " cells with energy deposition in layer " << lc.layer << endl;
+    }
+  lc.deposits.clear();
+  return;
 }
 
 void
@@ -927,7 +705,7 @@ bool PHG4CylinderCellReco::lines_intersect(
 					   double dy,
 					   double* rx, // intersection point (output)
 					   double* ry
-					   )
+					   ) const
 {
 
   // Find if a line segment limited by points A and B
@@ -987,7 +765,7 @@ bool  PHG4CylinderCellReco::line_and_rectangle_intersect(
 							 double dx,
 							 double dy,
 							 double* rr // length of the line segment inside the rectangle (output)
-							 )
+							 ) const
 {
 
   // find if a line isegment limited by points (A,B)
@@ -7,12 +7,19 @@
 #include <fun4all/SubsysReco.h>
 #include <phool/PHTimeServer.h>
 
+#include <g4main/PHG4HitDefs.h>
+
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 
 class PHCompositeNode;
 class PHG4Cell;
+class PHG4CellContainer;
+class PHG4CylinderCellGeom;
+class PHG4Hit;
+class PHG4HitContainer;
 
 class PHG4CylinderCellReco : public SubsysReco, public PHG4ParameterContainerInterface
 {
@@ -42,13 +49,44 @@ class PHG4CylinderCellReco : public SubsysReco, public PHG4ParameterContainerInt
   double get_timing_window_max(const int i) {return tmin_max[i].second;}
   void   set_timing_window(const int detid, const double tmin, const double tmax);
 
+  //! number of threads finding the fired cells (one layer at a time per thread), 1: no threads
+  //! the cells are filled afterwards in layer order, the output does not depend on it
+  void set_nthreads(const int n) {nthreads = n;}
+
  protected:
+  //! share of a g4hit in one fired cell
+  struct Deposit
+  {
+    int bin; // phibin * nzbins + zbin (or etabin)
+    PHG4HitDefs::keytype hitkey;
+    const PHG4Hit *hit;
+    double weight;
+  };
+  //! everything a layer needs to find its fired cells, set up before the threads start
+  struct LayerCells
+  {
+    int layer;
+    bool etaphi;
+    int nphibins;
+    int nzbins;
+    double tmin;
+    double tmax;
+    PHG4CylinderCellGeom *geo;
+    std::vector<Deposit> deposits;
+    double sum_energy_before_cuts;
+    double sum_energy_g4hit;
+  };
+  //! first pass, only reads hits and geometry (runs in the worker threads)
+  void FireCells(const PHG4HitContainer *g4hit, LayerCells &lc) const;
+  //! second pass, accumulates the deposits on the dense bin grid and adds the cells to the container
+  void FillCells(LayerCells &lc, PHG4CellContainer *cells);
+
   void set_size(const int i, const double sizeA, const double sizeB);
   int CheckEnergy(PHCompositeNode *topNode);
   static std::pair<double, double> get_etaphi(const double x, const double y, const double z);
   static double get_eta(const double radius, const double z);
-  bool lines_intersect( double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy, double* rx, double* ry);
-  bool line_and_rectangle_intersect( double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy, double* rr);
+  bool lines_intersect( double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy, double* rx, double* ry) const;
+  bool line_and_rectangle_intersect( double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy, double* rr) const;
 
   std::map<int, int>  binning;
   std::map<int, std::pair <double,double> > cell_size; // cell size in phi/z
@@ -63,13 +101,16 @@ class PHG4CylinderCellReco : public SubsysReco, public PHG4ParameterContainerInt
   std::string geonodename;
   std::string seggeonodename;
   std::map<int, std::pair<int, int> > n_phi_z_bins;
-  std::map<unsigned long long, PHG4Cell*> cellptmap;  // This map holds the hit cells
-  std::map<unsigned long long, PHG4Cell*>::iterator it;
+  std::map<int, std::vector<int> > cellindex; // dense phi x z (eta) grid per layer, index of the cell in firedcells or -1
+  std::vector<PHG4Cell *> firedcells;
+  std::vector<int> firedbins;
+  std::vector<LayerCells> layercells;
   std::map<int, std::pair<double,double> > tmin_max;
 
   PHTimeServer::timer _timer;
   int nbins[2];
   int chkenergyconservation;
+  int nthreads;
 
   double sum_energy_before_cuts;
   double sum_energy_g4hit;
@@ -1,7 +1,6 @@
 #include "PHG4CylinderCellTPCReco.h"
 #include "PHG4CellContainer.h"
 #include "PHG4CellDefs.h"
-#include "PHG4Cellv1.h"
 #include "PHG4CylinderCellGeom.h"
 #include "PHG4CylinderCellGeomContainer.h"
 #include "PHG4CylinderGeom.h"
@@ -30,11 +29,15 @@
 
 #include <gsl/gsl_randist.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 using namespace std;
 
@@ -67,6 +70,8 @@ PHG4CylinderCellTPCReco::PHG4CylinderCellTPCReco(int n_pixel,
   , fShapingLead(32.0 * 3.0 / 1000.0)
   ,                                  // ns
   fShapingTail(48.0 * 3.0 / 1000.0)  // ns
+  , nthreads(1)
+  , cellcontainer(nullptr)
 {
   memset(nbins, 0, sizeof(nbins));
   unsigned int seed = PHRandomSeed();  // fixed seed is handled in this funtcion
@@ -78,6 +83,10 @@ PHG4CylinderCellTPCReco::PHG4CylinderCellTPCReco(int n_pixel,
 PHG4CylinderCellTPCReco::~PHG4CylinderCellTPCReco()
 {
   gsl_rng_free(RandomGenerator);
+  for (vector<gsl_rng *>::const_iterator iter = workerrng.begin(); iter != workerrng.end(); ++iter)
+  {
+    gsl_rng_free(*iter);
+  }
   delete distortion;
 }
 
@@ -280,351 +289,439 @@ int PHG4CylinderCellTPCReco::process_event(PHCompositeNode *topNode)
     exit(1);
   }
 
+  // the workers take their cells from the container through NewCell()
+  cellcontainer = cells;
+
+  // everything the layers need is looked up here, the workers must not
+  // touch our maps. The seeds are drawn in layer order so the random
+  // numbers of a layer do not depend on which thread handles it
+  layerwork.clear();
+  unsigned int maxbins = 0;
   map<int, std::pair<double, double> >::iterator sizeiter;
   PHG4HitContainer::LayerIter layer;
   pair<PHG4HitContainer::LayerIter, PHG4HitContainer::LayerIter> layer_begin_end = g4hit->getLayers();
   for (layer = layer_begin_end.first; layer != layer_begin_end.second; layer++)
   {
-    std::map<unsigned long long, PHG4Cell *> cellptmap;
-    PHG4HitContainer::ConstIterator hiter;
-    PHG4HitContainer::ConstRange hit_begin_end = g4hit->getHits(*layer);
-    PHG4CylinderCellGeom *geo = seggeo->GetLayerCellGeom(*layer);
-    if (verbosity > 1000)
-    {
-      std::cout << "Layer " << (*layer);
-      std::cout << " Radius " << geo->get_radius();
-      std::cout << " Thickness " << geo->get_thickness();
-      std::cout << " zmin " << geo->get_zmin();
-      std::cout << " nbinsz " << geo->get_zbins();
-      std::cout << " phimin " << geo->get_phimin();
-      std::cout << " nbinsphi " << geo->get_phibins();
-      std::cout << std::endl;
-    }
-
-    int nphibins = n_phi_z_bins[*layer].first;
-    int nzbins = n_phi_z_bins[*layer].second;
-
     sizeiter = cell_size.find(*layer);
     if (sizeiter == cell_size.end())
     {
       cout << "logical screwup!!! no sizes for layer " << *layer << endl;
       exit(1);
     }
-    double zstepsize = (sizeiter->second).second;
-    double phistepsize = phistep[*layer];
-    for (hiter = hit_begin_end.first; hiter != hit_begin_end.second; hiter++)
+    LayerWork lw;
+    lw.layer = *layer;
+    lw.geo = seggeo->GetLayerCellGeom(*layer);
+    lw.nphibins = n_phi_z_bins[*layer].first;
+    lw.nzbins = n_phi_z_bins[*layer].second;
+    lw.tmin = tmin_max[*layer].first;
+    lw.tmax = tmin_max[*layer].second;
+    lw.zstepsize = (sizeiter->second).second;
+    lw.phistepsize = phistep[*layer];
+    lw.seed = gsl_rng_get(RandomGenerator);
+    layerwork.push_back(lw);
+    if ((unsigned int) (lw.nphibins * lw.nzbins) > maxbins)
+    {
+      maxbins = lw.nphibins * lw.nzbins;
+    }
+  }
+
+  // the histograms and the printout are not thread safe, distortions may
+  // smear with their own random generator (not reproducible with threads)
+  unsigned int nworkers = (verbosity > 1 || (distortion && !distortion->is_thread_safe()) || nthreads < 1) ? 1 : nthreads;
+  if (nworkers > layerwork.size())
+  {
+    nworkers = layerwork.size();
+  }
+  while (workergrid.size() < nworkers)
+  {
+    workergrid.push_back(vector<int>());
+    workerrng.push_back(gsl_rng_alloc(gsl_rng_mt19937));
+  }
+  for (unsigned int i = 0; i < nworkers; i++)
+  {
+    // resize keeps the grid all -1
+    if (workergrid[i].size() < maxbins)
+    {
+      workergrid[i].resize(maxbins, -1);
+    }
+  }
+  if (nworkers > 1)
+  {
+    atomic<unsigned int> next(0);
+    vector<thread> workers;
+    for (unsigned int i = 0; i < nworkers; i++)
+    {
+      workers.push_back(thread([this, g4hit, i, &next]() {
+        for (unsigned int j = next++; j < layerwork.size(); j = next++)
+        {
+          DepositLayer(g4hit, layerwork[j], workergrid[i], workerrng[i]);
+        }
+      }));
+    }
+    for (vector<thread>::iterator iter = workers.begin(); iter != workers.end(); ++iter)
+    {
+      iter->join();
+    }
+  }
+  else
+  {
+    for (vector<LayerWork>::iterator iter = layerwork.begin(); iter != layerwork.end(); ++iter)
+    {
+      DepositLayer(g4hit, *iter, workergrid[0], workerrng[0]);
+    }
+  }
+
+  for (vector<LayerWork>::iterator iter = layerwork.begin(); iter != layerwork.end(); ++iter)
+  {
+    for (vector<pair<int, PHG4Cell *> >::const_iterator it = iter->cells.begin(); it != iter->cells.end(); ++it)
     {
-      // checking ADC timing integration window cut
-      if (hiter->second->get_t(0) > tmin_max[*layer].second) continue;
-      if (hiter->second->get_t(1) < tmin_max[*layer].first) continue;
-
-      // the matching z-bin window in the corresponding cells
-      int min_cell_zbin = 0;
-      int max_cell_zbin = nzbins-1;
-      if (hiter->second->get_avg_z()>0)
+      cells->AddCell(it->second);
+      int phibin = PHG4CellDefs::SizeBinning::get_phibin(it->second->get_cellid());
+      int zbin = PHG4CellDefs::SizeBinning::get_zbin(it->second->get_cellid());
+      if (verbosity > 1)
       {
-        //positive drifting volume
+        float zthis = iter->geo->get_zcenter(zbin);
+        fHMeanElectronsPerCell->Fill(float(iter->layer), zthis, it->second->get_edep());
+      }
+      if (verbosity > 2000)
+        std::cout << " Adding phibin " << phibin << " zbin " << zbin << " with edep " << it->second->get_edep() << std::endl;
+    }
+    if (verbosity > 1000)
+      std::cout << " || Number of cells hit " << iter->cells.size() << std::endl;
+  }
+  if (verbosity > 1000) std::cout << "PHG4CylinderCellTPCReco end" << std::endl;
+  _timer.get()->stop();
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+PHG4Cell *PHG4CylinderCellTPCReco::NewCell(const PHG4CellDefs::keytype key)
+{
+  lock_guard<mutex> lock(cellmutex);
+  return cellcontainer->NewCell(key);
+}
 
-        min_cell_zbin = nzbins/2;
+void PHG4CylinderCellTPCReco::DepositLayer(const PHG4HitContainer *g4hit, LayerWork &lw, vector<int> &grid, gsl_rng *rng)
+{
+  gsl_rng_set(rng, lw.seed);
+  lw.cells.clear();
+  PHG4HitContainer::ConstIterator hiter;
+  PHG4HitContainer::ConstRange hit_begin_end = g4hit->getHits(lw.layer);
+  PHG4CylinderCellGeom *geo = lw.geo;
+  if (verbosity > 1000)
+  {
+    std::cout << "Layer " << lw.layer;
+    std::cout << " Radius " << geo->get_radius();
+    std::cout << " Thickness " << geo->get_thickness();
+    std::cout << " zmin " << geo->get_zmin();
+    std::cout << " nbinsz " << geo->get_zbins();
+    std::cout << " phimin " << geo->get_phimin();
+    std::cout << " nbinsphi " << geo->get_phibins();
+    std::cout << std::endl;
+  }
+
+  int nphibins = lw.nphibins;
+  int nzbins = lw.nzbins;
+  double zstepsize = lw.zstepsize;
+  double phistepsize = lw.phistepsize;
+  // charge fractions of the phi bins and erf at the z bin edges of the current hit
+  vector<double> phi_integral;
+  vector<double> zedge_erf;
+  for (hiter = hit_begin_end.first; hiter != hit_begin_end.second; hiter++)
+  {
+    // checking ADC timing integration window cut
+    if (hiter->second->get_t(0) > lw.tmax) continue;
+    if (hiter->second->get_t(1) < lw.tmin) continue;
+
+    // the matching z-bin window in the corresponding cells
+    int min_cell_zbin = 0;
+    int max_cell_zbin = nzbins - 1;
+    if (hiter->second->get_avg_z() > 0)
+    {
+      //positive drifting volume
+
+      min_cell_zbin = nzbins / 2;
+    }
+    else
+    {
+      //negative drifting volume
+
+      max_cell_zbin = nzbins / 2 - 1;
+    }
+
+    double xinout;
+    double yinout;
+    double phi;
+    double z;
+    int phibin;
+    int zbin;
+    xinout = hiter->second->get_avg_x();
+    yinout = hiter->second->get_avg_y();
+    double r = sqrt(xinout * xinout + yinout * yinout);
+    phi = atan2(hiter->second->get_avg_y(), hiter->second->get_avg_x());
+    z = hiter->second->get_avg_z();
+    if (verbosity > 2000)
+      cout << "loop over hits, hit avge z = " << hiter->second->get_avg_z()
+           << " hit avge x = " << hiter->second->get_avg_x()
+           << " hit avge y = " << hiter->second->get_avg_y()
+           << " phi = " << phi
+           << endl;
+
+    // apply primary charge distortion
+    if (lw.layer >= num_pixel_layers)
+    {  // in TPC
+      if (distortion)
+      {
+        // do TPC distortion, all components come from one lookup
+        double dr;
+        double drphi;
+        double dz;
+        distortion->get_distortion(r, phi, z, dr, drphi, dz);
+        //TODO: radial distortion is not applied at the moment,
+        //      because it leads to major change to the structure of this code and it affect the insensitive direction to
+        //      near radial tracks
+        phi += drphi / r;
+        z += dz;
       }
+      //TODO: this is an approximation of average track propagation time correction on a cluster's hit time or z-position.
+      // Full simulation require implement this correction in PHG4TPCClusterizer::process_event
+      const double approximate_cluster_path_length = sqrt(
+          hiter->second->get_avg_x() * hiter->second->get_avg_x() + hiter->second->get_avg_y() * hiter->second->get_avg_y() + hiter->second->get_avg_z() * hiter->second->get_avg_z());
+      const double speed_of_light_cm_ns = CLHEP::c_light / (CLHEP::centimeter / CLHEP::nanosecond);
+      if (z >= 0.0)
+        z -= driftv * (hiter->second->get_avg_t() - approximate_cluster_path_length / speed_of_light_cm_ns);
       else
-      {
-        //negative drifting volume
+        z += driftv * (hiter->second->get_avg_t() - approximate_cluster_path_length / speed_of_light_cm_ns);
+    }
+    phibin = geo->get_phibin(phi);
+    if (phibin < 0 || phibin >= nphibins)
+    {
+      continue;
+    }
+    double phidisp = phi - geo->get_phicenter(phibin);
 
-        max_cell_zbin = nzbins/2 - 1;
-      }
+    zbin = geo->get_zbin(hiter->second->get_avg_z());
+    if (zbin < 0 || zbin >= nzbins)
+    {
+      continue;
+    }
 
-      double xinout;
-      double yinout;
-      double phi;
-      double z;
-      int phibin;
-      int zbin;
-      xinout = hiter->second->get_avg_x();
-      yinout = hiter->second->get_avg_y();
-      double r = sqrt(xinout * xinout + yinout * yinout);
-      phi = atan2(hiter->second->get_avg_y(), hiter->second->get_avg_x());
-      z = hiter->second->get_avg_z();
-      if (verbosity > 2000)
-        cout << "loop over hits, hit avge z = " << hiter->second->get_avg_z()
-             << " hit avge x = " << hiter->second->get_avg_x()
-             << " hit avge y = " << hiter->second->get_avg_y()
-             << " phi = " << phi
-             << endl;
-
-      // apply primary charge distortion
-      if ((*layer) >= (unsigned int) num_pixel_layers)
-      {  // in TPC
-        if (distortion)
-        {
-          // do TPC distortion
-          const double dz = distortion->get_z_distortion(r, phi, z);
-          const double drphi = distortion->get_rphi_distortion(r, phi, z);
-          //TODO: radial distortion is not applied at the moment,
-          //      because it leads to major change to the structure of this code and it affect the insensitive direction to
-          //      near radial tracks
-          //
-          //          const double dr = distortion ->get_r_distortion(r,phi,z);
-          phi += drphi / r;
-          z += dz;
-        }
-        //TODO: this is an approximation of average track propagation time correction on a cluster's hit time or z-position.
-        // Full simulation require implement this correction in PHG4TPCClusterizer::process_event
-        const double approximate_cluster_path_length = sqrt(
-            hiter->second->get_avg_x() * hiter->second->get_avg_x() + hiter->second->get_avg_y() * hiter->second->get_avg_y() + hiter->second->get_avg_z() * hiter->second->get_avg_z());
-        const double speed_of_light_cm_ns = CLHEP::c_light / (CLHEP::centimeter / CLHEP::nanosecond);
-        if (z >= 0.0)
-          z -= driftv * (hiter->second->get_avg_t() - approximate_cluster_path_length / speed_of_light_cm_ns);
-        else
-          z += driftv * (hiter->second->get_avg_t() - approximate_cluster_path_length / speed_of_light_cm_ns);
+    double edep = hiter->second->get_edep();
+    if (verbosity > 1)
+    {
+      fHMeanEDepPerCell->Fill(float(lw.layer), z, edep);
+    }
+    if (verbosity > 2000) cout << "Find or start a cell for this hit" << endl;
+
+    if (lw.layer < num_pixel_layers)
+    {  // MAPS + ITT
+      int &index = grid[zbin * nphibins + phibin];
+      if (index < 0)
+      {
+        index = lw.cells.size();
+        PHG4CellDefs::keytype akey = PHG4CellDefs::SizeBinning::genkey(lw.layer, zbin, phibin);
+        lw.cells.push_back(make_pair(zbin * nphibins + phibin, NewCell(akey)));
+      }
+      PHG4Cell *cell = lw.cells[index].second;
+      cell->add_edep(hiter->first, edep);
+      cell->add_edep(edep);
+      cell->add_shower_edep(hiter->second->get_shower_id(), edep);
+      if (hiter->second->has_property(PHG4Hit::prop_eion)) cell->add_eion(hiter->second->get_eion());
+    }
+    else
+    {  // TPC
+      // converting Edep to Total Number Of Electrons
+      float eion = hiter->second->get_eion();
+      if (!isfinite(eion))
+      {
+        eion = edep;
+      }
+      if (eion <= 0)  // no ionization energy - skip to next hit
+      {
+        continue;
+      }
+      double nelec = gsl_ran_poisson(rng, elec_per_gev * eion);
+      if (verbosity > 1)
+      {
+        fHElectrons->Fill(nelec);
       }
+
+      // The resolution due to pad readout is dominated by the charge spread during GEM multiplication, which we hard code because it is not a matter of opinion!
+      double sigmaT = 0.04;  // 400 microns, charge dispersion at pad due to GEM stage, from Tom (see 8/11 email)
+      // We use a double gaussian to represent the smearing due to the SAMPA chip shaping time - default values of fShapingLead and fShapingTail are 0.19 and 0.285 cm
+      double sigmaL[2];
+      // These are calculated (in cm) in the macro from the shaping RMS times and the gas drift velocity
+      sigmaL[0] = fShapingLead;
+      sigmaL[1] = fShapingTail;
+      double cloud_sig_rp = sqrt(fDiffusionT * fDiffusionT * (fHalfLength - fabs(hiter->second->get_avg_z())) + sigmaT * sigmaT);
+      double cloud_sig_zz[2];
+      cloud_sig_zz[0] = sqrt(fDiffusionL * fDiffusionL * (fHalfLength - fabs(hiter->second->get_avg_z())) + sigmaL[0] * sigmaL[0]);
+      cloud_sig_zz[1] = sqrt(fDiffusionL * fDiffusionL * (fHalfLength - fabs(hiter->second->get_avg_z())) + sigmaL[1] * sigmaL[1]);
+
+      //===============
+      // adding a random displacement, parameter is set in the macro
+      // This just randomly offsets the cluster position to simulate the cluster resolution expected from a back of the enevelope calculation
+      phi += fFractRPsm * gsl_ran_gaussian(rng, cloud_sig_rp) / r;
+      if (phi > +M_PI) phi -= 2 * M_PI;
+      if (phi < -M_PI) phi += 2 * M_PI;
+      z += fFractZZsm * gsl_ran_gaussian(rng, cloud_sig_zz[0]);
+
+      // moving center
       phibin = geo->get_phibin(phi);
+      zbin = geo->get_zbin(z);
+      // bin protection
       if (phibin < 0 || phibin >= nphibins)
       {
         continue;
       }
-      double phidisp = phi - geo->get_phicenter(phibin);
-
-      zbin = geo->get_zbin(hiter->second->get_avg_z());
       if (zbin < 0 || zbin >= nzbins)
       {
         continue;
       }
-      double zdisp = z - geo->get_zcenter(zbin);
+      // bincenter correction
+      phidisp = phi - geo->get_phicenter(phibin);
+      // increase cloud sigma too
+      cloud_sig_rp *= (1 + fFractRPsm);
+      cloud_sig_zz[0] *= (1 + fFractZZsm);
+      cloud_sig_zz[1] *= (1 + fFractZZsm);
 
-      double edep = hiter->second->get_edep();
-      if (verbosity > 1)
+      if (verbosity > 2000)
+        cout << "After adding random displacement: phi = " << phi << " z = " << z << " phibin = " << phibin << " zbin = " << zbin << endl
+             << " phidisp = " << phidisp << " new cloud_sig_rp " << cloud_sig_rp << " cloud_sig_zz[0] " << cloud_sig_zz[0]
+             << " cloud_sig_zz[1] " << cloud_sig_zz[1] << endl;
+
+      //=====
+
+      // We should account for the fact that angled tracks deposit charge in a range of Z values, increasing the cluster Z length
+      // The new software is proposed to deal with this by using a single volume with a step size of ~0.3 cm, so 4 steps per layer. Let's use 7.
+      // Start with the entry and exit Z values for the track in this layer. These have to come from the G4 hit.
+      // Make nseg  segment centers - keep nseg odd - process each segment through the shaper and ADC binning
+
+      // Note that we ignore the difference in drift-diffusion between segments here, for convenience - it will be tiny
+
+      double zrange = fabs(hiter->second->get_z(1) - hiter->second->get_z(0));
+      if (verbosity > 2000) cout << " *********** zrange " << zrange << " zout " << hiter->second->get_z(1) << " zin " << hiter->second->get_z(0) << endl;
+
+      // the search window and the charge fractions in phi are the same for all segments
+      int n_rp = int(3 * cloud_sig_rp / (r * phistepsize) + 1);
+      int n_zz = int(3 * (cloud_sig_zz[0] + cloud_sig_zz[1]) / (2.0 * zstepsize) + 1);
+      double cloud_sig_rp_inv = 1. / cloud_sig_rp;
+      double cloud_sig_zz_inv[2];
+      cloud_sig_zz_inv[0] = 1. / cloud_sig_zz[0];
+      cloud_sig_zz_inv[1] = 1. / cloud_sig_zz[1];
+      phi_integral.resize(2 * n_rp + 1);
+      for (int iphi = -n_rp; iphi != n_rp + 1; ++iphi)
       {
-        fHMeanEDepPerCell->Fill(float(*layer), z, edep);
+        // Get the integral of the charge probability distribution in phi inside the current phi step
+        double phiLim1 = 0.5 * M_SQRT2 * ((iphi + 0.5) * phistepsize * r - phidisp * r) * cloud_sig_rp_inv;
+        double phiLim2 = 0.5 * M_SQRT2 * ((iphi - 0.5) * phistepsize * r - phidisp * r) * cloud_sig_rp_inv;
+        phi_integral[iphi + n_rp] = 0.5 * (erf(phiLim1) - erf(phiLim2));
+        if (verbosity > 2000) cout << " phi bin offset " << iphi << " phiLim1 " << phiLim1 << " phiLim2 " << phiLim2 << " phi_integral " << phi_integral[iphi + n_rp] << endl;
       }
-      if (verbosity > 2000) cout << "Find or start a cell for this hit" << endl;
-
-      if ((*layer) < (unsigned int) num_pixel_layers)
-      {  // MAPS + ITT
-        unsigned long long longphibins = nphibins;
-        unsigned long long key = zbin * longphibins + phibin;
-        std::map<unsigned long long, PHG4Cell *>::iterator it = cellptmap.find(key);
-        PHG4Cell *cell;
-        if (it != cellptmap.end())
-        {
-          cell = it->second;
-        }
-        else
-        {
-          PHG4CellDefs::keytype akey = PHG4CellDefs::SizeBinning::genkey(*layer, zbin, phibin);
-          cell = new PHG4Cellv1(akey);
-          cellptmap[key] = cell;
-        }
-        cell->add_edep(hiter->first, edep);
-        cell->add_edep(edep);
-        cell->add_shower_edep(hiter->second->get_shower_id(), edep);
-        if (hiter->second->has_property(PHG4Hit::prop_eion)) cell->add_eion(hiter->second->get_eion());
-      }
-      else
-      {  // TPC
-        // converting Edep to Total Number Of Electrons
-        float eion = hiter->second->get_eion();
-        if (!isfinite(eion))
-        {
-          eion = edep;
-        }
-        if (eion <= 0)  // no ionization energy - skip to next hit
+      zedge_erf.resize(2 * n_zz + 2);
+
+      int nseg = 7;  // must be odd number
+      // loop over the segment centers and distribute charge to the cells from each one
+      for (int izr = 0; izr < nseg; izr++)
+      {
+        double zsegoffset = (izr - nseg / 2) * zrange / nseg;
+
+        // offsetting z from the average for the layer may change the zbin, fix that
+        int zbinseg = geo->get_zbin(z + zsegoffset);
+        if (zbinseg < 0 || zbinseg >= nzbins)
         {
           continue;
         }
-        double nelec = gsl_ran_poisson(RandomGenerator, elec_per_gev * eion);
+        double zdispseg = z + zsegoffset - geo->get_zcenter(zbinseg);
+
+        if (verbosity > 2000) cout << " ---------- segment izr = " << izr << " with zsegoffset " << zsegoffset << " zbinseg " << zbinseg << " zdispseg " << zdispseg << endl;
+
+        // Now:
+        //    spread the charge in Z using the sigma due to the SAMPA chip shaping time
+        //    spread the charge in r-phi using the sigma due to the drift-diffusion and GEM stack broadening
+
         if (verbosity > 1)
         {
-          fHElectrons->Fill(nelec);
+          fHErrorRPhi->Fill(float(lw.layer), z, cloud_sig_rp);
+          fHErrorZ->Fill(float(lw.layer), z, cloud_sig_zz[0]);
+          fHWindowP->Fill(float(lw.layer), z, n_rp);
+          fHWindowZ->Fill(float(lw.layer), z, n_zz);
         }
-
-        // The resolution due to pad readout is dominated by the charge spread during GEM multiplication, which we hard code because it is not a matter of opinion!
-        double sigmaT = 0.04;  // 400 microns, charge dispersion at pad due to GEM stage, from Tom (see 8/11 email)
-        // We use a double gaussian to represent the smearing due to the SAMPA chip shaping time - default values of fShapingLead and fShapingTail are 0.19 and 0.285 cm
-        double sigmaL[2];
-        // These are calculated (in cm) in the macro from the shaping RMS times and the gas drift velocity
-        sigmaL[0] = fShapingLead;
-        sigmaL[1] = fShapingTail;
-        double cloud_sig_rp = sqrt(fDiffusionT * fDiffusionT * (fHalfLength - fabs(hiter->second->get_avg_z())) + sigmaT * sigmaT);
-        double cloud_sig_zz[2];
-        cloud_sig_zz[0] = sqrt(fDiffusionL * fDiffusionL * (fHalfLength - fabs(hiter->second->get_avg_z())) + sigmaL[0] * sigmaL[0]);
-        cloud_sig_zz[1] = sqrt(fDiffusionL * fDiffusionL * (fHalfLength - fabs(hiter->second->get_avg_z())) + sigmaL[1] * sigmaL[1]);
-
-        //===============
-        // adding a random displacement, parameter is set in the macro
-        // This just randomly offsets the cluster position to simulate the cluster resolution expected from a back of the enevelope calculation
-        phi += fFractRPsm * gsl_ran_gaussian(RandomGenerator, cloud_sig_rp) / r;
-        if (phi > +M_PI) phi -= 2 * M_PI;
-        if (phi < -M_PI) phi += 2 * M_PI;
-        z += fFractZZsm * gsl_ran_gaussian(RandomGenerator, cloud_sig_zz[0]);
-
-        // moving center
-        phibin = geo->get_phibin(phi);
-        zbin = geo->get_zbin(z);
-        // bin protection
-        if (phibin < 0 || phibin >= nphibins)
+        if (verbosity > 1000)
         {
-          continue;
+          std::cout << " Summary: Z PHI " << z << " " << phi << " edep " << edep * 1e6 << " nelec " << nelec
+                    << " cloud_sig_rp " << cloud_sig_rp << endl
+                    << " TPC shaping RMS leading " << fShapingLead
+                    << " TPC shaping RMS tail " << fShapingTail << endl
+                    << " cloud_sig_zz[0] " << cloud_sig_zz[0] << " cloud_sig_zz[1] " << cloud_sig_zz[1] << std::endl;
+          std::cout << " bin search window: nrp " << n_rp << " nzz " << n_zz << std::endl;
         }
-        if (zbin < 0 || zbin >= nzbins)
+        // neighbouring z bins share their edge, one erf per edge
+        for (int iedge = -n_zz; iedge != n_zz + 2; ++iedge)
         {
-          continue;
+          // Get the integral of the charge probability distribution in Z inside the current Z step. We only need to get the relative signs correct here, I think
+          // this is correct for z further from the membrane - charge arrives early
+          double zLim = 0.5 * M_SQRT2 * ((iedge - 0.5) * zstepsize - zdispseg) * cloud_sig_zz_inv[0];
+          // The above is correct if we are in the leading part of the time distribution. In the tail of the distribution we use the second gaussian width
+          // this is correct for z  closer to the membrane - charge arrives late
+          if (zLim > 0)
+            zLim = 0.5 * M_SQRT2 * ((iedge - 0.5) * zstepsize - zdispseg) * cloud_sig_zz_inv[1];
+          zedge_erf[iedge + n_zz] = erf(zLim);
         }
-        // bincenter correction
-        phidisp = phi - geo->get_phicenter(phibin);
-        zdisp = z - geo->get_zcenter(zbin);
-        // increase cloud sigma too
-        cloud_sig_rp *= (1 + fFractRPsm);
-        cloud_sig_zz[0] *= (1 + fFractZZsm);
-        cloud_sig_zz[1] *= (1 + fFractZZsm);
-
-        if (verbosity > 2000)
-          cout << "After adding random displacement: phi = " << phi << " z = " << z << " phibin = " << phibin << " zbin = " << zbin << endl
-               << " phidisp = " << phidisp << " zdisp = " << zdisp << " new cloud_sig_rp " << cloud_sig_rp << " cloud_sig_zz[0] " << cloud_sig_zz[0]
-               << " cloud_sig_zz[1] " << cloud_sig_zz[1] << endl;
-
-        //=====
-
-        // We should account for the fact that angled tracks deposit charge in a range of Z values, increasing the cluster Z length
-        // The new software is proposed to deal with this by using a single volume with a step size of ~0.3 cm, so 4 steps per layer. Let's use 7.
-        // Start with the entry and exit Z values for the track in this layer. These have to come from the G4 hit.
-        // Make nseg  segment centers - keep nseg odd - process each segment through the shaper and ADC binning
-
-        // Note that we ignore the difference in drift-diffusion between segments here, for convenience - it will be tiny
-
-        double zrange = fabs(hiter->second->get_z(1) - hiter->second->get_z(0));
-        if (verbosity > 2000) cout << " *********** zrange " << zrange << " zout " << hiter->second->get_z(1) << " zin " << hiter->second->get_z(0) << endl;
-
-        int nseg = 7;  // must be odd number
-        // loop over the segment centers and distribute charge to the cells from each one
-        for (int izr = 0; izr < nseg; izr++)
+        for (int iphi = -n_rp; iphi != n_rp + 1; ++iphi)
         {
-          double zsegoffset = (izr - nseg / 2) * zrange / nseg;
-
-          // offsetting z from the average for the layer may change the zbin, fix that
-          int zbinseg = zbin = geo->get_zbin(z + zsegoffset);
-          if (zbinseg < 0 || zbinseg >= nzbins)
+          int cur_phi_bin = phibin + iphi;
+          // correcting for continuity in phi
+          if (cur_phi_bin < 0)
+            cur_phi_bin += nphibins;
+          else if (cur_phi_bin >= nphibins)
+            cur_phi_bin -= nphibins;
+          if ((cur_phi_bin < 0) || (cur_phi_bin >= nphibins))
           {
+            std::cout << "PHG4CylinderCellTPCReco => error in phi continuity. Skipping" << std::endl;
             continue;
           }
-          double zdispseg = z + zsegoffset - geo->get_zcenter(zbinseg);
-
-          if (verbosity > 2000) cout << " ---------- segment izr = " << izr << " with zsegoffset " << zsegoffset << " zbinseg " << zbinseg << " zdispseg " << zdispseg << endl;
+          for (int iz = -n_zz; iz != n_zz + 1; ++iz)
+          {
+            int cur_z_bin = zbinseg + iz;
+            if ((cur_z_bin < min_cell_zbin) || (cur_z_bin > max_cell_zbin)) continue;
+            // 1/2 * the erf is the integral probability from the argument Z value to zero, so this is the integral probability between the Z limits
+            double z_integral = 0.5 * (zedge_erf[iz + n_zz + 1] - zedge_erf[iz + n_zz]);
+            float neffelectrons = (2000 / nseg) * nelec * (phi_integral[iphi + n_rp] * z_integral);  // adding constant electron avalanche (value chosen so that digitizer will not trip)
 
-          // Now:
-          //    spread the charge in Z using the sigma due to the SAMPA chip shaping time
-          //    spread the charge in r-phi using the sigma due to the drift-diffusion and GEM stack broadening
+            if (verbosity > 2000)
+              cout << "    cur_z_bin " << cur_z_bin << "  center z " << geo->get_zcenter(cur_z_bin) << " center r-phi " << geo->get_radius() * geo->get_phicenter(cur_phi_bin) << endl
+                   << "            z_integral " << z_integral << " neffelectrons " << neffelectrons << endl;
 
-          int n_rp = int(3 * cloud_sig_rp / (r * phistepsize) + 1);
-          int n_zz = int(3 * (cloud_sig_zz[0] + cloud_sig_zz[1]) / (2.0 * zstepsize) + 1);
-          if (verbosity > 1)
-          {
-            fHErrorRPhi->Fill(float(*layer), z, cloud_sig_rp);
-            fHErrorZ->Fill(float(*layer), z, cloud_sig_zz[0]);
-            fHWindowP->Fill(float(*layer), z, n_rp);
-            fHWindowZ->Fill(float(*layer), z, n_zz);
-          }
-          double cloud_sig_rp_inv = 1. / cloud_sig_rp;
-          double cloud_sig_zz_inv[2];
-          cloud_sig_zz_inv[0] = 1. / cloud_sig_zz[0];
-          cloud_sig_zz_inv[1] = 1. / cloud_sig_zz[1];
-          if (verbosity > 1000)
-          {
-            std::cout << " Summary: Z PHI " << z << " " << phi << " edep " << edep * 1e6 << " nelec " << nelec
-                      << " cloud_sig_rp " << cloud_sig_rp << endl
-                      << " TPC shaping RMS leading " << fShapingLead
-                      << " TPC shaping RMS tail " << fShapingTail << endl
-                      << " cloud_sig_zz[0] " << cloud_sig_zz[0] << " cloud_sig_zz[1] " << cloud_sig_zz[1] << std::endl;
-            std::cout << " bin search window: nrp " << n_rp << " nzz " << n_zz << std::endl;
-          }
-          for (int iphi = -n_rp; iphi != n_rp + 1; ++iphi)
-          {
-            int cur_phi_bin = phibin + iphi;
-            // correcting for continuity in phi
-            if (cur_phi_bin < 0)
-              cur_phi_bin += nphibins;
-            else if (cur_phi_bin >= nphibins)
-              cur_phi_bin -= nphibins;
-            if ((cur_phi_bin < 0) || (cur_phi_bin >= nphibins))
+            if (verbosity > 5000)
             {
-              std::cout << "PHG4CylinderCellTPCReco => error in phi continuity. Skipping" << std::endl;
-              continue;
+              std::cout << Form("%.3f", neffelectrons) << " ";
+              if (iz == n_zz) std::cout << std::endl;
             }
-            // Get the integral of the charge probability distribution in phi inside the current phi step
-            double phiLim1 = 0.5 * M_SQRT2 * ((iphi + 0.5) * phistepsize * r - phidisp * r) * cloud_sig_rp_inv;
-            double phiLim2 = 0.5 * M_SQRT2 * ((iphi - 0.5) * phistepsize * r - phidisp * r) * cloud_sig_rp_inv;
-            double phi_integral = 0.5 * (erf(phiLim1) - erf(phiLim2));
-            if (verbosity > 2000) cout << " current phi bin " << cur_phi_bin << " phiLim1 " << phiLim1 << " phiLim2 " << phiLim2 << " phi_integral " << phi_integral << endl;
-            for (int iz = -n_zz; iz != n_zz + 1; ++iz)
+            if (neffelectrons < 0) continue;  // skip no signals
+            int key = cur_z_bin * nphibins + cur_phi_bin;
+            int &index = grid[key];
+            if (index < 0)
             {
-              int cur_z_bin = zbinseg + iz;
-              if ((cur_z_bin < min_cell_zbin) || (cur_z_bin > max_cell_zbin)) continue;
-              // Get the integral of the charge probability distribution in Z inside the current Z step. We only need to get the relative signs correct here, I think
-              // this is correct for z further from the membrane - charge arrives early
-              double zLim1 = 0.5 * M_SQRT2 * ((iz + 0.5) * zstepsize - zdispseg) * cloud_sig_zz_inv[0];
-              double zLim2 = 0.5 * M_SQRT2 * ((iz - 0.5) * zstepsize - zdispseg) * cloud_sig_zz_inv[0];
-              // The above is correct if we are in the leading part of the time distribution. In the tail of the distribution we use the second gaussian width
-              // this is correct for z  closer to the membrane - charge arrives late
-              if (zLim1 > 0)
-                zLim1 = 0.5 * M_SQRT2 * ((iz + 0.5) * zstepsize - zdispseg) * cloud_sig_zz_inv[1];
-              if (zLim2 > 0)
-                zLim2 = 0.5 * M_SQRT2 * ((iz - 0.5) * zstepsize - zdispseg) * cloud_sig_zz_inv[1];
-              // 1/2 * the erf is the integral probability from the argument Z value to zero, so this is the integral probability between the Z limits
-              double z_integral = 0.5 * (erf(zLim1) - erf(zLim2));
-              float neffelectrons = (2000 / nseg) * nelec * (phi_integral * z_integral);  // adding constant electron avalanche (value chosen so that digitizer will not trip)
-
-              if (verbosity > 2000)
-                cout << "    cur_z_bin " << cur_z_bin << "  center z " << geo->get_zcenter(cur_z_bin) << " center r-phi " << geo->get_radius() * geo->get_phicenter(cur_phi_bin) << endl
-                     << "            zLim1 " << zLim1 << " zLim2 " << zLim2 << " z_integral " << z_integral << " neffelectrons " << neffelectrons << endl;
-
-              if (verbosity > 5000)
-              {
-                std::cout << Form("%.3f", neffelectrons) << " ";
-                if (iz == n_zz) std::cout << std::endl;
-              }
-              if (neffelectrons < 0) continue;  // skip no signals
-              unsigned long key = cur_z_bin * nphibins + cur_phi_bin;
-              std::map<unsigned long long, PHG4Cell *>::iterator it = cellptmap.find(key);
-              PHG4Cell *cell;
-              if (it != cellptmap.end())
-              {
-                cell = it->second;
-              }
-              else
-              {
-                PHG4CellDefs::keytype akey = PHG4CellDefs::SizeBinning::genkey(*layer, cur_z_bin, cur_phi_bin);
-                cell = new PHG4Cellv1(akey);
-                cellptmap[key] = cell;
-              }
-              if (verbosity > 2000) cout << "    adding edep = neffelectrons = " << neffelectrons << " to cell with key = " << key << endl;
-              cell->add_edep(hiter->first, neffelectrons);
-              cell->add_edep(neffelectrons);
-              cell->add_shower_edep(hiter->second->get_shower_id(), neffelectrons);
-              if (hiter->second->has_property(PHG4Hit::prop_eion)) cell->add_eion(hiter->second->get_eion());
-            }  //iz
-          }    //iphi
-        }      // izr
-      }
-    }
-    int count = 0;
-    for (std::map<unsigned long long, PHG4Cell *>::iterator it = cellptmap.begin(); it != cellptmap.end(); ++it)
-    {
-      cells->AddCell(it->second);
-      int phibin = PHG4CellDefs::SizeBinning::get_phibin(it->second->get_cellid());
-      int zbin = PHG4CellDefs::SizeBinning::get_zbin(it->second->get_cellid());
-      if (verbosity > 1)
-      {
-        float zthis = geo->get_zcenter(zbin);
-        fHMeanElectronsPerCell->Fill(float(*layer), zthis, it->second->get_edep());
-      }
-      if (verbosity > 2000)
-        std::cout << " Adding phibin " << phibin << " zbin " << zbin << " with edep " << it->second->get_edep() << std::endl;
-      count += 1;
+              index = lw.cells.size();
+              PHG4CellDefs::keytype akey = PHG4CellDefs::SizeBinning::genkey(lw.layer, cur_z_bin, cur_phi_bin);
+              lw.cells.push_back(make_pair(key, NewCell(akey)));
+            }
+            PHG4Cell *cell = lw.cells[index].second;
+            if (verbosity > 2000) cout << "    adding edep = neffelectrons = " << neffelectrons << " to cell with key = " << key << endl;
+            cell->add_edep(hiter->first, neffelectrons);
+            cell->add_edep(neffelectrons);
+            cell->add_shower_edep(hiter->second->get_shower_id(), neffelectrons);
+            if (hiter->second->has_property(PHG4Hit::prop_eion)) cell->add_eion(hiter->second->get_eion());
+          }  //iz
+        }    //iphi
+      }      // izr
     }
-    if (verbosity > 1000)
-      std::cout << " || Number of cells hit " << count << std::endl;
   }
-  if (verbosity > 1000) std::cout << "PHG4CylinderCellTPCReco end" << std::endl;
-  _timer.get()->stop();
-  return Fun4AllReturnCodes::EVENT_OK;
+  // reset the grid and hand out the cells in bin order
+  for (vector<pair<int, PHG4Cell *> >::const_iterator iter = lw.cells.begin(); iter != lw.cells.end(); ++iter)
+  {
+    grid[iter->first] = -1;
+  }
+  sort(lw.cells.begin(), lw.cells.end());
+  return;
 }
@@ -1,19 +1,28 @@
 #ifndef PHG4CYLINDERCELLTPCRECO_H
 #define PHG4CYLINDERCELLTPCRECO_H
 
+#include "PHG4CellDefs.h"
+
 #include <fun4all/SubsysReco.h>
 #include <phool/PHTimeServer.h>
 
 // rootcint barfs with this header so we need to hide it
 #ifndef __CINT__
 #include <gsl/gsl_rng.h>
+#include <mutex>
 #endif
 
 
 #include <string>
 #include <map>
+#include <utility>
+#include <vector>
 
 class PHCompositeNode;
+class PHG4CellContainer;
+class PHG4Cell;
+class PHG4CylinderCellGeom;
+class PHG4HitContainer;
 class PHG4TPCDistortion;
 class TH1;
 class TProfile2D;
@@ -61,7 +70,32 @@ public:
   //! distortion to the primary ionization
   void setDistortion (PHG4TPCDistortion * d) {distortion = d;}
 
+  //! number of threads depositing the charge (one layer at a time per thread), 1: no threads
+  //! every layer gets its own random seed in layer order, the output does not depend on it
+  void set_nthreads(const int n) {nthreads = n;}
+
 protected:
+  //! one layer of the current event, the fired cells are kept with their bin (z * nphibins + phi)
+  struct LayerWork
+  {
+    int layer;
+    PHG4CylinderCellGeom *geo;
+    int nphibins;
+    int nzbins;
+    double tmin;
+    double tmax;
+    double zstepsize;
+    double phistepsize;
+    unsigned long seed;
+    std::vector<std::pair<int, PHG4Cell *> > cells;
+  };
+  //! cell from PHG4CellContainer::NewCell, serialized for the layer threads
+  PHG4Cell *NewCell(const PHG4CellDefs::keytype key);
+#ifndef __CINT__
+  //! converts the hits of a layer to cells, grid is the dense z x phi index into lw.cells (all -1 on entry and exit)
+  void DepositLayer(const PHG4HitContainer *g4hit, LayerWork &lw, std::vector<int> &grid, gsl_rng *rng);
+#endif
+
   std::map<int, int> binning;
   std::map<int, std::pair<double,double>> cell_size; // cell size in phi/z
   std::map<int, double> phistep;
@@ -101,9 +135,18 @@ protected:
   double fFractZZsm;
   double fShapingLead;
   double fShapingTail;
+
+  int nthreads;
+  PHG4CellContainer *cellcontainer; // of the current event
+  std::vector<LayerWork> layerwork;
+  std::vector<std::vector<int> > workergrid; // one dense cell grid per thread, sized for the largest layer
 #ifndef __CINT__
   //! random generator that conform with sPHENIX standard
   gsl_rng *RandomGenerator;
+  //! reseeded for every layer
+  std::vector<gsl_rng *> workerrng;
+  //! the free list of the cell container is not thread safe
+  std::mutex cellmutex;
 #endif
 
 };
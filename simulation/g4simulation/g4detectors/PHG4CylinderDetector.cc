@@ -92,3 +92,23 @@ void PHG4CylinderDetector::Construct(G4LogicalVolume *logicWorld)
                                      G4String(GetName().c_str()),
                                      logicWorld, 0, false, overlapcheck);
 }
+
+//_______________________________________________________________
+bool PHG4CylinderDetector::GetVolumeTags(vector<PHG4VolumeTag> &tags) const
+{
+  PHG4VolumeTag tag = {cylinder_physi, 0, {0, 0}};
+  tags.push_back(tag);
+  return true;
+}
+
+//_______________________________________________________________
+void PHG4CylinderDetector::ConstructFromSnapshot(const vector<PHG4VolumeTag> &tags)
+{
+  cylinder_physi = tags.at(0).volume;
+  // user limits are not kept in the gdml
+  double steplimits = params->get_double_param("steplimits") * cm;
+  if (isfinite(steplimits))
+  {
+    cylinder_physi->GetLogicalVolume()->SetUserLimits(new G4UserLimits(steplimits));
+  }
+}
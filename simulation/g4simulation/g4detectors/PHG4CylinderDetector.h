@@ -4,6 +4,7 @@
 #include <g4main/PHG4Detector.h>
 
 #include <string>
+#include <vector>
 
 class G4LogicalVolume;
 class G4VPhysicalVolume;
@@ -23,6 +24,10 @@ class PHG4CylinderDetector : public PHG4Detector
   //! construct
   void Construct(G4LogicalVolume *world);
 
+  bool GetVolumeTags(std::vector<PHG4VolumeTag> &tags) const;
+  void ConstructFromSnapshot(const std::vector<PHG4VolumeTag> &tags);
+  int GetGeometryVersion() const { return 1; }
+
   bool IsInCylinder(const G4VPhysicalVolume *) const;
   void SuperDetector(const std::string &name) { superdetector = name; }
   const std::string SuperDetector() const { return superdetector; }
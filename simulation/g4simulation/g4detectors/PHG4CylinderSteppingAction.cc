@@ -55,6 +55,17 @@ PHG4CylinderSteppingAction::~PHG4CylinderSteppingAction()
   delete hit;
 }
 
+//____________________________________________________________________________..
+int PHG4CylinderSteppingAction::IsInDetector(G4VPhysicalVolume* volume) const
+{
+  // same check as at the start of UserSteppingAction
+  if (detector_->IsInCylinder(volume))
+  {
+    return VOLUME_OWNED;
+  }
+  return VOLUME_OTHER;
+}
+
 //____________________________________________________________________________..
 bool PHG4CylinderSteppingAction::UserSteppingAction(const G4Step* aStep, bool)
 {
@@ -131,7 +142,8 @@ bool PHG4CylinderSteppingAction::UserSteppingAction(const G4Step* aStep, bool)
 
       if (!hit)
       {
-        hit = new PHG4Hitv1();
+        // take the hit from the container, it recycles hits if enabled
+        hit = hits_->NewHit();
       }
 
       hit->set_layer((unsigned int) layer_id);
@@ -24,6 +24,9 @@ class PHG4CylinderSteppingAction : public PHG4SteppingAction
   //! stepping action
   bool UserSteppingAction(const G4Step *, bool);
 
+  //! reimplemented from base class, steps in other volumes are not passed to this action
+  virtual int IsInDetector(G4VPhysicalVolume *) const;
+
   //! reimplemented from base class
   void SetInterfacePointers(PHCompositeNode *);
 
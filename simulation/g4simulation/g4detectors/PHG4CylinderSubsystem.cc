@@ -100,6 +100,17 @@ int PHG4CylinderSubsystem::InitRunSubsystem(PHCompositeNode *topNode)
   return 0;
 }
 
+//_______________________________________________________________________
+void PHG4CylinderSubsystem::MakeWorkerActions(PHG4EventAction *&, PHG4SteppingAction *&steppingaction, PHG4TrackingAction *&) const
+{
+  // same settings as in InitRunSubsystem, the hit container is found in the sub event node tree
+  if (steppingAction_)
+  {
+    steppingaction = new PHG4CylinderSteppingAction(detector_, GetParams());
+  }
+  return;
+}
+
 //_______________________________________________________________________
 int PHG4CylinderSubsystem::process_event(PHCompositeNode *topNode)
 {
@@ -41,6 +41,10 @@ class PHG4CylinderSubsystem : public PHG4DetectorSubsystem
   //! accessors (reimplemented)
   PHG4Detector* GetDetector(void) const;
   PHG4SteppingAction* GetSteppingAction(void) const { return steppingAction_; }
+
+  //! worker threads of PHG4Reco::G4Threads(), every thread gets its own stepping action
+  bool SupportsWorkerThreads() const { return true; }
+  void MakeWorkerActions(PHG4EventAction*& eventaction, PHG4SteppingAction*& steppingaction, PHG4TrackingAction*& trackingaction) const;
  private:
   void SetDefaultParameters();
 
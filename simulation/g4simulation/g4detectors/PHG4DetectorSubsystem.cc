@@ -285,6 +285,7 @@ PHG4DetectorSubsystem::InitializeParameters()
   set_default_int_param("absorbertruth", 0);
   set_default_int_param("active", 0);
   set_default_int_param("blackhole", 0);
+  set_default_double_param("rangecut", -1.); // cm, negative: global cut of PHG4Reco
 
   SetDefaultParameters(); // call method from specific subsystem
   // now load those parameters to our params class
@@ -420,3 +421,21 @@ PHG4DetectorSubsystem::SetAbsorberTruth(const int i)
   iparams["absorbertruth"] = i;
 }
 
+
+void
+PHG4DetectorSubsystem::SetRangeCut(const double cut)
+{
+  dparams["rangecut"] = cut;
+}
+
+double
+PHG4DetectorSubsystem::GetRangeCut() const
+{
+  return params->get_double_param("rangecut");
+}
+
+size_t
+PHG4DetectorSubsystem::GetGeometryHash() const
+{
+  return params->get_hash();
+}
@@ -33,6 +33,7 @@ class PHG4DetectorSubsystem : public PHG4Subsystem
   bool CheckOverlap() const {return overlapcheck;}
 
   PHG4Parameters *GetParams() const {return params;} 
+  size_t GetGeometryHash() const;
 
  // Get/Set parameters from macro
   void set_double_param(const std::string &name, const double dval);
@@ -59,6 +60,9 @@ class PHG4DetectorSubsystem : public PHG4Subsystem
   void SetAbsorberActive(const int i = 1);
   void SetAbsorberTruth(const int i = 1);
   void BlackHole(const int i=1);
+  //! production range cut (cm) in the region of this detector
+  void SetRangeCut(const double cut);
+  double GetRangeCut() const;
   void SuperDetector(const std::string &name);
   const std::string SuperDetector() const {return superdetector;}
 
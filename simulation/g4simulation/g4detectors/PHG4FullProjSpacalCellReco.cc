@@ -8,7 +8,6 @@
 
 #include "PHG4CellContainer.h"
 #include "PHG4CellDefs.h"
-#include "PHG4Cellv1.h"
 
 #include <g4main/PHG4Hit.h>
 #include <g4main/PHG4HitContainer.h>
@@ -424,7 +423,7 @@ PHG4FullProjSpacalCellReco::process_event(PHCompositeNode *topNode)
 	  unsigned short etabinshort  =  etabin * layergeom->get_n_subtower_eta() + sub_tower_ID_y;
 	  unsigned short phibin = tower_ID_phi * layergeom->get_n_subtower_phi() + sub_tower_ID_x;
 	  PHG4CellDefs::keytype cellkey = PHG4CellDefs::SpacalBinning::genkey(etabinshort,phibin,fiber_ID);
-	  cell = new PHG4Cellv1(cellkey);
+	  cell = cells->NewCell(cellkey);
 	  celllist[key] = cell;
 	}
 
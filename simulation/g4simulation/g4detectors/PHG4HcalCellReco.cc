@@ -1,5 +1,4 @@
 #include "PHG4HcalCellReco.h"
-#include "PHG4Cellv1.h"
 #include "PHG4CellContainer.h"
 #include "PHG4Parameters.h"
 
@@ -155,7 +154,7 @@ PHG4HcalCellReco::process_event(PHCompositeNode *topNode)
 	  // hcal has no layers so far, I do not want to make an expensive 
 	  // call to the g4hits to find that out use 0 as layer number
 	  PHG4CellDefs::keytype key = PHG4CellDefs::ScintillatorSlatBinning::genkey(0,icolumn,irow);
-	  slatarray[irow][icolumn] = new PHG4Cellv1(key);
+	  slatarray[irow][icolumn] = slats->NewCell(key);
 	}
       slatarray[irow][icolumn]->add_edep(hiter->second->get_edep());
       slatarray[irow][icolumn]->add_eion(hiter->second->get_eion());
@@ -11,6 +11,7 @@
 #include <TSystem.h>
 
 #include <Geant4/G4AssemblyVolume.hh>
+#include <Geant4/G4BooleanSolid.hh>
 #include <Geant4/G4Box.hh>
 #include <Geant4/G4Colour.hh>
 #include <Geant4/G4Cons.hh>
@@ -27,6 +28,21 @@
 #include <Geant4/G4UserLimits.hh>
 #include <Geant4/G4VisAttributes.hh>
 
+// boost headers
+#include <boost/tokenizer.hpp>
+// this is an ugly hack, the gcc optimizer has a bug which
+// triggers the uninitialized variable warning which
+// stops compilation because of our -Werror
+#include <boost/version.hpp>  // to get BOOST_VERSION
+#if (__GNUC__ == 4 && __GNUC_MINOR__ == 4 && BOOST_VERSION == 105700)
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma message "ignoring bogus gcc warning in boost header lexical_cast.hpp"
+#include <boost/lexical_cast.hpp>
+#pragma GCC diagnostic warning "-Wuninitialized"
+#else
+#include <boost/lexical_cast.hpp>
+#endif
+
 #include <CGAL/Boolean_set_operations_2.h>
 #include <CGAL/Circular_kernel_intersections.h>
 #include <CGAL/Exact_circular_kernel_2.h>
@@ -34,6 +50,7 @@
 #include <CGAL/point_generators_2.h>
 
 #include <cmath>
+#include <iostream>
 #include <sstream>
 
 typedef CGAL::Circle_2<PHG4InnerHcalDetector::Circular_k> Circle_2;
@@ -43,6 +60,12 @@ typedef CGAL::Segment_2<PHG4InnerHcalDetector::Circular_k> Segment_2;
 
 using namespace std;
 
+namespace
+{
+  // volume types in geometry snapshots
+  enum {STEEL_TAG = 0, SCINTI_TAG = 1};
+}
+
 // there is still a minute problem for very low tilt angles where the scintillator
 // face touches the boundary instead of the corner, subtracting 1 permille from the total
 // scintilator length takes care of this
@@ -89,10 +112,65 @@ PHG4InnerHcalDetector::~PHG4InnerHcalDetector()
 //_______________________________________________________________
 //_______________________________________________________________
 int PHG4InnerHcalDetector::IsInInnerHcal(G4VPhysicalVolume *volume) const
+{
+  int layer_id;
+  int tower_id;
+  return IsInInnerHcal(volume, layer_id, tower_id);
+}
+
+int PHG4InnerHcalDetector::IsInInnerHcal(G4VPhysicalVolume *volume, int &layer_id, int &tower_id) const
+{
+  const int id = volume_ids.find(volume, 0);
+  if (id > 0)
+  {
+    if (!active)
+    {
+      return 0;
+    }
+    layer_id = (id - 1) >> 16;
+    tower_id = (id - 1) & 0xFFFF;
+    return 1;
+  }
+  if (id < 0 && absorberactive)
+  {
+    return -1;
+  }
+  return 0;
+}
+
+bool PHG4InnerHcalDetector::IsPassiveAbsorber(G4VPhysicalVolume *volume) const
+{
+  if (absorberactive)
+  {
+    return false;
+  }
+  return volume_ids.find(volume, 0) < 0;
+}
+
+void PHG4InnerHcalDetector::FillVolumeTable()
+{
+  volume_ids.clear();
+  for (set<G4VPhysicalVolume *>::const_iterator iter = steel_absorber_vec.begin(); iter != steel_absorber_vec.end(); ++iter)
+  {
+    volume_ids.insert(*iter, -1);
+  }
+  for (map<G4VPhysicalVolume *, pair<int, int> >::const_iterator iter = scinti_slats.begin(); iter != scinti_slats.end(); ++iter)
+  {
+    if (iter->second.first < 0 || iter->second.first > 0x7FFF || iter->second.second < 0 || iter->second.second > 0xFFFF)
+    {
+      cout << PHWHERE << " " << iter->first->GetName() << " layer " << iter->second.first
+           << ", tower " << iter->second.second << " cannot be encoded" << endl;
+      gSystem->Exit(1);
+    }
+    volume_ids.insert(iter->first, 1 + (iter->second.first << 16) + iter->second.second);
+  }
+}
+
+pair<int, int>
+PHG4InnerHcalDetector::ExtractLayerTowerId(G4VPhysicalVolume *volume) const
 {
   // G4AssemblyVolumes naming convention:
   //     av_WWW_impr_XXX_YYY_ZZZ
-
   // where:
 
   //     WWW - assembly volume instance number
@@ -103,21 +181,57 @@ int PHG4InnerHcalDetector::IsInInnerHcal(G4VPhysicalVolume *volume) const
   // 82 the number of the scintillator mother volume
   // HcalInnerScinti_11: name of scintillator slat
   // 11: number of scintillator slat logical volume
-  if (absorberactive)
+  // use boost tokenizer to separate the _, then take value
+  // after "impr" for mother volume and after "pv" for scintillator slat
+  // use boost lexical cast for string -> int conversion
+  int layer_id = -1;
+  int tower_id = -1;
+  boost::char_separator<char> sep("_");
+  boost::tokenizer<boost::char_separator<char> > tok(volume->GetName(), sep);
+  boost::tokenizer<boost::char_separator<char> >::const_iterator tokeniter;
+  for (tokeniter = tok.begin(); tokeniter != tok.end(); ++tokeniter)
   {
-    if (steel_absorber_vec.find(volume) != steel_absorber_vec.end())
+    if (*tokeniter == "impr")
     {
-      return -1;
+      ++tokeniter;
+      if (tokeniter != tok.end())
+      {
+        layer_id = boost::lexical_cast<int>(*tokeniter);
+        // check detector description, for assemblyvolumes it is not possible
+        // to give the first volume id=0, so they go from id=1 to id=n.
+        // I am not going to start with fortran again - our indices start
+        // at zero, id=0 to id=n-1. So subtract one here
+        layer_id--;
+        if (layer_id < 0 || layer_id >= n_scinti_plates)
+        {
+          cout << "invalid scintillator row " << layer_id
+               << ", valid range 0 < row < " << n_scinti_plates << endl;
+          gSystem->Exit(1);
+        }
+      }
+      else
+      {
+        cout << PHWHERE << " Error parsing " << volume->GetName()
+             << " for mother volume number " << endl;
+        gSystem->Exit(1);
+      }
     }
-  }
-  if (active)
-  {
-    if (volume->GetName().find(scintilogicnameprefix) != string::npos)
+    else if (*tokeniter == "pv")
     {
-      return 1;
+      ++tokeniter;
+      if (tokeniter != tok.end())
+      {
+        tower_id = boost::lexical_cast<int>(*tokeniter);
+      }
+      else
+      {
+        cout << PHWHERE << " Error parsing " << volume->GetName()
+             << " for mother scinti slat id " << endl;
+        gSystem->Exit(1);
+      }
     }
   }
-  return 0;
+  return make_pair(layer_id, tower_id);
 }
 
 G4VSolid *
@@ -423,6 +537,77 @@ void PHG4InnerHcalDetector::Construct(G4LogicalVolume *logicWorld)
   return;
 }
 
+//_______________________________________________________________
+G4VSolid *PHG4InnerHcalDetector::UnCutSolid(G4VSolid *solid)
+{
+  while (G4BooleanSolid *boolean = dynamic_cast<G4BooleanSolid *>(solid))
+  {
+    solid = boolean->GetConstituentSolid(0);
+  }
+  return solid;
+}
+
+//_______________________________________________________________
+bool PHG4InnerHcalDetector::GetVolumeTags(vector<PHG4VolumeTag> &tags) const
+{
+  for (set<G4VPhysicalVolume *>::const_iterator iter = steel_absorber_vec.begin(); iter != steel_absorber_vec.end(); ++iter)
+  {
+    PHG4VolumeTag tag = {*iter, STEEL_TAG, {0, 0}};
+    tags.push_back(tag);
+  }
+  for (map<G4VPhysicalVolume *, pair<int, int> >::const_iterator iter = scinti_slats.begin(); iter != scinti_slats.end(); ++iter)
+  {
+    PHG4VolumeTag tag = {iter->first, SCINTI_TAG, {iter->second.first, iter->second.second}};
+    tags.push_back(tag);
+  }
+  return true;
+}
+
+//_______________________________________________________________
+void PHG4InnerHcalDetector::ConstructFromSnapshot(const vector<PHG4VolumeTag> &tags)
+{
+  steel_absorber_vec.clear();
+  scinti_slats.clear();
+  set<G4LogicalVolume *> scinti_logvols;
+  // the tilt angle is calculated during the construction
+  ConsistencyCheck();
+  SetTiltViaNcross();
+  CheckTiltAngle();
+  for (vector<PHG4VolumeTag>::const_iterator iter = tags.begin(); iter != tags.end(); ++iter)
+  {
+    if (iter->type == STEEL_TAG)
+    {
+      steel_absorber_vec.insert(iter->volume);
+    }
+    else
+    {
+      scinti_slats[iter->volume] = make_pair(iter->id[0], iter->id[1]);
+      scinti_logvols.insert(iter->volume->GetLogicalVolume());
+    }
+  }
+  FillVolumeTable();
+  // the volumes Print reports, Construct takes them from the uncut steel
+  // plate and scintillator box which are the first operands of the loaded solids
+  volume_envelope = M_PI * (envelope_outer_radius * envelope_outer_radius - envelope_inner_radius * envelope_inner_radius) * envelope_z;
+  if (!steel_absorber_vec.empty())
+  {
+    volume_steel = UnCutSolid((*steel_absorber_vec.begin())->GetLogicalVolume()->GetSolid())->GetCubicVolume() * n_scinti_plates;
+  }
+  if (!scinti_slats.empty())
+  {
+    volume_scintillator = UnCutSolid(scinti_slats.begin()->first->GetLogicalVolume()->GetSolid())->GetCubicVolume() * n_scinti_plates;
+  }
+  // the gdml does not keep user limits
+  double steplimits = params->get_double_param("steplimits") * cm;
+  for (set<G4LogicalVolume *>::const_iterator iter = scinti_logvols.begin(); iter != scinti_logvols.end(); ++iter)
+  {
+    if (isfinite(steplimits))
+    {
+      (*iter)->SetUserLimits(new G4UserLimits(steplimits));
+    }
+  }
+}
+
 int PHG4InnerHcalDetector::ConstructInnerHcal(G4LogicalVolume *hcalenvelope)
 {
   ConsistencyCheck();
@@ -495,6 +680,13 @@ int PHG4InnerHcalDetector::ConstructInnerHcal(G4LogicalVolume *hcalenvelope)
     steel_absorber_vec.insert(new G4PVPlacement(Rot, G4ThreeVector(0, 0, 0), steel_logical, name.str().c_str(), hcalenvelope, 0, i, overlapcheck));
     phi += deltaphi;
   }
+  // decode the layer and tower ids of the imprinted scintillators once
+  vector<G4VPhysicalVolume *>::iterator scintiter = scinti_mother_assembly->GetVolumesIterator();
+  for (unsigned int i = 0; i < scinti_mother_assembly->TotalImprintedVolumes(); i++, ++scintiter)
+  {
+    scinti_slats[*scintiter] = ExtractLayerTowerId(*scintiter);
+  }
+  FillVolumeTable();
   return 0;
 }
 
@@ -1,6 +1,8 @@
 #ifndef PHG4InnerHcalDetector_h
 #define PHG4InnerHcalDetector_h
 
+#include "PHG4VolumeTable.h"
+
 #include <g4main/PHG4Detector.h>
 
 // cannot fwd declare G4RotationMatrix, it is a typedef pointing to clhep
@@ -11,6 +13,7 @@
 
 #include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
 class G4AssemblyVolume;
@@ -34,11 +37,20 @@ class PHG4InnerHcalDetector : public PHG4Detector
   //! construct
   virtual void Construct(G4LogicalVolume *world);
 
+  virtual bool GetVolumeTags(std::vector<PHG4VolumeTag> &tags) const;
+  virtual void ConstructFromSnapshot(const std::vector<PHG4VolumeTag> &tags);
+  virtual int GetGeometryVersion() const { return 1; }
+
   virtual void Print(const std::string &what = "ALL") const;
 
   //!@name volume accessors
   //@{
   int IsInInnerHcal(G4VPhysicalVolume *) const;
+  //! same as above, for scintillators (return value > 0) it also gives the
+  //! layer (scintillator plate) and tower (slat) id from the same lookup
+  int IsInInnerHcal(G4VPhysicalVolume *volume, int &layer_id, int &tower_id) const;
+  //! steel plate which does not record hits (absorber not active)
+  bool IsPassiveAbsorber(G4VPhysicalVolume *volume) const;
   //@}
 
   void SuperDetector(const std::string &name) { superdetector = name; }
@@ -57,6 +69,10 @@ class PHG4InnerHcalDetector : public PHG4Detector
  protected:
   int ConstructInnerHcal(G4LogicalVolume *sandwich);
   int DisplayVolume(G4VSolid *volume, G4LogicalVolume *logvol, G4RotationMatrix *rotm = nullptr);
+  std::pair<int, int> ExtractLayerTowerId(G4VPhysicalVolume *volume) const;
+  void FillVolumeTable();
+  //! first operand of (nested) boolean solids
+  static G4VSolid *UnCutSolid(G4VSolid *solid);
   double x_at_y(Point_2 &p0, Point_2 &p1, double yin);
   PHG4Parameters *params;
   G4AssemblyVolume *scinti_mother_assembly;
@@ -89,6 +105,12 @@ class PHG4InnerHcalDetector : public PHG4Detector
   std::string detector_type;
   std::string superdetector;
   std::set<G4VPhysicalVolume *> steel_absorber_vec;
+  // layer and tower id of all scintillator volumes, decoded from the volume names
+  // once after they are placed instead of in every step
+  std::map<G4VPhysicalVolume *, std::pair<int, int> > scinti_slats;
+  // what the stepping action needs per step in one flat table: -1 for steel
+  // plates, 1 + (layer << 16) + tower for scintillators
+  PHG4VolumeTable volume_ids;
   std::vector<G4VSolid *> scinti_tiles_vec;
   std::string scintilogicnameprefix;
 };
@@ -22,6 +22,9 @@ class PHG4InnerHcalSteppingAction : public PHG4SteppingAction
   //! stepping action
   virtual bool UserSteppingAction(const G4Step *, bool);
 
+  //! reimplemented from base class, steps in other volumes are not passed to this action
+  virtual int IsInDetector(G4VPhysicalVolume *) const;
+
   //! reimplemented from base class
   virtual void SetInterfacePointers(PHCompositeNode *);
 
@@ -49,7 +52,6 @@ class PHG4InnerHcalSteppingAction : public PHG4SteppingAction
   int absorbertruth;
   int IsActive;
   int IsBlackHole;
-  int n_scinti_plates;
   int light_scint_model;
 
   double light_balance_inner_corr;
@@ -4,7 +4,6 @@
 #include "PHG4CylinderCell_MAPS.h"
 #include "PHG4CylinderCellContainer.h"
 
-#include "PHG4Cellv1.h"
 #include "PHG4CellContainer.h"
 #include "PHG4CellDefs.h"
 
@@ -536,7 +535,7 @@ PHG4MapsCellReco::process_event(PHCompositeNode *topNode)
 		  unsigned int index = celllist.size();
 		  index++;
 		  PHG4CellDefs::keytype key = PHG4CellDefs::MapsBinning::genkey(*layer,index);
-		  cell = new PHG4Cellv1(key);
+		  cell = cells->NewCell(key);
 		  celllist[inkey] = cell;
 		  cell->set_stave_index(stave_number);
 		  cell->set_half_stave_index(half_stave_number);
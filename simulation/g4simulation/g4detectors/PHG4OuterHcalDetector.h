@@ -2,6 +2,7 @@
 #define PHG4OuterHcalDetector_h
 
 #include "PHG4OuterHcalFieldSetup.h"
+#include "PHG4VolumeTable.h"
 
 #include <g4main/PHG4Detector.h>
 
@@ -13,6 +14,7 @@
 
 #include <map>
 #include <set>
+#include <utility>
 #include <vector>
 
 class G4AssemblyVolume;
@@ -35,11 +37,20 @@ class PHG4OuterHcalDetector : public PHG4Detector
   //! construct
   virtual void Construct(G4LogicalVolume *world);
 
+  virtual bool GetVolumeTags(std::vector<PHG4VolumeTag> &tags) const;
+  virtual void ConstructFromSnapshot(const std::vector<PHG4VolumeTag> &tags);
+  virtual int GetGeometryVersion() const { return 1; }
+
   virtual void Print(const std::string &what = "ALL") const;
 
   //!@name volume accessors
   //@{
   int IsInOuterHcal(G4VPhysicalVolume *) const;
+  //! same as above, for scintillators (return value > 0) it also gives the
+  //! layer (scintillator plate) and tower (slat) id from the same lookup
+  int IsInOuterHcal(G4VPhysicalVolume *volume, int &layer_id, int &tower_id) const;
+  //! steel plate which does not record hits (absorber not active)
+  bool IsPassiveAbsorber(G4VPhysicalVolume *volume) const;
   //@}
 
   void SuperDetector(const std::string &name) { superdetector = name; }
@@ -57,6 +68,10 @@ class PHG4OuterHcalDetector : public PHG4Detector
   G4VSolid *ConstructSteelPlate(G4LogicalVolume *hcalenvelope);
   G4AssemblyVolume *ConstructHcalScintillatorAssembly(G4LogicalVolume *hcalenvelope);
   int DisplayVolume(G4VSolid *volume, G4LogicalVolume *logvol, G4RotationMatrix *rotm = nullptr);
+  std::pair<int, int> ExtractLayerTowerId(G4VPhysicalVolume *volume) const;
+  void FillVolumeTable();
+  //! first operand of (nested) boolean solids
+  static G4VSolid *UnCutSolid(G4VSolid *solid);
   G4double x_at_y(Point_2 &p0, Point_2 &p1, G4double yin);
   PHG4OuterHcalFieldSetup *field_setup;
   PHG4Parameters *params;
@@ -93,6 +108,12 @@ class PHG4OuterHcalDetector : public PHG4Detector
   std::string scintilogicnameprefix;
   std::vector<G4VSolid *> scinti_tiles_vec;
   std::set<G4VPhysicalVolume *> steel_absorber_vec;
+  // layer and tower id of all scintillator volumes, decoded from the volume names
+  // once after they are placed instead of in every step
+  std::map<G4VPhysicalVolume *, std::pair<int, int> > scinti_slats;
+  // what the stepping action needs per step in one flat table: -1 for steel
+  // plates, 1 + (layer << 16) + tower for scintillators
+  PHG4VolumeTable volume_ids;
 };
 
 #endif
@@ -34,19 +34,6 @@
 
 // boost headers
 #include <boost/foreach.hpp>
-#include <boost/tokenizer.hpp>
-// this is an ugly hack, the gcc optimizer has a bug which
-// triggers the uninitialized variable warning which
-// stops compilation because of our -Werror
-#include <boost/version.hpp>  // to get BOOST_VERSION
-#if (__GNUC__ == 4 && __GNUC_MINOR__ == 4 && BOOST_VERSION == 105700)
-#pragma GCC diagnostic ignored "-Wuninitialized"
-#pragma message "ignoring bogus gcc warning in boost header lexical_cast.hpp"
-#include <boost/lexical_cast.hpp>
-#pragma GCC diagnostic warning "-Wuninitialized"
-#else
-#include <boost/lexical_cast.hpp>
-#endif
 
 // finally system headers
 #include <cassert>
@@ -71,7 +58,6 @@ PHG4OuterHcalSteppingAction::PHG4OuterHcalSteppingAction(PHG4OuterHcalDetector*
   , absorbertruth(params->get_int_param("absorbertruth"))
   , IsActive(params->get_int_param("active"))
   , IsBlackHole(params->get_int_param("blackhole"))
-  , n_scinti_plates(params->get_int_param(PHG4HcalDefs::scipertwr) * params->get_int_param("n_towers"))
   , light_scint_model(params->get_int_param("light_scint_model"))
   , light_balance_inner_corr(params->get_double_param("light_balance_inner_corr"))
   , light_balance_inner_radius(params->get_double_param("light_balance_inner_radius") * cm)
@@ -96,6 +82,21 @@ int PHG4OuterHcalSteppingAction::Init()
   return 0;
 }
 
+//____________________________________________________________________________..
+int PHG4OuterHcalSteppingAction::IsInDetector(G4VPhysicalVolume* volume) const
+{
+  // same check as at the start of UserSteppingAction
+  if (detector_->IsInOuterHcal(volume))
+  {
+    return VOLUME_OWNED;
+  }
+  if (detector_->IsPassiveAbsorber(volume))
+  {
+    return VOLUME_PASSIVE;
+  }
+  return VOLUME_OTHER;
+}
+
 //____________________________________________________________________________..
 bool PHG4OuterHcalSteppingAction::UserSteppingAction(const G4Step* aStep, bool)
 {
@@ -110,7 +111,10 @@ bool PHG4OuterHcalSteppingAction::UserSteppingAction(const G4Step* aStep, bool)
   //  1 is inside scintillator
   // -1 is steel absorber (if absorber set to active)
 
-  int whichactive = detector_->IsInOuterHcal(volume);
+  // the layer and tower ids of scintillators come from the same lookup
+  int layer_id = -1;
+  int tower_id = -1;
+  int whichactive = detector_->IsInOuterHcal(volume, layer_id, tower_id);
 
   if (!whichactive)
   {
@@ -122,72 +126,7 @@ bool PHG4OuterHcalSteppingAction::UserSteppingAction(const G4Step* aStep, bool)
     FieldChecker(aStep);
   }
 
-  int layer_id = -1;
-  int tower_id = -1;
-  if (whichactive > 0)  // scintillator
-  {
-    // G4AssemblyVolumes naming convention:
-    //     av_WWW_impr_XXX_YYY_ZZZ
-    // where:
-
-    //     WWW - assembly volume instance number
-    //     XXX - assembly volume imprint number
-    //     YYY - the name of the placed logical volume
-    //     ZZZ - the logical volume index inside the assembly volume
-    // e.g. av_1_impr_82_HcalOuterScinti_11_pv_11
-    // 82 the number of the scintillator mother volume
-    // HcalOuterScinti_11: name of scintillator slat
-    // 11: number of scintillator slat logical volume
-    // use boost tokenizer to separate the _, then take value
-    // after "impr" for mother volume and after "pv" for scintillator slat
-    // use boost lexical cast for string -> int conversion
-    boost::char_separator<char> sep("_");
-    boost::tokenizer<boost::char_separator<char> > tok(volume->GetName(), sep);
-    boost::tokenizer<boost::char_separator<char> >::const_iterator tokeniter;
-    for (tokeniter = tok.begin(); tokeniter != tok.end(); ++tokeniter)
-    {
-      if (*tokeniter == "impr")
-      {
-        ++tokeniter;
-        if (tokeniter != tok.end())
-        {
-          layer_id = boost::lexical_cast<int>(*tokeniter);
-          // check detector description, for assemblyvolumes it is not possible
-          // to give the first volume id=0, so they go from id=1 to id=n.
-          // I am not going to start with fortran again - our indices start
-          // at zero, id=0 to id=n-1. So subtract one here
-          layer_id--;
-          if (layer_id < 0 || layer_id >= n_scinti_plates)
-          {
-            cout << "invalid scintillator row " << layer_id
-                 << ", valid range 0 < row < " << n_scinti_plates << endl;
-            gSystem->Exit(1);
-          }
-        }
-        else
-        {
-          cout << PHWHERE << " Error parsing " << volume->GetName()
-               << " for mother volume number " << endl;
-          gSystem->Exit(1);
-        }
-      }
-      else if (*tokeniter == "pv")
-      {
-        ++tokeniter;
-        if (tokeniter != tok.end())
-        {
-          tower_id = boost::lexical_cast<int>(*tokeniter);
-        }
-        else
-        {
-          cout << PHWHERE << " Error parsing " << volume->GetName()
-               << " for mother scinti slat id " << endl;
-          gSystem->Exit(1);
-        }
-      }
-    }
-  }
-  else
+  if (whichactive < 0)
   {
     layer_id = touch->GetCopyNumber();  // steel plate id
   }
@@ -249,7 +188,9 @@ bool PHG4OuterHcalSteppingAction::UserSteppingAction(const G4Step* aStep, bool)
     case fUndefined:
       if (!hit)
       {
-        hit = new PHG4Hitv1();
+        // take the hit from the container it will be saved in (recycles hits if enabled)
+        PHG4HitContainer *hitpool = (whichactive > 0) ? hits_ : absorberhits_;
+        hit = (hitpool ? hitpool->NewHit() : new PHG4Hitv1());
       }
       //here we set the entrance values in cm
       hit->set_x(0, prePoint->GetPosition().x() / cm);
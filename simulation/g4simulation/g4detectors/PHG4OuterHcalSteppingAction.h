@@ -22,6 +22,9 @@ class PHG4OuterHcalSteppingAction : public PHG4SteppingAction
   //! stepping action
   virtual bool UserSteppingAction(const G4Step *, bool);
 
+  //! reimplemented from base class, steps in other volumes are not passed to this action
+  virtual int IsInDetector(G4VPhysicalVolume *) const;
+
   virtual int Init();
 
   //! reimplemented from base class
@@ -55,7 +58,6 @@ class PHG4OuterHcalSteppingAction : public PHG4SteppingAction
   int absorbertruth;
   int IsActive;
   int IsBlackHole;
-  int n_scinti_plates;
   int light_scint_model;
 
   double light_balance_inner_corr;
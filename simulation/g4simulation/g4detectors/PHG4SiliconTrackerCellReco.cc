@@ -1,6 +1,5 @@
 #include "PHG4SiliconTrackerCellReco.h"
 #include "PHG4CellContainer.h"
-#include "PHG4Cellv1.h"
 #include "PHG4CylinderCellGeom.h"
 #include "PHG4CylinderCellGeomContainer.h"
 #include "PHG4CylinderGeomContainer.h"
@@ -187,7 +186,7 @@ int PHG4SiliconTrackerCellReco::process_event(PHCompositeNode *topNode)
 	unsigned int index = celllist.size();
 	index++;
 	PHG4CellDefs::keytype cellkey = PHG4CellDefs::MapsBinning::genkey(sphxlayer, index);
-	cell = new PHG4Cellv1(cellkey);
+	cell = cells->NewCell(cellkey);
 	celllist[key] = cell;
 	// This encodes the z and phi position of the sensor
 	//          celllist[key]->set_sensor_index(boost::str(boost::format("%d_%d") %ladder_z_index %ladder_phi_index).c_str());
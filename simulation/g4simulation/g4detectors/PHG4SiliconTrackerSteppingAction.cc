@@ -91,6 +91,17 @@ PHG4SiliconTrackerSteppingAction::~PHG4SiliconTrackerSteppingAction()
   }
 }
 
+//____________________________________________________________________________..
+int PHG4SiliconTrackerSteppingAction::IsInDetector(G4VPhysicalVolume* volume) const
+{
+  // same check as at the start of UserSteppingAction
+  if (detector_->IsInSiliconTracker(volume))
+  {
+    return VOLUME_OWNED;
+  }
+  return VOLUME_OTHER;
+}
+
 //____________________________________________________________________________..
 bool PHG4SiliconTrackerSteppingAction::UserSteppingAction(const G4Step* aStep, bool)
 {
@@ -336,7 +347,9 @@ bool PHG4SiliconTrackerSteppingAction::UserSteppingAction(const G4Step* aStep, b
     // and we have to make a new one
     if (!hit)
     {
-      hit = new PHG4Hitv1();
+      // take the hit from the container it will be saved in (recycles hits if enabled)
+      PHG4HitContainer *hitpool = (whichactive > 0) ? hits_ : absorberhits_;
+      hit = (hitpool ? hitpool->NewHit() : new PHG4Hitv1());
     }
 
     hit->set_layer((unsigned int) sphxlayer);
@@ -18,6 +18,9 @@ class PHG4SiliconTrackerSteppingAction : public PHG4SteppingAction
 
   virtual bool UserSteppingAction(const G4Step *, bool);
 
+  //! reimplemented from base class, steps in other volumes are not passed to this action
+  virtual int IsInDetector(G4VPhysicalVolume *) const;
+
   virtual void SetInterfacePointers(PHCompositeNode *);
 
  private:
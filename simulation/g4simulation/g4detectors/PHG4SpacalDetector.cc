@@ -50,6 +50,7 @@ PHG4SpacalDetector::PHG4SpacalDetector(PHCompositeNode *Node,
   , cylinder_solid(NULL)
   , cylinder_logic(NULL)
   , cylinder_physi(NULL)
+  , volume_lookup_built(false)
   , active(0)
   , absorberactive(0)
   , layer(lyr)
@@ -86,24 +87,50 @@ PHG4SpacalDetector::~PHG4SpacalDetector(void)
 //_______________________________________________________________
 int PHG4SpacalDetector::IsInCylinderActive(const G4VPhysicalVolume *volume)
 {
-  //  cout << "checking detector" << endl;
-  if (active && fiber_core_vol.find(volume) != fiber_core_vol.end())
+  // the full projective spacal has O(100k) fibers, instead of up to four
+  // map searches the answer comes from one hash table probe
+  if (!volume_lookup_built)
   {
-    //      return fiber_core_vol.find(volume)->second;
-    return FIBER_CORE;
+    BuildVolumeLookup();
   }
+  return volume_lookup.find(volume, INACTIVE);
+}
+
+//_______________________________________________________________
+void PHG4SpacalDetector::BuildVolumeLookup()
+{
+  // the active and absorberactive flags are resolved here, fill in
+  // reverse order of precedence so fiber cores win
+  volume_lookup.clear();
   if (absorberactive)
   {
-    if (fiber_vol.find(volume) != fiber_vol.end())
-      return FIBER_CLADING;
-
-    if (block_vol.find(volume) != block_vol.end())
-      return ABSORBER;
-
-    if (calo_vol.find(volume) != calo_vol.end())
-      return SUPPORT;
+    for (map<const G4VPhysicalVolume *, int>::const_iterator iter = calo_vol.begin(); iter != calo_vol.end(); ++iter)
+    {
+      volume_lookup.insert(iter->first, SUPPORT);
+    }
+    for (map<const G4VPhysicalVolume *, int>::const_iterator iter = block_vol.begin(); iter != block_vol.end(); ++iter)
+    {
+      volume_lookup.insert(iter->first, ABSORBER);
+    }
+    for (map<const G4VPhysicalVolume *, int>::const_iterator iter = fiber_vol.begin(); iter != fiber_vol.end(); ++iter)
+    {
+      volume_lookup.insert(iter->first, FIBER_CLADING);
+    }
+  }
+  if (active)
+  {
+    for (map<const G4VPhysicalVolume *, int>::const_iterator iter = fiber_core_vol.begin(); iter != fiber_core_vol.end(); ++iter)
+    {
+      volume_lookup.insert(iter->first, FIBER_CORE);
+    }
+  }
+  volume_lookup_built = true;
+  if (verbosity > 0)
+  {
+    cout << "PHG4SpacalDetector::BuildVolumeLookup::" << GetName()
+         << " - " << volume_lookup.size() << " volumes in a table of "
+         << volume_lookup.capacity() << " slots" << endl;
   }
-  return INACTIVE;
 }
 
 //_______________________________________________________________
@@ -13,6 +13,7 @@
 
 #include "g4main/PHG4Detector.h"
 #include "PHG4CylinderGeom_Spacalv1.h"
+#include "PHG4VolumeTable.h"
 
 #include <Geant4/globals.hh>
 #include <Geant4/G4Region.hh>
@@ -73,6 +74,7 @@ public:
     detector_type = typ;
   }
 
+  //! FIBER_CORE, FIBER_CLADING, ABSORBER, SUPPORT or INACTIVE, one lookup in a flat table
   int
   IsInCylinderActive(const G4VPhysicalVolume*);
 
@@ -156,6 +158,14 @@ protected:
   //! map for G4VPhysicalVolume -> towers ID
   std::map<const G4VPhysicalVolume*, int> block_vol;
 
+  //! merge the volume maps above into volume_lookup, done on the first step after construction
+  void
+  BuildVolumeLookup();
+
+  //! G4VPhysicalVolume -> return value of IsInCylinderActive
+  PHG4VolumeTable volume_lookup;
+  bool volume_lookup_built;
+
   int active;
   int absorberactive;
   int layer;
@@ -48,6 +48,17 @@ PHG4SpacalSteppingAction::~PHG4SpacalSteppingAction()
   delete hit;
 }
 
+//____________________________________________________________________________..
+int PHG4SpacalSteppingAction::IsInDetector(G4VPhysicalVolume* volume) const
+{
+  // same check as at the start of UserSteppingAction
+  if (detector_->IsInCylinderActive(volume) > PHG4SpacalDetector::INACTIVE)
+  {
+    return VOLUME_OWNED;
+  }
+  return VOLUME_OTHER;
+}
+
 //____________________________________________________________________________..
 bool PHG4SpacalSteppingAction::UserSteppingAction(const G4Step* aStep, bool)
 {
@@ -149,7 +160,9 @@ bool PHG4SpacalSteppingAction::UserSteppingAction(const G4Step* aStep, bool)
       // and we have to make a new one
       if (!hit)
       {
-        hit = new PHG4Hitv1();
+        // take the hit from the container it will be saved in (recycles hits if enabled)
+        PHG4HitContainer *hitpool = (isactive == PHG4SpacalDetector::FIBER_CORE) ? hits_ : absorberhits_;
+        hit = (hitpool ? hitpool->NewHit() : new PHG4Hitv1());
       }
       hit->set_layer((unsigned int) layer_id);
       hit->set_scint_id(scint_id);  // isactive contains the scintillator slat id
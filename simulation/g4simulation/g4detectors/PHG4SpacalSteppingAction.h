@@ -31,6 +31,10 @@ class PHG4SpacalSteppingAction : public PHG4SteppingAction
   virtual bool
   UserSteppingAction(const G4Step *, bool);
 
+  //! reimplemented from base class, steps in other volumes are not passed to this action
+  virtual int
+  IsInDetector(G4VPhysicalVolume *) const;
+
   //! reimplemented from base class
   virtual void
   SetInterfacePointers(PHCompositeNode *);
@@ -25,3 +25,12 @@ PHG4TPCDistortion::~PHG4TPCDistortion()
   gsl_rng_free(RandomGenerator);
 }
 
+
+void
+PHG4TPCDistortion::get_distortion(double r, double phi, double z,
+    double &dr, double &drphi, double &dz)
+{
+  dr = get_r_distortion(r, phi, z);
+  drphi = get_rphi_distortion(r, phi, z);
+  dz = get_z_distortion(r, phi, z);
+}
@@ -42,6 +42,18 @@ public:
   virtual double
   get_z_distortion(double r, double phi, double z) = 0;
 
+  //! all three distortions for a given truth location, implementations with a
+  //! common lookup for the three components should override this
+  virtual void
+  get_distortion(double r, double phi, double z, double &dr, double &drphi, double &dz);
+
+  //! true if the distortions can be evaluated from several threads (no random numbers or other state)
+  virtual bool
+  is_thread_safe() const
+  {
+    return false;
+  }
+
   //! Sets the verbosity of this module (0 by default=quiet).
   virtual void
   Verbosity(const int ival)
@@ -0,0 +1,302 @@
+// $Id: $
+
+/*!
+ * \file PHG4TPCDistortionMap.cc
+ * \brief 3D (r, phi, z) distortion maps with trilinear interpolation
+ * \version $Revision:   $
+ * \date $Date: $
+ */
+
+#include "PHG4TPCDistortionMap.h"
+
+#include <TAxis.h>
+#include <TFile.h>
+#include <TH3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+namespace
+{
+  const char *mapnames[3] = {"mapDeltaR", "mapRDeltaPHI", "mapDeltaZ"};
+}
+
+PHG4TPCDistortionMap::PHG4TPCDistortionMap(
+    const std::string & distortion_map_file, int verbose) :
+    PHG4TPCDistortion(verbose), mirror_z(false), mapweight(0), scale(1)
+{
+  imap[0] = 0;
+  imap[1] = 0;
+  maps.push_back(vector<float>());
+  ReadMap(distortion_map_file, maps.back());
+  maptimes.push_back(0);
+}
+
+void
+PHG4TPCDistortionMap::AddMap(const std::string & distortion_map_file,
+    const double t)
+{
+  if (t <= maptimes.back())
+    {
+      cout << "PHG4TPCDistortionMap::AddMap - Fatal Error - "
+          << "map times have to increase, " << distortion_map_file << " at t = "
+          << t << " after a map at t = " << maptimes.back() << endl;
+      exit(13);
+    }
+  maps.push_back(vector<float>());
+  ReadMap(distortion_map_file, maps.back());
+  maptimes.push_back(t);
+}
+
+void
+PHG4TPCDistortionMap::set_time(const double t)
+{
+  imap[0] = 0;
+  for (unsigned int i = 1; i < maptimes.size(); i++)
+    {
+      if (maptimes[i] <= t)
+        imap[0] = i;
+    }
+  imap[1] = imap[0];
+  mapweight = 0;
+  if (imap[0] + 1 < maptimes.size() && t > maptimes[imap[0]])
+    {
+      imap[1] = imap[0] + 1;
+      mapweight = (t - maptimes[imap[0]])
+          / (maptimes[imap[1]] - maptimes[imap[0]]);
+    }
+  if (verbosity > 1)
+    {
+      cout << "PHG4TPCDistortionMap::set_time - t = " << t << " map "
+          << imap[0] << " (" << 1 - mapweight << ") map " << imap[1] << " ("
+          << mapweight << ")" << endl;
+    }
+}
+
+void
+PHG4TPCDistortionMap::ReadMap(const std::string & distortion_map_file,
+    vector<float> &grid)
+{
+  TFile file(distortion_map_file.c_str());
+
+  if (not file.IsOpen())
+    {
+      cout << "PHG4TPCDistortionMap::ReadMap - Fatal Error - "
+          << "Failed to open distortion file " << distortion_map_file << endl;
+
+      exit(13);
+    }
+
+  TH3 *h[3];
+  for (int k = 0; k < 3; k++)
+    {
+      h[k] = dynamic_cast<TH3 *>(file.Get(mapnames[k]));
+      if (not h[k] && k < 2)
+        {
+          cout << "PHG4TPCDistortionMap::ReadMap - Fatal Error - "
+              << "Failed to find TH3 " << mapnames[k] << " in distortion file "
+              << distortion_map_file << endl;
+
+          exit(13);
+        }
+    }
+
+  // the first map defines the grid, all others have to use it
+  if (maps.size() == 1)
+    {
+      SetAxis(axis[0], h[0], 0, 3);
+      SetAxis(axis[1], h[0], 1, 3 * axis[0].n);
+      SetAxis(axis[2], h[0], 2, 3 * axis[0].n * axis[1].n);
+      mirror_z = (h[0]->GetZaxis()->GetXmax() <= 0);
+    }
+  for (int k = 0; k < 3; k++)
+    {
+      if (not h[k])
+        continue;
+      for (int i = 0; i < 3; i++)
+        {
+          const TAxis *a = (i == 0) ? h[k]->GetXaxis() :
+              ((i == 1) ? h[k]->GetYaxis() : h[k]->GetZaxis());
+          if (a->IsVariableBinSize() || a->GetNbins() != axis[i].n
+              || fabs(a->GetBinCenter(1) - axis[i].min) > 1e-6 * axis[i].step
+              || fabs(a->GetBinWidth(1) - axis[i].step) > 1e-6 * axis[i].step)
+            {
+              cout << "PHG4TPCDistortionMap::ReadMap - Fatal Error - "
+                  << mapnames[k] << " in distortion file " << distortion_map_file
+                  << " does not have the fixed binning of " << mapnames[0]
+                  << " in the first map" << endl;
+
+              exit(13);
+            }
+        }
+    }
+
+  grid.assign(3 * axis[0].n * axis[1].n * axis[2].n, 0);
+  for (int iz = 0; iz < axis[2].n; iz++)
+    {
+      for (int iphi = 0; iphi < axis[1].n; iphi++)
+        {
+          for (int ir = 0; ir < axis[0].n; ir++)
+            {
+              int index = ir * axis[0].stride + iphi * axis[1].stride
+                  + iz * axis[2].stride;
+              for (int k = 0; k < 3; k++)
+                {
+                  if (h[k])
+                    grid[index + k] = h[k]->GetBinContent(ir + 1, iphi + 1,
+                        iz + 1);
+                }
+            }
+        }
+    }
+
+  if (verbosity > 1)
+    {
+      cout << "PHG4TPCDistortionMap::ReadMap - " << distortion_map_file
+          << ": r " << axis[0].n << " bins from " << axis[0].min
+          << ", phi " << axis[1].n << " bins from " << axis[1].min
+          << (axis[1].periodic ? " (periodic)" : "")
+          << ", z " << axis[2].n << " bins from " << axis[2].min
+          << (mirror_z ? " (mirrored)" : "")
+          << (h[2] ? "" : ", no z distortion") << endl;
+    }
+}
+
+void
+PHG4TPCDistortionMap::SetAxis(Axis &ax, const TH3 *h, const int iaxis,
+    const int stride)
+{
+  const TAxis *a = (iaxis == 0) ? h->GetXaxis() :
+      ((iaxis == 1) ? h->GetYaxis() : h->GetZaxis());
+  ax.n = a->GetNbins();
+  ax.min = a->GetBinCenter(1);
+  ax.step = a->GetBinWidth(1);
+  ax.invstep = 1. / ax.step;
+  ax.stride = stride;
+  ax.periodic = (iaxis == 1 && ax.n > 1
+      && fabs(a->GetXmax() - a->GetXmin() - 2 * M_PI) < 1e-3);
+}
+
+void
+PHG4TPCDistortionMap::Locate(const Axis &ax, const double x, int &offset,
+    int &next, double &w)
+{
+  double u = (x - ax.min) * ax.invstep;
+  int i;
+  if (ax.periodic)
+    {
+      // between the last and the first bin center we go around
+      u -= ax.n * floor(u / ax.n);
+      i = min(int(u), ax.n - 1);
+      next = ((i + 1 == ax.n) ? -i : 1) * ax.stride;
+    }
+  else
+    {
+      // clamped to the outer bin centers, a single bin is constant
+      u = min(max(u, 0.), ax.n - 1.);
+      i = min(int(u), max(ax.n - 2, 0));
+      next = (ax.n > 1) ? ax.stride : 0;
+    }
+  w = u - i;
+  offset = i * ax.stride;
+}
+
+void
+PHG4TPCDistortionMap::Interpolate(const vector<float> &grid, double r,
+    double phi, double z, double *d) const
+{
+  int offset[3];
+  int next[3];
+  double w[3];
+  Locate(axis[0], r, offset[0], next[0], w[0]);
+  Locate(axis[1], phi, offset[1], next[1], w[1]);
+  Locate(axis[2], z, offset[2], next[2], w[2]);
+  const float *c = &grid[offset[0] + offset[1] + offset[2]];
+  for (int k = 0; k < 3; k++)
+    {
+      double c00 = c[k] * (1 - w[0]) + c[next[0] + k] * w[0];
+      double c10 = c[next[1] + k] * (1 - w[0])
+          + c[next[1] + next[0] + k] * w[0];
+      double c01 = c[next[2] + k] * (1 - w[0])
+          + c[next[2] + next[0] + k] * w[0];
+      double c11 = c[next[2] + next[1] + k] * (1 - w[0])
+          + c[next[2] + next[1] + next[0] + k] * w[0];
+      double c0 = c00 * (1 - w[1]) + c10 * w[1];
+      double c1 = c01 * (1 - w[1]) + c11 * w[1];
+      d[k] = c0 * (1 - w[2]) + c1 * w[2];
+    }
+}
+
+void
+PHG4TPCDistortionMap::Lookup(double r, double phi, double z, double *d) const
+{
+  bool mirrored = (mirror_z && z > 0);
+  Interpolate(maps[imap[0]], r, phi, mirrored ? -z : z, d);
+  if (mapweight > 0)
+    {
+      double d1[3];
+      Interpolate(maps[imap[1]], r, phi, mirrored ? -z : z, d1);
+      for (int k = 0; k < 3; k++)
+        d[k] += mapweight * (d1[k] - d[k]);
+    }
+  d[0] *= scale;
+  d[1] *= scale;
+  d[2] *= (mirrored ? -scale : scale);
+}
+
+void
+PHG4TPCDistortionMap::get_distortion(double r, double phi, double z,
+    double &dr, double &drphi, double &dz)
+{
+  double d[3];
+  Lookup(r, phi, z, d);
+  dr = d[0];
+  drphi = d[1];
+  dz = d[2];
+}
+
+void
+PHG4TPCDistortionMap::get_distortion(const unsigned int n, const double *r,
+    const double *phi, const double *z, double *dr, double *drphi,
+    double *dz) const
+{
+  for (unsigned int i = 0; i < n; i++)
+    {
+      double d[3];
+      Lookup(r[i], phi[i], z[i], d);
+      if (dr)
+        dr[i] = d[0];
+      if (drphi)
+        drphi[i] = d[1];
+      if (dz)
+        dz[i] = d[2];
+    }
+}
+
+double
+PHG4TPCDistortionMap::get_r_distortion(double r, double phi, double z)
+{
+  double d[3];
+  Lookup(r, phi, z, d);
+  return d[0];
+}
+
+double
+PHG4TPCDistortionMap::get_rphi_distortion(double r, double phi, double z)
+{
+  double d[3];
+  Lookup(r, phi, z, d);
+  return d[1];
+}
+
+double
+PHG4TPCDistortionMap::get_z_distortion(double r, double phi, double z)
+{
+  double d[3];
+  Lookup(r, phi, z, d);
+  return d[2];
+}
@@ -0,0 +1,127 @@
+// $Id: $
+
+/*!
+ * \file PHG4TPCDistortionMap.h
+ * \brief 3D (r, phi, z) distortion maps with trilinear interpolation
+ * \version $Revision:   $
+ * \date $Date: $
+ */
+
+#ifndef PHG4TPCDISTORTIONMAP_H_
+#define PHG4TPCDISTORTIONMAP_H_
+
+#include "PHG4TPCDistortion.h"
+
+#include <string>
+#include <vector>
+
+class TH3;
+
+/*!
+ * \brief PHG4TPCDistortionMap applies the full 3D distortion of a map
+ *
+ * The map file has TH3 histograms (x: r, y: phi, z: z, cm) with fixed
+ * binning: mapDeltaR, mapRDeltaPHI and optionally mapDeltaZ (zero if
+ * missing). The bin contents are copied to one float array on the grid
+ * of the bin centers (r, r*phi, z distortion next to each other) and
+ * interpolated trilinearly, outside of the outer bin centers the value
+ * at the border is used. A phi axis covering 2 pi is periodic, maps
+ * with a single phi bin are phi independent. Maps which only cover
+ * negative z are mirrored to positive z (as in PHG4TPCSpaceChargeDistortion,
+ * the z distortion changes sign).
+ *
+ * Time dependent distortions: every map added with AddMap is valid at its
+ * time, in between the maps are interpolated linearly. The time is set
+ * with set_time (e.g. per event by the module which knows the beam
+ * conditions), the map of the constructor is at t = 0.
+ *
+ * There are no random numbers involved, the lookup can be used from
+ * several threads.
+ */
+class PHG4TPCDistortionMap : public PHG4TPCDistortion
+{
+public:
+  PHG4TPCDistortionMap(const std::string & distortion_map_file, int verbose = 0);
+
+  virtual
+  ~PHG4TPCDistortionMap() {}
+
+  //! radial distortion for a given truth location of the primary ionization
+  double
+  get_r_distortion(double r, double phi, double z);
+
+  //! r*phi distortion for a given truth location of the primary ionization
+  double
+  get_rphi_distortion(double r, double phi, double z);
+
+  //! z distortion for a given truth location of the primary ionization
+  double
+  get_z_distortion(double r, double phi, double z);
+
+  //! all three distortions with one lookup
+  void
+  get_distortion(double r, double phi, double z, double &dr, double &drphi, double &dz);
+
+  //! distortions of n ionization points, output arrays which are not needed can be NULL
+  void
+  get_distortion(const unsigned int n, const double *r, const double *phi, const double *z,
+      double *dr, double *drphi, double *dz) const;
+
+  //! map valid at time t (ns), the times have to increase, the binning has to be the one of the first map
+  void
+  AddMap(const std::string & distortion_map_file, const double t);
+
+  //! time (ns) of the distortions
+  void
+  set_time(const double t);
+
+  //! scale factor applied to all distortions (e.g. for luminosity scans)
+  void
+  set_scale(const double s) {scale = s;}
+
+  bool
+  is_thread_safe() const {return true;}
+
+protected:
+
+  //! regular axis of the grid of bin centers
+  struct Axis
+  {
+    int n;
+    double min; // first bin center
+    double step;
+    double invstep;
+    int stride; // in floats
+    bool periodic;
+  };
+
+  void
+  ReadMap(const std::string & distortion_map_file, std::vector<float> &grid);
+
+  void
+  SetAxis(Axis &axis, const TH3 *h, const int iaxis, const int stride);
+
+  //! lower grid node and weight of the upper one along an axis
+  static void
+  Locate(const Axis &axis, const double x, int &offset, int &next, double &w);
+
+  //! trilinear interpolation of the three distortions in one map
+  void
+  Interpolate(const std::vector<float> &grid, double r, double phi, double z, double *d) const;
+
+  //! scaled distortions at the current time, no output so it can run in several threads
+  void
+  Lookup(double r, double phi, double z, double *d) const;
+
+  Axis axis[3]; // r, phi, z
+  bool mirror_z;
+  std::vector<std::vector<float> > maps;
+  std::vector<double> maptimes;
+
+  // maps and weights of the current time
+  unsigned int imap[2];
+  double mapweight;
+  double scale;
+};
+
+#endif /* PHG4TPCDISTORTIONMAP_H_ */
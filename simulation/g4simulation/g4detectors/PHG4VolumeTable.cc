@@ -0,0 +1,56 @@
+#include "PHG4VolumeTable.h"
+
+using namespace std;
+
+PHG4VolumeTable::PHG4VolumeTable()
+  : nentries(0)
+  , mask(0)
+{
+}
+
+void
+PHG4VolumeTable::insert(const G4VPhysicalVolume *volume, const int value)
+{
+  // keep the load factor below 1/2, probe sequences stay short
+  if (2 * (nentries + 1) > table.size())
+  {
+    rehash(table.empty() ? 64 : 2 * table.size());
+  }
+  size_t i = slot(volume);
+  while (table[i].volume && table[i].volume != volume)
+  {
+    i = (i + 1) & mask;
+  }
+  if (!table[i].volume)
+  {
+    table[i].volume = volume;
+    nentries++;
+  }
+  table[i].value = value;
+}
+
+void
+PHG4VolumeTable::rehash(const size_t newsize)
+{
+  vector<Entry> old;
+  old.swap(table);
+  Entry empty = {nullptr, 0};
+  table.assign(newsize, empty);
+  mask = newsize - 1;
+  nentries = 0;
+  for (vector<Entry>::const_iterator iter = old.begin(); iter != old.end(); ++iter)
+  {
+    if (iter->volume)
+    {
+      insert(iter->volume, iter->value);
+    }
+  }
+}
+
+void
+PHG4VolumeTable::clear()
+{
+  vector<Entry>().swap(table);
+  nentries = 0;
+  mask = 0;
+}
@@ -0,0 +1,88 @@
+#ifndef PHG4VolumeTable_h
+#define PHG4VolumeTable_h
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class G4VPhysicalVolume;
+
+/*!
+ * \brief flat G4VPhysicalVolume* -> int lookup for the stepping actions
+ *
+ * Open addressing hash table with linear probing. Keys and values are
+ * stored next to each other in one array which is kept at most half
+ * full, a lookup is a multiplicative hash of the pointer and typically
+ * a single cache line. It is meant to be filled once after the geometry
+ * is constructed and then queried in every step, entries cannot be removed.
+ */
+class PHG4VolumeTable
+{
+ public:
+  PHG4VolumeTable();
+
+  //! add or overwrite the value for volume
+  void
+  insert(const G4VPhysicalVolume *volume, const int value);
+
+  //! value stored for volume, notfound if the volume is not in the table
+  int
+  find(const G4VPhysicalVolume *volume, const int notfound) const
+  {
+    if (!nentries)
+    {
+      return notfound;
+    }
+    for (size_t i = slot(volume);; i = (i + 1) & mask)
+    {
+      const Entry &entry = table[i];
+      if (entry.volume == volume)
+      {
+        return entry.value;
+      }
+      if (!entry.volume)
+      {
+        return notfound;
+      }
+    }
+  }
+
+  size_t
+  size() const
+  {
+    return nentries;
+  }
+
+  size_t
+  capacity() const
+  {
+    return table.size();
+  }
+
+  void
+  clear();
+
+ private:
+  struct Entry
+  {
+    const G4VPhysicalVolume *volume;
+    int value;
+  };
+
+  size_t
+  slot(const G4VPhysicalVolume *volume) const
+  {
+    // pointers are aligned, mix the upper bits down (fibonacci hashing)
+    const uint64_t h = (reinterpret_cast<uintptr_t>(volume) >> 3) * 0x9E3779B97F4A7C15ULL;
+    return (h >> 32) & mask;
+  }
+
+  void
+  rehash(const size_t newsize);
+
+  std::vector<Entry> table;
+  size_t nentries;
+  size_t mask;
+};
+
+#endif
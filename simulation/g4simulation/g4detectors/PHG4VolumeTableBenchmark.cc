@@ -0,0 +1,164 @@
+// Benchmark of the per step volume lookup of PHG4SpacalDetector: the four
+// std::map searches IsInCylinderActive did before (fiber cores, fibers,
+// blocks, sectors) versus the single PHG4VolumeTable probe. The default
+// of 32 sectors with 96 blocks of 100 fibers gives the ~ 300k fiber
+// placements of the full projective CEMC. The volumes are only used as
+// keys, blocks of the size of a G4PVPlacement stand in for them.
+//
+// Usage: PHG4VolumeTableBenchmark [fibers per block] [lookups]
+
+#include "PHG4VolumeTable.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <vector>
+
+using namespace std;
+
+namespace
+{
+  enum
+  {
+    INACTIVE = -100,
+    FIBER_CORE = 1,
+    FIBER_CLADING = 0,
+    ABSORBER = -1,
+    SUPPORT = -2
+  };
+
+  typedef map<const G4VPhysicalVolume *, int> VolumeMap;
+
+  // the old IsInCylinderActive with active and absorberactive set
+  int mapLookup(const VolumeMap &fiber_core_vol, const VolumeMap &fiber_vol, const VolumeMap &block_vol, const VolumeMap &calo_vol, const G4VPhysicalVolume *volume)
+  {
+    if (fiber_core_vol.find(volume) != fiber_core_vol.end())
+    {
+      return FIBER_CORE;
+    }
+    if (fiber_vol.find(volume) != fiber_vol.end())
+    {
+      return FIBER_CLADING;
+    }
+    if (block_vol.find(volume) != block_vol.end())
+    {
+      return ABSORBER;
+    }
+    if (calo_vol.find(volume) != calo_vol.end())
+    {
+      return SUPPORT;
+    }
+    return INACTIVE;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  const int nfibers_per_block = (argc > 1) ? atoi(argv[1]) : 100;
+  const long nlookups = (argc > 2) ? atol(argv[2]) : 20000000;
+  const int nsectors = 32;
+  const int nblocks = nsectors * 96;
+  const size_t volumesize = 160;  // about a G4PVPlacement
+
+  // volumes are allocated in construction order: sector, its blocks, their fibers
+  vector<char *> memory;
+  VolumeMap fiber_core_vol, fiber_vol, block_vol, calo_vol;
+  vector<const G4VPhysicalVolume *> cores, clads, blocks;
+  for (int isector = 0; isector < nsectors; isector++)
+  {
+    memory.push_back(new char[volumesize]);
+    calo_vol[reinterpret_cast<const G4VPhysicalVolume *>(memory.back())] = isector;
+    for (int iblock = 0; iblock < nblocks / nsectors; iblock++)
+    {
+      memory.push_back(new char[volumesize]);
+      blocks.push_back(reinterpret_cast<const G4VPhysicalVolume *>(memory.back()));
+      block_vol[blocks.back()] = iblock;
+      for (int ifiber = 0; ifiber < nfibers_per_block; ifiber++)
+      {
+        memory.push_back(new char[volumesize]);
+        clads.push_back(reinterpret_cast<const G4VPhysicalVolume *>(memory.back()));
+        fiber_vol[clads.back()] = ifiber;
+        memory.push_back(new char[volumesize]);
+        cores.push_back(reinterpret_cast<const G4VPhysicalVolume *>(memory.back()));
+        fiber_core_vol[cores.back()] = ifiber;
+      }
+    }
+  }
+  PHG4VolumeTable table;
+  for (VolumeMap::const_iterator iter = calo_vol.begin(); iter != calo_vol.end(); ++iter)
+  {
+    table.insert(iter->first, SUPPORT);
+  }
+  for (VolumeMap::const_iterator iter = block_vol.begin(); iter != block_vol.end(); ++iter)
+  {
+    table.insert(iter->first, ABSORBER);
+  }
+  for (VolumeMap::const_iterator iter = fiber_vol.begin(); iter != fiber_vol.end(); ++iter)
+  {
+    table.insert(iter->first, FIBER_CLADING);
+  }
+  for (VolumeMap::const_iterator iter = fiber_core_vol.begin(); iter != fiber_core_vol.end(); ++iter)
+  {
+    table.insert(iter->first, FIBER_CORE);
+  }
+
+  // step mix of a shower: mostly tungsten, then fibers, some steps in
+  // volumes of other detectors. Steps of one shower stay in a few blocks
+  const size_t nsteps = 1 << 20;
+  vector<const G4VPhysicalVolume *> steps(nsteps);
+  memory.push_back(new char[volumesize]);
+  const G4VPhysicalVolume *other = reinterpret_cast<const G4VPhysicalVolume *>(memory.back());
+  mt19937 rng(12345);
+  uniform_real_distribution<double> flat(0, 1);
+  size_t block = 0;
+  for (size_t i = 0; i < nsteps; i++)
+  {
+    if (i % 1000 == 0)
+    {
+      block = rng() % blocks.size();
+    }
+    size_t fiber = block * nfibers_per_block + rng() % nfibers_per_block;
+    double r = flat(rng);
+    if (r < 0.5)
+    {
+      steps[i] = blocks[block];
+    }
+    else if (r < 0.75)
+    {
+      steps[i] = cores[fiber];
+    }
+    else if (r < 0.9)
+    {
+      steps[i] = clads[fiber];
+    }
+    else
+    {
+      steps[i] = other;
+    }
+  }
+
+  long sum = 0;
+  chrono::high_resolution_clock::time_point t0 = chrono::high_resolution_clock::now();
+  for (long i = 0; i < nlookups; i++)
+  {
+    sum += mapLookup(fiber_core_vol, fiber_vol, block_vol, calo_vol, steps[i & (nsteps - 1)]);
+  }
+  chrono::high_resolution_clock::time_point t1 = chrono::high_resolution_clock::now();
+  for (long i = 0; i < nlookups; i++)
+  {
+    sum -= table.find(steps[i & (nsteps - 1)], INACTIVE);
+  }
+  chrono::high_resolution_clock::time_point t2 = chrono::high_resolution_clock::now();
+
+  cout << "PHG4VolumeTableBenchmark: " << table.size() << " volumes ("
+       << cores.size() << " fibers), " << nlookups << " lookups, check " << sum << endl;
+  cout << "  std::map chain:  " << chrono::duration<double, nano>(t1 - t0).count() / nlookups << " ns/step" << endl;
+  cout << "  PHG4VolumeTable: " << chrono::duration<double, nano>(t2 - t1).count() / nlookups << " ns/step" << endl;
+  for (vector<char *>::const_iterator iter = memory.begin(); iter != memory.end(); ++iter)
+  {
+    delete[] *iter;
+  }
+  return 0;
+}
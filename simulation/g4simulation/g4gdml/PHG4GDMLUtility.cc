@@ -19,6 +19,7 @@
 #include <phool/getClass.h>
 #include <fun4all/Fun4AllServer.h>
 
+#include <Geant4/G4LogicalVolume.hh>
 #include <Geant4/G4VPhysicalVolume.hh>
 
 #include <cassert>
@@ -59,6 +60,17 @@ void PHG4GDMLUtility::Dump_GDML(const std::string &filename, G4VPhysicalVolume *
   xercesc::XMLPlatformUtils::Terminate();
 }
 
+void PHG4GDMLUtility::Dump_GDML(const std::string &filename, G4LogicalVolume * vol, const PHG4GDMLConfig *config)
+{
+  assert(config);
+  assert(vol);
+
+  PHG4GDMLWriteStructure gdml_parser(config);
+
+  xercesc::XMLPlatformUtils::Initialize();
+  gdml_parser.Write(filename, vol, get_PHG4GDML_Schema(), 0, true);
+  xercesc::XMLPlatformUtils::Terminate();
+}
 
 PHG4GDMLConfig * PHG4GDMLUtility::GetOrMakeConfigNode(PHCompositeNode *topNode, bool build_new )
 {
@@ -13,6 +13,7 @@
 
 #include <string>
 
+class G4LogicalVolume;
 class G4VPhysicalVolume;
 class PHG4GDMLConfig;
 class PHCompositeNode;
@@ -28,6 +29,9 @@ class PHG4GDMLUtility
   //! save the current Geant4 geometry to GDML file. Reading PHG4GDMLConfig from topNode
   static void Dump_GDML(const std::string &filename, G4VPhysicalVolume * vol, PHCompositeNode *topNode = nullptr);
 
+  //! save the volume tree under vol to GDML file with an explicit config (e.g. an empty one to write everything)
+  static void Dump_GDML(const std::string &filename, G4LogicalVolume * vol, const PHG4GDMLConfig *config);
+
   static constexpr const char * get_PHG4GDML_Schema()
   {
     return "http://service-spi.web.cern.ch/service-spi/app/releases/GDML/schema/gdml.xsd";
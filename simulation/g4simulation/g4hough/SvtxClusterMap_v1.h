@@ -6,6 +6,7 @@
 
 #include <phool/PHObject.h>
 #include <map>
+#include <vector>
 #include <iostream>
 
 class SvtxClusterMap_v1 : public SvtxClusterMap {
@@ -30,9 +31,7 @@ public:
   const SvtxCluster* get(unsigned int idkey) const;
         SvtxCluster* get(unsigned int idkey); 
         SvtxCluster* insert(const SvtxCluster* cluster);
-        size_t       erase(unsigned int idkey) {
-	  delete _map[idkey]; return _map.erase(idkey);
-	}
+        size_t       erase(unsigned int idkey);
 
   ConstIter begin()                   const {return _map.begin();}
   ConstIter  find(unsigned int idkey) const {return _map.find(idkey);}
@@ -41,9 +40,27 @@ public:
   Iter begin()                   {return _map.begin();}
   Iter  find(unsigned int idkey) {return _map.find(idkey);}
   Iter   end()                   {return _map.end();}
+
+  // keep the clusters of the last event on a free list in Reset()
+  // instead of deleting them, insert() copies into those
+  void Recycle(bool b = true);
+  bool Recycle() const {return _recycle;}
+  static void RecycleDefault(bool b) {_recycle_default = b;}
+
+  unsigned long get_nallocated() const {return _nallocated;}
+  unsigned long get_nrecycled() const {return _nrecycled;}
   
 private:
+  void release(SvtxCluster* cluster);
+
   ClusterMap _map;
+
+  bool _recycle;                            //! transient, recycling mode
+  std::vector<SvtxCluster*> _freeclusters;  //! transient, clusters kept from previous events
+  unsigned long _nallocated;                //! transient
+  unsigned long _nrecycled;                 //! transient
+
+  static bool _recycle_default;
     
   ClassDef(SvtxClusterMap_v1, 1);
 };
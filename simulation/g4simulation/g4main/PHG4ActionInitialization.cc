@@ -0,0 +1,73 @@
+#include "PHG4ActionInitialization.h"
+
+#include "G4TBMagneticFieldSetup.hh"
+#include "PHG4PhenixEventAction.h"
+#include "PHG4PhenixSteppingAction.h"
+#include "PHG4PhenixTrackingAction.h"
+#include "PHG4TrackingAction.h"
+#include "PHG4WorkerGeneratorAction.h"
+
+#include <phfield/PHField.h>
+
+#include <phool/phool.h>
+
+#include <Geant4/G4AutoDelete.hh>
+#include <Geant4/G4EventManager.hh>
+#include <Geant4/G4Threading.hh>
+#include <Geant4/G4TrackingManager.hh>
+
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+PHG4ActionInitialization::~PHG4ActionInitialization()
+{
+  // the worker threads are gone by now, their field setups were deleted when they ended
+  for (vector<WorkerActions>::iterator iter = workers.begin(); iter != workers.end(); ++iter)
+  {
+    delete iter->field;
+  }
+}
+
+void PHG4ActionInitialization::AddWorker(PHG4WorkerGeneratorAction *generatoraction, PHG4PhenixEventAction *eventaction, PHG4PhenixSteppingAction *steppingaction, PHG4PhenixTrackingAction *trackingaction, const vector<PHG4TrackingAction *> &subsystemtracking, PHField *field)
+{
+  WorkerActions worker;
+  worker.generatoraction = generatoraction;
+  worker.eventaction = eventaction;
+  worker.steppingaction = steppingaction;
+  worker.trackingaction = trackingaction;
+  worker.subsystemtracking = subsystemtracking;
+  worker.field = field;
+  workers.push_back(worker);
+}
+
+void PHG4ActionInitialization::Build() const
+{
+  const int thread = G4Threading::G4GetThreadId();
+  if (thread < 0 || thread >= (int) workers.size())
+  {
+    cout << PHWHERE << " no actions for worker thread " << thread
+         << " (" << workers.size() << " threads), exiting" << endl;
+    exit(1);
+  }
+  const WorkerActions &worker = workers[thread];
+  SetUserAction(worker.generatoraction);
+  SetUserAction(worker.eventaction);
+  SetUserAction(worker.steppingaction);
+  SetUserAction(worker.trackingaction);
+
+  // make the tracking manager of this thread accessible within the subsystem tracking actions
+  if (G4TrackingManager *trackingManager = G4EventManager::GetEventManager()->GetTrackingManager())
+  {
+    for (vector<PHG4TrackingAction *>::const_iterator iter = worker.subsystemtracking.begin(); iter != worker.subsystemtracking.end(); ++iter)
+    {
+      (*iter)->SetTrackingManagerPointer(trackingManager);
+    }
+  }
+
+  // registers the field with the field manager of this thread
+  G4TBMagneticFieldSetup *fieldsetup = new G4TBMagneticFieldSetup(worker.field);
+  G4AutoDelete::Register(fieldsetup);
+  return;
+}
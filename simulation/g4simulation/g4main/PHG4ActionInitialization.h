@@ -0,0 +1,57 @@
+#ifndef PHG4ActionInitialization_H__
+#define PHG4ActionInitialization_H__
+
+#include <Geant4/G4VUserActionInitialization.hh>
+
+#include <vector>
+
+class PHField;
+class PHG4PhenixEventAction;
+class PHG4PhenixSteppingAction;
+class PHG4PhenixTrackingAction;
+class PHG4TrackingAction;
+class PHG4WorkerGeneratorAction;
+
+// action initialization of the multi threaded mode of PHG4Reco (PHG4Reco::G4Threads).
+// PHG4Reco makes the actions of all worker threads in InitRun (the subsystems copy
+// theirs in PHG4Subsystem::MakeWorkerActions), Build() hands the set of the calling
+// thread to its worker run manager which owns them from then on. The field manager
+// is thread local and the field maps cache their last lookup, so every worker also
+// gets its own field map and field setup
+
+class PHG4ActionInitialization : public G4VUserActionInitialization
+{
+ public:
+  PHG4ActionInitialization() {}
+
+  //! deletes the field maps
+  virtual ~PHG4ActionInitialization();
+
+  //! actions and field map of the next worker thread, the field map belongs to this object
+  void AddWorker(PHG4WorkerGeneratorAction *generatoraction, PHG4PhenixEventAction *eventaction, PHG4PhenixSteppingAction *steppingaction, PHG4PhenixTrackingAction *trackingaction, const std::vector<PHG4TrackingAction *> &subsystemtracking, PHField *field);
+
+  //! the master does not process events
+  virtual void BuildForMaster() const {}
+
+  virtual void Build() const;
+
+  unsigned int size() const { return workers.size(); }
+
+  //! main stepping action of worker thread i (settings and summary)
+  PHG4PhenixSteppingAction *GetSteppingAction(const unsigned int i) const { return workers[i].steppingaction; }
+
+ private:
+  struct WorkerActions
+  {
+    PHG4WorkerGeneratorAction *generatoraction;
+    PHG4PhenixEventAction *eventaction;
+    PHG4PhenixSteppingAction *steppingaction;
+    PHG4PhenixTrackingAction *trackingaction;
+    std::vector<PHG4TrackingAction *> subsystemtracking;
+    PHField *field;
+  };
+
+  std::vector<WorkerActions> workers;
+};
+
+#endif
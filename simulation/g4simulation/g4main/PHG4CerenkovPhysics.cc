@@ -0,0 +1,71 @@
+#include "PHG4CerenkovPhysics.h"
+
+#include <Geant4/G4Cerenkov.hh>
+#include <Geant4/G4OpAbsorption.hh>
+#include <Geant4/G4OpBoundaryProcess.hh>
+#include <Geant4/G4OpMieHG.hh>
+#include <Geant4/G4OpRayleigh.hh>
+#include <Geant4/G4OpWLS.hh>
+#include <Geant4/G4OpticalPhoton.hh>
+#include <Geant4/G4ParticleDefinition.hh>
+#include <Geant4/G4ParticleTable.hh>
+#include <Geant4/G4PhotoElectricEffect.hh>
+#include <Geant4/G4ProcessManager.hh>
+
+void PHG4CerenkovPhysics::AddOpticalProcesses()
+{
+  // cout << endl << "Ignore the next message - we implemented this correctly" << endl;
+  G4Cerenkov *theCerenkovProcess = new G4Cerenkov("Cerenkov");
+  // cout << "End of bogus warning message" << endl << endl;
+  // G4Scintillation* theScintillationProcess      = new G4Scintillation("Scintillation");
+
+  /*
+    if (verbosity > 0)
+    {
+    // This segfaults
+    theCerenkovProcess->DumpPhysicsTable();
+    }
+  */
+  theCerenkovProcess->SetMaxNumPhotonsPerStep(100);
+  theCerenkovProcess->SetMaxBetaChangePerStep(10.0);
+  theCerenkovProcess->SetTrackSecondariesFirst(true);
+
+  // theScintillationProcess->SetScintillationYieldFactor(1.);
+  // theScintillationProcess->SetTrackSecondariesFirst(true);
+
+  // Use Birks Correction in the Scintillation process
+
+  // G4EmSaturation* emSaturation = G4LossTableManager::Instance()->EmSaturation();
+  // theScintillationProcess->AddSaturation(emSaturation);
+
+  G4ParticleTable *theParticleTable = G4ParticleTable::GetParticleTable();
+  G4ParticleTable::G4PTblDicIterator *_theParticleIterator;
+  _theParticleIterator = theParticleTable->GetIterator();
+  _theParticleIterator->reset();
+  while ((*_theParticleIterator)())
+  {
+    G4ParticleDefinition *particle = _theParticleIterator->value();
+    G4String particleName = particle->GetParticleName();
+    G4ProcessManager *pmanager = particle->GetProcessManager();
+    if (theCerenkovProcess->IsApplicable(*particle))
+    {
+      pmanager->AddProcess(theCerenkovProcess);
+      pmanager->SetProcessOrdering(theCerenkovProcess, idxPostStep);
+    }
+    // if (theScintillationProcess->IsApplicable(*particle))
+    // {
+    //   pmanager->AddProcess(theScintillationProcess);
+    //   pmanager->SetProcessOrderingToLast(theScintillationProcess, idxAtRest);
+    //   pmanager->SetProcessOrderingToLast(theScintillationProcess, idxPostStep);
+    // }
+  }
+  G4ProcessManager *pmanager = G4OpticalPhoton::OpticalPhoton()->GetProcessManager();
+  // G4cout << " AddDiscreteProcess to OpticalPhoton " << G4endl;
+  pmanager->AddDiscreteProcess(new G4OpAbsorption());
+  pmanager->AddDiscreteProcess(new G4OpRayleigh());
+  pmanager->AddDiscreteProcess(new G4OpMieHG());
+  pmanager->AddDiscreteProcess(new G4OpBoundaryProcess());
+  pmanager->AddDiscreteProcess(new G4OpWLS());
+  pmanager->AddDiscreteProcess(new G4PhotoElectricEffect());
+  // pmanager->DumpInfo();
+}
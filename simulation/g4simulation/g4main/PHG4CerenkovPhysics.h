@@ -0,0 +1,28 @@
+#ifndef PHG4CerenkovPhysics_H__
+#define PHG4CerenkovPhysics_H__
+
+#include <Geant4/G4VPhysicsConstructor.hh>
+
+// the cerenkov and optical photon processes of PHG4Reco. The sequential run
+// manager gets them after its initialization (AddOpticalProcesses), in the multi
+// threaded mode (PHG4Reco::G4Threads) they are registered with the physics list
+// since every worker thread builds its own processes
+
+class PHG4CerenkovPhysics : public G4VPhysicsConstructor
+{
+ public:
+  PHG4CerenkovPhysics()
+    : G4VPhysicsConstructor("PHG4CerenkovPhysics")
+  {}
+
+  virtual ~PHG4CerenkovPhysics() {}
+
+  virtual void ConstructParticle() {}
+
+  virtual void ConstructProcess() { AddOpticalProcesses(); }
+
+  //! adds the processes to the particles of the calling thread
+  static void AddOpticalProcesses();
+};
+
+#endif
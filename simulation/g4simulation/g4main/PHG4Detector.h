@@ -3,11 +3,21 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 
 class G4UserSteppingAction;
 class G4LogicalVolume;
+class G4VPhysicalVolume;
 class PHCompositeNode;
 
+//! a volume the detector needs to recognize with its detector specific type and ids (geometry snapshots)
+struct PHG4VolumeTag
+{
+  G4VPhysicalVolume *volume;
+  int type;
+  int id[2];
+};
+
 //! base class for phenix detector creation
 /*! derived classes must implement construct method, which takes the "world" logical volume as argument */
 class PHG4Detector
@@ -42,6 +52,20 @@ class PHG4Detector
   */
   virtual void Construct( G4LogicalVolume* world ) = 0;
 
+  //! geometry snapshot support (PHG4Reco::GeometrySnapshot)
+  /*!
+  GetVolumeTags returns all volumes the detector looks up during the simulation
+  (e.g. in IsInDetector) after Construct, false if the detector cannot be loaded
+  from a snapshot. When the snapshot is loaded ConstructFromSnapshot is called
+  instead of Construct with the same tags pointing to the loaded volumes, it has
+  to restore what the snapshot does not keep (volume lookups, user limits, fields)
+  */
+  virtual bool GetVolumeTags(std::vector<PHG4VolumeTag> &tags) const { return false; }
+  virtual void ConstructFromSnapshot(const std::vector<PHG4VolumeTag> &tags) {}
+  //! version of the construction code, part of the snapshot file name - increment it
+  //! whenever a change of Construct changes the geometry for the same parameters
+  virtual int GetGeometryVersion() const { return 0; }
+
   virtual void Verbosity(const int v) {verbosity = v;}
 
   virtual int Verbosity()  const {return verbosity;}
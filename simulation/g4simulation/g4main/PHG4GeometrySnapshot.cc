@@ -0,0 +1,285 @@
+#include "PHG4GeometrySnapshot.h"
+#include "PHG4Detector.h"
+
+#include <g4gdml/PHG4GDMLConfig.hh>
+#include <g4gdml/PHG4GDMLUtility.hh>
+
+#include <Geant4/G4Element.hh>
+#include <Geant4/G4GDMLParser.hh>
+#include <Geant4/G4LogicalVolume.hh>
+#include <Geant4/G4Material.hh>
+#include <Geant4/G4PVPlacement.hh>
+#include <Geant4/G4VPhysicalVolume.hh>
+#include <Geant4/G4VSolid.hh>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+#include <unistd.h>
+
+using namespace std;
+
+namespace
+{
+  const string MAGIC = "PHG4GeometrySnapshot";
+}
+
+void
+PHG4GeometrySnapshot::CollectVolumes(const vector<G4VPhysicalVolume *> &topvolumes, vector<G4VPhysicalVolume *> &volumes)
+{
+  // a physical volume has exactly one mother, listing the daughters of
+  // every logical volume once lists every physical volume once
+  set<G4LogicalVolume *> visited;
+  vector<G4VPhysicalVolume *> stack(topvolumes.rbegin(), topvolumes.rend());
+  while (!stack.empty())
+    {
+      G4VPhysicalVolume *volume = stack.back();
+      stack.pop_back();
+      volumes.push_back(volume);
+      G4LogicalVolume *logvol = volume->GetLogicalVolume();
+      if (!visited.insert(logvol).second)
+	{
+	  continue;
+	}
+      for (int i = logvol->GetNoDaughters() - 1; i >= 0; i--)
+	{
+	  stack.push_back(logvol->GetDaughter(i));
+	}
+    }
+  return;
+}
+
+void
+PHG4GeometrySnapshot::MergeMaterials(const vector<G4VPhysicalVolume *> &volumes, const size_t nmaterials, const size_t nelements)
+{
+  // gdml defines its own copies of the materials, the volumes get the ones
+  // which exist already
+  G4MaterialTable *materials = G4Material::GetMaterialTable();
+  map<G4Material *, G4Material *> replace;
+  for (size_t i = nmaterials; i < materials->size(); i++)
+    {
+      for (size_t j = 0; j < nmaterials; j++)
+	{
+	  if ((*materials)[j] && (*materials)[j]->GetName() == (*materials)[i]->GetName())
+	    {
+	      replace[(*materials)[i]] = (*materials)[j];
+	      break;
+	    }
+	}
+    }
+  set<G4LogicalVolume *> logvols;
+  for (vector<G4VPhysicalVolume *>::const_iterator iter = volumes.begin(); iter != volumes.end(); ++iter)
+    {
+      G4LogicalVolume *logvol = (*iter)->GetLogicalVolume();
+      map<G4Material *, G4Material *>::const_iterator found = replace.find(logvol->GetMaterial());
+      if (logvols.insert(logvol).second && found != replace.end())
+	{
+	  logvol->SetMaterial(found->second);
+	}
+    }
+  // the physics indexes materials and elements by their position in the
+  // tables, a deleted one leaves a null entry. Only copies at the end of
+  // the tables are deleted and their entries removed, which is all of them
+  // unless the gdml brought a material we did not have
+  while (materials->size() > nmaterials && replace.find(materials->back()) != replace.end())
+    {
+      delete materials->back();
+      materials->pop_back();
+    }
+  if (materials->size() > nmaterials)
+    {
+      return;
+    }
+  G4ElementTable *elements = G4Element::GetElementTable();
+  while (elements->size() > nelements)
+    {
+      bool duplicate = false;
+      for (size_t j = 0; j < nelements; j++)
+	{
+	  if ((*elements)[j] && (*elements)[j]->GetName() == elements->back()->GetName())
+	    {
+	      duplicate = true;
+	      break;
+	    }
+	}
+      if (!duplicate)
+	{
+	  break;
+	}
+      delete elements->back();
+      elements->pop_back();
+    }
+  return;
+}
+
+int
+PHG4GeometrySnapshot::Write(const string &filename, const PHG4Detector *detector, G4LogicalVolume *world, const int firstdaughter)
+{
+  vector<PHG4VolumeTag> tags;
+  if (!detector->GetVolumeTags(tags))
+    {
+      return -1;
+    }
+  vector<G4VPhysicalVolume *> topvolumes;
+  for (int i = firstdaughter; i < world->GetNoDaughters(); i++)
+    {
+      G4VPhysicalVolume *volume = world->GetDaughter(i);
+      if (volume->IsReplicated() || volume->IsParameterised())
+	{
+	  cout << "PHG4GeometrySnapshot: " << detector->GetName() << " places replicas in the world, no snapshot" << endl;
+	  return -1;
+	}
+      topvolumes.push_back(volume);
+    }
+  vector<G4VPhysicalVolume *> volumes;
+  CollectVolumes(topvolumes, volumes);
+  map<G4VPhysicalVolume *, unsigned int> index;
+  for (unsigned int i = 0; i < volumes.size(); i++)
+    {
+      index[volumes[i]] = i;
+    }
+
+  ostringstream tagtext;
+  tagtext << MAGIC << " " << tags.size() << endl;
+  for (vector<PHG4VolumeTag>::const_iterator iter = tags.begin(); iter != tags.end(); ++iter)
+    {
+      map<G4VPhysicalVolume *, unsigned int>::const_iterator found = index.find(iter->volume);
+      if (found == index.end())
+	{
+	  cout << "PHG4GeometrySnapshot: " << detector->GetName() << " has volumes outside of its world volumes, no snapshot" << endl;
+	  return -1;
+	}
+      tagtext << found->second << " " << iter->type << " " << iter->id[0] << " " << iter->id[1] << endl;
+    }
+
+  // the gdml writer takes a mother volume, give the top volumes a temporary one
+  G4LogicalVolume *snapworld = new G4LogicalVolume(world->GetSolid(), world->GetMaterial(), world->GetName() + "_snapshot");
+  vector<G4VPhysicalVolume *> copies;
+  for (vector<G4VPhysicalVolume *>::const_iterator iter = topvolumes.begin(); iter != topvolumes.end(); ++iter)
+    {
+      copies.push_back(new G4PVPlacement((*iter)->GetRotation(), (*iter)->GetTranslation(), (*iter)->GetLogicalVolume(),
+					 (*iter)->GetName(), snapworld, false, (*iter)->GetCopyNo()));
+    }
+  // parallel jobs may write the same snapshot, files only show up complete
+  // under their final name and the tags (which Read looks for first) come last
+  ostringstream suffix;
+  suffix << "." << getpid();
+  PHG4GDMLConfig config; // nothing excluded
+  PHG4GDMLUtility::Dump_GDML(filename + ".gdml" + suffix.str(), snapworld, &config);
+  for (vector<G4VPhysicalVolume *>::const_iterator iter = copies.begin(); iter != copies.end(); ++iter)
+    {
+      delete *iter;
+    }
+  delete snapworld;
+  ofstream tagfile((filename + ".tags" + suffix.str()).c_str());
+  tagfile << tagtext.str();
+  tagfile.close();
+  if (!tagfile ||
+      rename((filename + ".gdml" + suffix.str()).c_str(), (filename + ".gdml").c_str()) ||
+      rename((filename + ".tags" + suffix.str()).c_str(), (filename + ".tags").c_str()))
+    {
+      cout << "PHG4GeometrySnapshot: could not write snapshot " << filename << endl;
+      remove((filename + ".gdml" + suffix.str()).c_str());
+      remove((filename + ".tags" + suffix.str()).c_str());
+      return -1;
+    }
+  cout << "PHG4GeometrySnapshot: wrote " << detector->GetName() << " geometry to " << filename << ".gdml/.tags" << endl;
+  return 0;
+}
+
+int
+PHG4GeometrySnapshot::Read(const string &filename, PHG4Detector *detector, G4LogicalVolume *world)
+{
+  ifstream tagfile((filename + ".tags").c_str());
+  if (!tagfile)
+    {
+      return -1;
+    }
+  string magic;
+  unsigned int ntags = 0;
+  tagfile >> magic >> ntags;
+  if (magic != MAGIC)
+    {
+      cout << "PHG4GeometrySnapshot: " << filename << ".tags is not a snapshot" << endl;
+      return -1;
+    }
+  vector<PHG4VolumeTag> tags(ntags);
+  vector<unsigned int> indices(ntags);
+  for (unsigned int i = 0; i < ntags; i++)
+    {
+      tagfile >> indices[i] >> tags[i].type >> tags[i].id[0] >> tags[i].id[1];
+    }
+  if (!tagfile)
+    {
+      cout << "PHG4GeometrySnapshot: " << filename << ".tags is truncated" << endl;
+      return -1;
+    }
+  if (access((filename + ".gdml").c_str(), R_OK))
+    {
+      return -1;
+    }
+
+  size_t nmaterials = G4Material::GetMaterialTable()->size();
+  size_t nelements = G4Element::GetElementTable()->size();
+  G4GDMLParser parser;
+  parser.Read(filename + ".gdml", false);
+  G4VPhysicalVolume *snapworld = parser.GetWorldVolume();
+  if (!snapworld)
+    {
+      cout << "PHG4GeometrySnapshot: no volumes in " << filename << ".gdml" << endl;
+      return -1;
+    }
+  G4LogicalVolume *snaplog = snapworld->GetLogicalVolume();
+  vector<G4VPhysicalVolume *> topvolumes;
+  for (int i = 0; i < snaplog->GetNoDaughters(); i++)
+    {
+      topvolumes.push_back(snaplog->GetDaughter(i));
+    }
+  vector<G4VPhysicalVolume *> volumes;
+  CollectVolumes(topvolumes, volumes);
+  for (unsigned int i = 0; i < ntags; i++)
+    {
+      if (indices[i] >= volumes.size())
+	{
+	  cout << "PHG4GeometrySnapshot: " << filename << ".tags does not match " << filename << ".gdml" << endl;
+	  return -1;
+	}
+    }
+
+  // the loaded top volumes are in the snapshot world, the ones in our world replace them
+  map<G4VPhysicalVolume *, G4VPhysicalVolume *> placed;
+  vector<G4VPhysicalVolume *> newtopvolumes;
+  for (vector<G4VPhysicalVolume *>::const_iterator iter = topvolumes.begin(); iter != topvolumes.end(); ++iter)
+    {
+      placed[*iter] = new G4PVPlacement((*iter)->GetRotation(), (*iter)->GetTranslation(), (*iter)->GetLogicalVolume(),
+					(*iter)->GetName(), world, false, (*iter)->GetCopyNo());
+      newtopvolumes.push_back(placed[*iter]);
+    }
+  for (unsigned int i = 0; i < ntags; i++)
+    {
+      G4VPhysicalVolume *volume = volumes[indices[i]];
+      map<G4VPhysicalVolume *, G4VPhysicalVolume *>::const_iterator found = placed.find(volume);
+      tags[i].volume = (found != placed.end()) ? found->second : volume;
+    }
+  // the snapshot world and its placements of the top volumes would stay
+  // in the volume stores (and show up in every walk over them)
+  for (vector<G4VPhysicalVolume *>::const_iterator iter = topvolumes.begin(); iter != topvolumes.end(); ++iter)
+    {
+      snaplog->RemoveDaughter(*iter);
+      delete *iter;
+    }
+  G4VSolid *snapsolid = snaplog->GetSolid();
+  delete snapworld;
+  delete snaplog;
+  delete snapsolid;
+  volumes.clear();
+  CollectVolumes(newtopvolumes, volumes);
+  MergeMaterials(volumes, nmaterials, nelements);
+  detector->ConstructFromSnapshot(tags);
+  cout << "PHG4GeometrySnapshot: read " << detector->GetName() << " geometry from " << filename << ".gdml" << endl;
+  return 0;
+}
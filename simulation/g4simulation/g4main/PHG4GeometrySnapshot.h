@@ -0,0 +1,39 @@
+#ifndef PHG4GEOMETRYSNAPSHOT_H
+#define PHG4GEOMETRYSNAPSHOT_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class G4LogicalVolume;
+class G4VPhysicalVolume;
+class PHG4Detector;
+
+/*!
+  geometry snapshot of a single detector: the volumes the detector placed
+  in the world are written to <filename>.gdml (with the materials and
+  solids they use), the volume tags of the detector (PHG4Detector::GetVolumeTags)
+  to <filename>.tags. The tags refer to the volumes by their index in a depth
+  first walk of the volume tree which is the same for the written and the
+  loaded geometry since gdml keeps the order of the daughters.
+  The file name has to encode everything the geometry depends on,
+  PHG4Reco uses the parameter hash of the subsystem
+*/
+class PHG4GeometrySnapshot
+{
+ public:
+  //! write the world daughters from firstdaughter on (placed by detector), returns non zero if the detector does not support snapshots
+  static int Write(const std::string &filename, const PHG4Detector *detector, G4LogicalVolume *world, const int firstdaughter);
+
+  //! place the snapshot volumes in the world and call ConstructFromSnapshot, returns non zero (and places nothing) if there is no usable snapshot
+  static int Read(const std::string &filename, PHG4Detector *detector, G4LogicalVolume *world);
+
+ protected:
+  //! depth first walk, every physical volume is listed once
+  static void CollectVolumes(const std::vector<G4VPhysicalVolume *> &topvolumes, std::vector<G4VPhysicalVolume *> &volumes);
+
+  //! volumes use the existing materials instead of the gdml copies (created after the first nmaterials/nelements), the copies are deleted
+  static void MergeMaterials(const std::vector<G4VPhysicalVolume *> &volumes, const size_t nmaterials, const size_t nelements);
+};
+
+#endif
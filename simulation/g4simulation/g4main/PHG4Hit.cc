@@ -19,7 +19,8 @@ PHG4Hit::Copy(PHG4Hit const &g4hit)
   set_hit_id(g4hit.get_hit_id());
   set_trkid(g4hit.get_trkid());
   set_edep(g4hit.get_edep());
-  for (unsigned char ic = 0; ic < UCHAR_MAX; ic++)
+  // unsigned int, ic <= UCHAR_MAX never ends with an unsigned char
+  for (unsigned int ic = 0; ic <= UCHAR_MAX; ic++)
     {
       PROPERTY prop_id = static_cast<PHG4Hit::PROPERTY> (ic);
       if (g4hit.has_property(prop_id))
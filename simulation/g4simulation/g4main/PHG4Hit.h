@@ -183,6 +183,8 @@ class PHG4Hit: public PHObject
   static std::string get_property_type(const PROPERTY_TYPE prop_type);
 
  protected:
+  //! copies the raw property storage
+  friend class PHG4HitColumns;
   virtual unsigned int get_property_nocheck(const PROPERTY prop_id) const {return UINT_MAX;}
   virtual void set_property_nocheck(const PROPERTY prop_id,const unsigned int) {return;}
   ClassDef(PHG4Hit,1)
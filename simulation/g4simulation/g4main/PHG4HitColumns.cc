@@ -0,0 +1,286 @@
+#include "PHG4HitColumns.h"
+#include "PHG4HitContainer.h"
+#include "PHG4Hitv1.h"
+
+#include <algorithm>
+#include <bitset>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+
+using namespace std;
+
+ClassImp(PHG4HitColumns)
+
+namespace
+{
+  // same bit conversion as PHG4Hitv1::u_property
+  union u_property
+  {
+    float fdata;
+    int32_t idata;
+    uint32_t uidata;
+  };
+}
+
+PHG4HitColumns::PHG4HitColumns():
+  id(-1)
+{}
+
+void
+PHG4HitColumns::Reset()
+{
+  // clear() keeps the capacity, the next event fills the same memory
+  layers.clear();
+  hitid.clear();
+  trkid.clear();
+  showerid.clear();
+  x0.clear();
+  x1.clear();
+  y0.clear();
+  y1.clear();
+  z0.clear();
+  z1.clear();
+  t0.clear();
+  t1.clear();
+  edep.clear();
+  prop_ids.clear();
+  prop_values.clear();
+  prop_set.clear();
+  return;
+}
+
+void
+PHG4HitColumns::identify(ostream& os) const
+{
+  os << "PHG4HitColumns, id " << id << ", number of hits: " << size()
+     << ", property columns: " << prop_ids.size();
+  if (!prop_set.empty())
+    {
+      os << " (with presence mask)";
+    }
+  os << endl;
+  return;
+}
+
+void
+PHG4HitColumns::Fill(const PHG4HitContainer *hits)
+{
+  Reset();
+  id = hits->GetID();
+  for (PHG4HitContainer::LayerIter iter = hits->getLayers().first; iter != hits->getLayers().second; ++iter)
+    {
+      layers.push_back(*iter);
+    }
+
+  // the property columns are the union of the properties of all hits
+  PHG4HitContainer::ConstRange range = hits->getHits();
+  bitset<UCHAR_MAX + 1> used;
+  for (PHG4HitContainer::ConstIterator iter = range.first; iter != range.second; ++iter)
+    {
+      const PHG4Hitv1 *hitv1 = dynamic_cast<const PHG4Hitv1 *>(iter->second);
+      if (hitv1)
+	{
+	  for (PHG4Hitv1::prop_map_t::const_iterator piter = hitv1->prop_map.begin(); piter != hitv1->prop_map.end(); ++piter)
+	    {
+	      used.set(piter->first);
+	    }
+	}
+      else
+	{
+	  for (unsigned int ic = 0; ic <= UCHAR_MAX; ic++)
+	    {
+	      if (iter->second->has_property(static_cast<PHG4Hit::PROPERTY>(ic)))
+		{
+		  used.set(ic);
+		}
+	    }
+	}
+    }
+  int column[UCHAR_MAX + 1];
+  for (unsigned int ic = 0; ic <= UCHAR_MAX; ic++)
+    {
+      column[ic] = -1;
+      if (used.test(ic))
+	{
+	  column[ic] = prop_ids.size();
+	  prop_ids.push_back(ic);
+	}
+    }
+
+  const unsigned int nhits = hits->size();
+  hitid.reserve(nhits);
+  trkid.reserve(nhits);
+  showerid.reserve(nhits);
+  x0.reserve(nhits);
+  x1.reserve(nhits);
+  y0.reserve(nhits);
+  y1.reserve(nhits);
+  z0.reserve(nhits);
+  z1.reserve(nhits);
+  t0.reserve(nhits);
+  t1.reserve(nhits);
+  edep.reserve(nhits);
+  prop_values.assign(prop_ids.size() * nhits, 0);
+  prop_set.assign(prop_ids.size() * nhits, 0);
+  size_t nset = 0;
+
+  // the map iterates in key order, the columns come out sorted
+  unsigned int ihit = 0;
+  for (PHG4HitContainer::ConstIterator iter = range.first; iter != range.second; ++iter, ++ihit)
+    {
+      const PHG4Hit *hit = iter->second;
+      hitid.push_back(iter->first);
+      trkid.push_back(hit->get_trkid());
+      showerid.push_back(hit->get_shower_id());
+      x0.push_back(hit->get_x(0));
+      x1.push_back(hit->get_x(1));
+      y0.push_back(hit->get_y(0));
+      y1.push_back(hit->get_y(1));
+      z0.push_back(hit->get_z(0));
+      z1.push_back(hit->get_z(1));
+      t0.push_back(hit->get_t(0));
+      t1.push_back(hit->get_t(1));
+      edep.push_back(hit->get_edep());
+      const PHG4Hitv1 *hitv1 = dynamic_cast<const PHG4Hitv1 *>(hit);
+      if (hitv1)
+	{
+	  for (PHG4Hitv1::prop_map_t::const_iterator piter = hitv1->prop_map.begin(); piter != hitv1->prop_map.end(); ++piter)
+	    {
+	      const size_t index = column[piter->first] * nhits + ihit;
+	      prop_values[index] = piter->second;
+	      prop_set[index] = 1;
+	      nset++;
+	    }
+	}
+      else
+	{
+	  for (unsigned int k = 0; k < prop_ids.size(); k++)
+	    {
+	      const PHG4Hit::PROPERTY prop_id = static_cast<PHG4Hit::PROPERTY>(prop_ids[k]);
+	      if (hit->has_property(prop_id))
+		{
+		  const size_t index = k * nhits + ihit;
+		  prop_values[index] = hit->get_property_nocheck(prop_id);
+		  prop_set[index] = 1;
+		  nset++;
+		}
+	    }
+	}
+    }
+  // the usual case, every hit has the same properties
+  if (nset == prop_set.size())
+    {
+      prop_set.clear();
+    }
+  return;
+}
+
+void
+PHG4HitColumns::Unpack(PHG4HitContainer *hits) const
+{
+  for (vector<unsigned int>::const_iterator iter = layers.begin(); iter != layers.end(); ++iter)
+    {
+      hits->AddLayer(*iter);
+    }
+  const unsigned int nhits = size();
+  for (unsigned int i = 0; i < nhits; i++)
+    {
+      PHG4Hit *hit = hits->NewHit();
+      hit->set_hit_id(hitid[i]);
+      hit->set_trkid(trkid[i]);
+      hit->set_shower_id(showerid[i]);
+      hit->set_x(0, x0[i]);
+      hit->set_x(1, x1[i]);
+      hit->set_y(0, y0[i]);
+      hit->set_y(1, y1[i]);
+      hit->set_z(0, z0[i]);
+      hit->set_z(1, z1[i]);
+      hit->set_t(0, t0[i]);
+      hit->set_t(1, t1[i]);
+      hit->set_edep(edep[i]);
+      for (unsigned int k = 0; k < prop_ids.size(); k++)
+	{
+	  const size_t index = k * nhits + i;
+	  if (prop_set.empty() || prop_set[index])
+	    {
+	      hit->set_property_nocheck(static_cast<PHG4Hit::PROPERTY>(prop_ids[k]), prop_values[index]);
+	    }
+	}
+      hits->AddHit(hit);
+    }
+  return;
+}
+
+pair<unsigned int, unsigned int>
+PHG4HitColumns::getHits(const unsigned int detid) const
+{
+  PHG4HitDefs::keytype detidlong = detid;
+  PHG4HitDefs::keytype keylow = detidlong << PHG4HitDefs::hit_idbits;
+  PHG4HitDefs::keytype keyup = ((detidlong + 1) << PHG4HitDefs::hit_idbits) - 1;
+  vector<PHG4HitDefs::keytype>::const_iterator first = lower_bound(hitid.begin(), hitid.end(), keylow);
+  vector<PHG4HitDefs::keytype>::const_iterator last = upper_bound(first, hitid.end(), keyup);
+  return make_pair(first - hitid.begin(), last - hitid.begin());
+}
+
+int
+PHG4HitColumns::prop_column(const PHG4Hit::PROPERTY prop_id) const
+{
+  vector<unsigned char>::const_iterator iter = lower_bound(prop_ids.begin(), prop_ids.end(), prop_id);
+  if (iter == prop_ids.end() || *iter != prop_id)
+    {
+      return -1;
+    }
+  return iter - prop_ids.begin();
+}
+
+bool
+PHG4HitColumns::has_property(const PHG4Hit::PROPERTY prop_id) const
+{
+  return (prop_column(prop_id) >= 0);
+}
+
+bool
+PHG4HitColumns::has_property(const unsigned int i, const PHG4Hit::PROPERTY prop_id) const
+{
+  int k = prop_column(prop_id);
+  if (k < 0)
+    {
+      return false;
+    }
+  return (prop_set.empty() || prop_set[k * size() + i]);
+}
+
+float
+PHG4HitColumns::get_property_float(const unsigned int i, const PHG4Hit::PROPERTY prop_id) const
+{
+  if (!has_property(i, prop_id))
+    {
+      return NAN;
+    }
+  u_property u;
+  u.uidata = prop_values[prop_column(prop_id) * size() + i];
+  return u.fdata;
+}
+
+int
+PHG4HitColumns::get_property_int(const unsigned int i, const PHG4Hit::PROPERTY prop_id) const
+{
+  if (!has_property(i, prop_id))
+    {
+      return INT_MIN;
+    }
+  u_property u;
+  u.uidata = prop_values[prop_column(prop_id) * size() + i];
+  return u.idata;
+}
+
+unsigned int
+PHG4HitColumns::get_property_uint(const unsigned int i, const PHG4Hit::PROPERTY prop_id) const
+{
+  if (!has_property(i, prop_id))
+    {
+      return UINT_MAX;
+    }
+  return prop_values[prop_column(prop_id) * size() + i];
+}
@@ -0,0 +1,99 @@
+#ifndef PHG4HITCOLUMNS_H__
+#define PHG4HITCOLUMNS_H__
+
+#include "PHG4HitDefs.h"
+#include "PHG4Hit.h"
+
+#include <phool/PHObject.h>
+
+#include <iostream>
+#include <utility>
+#include <vector>
+
+class PHG4HitContainer;
+
+/*! \brief columnar (structure of arrays) storage of a PHG4HitContainer
+
+  Every hit variable is kept in its own vector, all of them sorted by
+  the hit key. With the default split level each column is written into
+  its own branch which compresses much better than the per hit streamer
+  of the PHG4Hitv1 objects in the map of the PHG4HitContainer.
+  Optional hit properties (PHG4Hit::PROPERTY) only get a column if at
+  least one hit of the event has them, a presence mask is only stored
+  if some hits are missing a property of an existing column.
+
+  PHG4HitCompress fills it from the PHG4HitContainer before the output,
+  PHG4HitColumnsReadBack restores the PHG4HitContainer when reading.
+  This is a DST compression only: in memory the hits are PHG4Hitv1 in
+  the map of the PHG4HitContainer as before, the memory per hit and the
+  iteration in the cell reconstruction do not change.
+*/
+
+class PHG4HitColumns: public PHObject
+{
+ public:
+  PHG4HitColumns();
+  virtual ~PHG4HitColumns() {}
+
+  void Reset();
+  void identify(std::ostream& os = std::cout) const;
+  int isValid() const {return !hitid.empty();}
+
+  //! replace the content by the hits (and the id, layers) of container
+  void Fill(const PHG4HitContainer *hits);
+  //! add all hits as PHG4Hitv1 to the container, the container is not reset
+  void Unpack(PHG4HitContainer *hits) const;
+
+  unsigned int size() const {return hitid.size();}
+  int GetID() const {return id;}
+
+  //! index range [first, second) of the hits with a given detid, same selection as PHG4HitContainer::getHits(detid)
+  std::pair<unsigned int, unsigned int> getHits(const unsigned int detid) const;
+
+  PHG4HitDefs::keytype get_hit_id(const unsigned int i) const {return hitid[i];}
+  int get_trkid(const unsigned int i) const {return trkid[i];}
+  int get_shower_id(const unsigned int i) const {return showerid[i];}
+  float get_x(const unsigned int i, const int j) const {return j ? x1[i] : x0[i];}
+  float get_y(const unsigned int i, const int j) const {return j ? y1[i] : y0[i];}
+  float get_z(const unsigned int i, const int j) const {return j ? z1[i] : z0[i];}
+  float get_t(const unsigned int i, const int j) const {return j ? t1[i] : t0[i];}
+  float get_edep(const unsigned int i) const {return edep[i];}
+
+  //! does any hit have this property
+  bool has_property(const PHG4Hit::PROPERTY prop_id) const;
+  bool has_property(const unsigned int i, const PHG4Hit::PROPERTY prop_id) const;
+  float get_property_float(const unsigned int i, const PHG4Hit::PROPERTY prop_id) const;
+  int get_property_int(const unsigned int i, const PHG4Hit::PROPERTY prop_id) const;
+  unsigned int get_property_uint(const unsigned int i, const PHG4Hit::PROPERTY prop_id) const;
+
+ protected:
+  //! column of prop_id in prop_values, -1 if there is none
+  int prop_column(const PHG4Hit::PROPERTY prop_id) const;
+
+  int id;
+  std::vector<unsigned int> layers;
+
+  std::vector<PHG4HitDefs::keytype> hitid;
+  std::vector<int> trkid;
+  std::vector<int> showerid;
+  std::vector<float> x0;
+  std::vector<float> x1;
+  std::vector<float> y0;
+  std::vector<float> y1;
+  std::vector<float> z0;
+  std::vector<float> z1;
+  std::vector<float> t0;
+  std::vector<float> t1;
+  std::vector<float> edep;
+
+  //! property ids of the property columns, ascending
+  std::vector<unsigned char> prop_ids;
+  //! 32 bit storage of the properties, column k is [k*size(), (k+1)*size())
+  std::vector<unsigned int> prop_values;
+  //! same layout as prop_values, 1 if the hit has the property. Empty if all hits have all
+  std::vector<unsigned char> prop_set;
+
+  ClassDef(PHG4HitColumns,1)
+};
+
+#endif
@@ -0,0 +1,65 @@
+#include "PHG4HitColumnsReadBack.h"
+#include "PHG4HitColumns.h"
+#include "PHG4HitContainer.h"
+
+#include <fun4all/Fun4AllReturnCodes.h>
+
+#include <phool/getClass.h>
+#include <phool/PHCompositeNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHNodeIterator.h>
+#include <phool/phool.h>
+
+#include <iostream>
+
+using namespace std;
+
+PHG4HitColumnsReadBack::PHG4HitColumnsReadBack(const std::string &name):
+  SubsysReco(name)
+{}
+
+int
+PHG4HitColumnsReadBack::InitRun(PHCompositeNode *topNode)
+{
+  PHNodeIterator iter(topNode);
+  for (vector<string>::const_iterator hiter = hitnodes.begin(); hiter != hitnodes.end(); ++hiter)
+    {
+      if (findNode::getClass<PHG4HitContainer>(topNode, *hiter))
+	{
+	  continue;
+	}
+      PHNode *colnode = iter.findFirst("PHIODataNode", *hiter + "_COLUMNS");
+      if (!colnode)
+	{
+	  cout << PHWHERE << " no node " << *hiter << "_COLUMNS found" << endl;
+	  return Fun4AllReturnCodes::ABORTRUN;
+	}
+      PHCompositeNode *parent = dynamic_cast<PHCompositeNode *>(colnode->getParent());
+      // the container is ours and only filled by Unpack, recycling its
+      // hits saves the allocation of every hit after the first events
+      PHG4HitContainer *hits = new PHG4HitContainer(*hiter);
+      hits->Recycle();
+      PHIODataNode<PHObject> *newnode = new PHIODataNode<PHObject>(hits, *hiter, "PHObject");
+      newnode->makeTransient();
+      parent->addNode(newnode);
+    }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+int
+PHG4HitColumnsReadBack::process_event(PHCompositeNode *topNode)
+{
+  for (vector<string>::const_iterator hiter = hitnodes.begin(); hiter != hitnodes.end(); ++hiter)
+    {
+      PHG4HitContainer *hits = findNode::getClass<PHG4HitContainer>(topNode, *hiter);
+      PHG4HitColumns *columns = findNode::getClass<PHG4HitColumns>(topNode, *hiter + "_COLUMNS");
+      if (!hits || !columns)
+	{
+	  cout << PHWHERE << " missing node " << *hiter << " or " << *hiter << "_COLUMNS" << endl;
+	  return Fun4AllReturnCodes::ABORTRUN;
+	}
+      hits->Reset();
+      columns->Unpack(hits);
+    }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
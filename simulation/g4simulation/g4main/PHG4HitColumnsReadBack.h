@@ -0,0 +1,29 @@
+#ifndef PHG4HITCOLUMNSREADBACK_H
+#define PHG4HITCOLUMNSREADBACK_H
+
+#include <fun4all/SubsysReco.h>
+
+#include <string>
+#include <vector>
+
+/*!
+  restores the PHG4HitContainer nodes from the PHG4HitColumns nodes
+  written by PHG4HitCompress. The restored hit nodes are transient,
+  the columns are still on the node tree to be written again
+*/
+class PHG4HitColumnsReadBack: public SubsysReco
+{
+ public:
+  PHG4HitColumnsReadBack(const std::string &name = "PHG4HitColumnsReadBack");
+  virtual ~PHG4HitColumnsReadBack() {}
+  int InitRun(PHCompositeNode *topNode);
+  int process_event(PHCompositeNode *topNode);
+
+  //! hit node to restore, e.g. G4HIT_CEMC (read from G4HIT_CEMC_COLUMNS)
+  void AddNode(const std::string &hitnode) {hitnodes.push_back(hitnode);}
+
+ protected:
+  std::vector<std::string> hitnodes;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "PHG4HitCompress.h"
+#include "PHG4HitColumns.h"
+#include "PHG4HitContainer.h"
+
+#include <fun4all/Fun4AllReturnCodes.h>
+
+#include <phool/getClass.h>
+#include <phool/PHCompositeNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHNodeIterator.h>
+#include <phool/phool.h>
+
+#include <iostream>
+
+using namespace std;
+
+PHG4HitCompress::PHG4HitCompress(const std::string &name):
+  SubsysReco(name),
+  keephits(0)
+{}
+
+int
+PHG4HitCompress::InitRun(PHCompositeNode *topNode)
+{
+  PHNodeIterator iter(topNode);
+  for (vector<string>::const_iterator hiter = hitnodes.begin(); hiter != hitnodes.end(); ++hiter)
+    {
+      PHNode *hitnode = iter.findFirst("PHIODataNode", *hiter);
+      if (!hitnode)
+	{
+	  cout << PHWHERE << " no hit node " << *hiter << " found" << endl;
+	  return Fun4AllReturnCodes::ABORTRUN;
+	}
+      if (!keephits)
+	{
+	  hitnode->makeTransient();
+	}
+      string colname = *hiter + "_COLUMNS";
+      if (findNode::getClass<PHG4HitColumns>(topNode, colname))
+	{
+	  continue;
+	}
+      PHCompositeNode *parent = dynamic_cast<PHCompositeNode *>(hitnode->getParent());
+      PHIODataNode<PHObject> *newnode = new PHIODataNode<PHObject>(new PHG4HitColumns(), colname, "PHObject");
+      parent->addNode(newnode);
+      if (verbosity > 0)
+	{
+	  cout << Name() << ": writing " << *hiter << " as " << colname << endl;
+	}
+    }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+int
+PHG4HitCompress::process_event(PHCompositeNode *topNode)
+{
+  for (vector<string>::const_iterator hiter = hitnodes.begin(); hiter != hitnodes.end(); ++hiter)
+    {
+      PHG4HitContainer *hits = findNode::getClass<PHG4HitContainer>(topNode, *hiter);
+      PHG4HitColumns *columns = findNode::getClass<PHG4HitColumns>(topNode, *hiter + "_COLUMNS");
+      if (!hits || !columns)
+	{
+	  cout << PHWHERE << " missing node " << *hiter << " or " << *hiter << "_COLUMNS" << endl;
+	  return Fun4AllReturnCodes::ABORTRUN;
+	}
+      columns->Fill(hits);
+    }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
@@ -0,0 +1,33 @@
+#ifndef PHG4HITCOMPRESS_H
+#define PHG4HITCOMPRESS_H
+
+#include <fun4all/SubsysReco.h>
+
+#include <string>
+#include <vector>
+
+/*!
+  copies PHG4HitContainer nodes into columnar PHG4HitColumns nodes
+  (named <hitnode>_COLUMNS, placed next to the hit node) for the DST
+  output. The hit nodes are made transient so only the columns are
+  written, PHG4HitColumnsReadBack restores the hit nodes when reading
+*/
+class PHG4HitCompress: public SubsysReco
+{
+ public:
+  PHG4HitCompress(const std::string &name = "PHG4HitCompress");
+  virtual ~PHG4HitCompress() {}
+  int InitRun(PHCompositeNode *topNode);
+  int process_event(PHCompositeNode *topNode);
+
+  //! hit node to compress, e.g. G4HIT_CEMC
+  void AddNode(const std::string &hitnode) {hitnodes.push_back(hitnode);}
+  //! keep writing the hit nodes as well (default: make them transient)
+  void KeepHits(const int i = 1) {keephits = i;}
+
+ protected:
+  std::vector<std::string> hitnodes;
+  int keephits;
+};
+
+#endif
@@ -10,24 +10,94 @@
 
 using namespace std;
 
+bool PHG4HitContainer::recycle_default = false;
+
 PHG4HitContainer::PHG4HitContainer()
-  : id(-1), hitmap(), layers()
+  : id(-1), hitmap(), layers(),
+    recycle(recycle_default),
+    nallocated(0),
+    nrecycled(0)
 {
 }
 
 PHG4HitContainer::PHG4HitContainer(const std::string &nodename)
-  : id(PHG4HitDefs::get_volume_id(nodename)), hitmap(), layers()
+  : id(PHG4HitDefs::get_volume_id(nodename)), hitmap(), layers(),
+    recycle(recycle_default),
+    nallocated(0),
+    nrecycled(0)
+{
+}
+
+PHG4HitContainer::~PHG4HitContainer()
 {
+  Recycle(false);
 }
 
 void
 PHG4HitContainer::Reset()
 {
-   while(hitmap.begin() != hitmap.end())
-     {
-       delete hitmap.begin()->second;
-       hitmap.erase(hitmap.begin());
-     }
+  for (Iterator iter = hitmap.begin(); iter != hitmap.end(); ++iter)
+    {
+      ReleaseHit(iter->second);
+    }
+  hitmap.clear();
+  return;
+}
+
+void
+PHG4HitContainer::Recycle(const bool b)
+{
+  recycle = b;
+  if (!recycle)
+    {
+      while (!freehits.empty())
+	{
+	  delete freehits.back();
+	  freehits.pop_back();
+	}
+    }
+  return;
+}
+
+PHG4Hit *
+PHG4HitContainer::NewHit()
+{
+  if (!freehits.empty())
+    {
+      PHG4Hit *hit = freehits.back();
+      freehits.pop_back();
+      nrecycled++;
+      return hit;
+    }
+  nallocated++;
+  return new PHG4Hitv1();
+}
+
+void
+PHG4HitContainer::ReleaseHit(PHG4Hit *hit)
+{
+  // only our own hit type goes on the free list, NewHit() hands out PHG4Hitv1.
+  // Hits made with new (or read from a DST) are not counted in nallocated,
+  // the free list never holds more hits than NewHit() allocated
+  if (recycle && hit->IsA() == PHG4Hitv1::Class() && freehits.size() < nallocated)
+    {
+      hit->Reset();
+      freehits.push_back(hit);
+    }
+  else
+    {
+      delete hit;
+    }
+  return;
+}
+
+void
+PHG4HitContainer::PrintAllocStats(ostream& os) const
+{
+  os << "hits allocated: " << nallocated
+     << ", recycled: " << nrecycled
+     << ", on free list: " << freehits.size()
+     << (recycle ? "" : " (recycling off)") << endl;
   return;
 }
 
@@ -47,6 +117,7 @@ PHG4HitContainer::identify(ostream& os) const
      {
        os << "layer : " << *siter << endl;
      }
+   PrintAllocStats(os);
   return;
 }
 
@@ -154,7 +225,7 @@ PHG4HitContainer::Iterator PHG4HitContainer::findOrAddHit(PHG4HitDefs::keytype k
   PHG4HitContainer::Iterator it = hitmap.find(key);
   if(it == hitmap.end())
   {
-    hitmap[key] = new PHG4Hitv1();
+    hitmap[key] = NewHit();
     it = hitmap.find(key);
     PHG4Hit* mhit = it->second;
     mhit->set_hit_id(key);
@@ -175,6 +246,24 @@ PHG4Hit* PHG4HitContainer::findHit(PHG4HitDefs::keytype key)
   return NULL;
 }
 
+void
+PHG4HitContainer::MoveHits(PHG4HitContainer *other, std::map<PHG4HitDefs::keytype, PHG4HitDefs::keytype> &newids)
+{
+  for (Iterator iter = other->hitmap.begin(); iter != other->hitmap.end(); ++iter)
+    {
+      unsigned int detid = iter->first >> PHG4HitDefs::hit_idbits;
+      ConstIterator newhit = AddHit(detid, iter->second);
+      newids[iter->first] = newhit->first;
+      if (other->recycle && !freehits.empty())
+	{
+	  other->freehits.push_back(freehits.back());
+	  freehits.pop_back();
+	}
+    }
+  other->hitmap.clear();
+  return;
+}
+
 void
 PHG4HitContainer::RemoveZeroEDep()
 {
@@ -186,7 +275,7 @@ PHG4HitContainer::RemoveZeroEDep()
       PHG4Hit *hit = itr->second;
       if (hit->get_edep() == 0)
         {
-          delete hit;
+          ReleaseHit(hit);
           hitmap.erase(itr++);
         }
       else
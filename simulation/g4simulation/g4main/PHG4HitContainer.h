@@ -7,6 +7,7 @@
 #include <map>
 #include <set>
 #include <string>
+#include <vector>
 class PHG4Hit;
 
 class PHG4HitContainer: public PHObject
@@ -23,7 +24,7 @@ class PHG4HitContainer: public PHObject
   PHG4HitContainer(); //< used only by ROOT for DST readback
   PHG4HitContainer(const std::string &nodename);
 
-  virtual ~PHG4HitContainer() {}
+  virtual ~PHG4HitContainer();
 
   void Reset();
 
@@ -57,14 +58,42 @@ class PHG4HitContainer: public PHObject
      { return make_pair(layers.begin(), layers.end());} 
   void AddLayer(const unsigned int ilayer) {layers.insert(ilayer);}
   void RemoveZeroEDep();
+
+  //! moves the hits of other into this container with new hit ids (newids: old id -> new id),
+  //! other is empty afterwards. With recycling the same number of free hits goes back to
+  //! other, the hits circulate to the container which allocates them
+  void MoveHits(PHG4HitContainer *other, std::map<PHG4HitDefs::keytype, PHG4HitDefs::keytype> &newids);
   PHG4HitDefs::keytype getmaxkey(const unsigned int detid);
 
+  //! returns an empty PHG4Hitv1, taken from the free list if recycling is on
+  //! (ownership goes back to the container via AddHit)
+  PHG4Hit *NewHit();
+
+  //! keep the hits of the last event on a free list in Reset() instead of deleting them
+  void Recycle(const bool b = true);
+  bool Recycle() const {return recycle;}
+  //! recycling mode of containers created after this call
+  static void RecycleDefault(const bool b) {recycle_default = b;}
+
+  //! number of hits allocated with new by NewHit() and handed out from the free list
+  unsigned long get_nallocated() const {return nallocated;}
+  unsigned long get_nrecycled() const {return nrecycled;}
+  void PrintAllocStats(std::ostream& os = std::cout) const;
+
  protected:
+  void ReleaseHit(PHG4Hit *hit);
 
   int id; //< unique identifier from hash of node name. Defined following PHG4HitDefs::get_volume_id
   Map hitmap;
   std::set<unsigned int> layers; // layers is not reset since layers must not change event by event
 
+  bool recycle; //! transient, recycling mode
+  std::vector<PHG4Hit *> freehits; //! transient, hits kept from previous events
+  unsigned long nallocated; //! transient
+  unsigned long nrecycled; //! transient
+
+  static bool recycle_default;
+
   ClassDef(PHG4HitContainer,1)
 };
 
@@ -9,6 +9,7 @@
 #pragma link C++ class PHG4EventHeaderv1+;
 #pragma link C++ class PHG4Hit+;
 #pragma link C++ class PHG4Hitv1+;
+#pragma link C++ class PHG4HitColumns+;
 #pragma link C++ class PHG4HitEval+;
 #pragma link C++ class PHG4HitContainer+;
 #pragma link C++ class PHG4InEvent+;
@@ -12,6 +12,7 @@ ClassImp(PHG4Hitv1)
 PHG4Hitv1::PHG4Hitv1():
  hitid(ULONG_LONG_MAX),
  trackid(INT_MIN),
+ showerid(INT_MIN),
  edep(NAN)
 {
   for (int i = 0; i<2;i++)
@@ -34,6 +35,7 @@ PHG4Hitv1::Reset()
 {
   hitid = ULONG_LONG_MAX;
   trackid = INT_MIN;
+  showerid = INT_MIN;
   edep = NAN;
   for (int i = 0; i<2;i++)
     {
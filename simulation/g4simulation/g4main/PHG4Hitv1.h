@@ -96,6 +96,8 @@ class PHG4Hitv1 : public PHG4Hit
   virtual void set_hit_type(const int i) {set_property(prop_hit_type,i);}
 
  protected:
+  //! reads prop_map directly
+  friend class PHG4HitColumns;
   unsigned int get_property_nocheck(const PROPERTY prop_id) const;
   void set_property_nocheck(const PROPERTY prop_id,const unsigned int ui) {prop_map[prop_id]=ui;}
   // Store both the entry and exit points of the particle
@@ -3,6 +3,8 @@
 #pragma link C++ class HepMCNodeReader-!;
 #pragma link C++ class PHG4ConsistencyCheck-!;
 #pragma link C++ class PHG4HeadReco-!;
+#pragma link C++ class PHG4HitColumnsReadBack-!;
+#pragma link C++ class PHG4HitCompress-!;
 #pragma link C++ class PHG4InEventCompress-!;
 #pragma link C++ class PHG4InEventReadBack-!;
 #pragma link C++ class PHG4InputFilter-!;
@@ -12,8 +14,10 @@
 #pragma link C++ class PHG4ParticleGeneratorVectorMeson-!;
 #pragma link C++ class PHG4ParticleGeneratorD0-!;
 #pragma link C++ class PHG4Reco-!;
+#pragma link C++ class PHG4ShowerLibraryMaker-!;
 #pragma link C++ class PHG4SimpleEventGenerator-!;
 #pragma link C++ class PHG4PileupGenerator-!;
+#pragma link C++ class PHG4PileupOverlay-!;
 #pragma link C++ class PHG4Subsystem-!;
 #pragma link C++ class PHG4TruthSubsystem-!;
 //#pragma link C++ class PHG4UIsession-!;
@@ -1,5 +1,6 @@
 #include "PHG4PhenixDetector.h"
 #include "PHG4Detector.h"
+#include "PHG4GeometrySnapshot.h"
 #include "PHG4RegionInformation.h"
 
 #include <phool/recoConsts.h>
@@ -7,6 +8,7 @@
 #include <Geant4/G4Box.hh>
 #include <Geant4/G4Element.hh>
 #include <Geant4/G4GeometryManager.hh>
+#include <Geant4/G4LogicalVolume.hh>
 #include <Geant4/G4LogicalVolumeStore.hh>
 #include <Geant4/G4Material.hh>
 #include <Geant4/G4PhysicalVolumeStore.hh>
@@ -18,6 +20,7 @@
 #include <Geant4/G4Tubs.hh>
 #include <Geant4/G4VisAttributes.hh>
 
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 
@@ -92,12 +95,32 @@ G4VPhysicalVolume* PHG4PhenixDetector::Construct()
 	      << "material " << logicWorld->GetMaterial()->GetName() << " done." << std::endl;
   }
   
-  // construct all detectors
+  // construct all detectors, the volumes they place in the world are
+  // the roots of their regions
+  topVolumes_.clear();
   for( DetectorList::iterator iter = detectors_.begin(); iter != detectors_.end(); ++iter )
   {
     if( *iter )
     {
-      (*iter)->Construct( logicWorld );
+      int ndaughters = logicWorld->GetNoDaughters();
+      std::map<PHG4Detector*, std::string>::const_iterator snapshot = snapshots_.find(*iter);
+      if (snapshot == snapshots_.end() || PHG4GeometrySnapshot::Read(snapshot->second, *iter, logicWorld))
+	{
+	  (*iter)->Construct( logicWorld );
+	  if (snapshot != snapshots_.end())
+	    {
+	      PHG4GeometrySnapshot::Write(snapshot->second, *iter, logicWorld, ndaughters);
+	    }
+	}
+      std::vector<G4LogicalVolume*> &volumes = topVolumes_[*iter];
+      for (int i = ndaughters; i < logicWorld->GetNoDaughters(); i++)
+	{
+	  G4LogicalVolume *logvol = logicWorld->GetDaughter(i)->GetLogicalVolume();
+	  if (find(volumes.begin(), volumes.end(), logvol) == volumes.end())
+	    {
+	      volumes.push_back(logvol);
+	    }
+	}
     }
   }
 
@@ -106,3 +129,15 @@ G4VPhysicalVolume* PHG4PhenixDetector::Construct()
   return physiWorld;
 }
 
+
+const std::vector<G4LogicalVolume*> &
+PHG4PhenixDetector::GetTopVolumes(PHG4Detector *detector) const
+{
+  static const std::vector<G4LogicalVolume*> novolumes;
+  std::map<PHG4Detector*, std::vector<G4LogicalVolume*> >::const_iterator iter = topVolumes_.find(detector);
+  if (iter == topVolumes_.end())
+    {
+      return novolumes;
+    }
+  return iter->second;
+}
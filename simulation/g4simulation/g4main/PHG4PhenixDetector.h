@@ -4,6 +4,9 @@
 #include <Geant4/G4VUserDetectorConstruction.hh>
 #include <Geant4/globals.hh>
 #include <list>
+#include <map>
+#include <string>
+#include <vector>
 
 class PHG4Detector;
 class G4Material;
@@ -47,6 +50,12 @@ class PHG4PhenixDetector: public G4VUserDetectorConstruction
   void SetWorldMaterial(const std::string &s) {worldmaterial = s;}
   G4VPhysicalVolume* GetPhysicalVolume(void) {return physiWorld;}
 
+  //! load the detector from the snapshot filename (.gdml/.tags) if it exists, write it otherwise (PHG4GeometrySnapshot)
+  void SetSnapshot(PHG4Detector *detector, const std::string &filename) {snapshots_[detector] = filename;}
+
+  //! logical volumes a detector placed directly in the world (valid after Construct)
+  const std::vector<G4LogicalVolume*> &GetTopVolumes(PHG4Detector *detector) const;
+
   protected:
 
   private:
@@ -56,6 +65,12 @@ class PHG4PhenixDetector: public G4VUserDetectorConstruction
   typedef std::list<PHG4Detector*> DetectorList;
   DetectorList detectors_;
 
+  //! world daughters placed by each detector
+  std::map<PHG4Detector*, std::vector<G4LogicalVolume*> > topVolumes_;
+
+  //! snapshot file names by detector
+  std::map<PHG4Detector*, std::string> snapshots_;
+
   G4Material* defaultMaterial;
 
   G4LogicalVolume* logicWorld; //pointer to the logical World
@@ -1,6 +1,22 @@
 #include "PHG4PhenixSteppingAction.h"
 #include "PHG4SteppingAction.h"
 
+#include <Geant4/G4LogicalVolume.hh>
+#include <Geant4/G4PhysicalVolumeStore.hh>
+#include <Geant4/G4Region.hh>
+#include <Geant4/G4Step.hh>
+#include <Geant4/G4StepPoint.hh>
+#include <Geant4/G4SystemOfUnits.hh>
+#include <Geant4/G4TouchableHandle.hh>
+#include <Geant4/G4Track.hh>
+#include <Geant4/G4VPhysicalVolume.hh>
+
+#include <iostream>
+#include <map>
+#include <string>
+
+using namespace std;
+
 PHG4PhenixSteppingAction::~PHG4PhenixSteppingAction()
 {
   while (actions_.begin() != actions_.end())
@@ -10,18 +26,148 @@ PHG4PhenixSteppingAction::~PHG4PhenixSteppingAction()
     }
 }
 
+//_________________________________________________________________
+void PHG4PhenixSteppingAction::BuildDispatchTable()
+{
+  dispatch_.clear();
+  G4PhysicalVolumeStore *store = G4PhysicalVolumeStore::GetInstance();
+  size_t nowned = 0;
+  for (G4PhysicalVolumeStore::const_iterator iter = store->begin(); iter != store->end(); ++iter)
+    {
+      nowned += AddVolume(*iter).actions.size();
+    }
+  if (verbosity > 0)
+    {
+      cout << "PHG4PhenixSteppingAction: dispatch table for " << dispatch_.size()
+	   << " volumes, " << nowned << " volume/action pairs for "
+	   << actions_.size() << " stepping actions" << endl;
+    }
+}
 
 //_________________________________________________________________
-void PHG4PhenixSteppingAction::UserSteppingAction( const G4Step* aStep )
+PHG4PhenixSteppingAction::VolumeEntry &PHG4PhenixSteppingAction::AddVolume(G4VPhysicalVolume *volume)
 {
-  // loop over registered actions, and process
-  bool hit_was_used = false;
+  VolumeEntry &entry = dispatch_[volume];
+  entry.actions.clear();
+  entry.passive = false;
+  entry.nsteps = 0;
+  bool marked = false;
+  bool owned = false;
   for( ActionList::const_iterator iter = actions_.begin(); iter != actions_.end(); ++iter )
   {
-    if(*iter)
+    if (!*iter)
+      {
+	continue;
+      }
+    // actions which cannot tell (VOLUME_UNKNOWN) get every step
+    int inside = (*iter)->IsInDetector(volume);
+    if (inside == PHG4SteppingAction::VOLUME_PASSIVE)
+      {
+	marked = true;
+      }
+    else if (inside != PHG4SteppingAction::VOLUME_OTHER)
+      {
+	owned = true;
+      }
+    if (!dispatch || (inside != PHG4SteppingAction::VOLUME_PASSIVE && inside != PHG4SteppingAction::VOLUME_OTHER))
+      {
+	entry.actions.push_back(*iter);
+      }
+  }
+  // tracks only pass through the world and mother volumes (envelopes), the
+  // kill would reach the daughters they are about to enter
+  if (marked && !owned && volume->GetMotherLogical() && !volume->GetLogicalVolume()->GetNoDaughters())
     {
-      hit_was_used |= (*iter)->UserSteppingAction( aStep, hit_was_used );
+      entry.passive = true;
     }
+  return entry;
+}
+
+//_________________________________________________________________
+PHG4PhenixSteppingAction::VolumeEntry &PHG4PhenixSteppingAction::GetEntry(const G4Step *step)
+{
+  G4VPhysicalVolume *volume = step->GetPreStepPoint()->GetTouchableHandle()->GetVolume();
+  DispatchMap::iterator found = dispatch_.find(volume);
+  VolumeEntry &entry = (found != dispatch_.end()) ? found->second : AddVolume(volume);
+  entry.nsteps++;
+  return entry;
+}
+
+//_________________________________________________________________
+void PHG4PhenixSteppingAction::Dispatch(const VolumeEntry &entry, const G4Step *step)
+{
+  // loop over the actions for this volume, and process
+  // skipped actions would have returned false, so hit_was_used is the same
+  // as calling all registered actions
+  bool hit_was_used = false;
+  for( vector<PHG4SteppingAction*>::const_iterator iter = entry.actions.begin(); iter != entry.actions.end(); ++iter )
+  {
+    hit_was_used |= (*iter)->UserSteppingAction( step, hit_was_used );
   }
+}
 
+//_________________________________________________________________
+void PHG4PhenixSteppingAction::DispatchStep( const G4Step* aStep )
+{
+  Dispatch(GetEntry(aStep), aStep);
+}
+
+//_________________________________________________________________
+void PHG4PhenixSteppingAction::UserSteppingAction( const G4Step* aStep )
+{
+  VolumeEntry &entry = GetEntry(aStep);
+
+  // kill before the actions run, so they see the stopped track and
+  // save their hits as for any other track which ends here
+  G4Track *track = aStep->GetTrack();
+  if (track->GetTrackStatus() != fStopAndKill)
+    {
+      if (time_window >= 0 && track->GetGlobalTime() > time_window)
+	{
+	  track->SetTrackStatus(fStopAndKill);
+	  nkilled_time++;
+	}
+      else if (entry.passive && track->GetKineticEnergy() < passive_ekin)
+	{
+	  track->SetTrackStatus(fStopAndKill);
+	  nkilled_passive++;
+	}
+    }
+
+  Dispatch(entry, aStep);
+}
+
+//_________________________________________________________________
+void PHG4PhenixSteppingAction::PrintSummary() const
+{
+  map<string, unsigned long> regionsteps;
+  unsigned long nsteps = 0;
+  unsigned long npassive = 0;
+  for (DispatchMap::const_iterator iter = dispatch_.begin(); iter != dispatch_.end(); ++iter)
+    {
+      if (!iter->second.nsteps)
+	{
+	  continue;
+	}
+      G4Region *region = iter->first->GetLogicalVolume()->GetRegion();
+      regionsteps[region ? region->GetName() : "none"] += iter->second.nsteps;
+      nsteps += iter->second.nsteps;
+      if (iter->second.passive)
+	{
+	  npassive += iter->second.nsteps;
+	}
+    }
+  cout << "PHG4PhenixSteppingAction: " << nsteps << " steps, " << npassive << " in passive volumes" << endl;
+  for (map<string, unsigned long>::const_iterator iter = regionsteps.begin(); iter != regionsteps.end(); ++iter)
+    {
+      cout << "  region " << iter->first << ": " << iter->second << " steps" << endl;
+    }
+  if (time_window >= 0)
+    {
+      cout << "  " << nkilled_time << " tracks killed after " << time_window / ns << " ns" << endl;
+    }
+  if (passive_ekin >= 0)
+    {
+      cout << "  " << nkilled_passive << " tracks killed below " << passive_ekin / MeV << " MeV in passive volumes" << endl;
+    }
 }
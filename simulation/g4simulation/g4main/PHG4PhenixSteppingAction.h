@@ -3,8 +3,11 @@
 
 #include <Geant4/G4UserSteppingAction.hh>
 #include <list>
+#include <unordered_map>
+#include <vector>
 
 class G4Step;
+class G4VPhysicalVolume;
 class PHG4SteppingAction;
 class PHCompositeNode;
 
@@ -12,7 +15,13 @@ class PHG4PhenixSteppingAction : public G4UserSteppingAction
 {
 
   public:
-  PHG4PhenixSteppingAction( void )
+  PHG4PhenixSteppingAction( void ):
+    time_window(-1),
+    passive_ekin(-1),
+    dispatch(true),
+    nkilled_time(0),
+    nkilled_passive(0),
+    verbosity(0)
   {}
 
   virtual ~PHG4PhenixSteppingAction();
@@ -24,17 +33,74 @@ class PHG4PhenixSteppingAction : public G4UserSteppingAction
     if (action)
       {
 	actions_.push_back( action );
+	dispatch_.clear();
       }
   }
 
+  //! map every physical volume to the actions owning it (PHG4SteppingAction::IsInDetector)
+  /*!
+  has to be called after the geometry is constructed. Volumes which are not in the
+  table yet (placed later or the table was never built) are added on their first step
+  */
+  void BuildDispatchTable();
+
+  //! false: every action is called for every step, the way it was before the dispatch table
+  void DispatchSteps(const bool b) {dispatch = b; dispatch_.clear();}
+
   virtual void UserSteppingAction(const G4Step*);
 
+  //! hand the step to the actions owning its volume, without the time window and passive kill
+  /*!
+  for the steps PHG4ShowerLibraryModel makes from replayed deposits, which are not
+  transported and whose stand in track must not be killed
+  */
+  void DispatchStep(const G4Step*);
+
+  void Verbosity(const int i) {verbosity = i;}
+
+  //! kill tracks when their global time exceeds t (G4 units), negative: never
+  void SetTimeWindow(const double t) {time_window = t;}
+
+  //! kill tracks below kinetic energy e (G4 units) in volumes marked VOLUME_PASSIVE, negative: never
+  void SetPassiveKillEnergy(const double e) {passive_ekin = e;}
+
+  //! steps per region and in passive volumes, and the number of killed tracks
+  void PrintSummary() const;
+
   private:
 
+  struct VolumeEntry
+  {
+    //! actions to be called for steps starting in the volume, in the order of registration
+    std::vector<PHG4SteppingAction*> actions;
+    //! marked VOLUME_PASSIVE and no action owns it or might own it, never the world or a mother volume
+    bool passive;
+    unsigned long nsteps;
+  };
+
+  VolumeEntry &AddVolume(G4VPhysicalVolume *volume);
+
+  //! the entry of the volume the step starts in
+  VolumeEntry &GetEntry(const G4Step *step);
+
+  //! call the actions of the entry
+  void Dispatch(const VolumeEntry &entry, const G4Step *step);
+
   //! list of subsystem specific stepping actions
   typedef std::list<PHG4SteppingAction*> ActionList;
   ActionList actions_;
 
+  //! actions which own the volume plus the ones which need every step
+  typedef std::unordered_map<G4VPhysicalVolume*, VolumeEntry> DispatchMap;
+  DispatchMap dispatch_;
+
+  double time_window;
+  double passive_ekin;
+  bool dispatch;
+  unsigned long nkilled_time;
+  unsigned long nkilled_passive;
+
+  int verbosity;
 };
 
 
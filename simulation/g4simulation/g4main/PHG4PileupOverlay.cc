@@ -0,0 +1,220 @@
+#include "PHG4PileupOverlay.h"
+#include "PHG4Hit.h"
+#include "PHG4HitColumns.h"
+#include "PHG4HitContainer.h"
+#include "PHG4Particlev2.h"
+#include "PHG4TruthInfoContainer.h"
+#include "PHG4VtxPointv1.h"
+
+#include <fun4all/Fun4AllReturnCodes.h>
+
+#include <phool/getClass.h>
+#include <phool/PHCompositeNode.h>
+#include <phool/PHNodeIOManager.h>
+#include <phool/PHRandomSeed.h>
+#include <phool/phool.h>
+
+#include <gsl/gsl_randist.h>
+
+#include <climits>
+#include <iostream>
+
+using namespace std;
+
+PHG4PileupOverlay::PHG4PileupOverlay(const string &name)
+    : SubsysReco(name),
+      _ifile(0),
+      _iomanager(NULL),
+      _pileupNode(new PHCompositeNode("DST")),
+      _min_integration_time(-1000.0),
+      _max_integration_time(+1000.0),
+      _collision_rate(100.0),
+      _time_between_crossings(106.0),
+      _ave_coll_per_crossing(1.0), // recalculated
+      _min_crossing(0),            // recalculated
+      _max_crossing(0),            // recalculated
+      _embedflag(0),
+      _rng(gsl_rng_alloc(gsl_rng_mt19937)),
+      _ncollisions(0),
+      _nhits(0) {
+  set_seed(PHRandomSeed()); // fixed seed is handled in this function
+  return;
+}
+
+PHG4PileupOverlay::~PHG4PileupOverlay() {
+  delete _iomanager;
+  delete _pileupNode;
+  for (map<string, PHG4HitContainer*>::const_iterator iter = _unpacked.begin(); iter != _unpacked.end(); ++iter) {
+    delete iter->second;
+  }
+  gsl_rng_free(_rng);
+}
+
+void PHG4PileupOverlay::set_seed(const unsigned int iseed) {
+  cout << Name() << " random seed: " << iseed << endl;
+  gsl_rng_set(_rng, iseed);
+}
+
+int PHG4PileupOverlay::InitRun(PHCompositeNode *topNode) {
+
+  if (_files.empty()) {
+    cout << PHWHERE << " no minimum bias files (AddFile)" << endl;
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+  for (vector<string>::const_iterator iter = _hitnodes.begin(); iter != _hitnodes.end(); ++iter) {
+    if (!findNode::getClass<PHG4HitContainer>(topNode, *iter)) {
+      cout << PHWHERE << " no hit node " << *iter << " in the signal event" << endl;
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
+  }
+
+  _ave_coll_per_crossing = _collision_rate * _time_between_crossings * 1000.0 * 1e-9;
+
+  _min_crossing = _min_integration_time / _time_between_crossings;
+  _max_crossing = _max_integration_time / _time_between_crossings;
+
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+int PHG4PileupOverlay::process_event(PHCompositeNode *topNode) {
+
+  PHG4TruthInfoContainer *truth = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
+  if (!truth) {
+    cout << PHWHERE << " no G4TruthInfo node" << endl;
+    return Fun4AllReturnCodes::ABORTRUN;
+  }
+
+  // same crossing model as PHG4PileupGenerator, the signal is one of
+  // the collisions of the triggered crossing
+  for (int icrossing = _min_crossing; icrossing <= _max_crossing; ++icrossing) {
+
+    double crossing_time = _time_between_crossings * icrossing;
+
+    int ncollisions = gsl_ran_poisson(_rng,_ave_coll_per_crossing);
+    if (icrossing == 0) --ncollisions;
+
+    for (int icollision = 0; icollision < ncollisions; ++icollision) {
+      if (ReadNextEvent() || Overlay(topNode, truth, crossing_time)) {
+        return Fun4AllReturnCodes::ABORTRUN;
+      }
+    }
+  }
+
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+int PHG4PileupOverlay::End(PHCompositeNode *topNode) {
+  cout << Name() << ": overlaid " << _ncollisions << " minimum bias events with "
+       << _nhits << " hits" << endl;
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+int PHG4PileupOverlay::ReadNextEvent() {
+
+  // one pass over all files without a single event is an error
+  for (unsigned int itry = 0; itry <= _files.size(); ++itry) {
+    if (_iomanager && _iomanager->read(_pileupNode)) {
+      return 0;
+    }
+    delete _iomanager;
+    const string &filename = _files[_ifile];
+    _ifile = (_ifile + 1) % _files.size();
+    if (verbosity > 0) {
+      cout << Name() << ": opening minimum bias file " << filename << endl;
+    }
+    _iomanager = new PHNodeIOManager(filename, PHReadOnly);
+    if (!_iomanager->isFunctional()) {
+      cout << PHWHERE << " could not open " << filename << endl;
+      delete _iomanager;
+      _iomanager = NULL;
+      return -1;
+    }
+  }
+  cout << PHWHERE << " no events in the minimum bias files" << endl;
+  return -1;
+}
+
+PHG4HitContainer *PHG4PileupOverlay::GetPileupHits(const string &hitnode) {
+
+  PHG4HitContainer *hits = findNode::getClass<PHG4HitContainer>(_pileupNode, hitnode);
+  if (hits) return hits;
+
+  PHG4HitColumns *columns = findNode::getClass<PHG4HitColumns>(_pileupNode, hitnode + "_COLUMNS");
+  if (!columns) return NULL;
+
+  PHG4HitContainer *&unpacked = _unpacked[hitnode];
+  if (!unpacked) unpacked = new PHG4HitContainer(hitnode);
+  unpacked->Reset();
+  columns->Unpack(unpacked);
+  return unpacked;
+}
+
+int PHG4PileupOverlay::Overlay(PHCompositeNode *topNode, PHG4TruthInfoContainer *truth, const double crossing_time) {
+
+  PHG4TruthInfoContainer *pileuptruth = findNode::getClass<PHG4TruthInfoContainer>(_pileupNode, "G4TruthInfo");
+  if (!pileuptruth) {
+    cout << PHWHERE << " no G4TruthInfo in the minimum bias event" << endl;
+    return -1;
+  }
+
+  // primaries (positive ids) go above, secondaries (negative ids) below
+  // everything which is already there
+  int trkoffset_primary = truth->maxtrkindex();
+  int trkoffset_secondary = truth->mintrkindex();
+  int vtxoffset_primary = truth->maxvtxindex();
+  int vtxoffset_secondary = truth->minvtxindex();
+
+  PHG4TruthInfoContainer::ConstVtxRange vtxrange = pileuptruth->GetVtxRange();
+  for (PHG4TruthInfoContainer::ConstVtxIterator iter = vtxrange.first; iter != vtxrange.second; ++iter) {
+    int vtxid = iter->first + ((iter->first > 0) ? vtxoffset_primary : vtxoffset_secondary);
+    PHG4VtxPoint *vtx = new PHG4VtxPointv1(iter->second);
+    vtx->set_id(vtxid);
+    vtx->set_t(vtx->get_t() + crossing_time);
+    truth->AddVertex(vtxid, vtx);
+  }
+
+  PHG4TruthInfoContainer::ConstRange range = pileuptruth->GetParticleRange();
+  for (PHG4TruthInfoContainer::ConstIterator iter = range.first; iter != range.second; ++iter) {
+    const PHG4Particle *in = iter->second;
+    int trkid = iter->first + ((iter->first > 0) ? trkoffset_primary : trkoffset_secondary);
+    int vtxid = in->get_vtx_id() + ((in->get_vtx_id() > 0) ? vtxoffset_primary : vtxoffset_secondary);
+    PHG4Particle *particle = new PHG4Particlev2(in);
+    particle->set_track_id(trkid);
+    particle->set_vtx_id(vtxid);
+    // parent id 0 marks primaries
+    if (in->get_parent_id() != 0) {
+      particle->set_parent_id(in->get_parent_id() + ((in->get_parent_id() > 0) ? trkoffset_primary : trkoffset_secondary));
+    }
+    particle->set_primary_id(in->get_primary_id() + trkoffset_primary);
+    particle->set_e(in->get_e());
+    truth->AddParticle(trkid, particle);
+    if (_embedflag != 0 && iter->first > 0) {
+      truth->AddEmbededTrkId(trkid, _embedflag);
+    }
+  }
+
+  for (vector<string>::const_iterator niter = _hitnodes.begin(); niter != _hitnodes.end(); ++niter) {
+    PHG4HitContainer *hits = findNode::getClass<PHG4HitContainer>(topNode, *niter);
+    PHG4HitContainer *pileuphits = GetPileupHits(*niter);
+    if (!pileuphits) {
+      cout << PHWHERE << " no " << *niter << " in the minimum bias event" << endl;
+      return -1;
+    }
+    PHG4HitContainer::ConstRange hitrange = pileuphits->getHits();
+    for (PHG4HitContainer::ConstIterator hiter = hitrange.first; hiter != hitrange.second; ++hiter) {
+      const PHG4Hit *in = hiter->second;
+      PHG4Hit *hit = hits->NewHit();
+      hit->Copy(*in);
+      for (int i = 0; i < 2; i++) {
+        hit->set_t(i, in->get_t(i) + crossing_time);
+      }
+      hit->set_trkid(in->get_trkid() + ((in->get_trkid() > 0) ? trkoffset_primary : trkoffset_secondary));
+      // Copy() does not touch the shower id and the pileup showers are not overlaid
+      hit->set_shower_id(INT_MIN);
+      hits->AddHit(in->get_detid(), hit);
+    }
+    _nhits += pileuphits->size();
+  }
+  _ncollisions++;
+  return 0;
+}
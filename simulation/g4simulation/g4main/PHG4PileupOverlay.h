@@ -0,0 +1,99 @@
+#ifndef PHG4PileupOverlay_H__
+#define PHG4PileupOverlay_H__
+
+#include <fun4all/SubsysReco.h>
+
+#include <gsl/gsl_rng.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+class PHCompositeNode;
+class PHG4HitContainer;
+class PHG4TruthInfoContainer;
+class PHNodeIOManager;
+
+/*!
+  hit level pileup: instead of running the pileup collisions through
+  geant (PHG4PileupGenerator) the G4Hits of minimum bias events from
+  previously simulated DSTs are added to the hit nodes of the signal
+  event. The number of collisions per crossing follows the same poisson
+  model as PHG4PileupGenerator, the hits are shifted by the crossing time.
+  The truth particles and vertices of the pileup events are added to
+  G4TruthInfo with ids above (primaries) and below (secondaries) the ones
+  already there, so the embedding flags of the signal stay valid.
+  Register it after PHG4Reco and before the cell reconstruction, e.g.
+
+    PHG4PileupOverlay *overlay = new PHG4PileupOverlay();
+    overlay->AddFile("minbias_g4hits.root");
+    overlay->AddNode("G4HIT_SVTX");
+    overlay->set_collision_rate(200.);
+
+  The minbias DSTs need G4TruthInfo and the hit nodes, either as
+  PHG4HitContainer or as PHG4HitColumns (<hitnode>_COLUMNS).
+*/
+
+class PHG4PileupOverlay : public SubsysReco {
+
+public:
+
+  PHG4PileupOverlay(const std::string &name="PILEUPOVERLAY");
+  virtual ~PHG4PileupOverlay();
+
+  int InitRun(PHCompositeNode *topNode);
+  int process_event(PHCompositeNode *topNode);
+  int End(PHCompositeNode *topNode);
+
+  //! minimum bias DST, the files are used in turn and reused when all are read
+  void AddFile(const std::string &filename) {_files.push_back(filename);}
+  //! hit node to overlay, e.g. G4HIT_SVTX
+  void AddNode(const std::string &hitnode) {_hitnodes.push_back(hitnode);}
+
+  /// past times are negative, future times are positive
+  void set_time_window(double past_nsec,double future_nsec) {
+    _min_integration_time = past_nsec;
+    _max_integration_time = future_nsec;
+  }
+  void set_collision_rate(double kHz) {_collision_rate = kHz;}
+  void set_time_between_crossings(double nsec) {_time_between_crossings = nsec;}
+
+  //! embedding flag of the overlaid primaries (0: not embedded)
+  void Embed(const int i=1) {_embedflag = i;}
+  void set_seed(const unsigned int iseed);
+
+private:
+
+  //! read the next minbias event, opens the next file at the end of the current one
+  int ReadNextEvent();
+  //! add the current minbias event to the signal event
+  int Overlay(PHCompositeNode *topNode, PHG4TruthInfoContainer *truth, const double crossing_time);
+  //! hit node of the current minbias event
+  PHG4HitContainer *GetPileupHits(const std::string &hitnode);
+
+  std::vector<std::string> _files;
+  std::vector<std::string> _hitnodes;
+  unsigned int _ifile;
+
+  PHNodeIOManager *_iomanager;
+  PHCompositeNode *_pileupNode;
+  //! hit containers unpacked from PHG4HitColumns
+  std::map<std::string, PHG4HitContainer*> _unpacked;
+
+  double _min_integration_time;
+  double _max_integration_time;
+  double _collision_rate;
+  double _time_between_crossings;
+
+  double   _ave_coll_per_crossing;
+  int      _min_crossing;
+  int      _max_crossing;
+
+  int _embedflag;
+  gsl_rng *_rng;
+
+  unsigned long _ncollisions;
+  unsigned long _nhits;
+};
+
+#endif
@@ -1,16 +1,22 @@
 #include "PHG4Reco.h"
 
 #include "G4TBMagneticFieldSetup.hh"
+#include "PHG4ActionInitialization.h"
+#include "PHG4CerenkovPhysics.h"
 #include "PHG4InEvent.h"
 #include "PHG4PhenixDetector.h"
 #include "PHG4PhenixEventAction.h"
 #include "PHG4PhenixSteppingAction.h"
 #include "PHG4PhenixTrackingAction.h"
 #include "PHG4PrimaryGeneratorAction.h"
+#include "PHG4ShowerLibrary.h"
+#include "PHG4ShowerLibraryModel.h"
+#include "PHG4SubEvents.h"
 #include "PHG4Subsystem.h"
 #include "PHG4TrackingAction.h"
 #include "PHG4UIsession.h"
 #include "PHG4Utils.h"
+#include "PHG4WorkerGeneratorAction.h"
 
 #include <g4decayer/EDecayType.hh>
 #include <g4decayer/P6DExtDecayerPhysics.hh>
@@ -19,6 +25,7 @@
 
 #include <phool/PHCompositeNode.h>
 #include <phool/PHRandomSeed.h>
+#include <phool/PHTrace.h>
 #include <phool/getClass.h>
 #include <phool/recoConsts.h>
 
@@ -33,6 +40,9 @@
 #include <CLHEP/Random/Random.h>
 
 #include <Geant4/G4RunManager.hh>
+#ifdef G4MULTITHREADED
+#include <Geant4/G4MTRunManager.hh>
+#endif
 
 #include <Geant4/G4Material.hh>
 #include <Geant4/G4NistManager.hh>
@@ -44,7 +54,10 @@
 #include <Geant4/G4Cerenkov.hh>
 #include <Geant4/G4EmProcessOptions.hh>
 #include <Geant4/G4EmSaturation.hh>
+#include <Geant4/G4FastSimulationManagerProcess.hh>
 #include <Geant4/G4HadronicProcessStore.hh>
+#include <Geant4/G4LogicalVolume.hh>
+#include <Geant4/G4LogicalVolumeStore.hh>
 #include <Geant4/G4LossTableManager.hh>
 #include <Geant4/G4OpAbsorption.hh>
 #include <Geant4/G4OpBoundaryProcess.hh>
@@ -54,6 +67,8 @@
 #include <Geant4/G4OpticalPhoton.hh>
 #include <Geant4/G4OpticalPhysics.hh>
 #include <Geant4/G4PEEffectFluoModel.hh>
+#include <Geant4/G4ProductionCuts.hh>
+#include <Geant4/G4Region.hh>
 #include <Geant4/G4EmProcessOptions.hh>
 #include <Geant4/G4HadronicProcessStore.hh>
 #include <Geant4/G4StepLimiterPhysics.hh>
@@ -89,6 +104,8 @@
 #include <boost/foreach.hpp>
 
 #include <memory>
+#include <set>
+#include <sstream>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
@@ -127,6 +144,14 @@ PHG4Reco::PHG4Reco(const string &name)
   , active_force_decay_(false)
   , force_decay_type_(kAll)
   , save_DST_geometry_(true)
+  , rangecut(-1)
+  , time_window(-1)
+  , passive_ekin(-1)
+  , dispatch_steps(true)
+  , nthreads(0)
+  , nsubevents(0)
+  , subevents_(nullptr)
+  , actionInit_(nullptr)
   , _timer(PHTimeServer::get()->insert_new(name))
 {
   for (int i = 0; i < 3; i++)
@@ -144,8 +169,13 @@ PHG4Reco::~PHG4Reco(void)
   delete gui_thread;
   delete field_;
   delete runManager_;
+  delete subevents_;
   delete uisession_;
   delete visManager;
+  for (map<string, PHG4ShowerLibrary *>::const_iterator iter = showerlibraries.begin(); iter != showerlibraries.end(); ++iter)
+  {
+    delete iter->second;
+  }
   while (subsystems_.begin() != subsystems_.end())
   {
     delete subsystems_.back();
@@ -176,7 +206,27 @@ int PHG4Reco::Init(PHCompositeNode *topNode)
     uimanager->SetCoutDestination(uisession_);
   }
 
-  runManager_ = new G4RunManager();
+  if (nthreads > 1 && UseWorkerThreads())
+  {
+#ifdef G4MULTITHREADED
+    G4MTRunManager *mtrunmanager = new G4MTRunManager();
+    mtrunmanager->SetNumberOfThreads(nthreads);
+    // sub events are handed out one by one, they are only a few per BeamOn
+    mtrunmanager->SetEventModulo(1);
+    runManager_ = mtrunmanager;
+    subevents_ = new PHG4SubEvents((nsubevents > 0) ? nsubevents : nthreads);
+    subevents_->Verbosity(verbosity);
+    cout << Name() << " simulating events with " << nthreads << " G4 worker threads" << endl;
+#endif
+  }
+  else
+  {
+    if (nthreads > 1)
+    {
+      cout << Name() << " using the sequential run manager" << endl;
+    }
+    runManager_ = new G4RunManager();
+  }
 
   DefineMaterials();
 
@@ -232,6 +282,15 @@ int PHG4Reco::Init(PHCompositeNode *topNode)
     myphysicslist->RegisterPhysics(decayer);
   }
   myphysicslist->RegisterPhysics(new G4StepLimiterPhysics());
+  if (subevents_)
+  {
+    // process managers are thread local, only a physics constructor reaches the workers
+    myphysicslist->RegisterPhysics(new PHG4CerenkovPhysics());
+  }
+  if (rangecut > 0)
+  {
+    myphysicslist->SetDefaultCutValue(rangecut * cm);
+  }
   runManager_->SetUserInitialization(myphysicslist);
 
   // initialize registered subsystems
@@ -323,119 +382,123 @@ int PHG4Reco::InitRun(PHCompositeNode *topNode)
   rc->set_FloatFlag("WorldSizey", WorldSize[1]);
   rc->set_FloatFlag("WorldSizez", WorldSize[2]);
 
+  bool snapshots = !snapshotdir.empty();
+  if (snapshots)
+  {
+    try
+    {
+      boost::filesystem::create_directories(snapshotdir);
+    }
+    catch (const boost::filesystem::filesystem_error &e)
+    {
+      cout << PHWHERE << " cannot create snapshot directory " << snapshotdir
+           << ": " << e.what() << ", constructing all detectors" << endl;
+      snapshots = false;
+    }
+  }
   BOOST_FOREACH (PHG4Subsystem *g4sub, subsystems_)
   {
     detector_->AddDetector(g4sub->GetDetector());
+    if (snapshots && g4sub->GetDetector() && g4sub->GetGeometryHash())
+    {
+      // parameters, construction code version and geant4 version (gdml, solids)
+      ostringstream snapshot;
+      snapshot << snapshotdir << "/" << g4sub->Name()
+               << "_v" << g4sub->GetDetector()->GetGeometryVersion()
+               << "_g4" << G4VERSION_NUMBER
+               << "_" << hex << g4sub->GetGeometryHash();
+      detector_->SetSnapshot(g4sub->GetDetector(), snapshot.str());
+    }
   }
   runManager_->SetUserInitialization(detector_);
 
   setupInputEventNodeReader(topNode);
-  // create main event action, add subsystemts and register to GEANT
-  eventAction_ = new PHG4PhenixEventAction();
-
-  BOOST_FOREACH (PHG4Subsystem *g4sub, subsystems_)
+  if (subevents_)
   {
-    PHG4EventAction *evtact = g4sub->GetEventAction();
-    if (evtact)
-    {
-      eventAction_->AddAction(evtact);
-    }
+    InitWorkerThreads(topNode);
   }
-  runManager_->SetUserAction(eventAction_);
-
-  // create main stepping action, add subsystems and register to GEANT
-  steppingAction_ = new PHG4PhenixSteppingAction();
-  BOOST_FOREACH (PHG4Subsystem *g4sub, subsystems_)
+  else
   {
-    PHG4SteppingAction *action = g4sub->GetSteppingAction();
-    if (action)
+    // create main event action, add subsystemts and register to GEANT
+    eventAction_ = new PHG4PhenixEventAction();
+
+    BOOST_FOREACH (PHG4Subsystem *g4sub, subsystems_)
     {
-      if (verbosity > 1)
+      PHG4EventAction *evtact = g4sub->GetEventAction();
+      if (evtact)
       {
-        cout << "Adding steppingaction for " << g4sub->Name() << endl;
+        eventAction_->AddAction(evtact);
       }
-      steppingAction_->AddAction(g4sub->GetSteppingAction());
     }
-  }
-  runManager_->SetUserAction(steppingAction_);
+    runManager_->SetUserAction(eventAction_);
 
-  // create main tracking action, add subsystems and register to GEANT
-  trackingAction_ = new PHG4PhenixTrackingAction();
-  BOOST_FOREACH (PHG4Subsystem *g4sub, subsystems_)
-  {
-    trackingAction_->AddAction(g4sub->GetTrackingAction());
+    // create main stepping action, add subsystems and register to GEANT
+    steppingAction_ = new PHG4PhenixSteppingAction();
+    BOOST_FOREACH (PHG4Subsystem *g4sub, subsystems_)
+    {
+      PHG4SteppingAction *action = g4sub->GetSteppingAction();
+      if (action)
+      {
+        if (verbosity > 1)
+        {
+          cout << "Adding steppingaction for " << g4sub->Name() << endl;
+        }
+        steppingAction_->AddAction(g4sub->GetSteppingAction());
+      }
+    }
+    runManager_->SetUserAction(steppingAction_);
 
-    // not all subsystems define a user tracking action
-    if (g4sub->GetTrackingAction())
+    // create main tracking action, add subsystems and register to GEANT
+    trackingAction_ = new PHG4PhenixTrackingAction();
+    BOOST_FOREACH (PHG4Subsystem *g4sub, subsystems_)
     {
-      // make tracking manager accessible within user tracking action if defined
-      if (G4TrackingManager *trackingManager = G4EventManager::GetEventManager()->GetTrackingManager())
+      trackingAction_->AddAction(g4sub->GetTrackingAction());
+
+      // not all subsystems define a user tracking action
+      if (g4sub->GetTrackingAction())
       {
-        g4sub->GetTrackingAction()->SetTrackingManagerPointer(trackingManager);
+        // make tracking manager accessible within user tracking action if defined
+        if (G4TrackingManager *trackingManager = G4EventManager::GetEventManager()->GetTrackingManager())
+        {
+          g4sub->GetTrackingAction()->SetTrackingManagerPointer(trackingManager);
+        }
       }
     }
-  }
 
-  runManager_->SetUserAction(trackingAction_);
+    runManager_->SetUserAction(trackingAction_);
+  }
 
   // initialize
   runManager_->Initialize();
 
-  // add cerenkov and optical photon processes
-  // cout << endl << "Ignore the next message - we implemented this correctly" << endl;
-  G4Cerenkov *theCerenkovProcess = new G4Cerenkov("Cerenkov");
-  // cout << "End of bogus warning message" << endl << endl;
-  // G4Scintillation* theScintillationProcess      = new G4Scintillation("Scintillation");
-
-  /*
-    if (verbosity > 0)
+  // the geometry exists now, stepping actions only get the steps in their own volumes
+  if (subevents_)
+  {
+    for (unsigned int i = 0; i < actionInit_->size(); i++)
     {
-    // This segfaults
-    theCerenkovProcess->DumpPhysicsTable();
+      SetupSteppingAction(actionInit_->GetSteppingAction(i));
     }
-  */
-  theCerenkovProcess->SetMaxNumPhotonsPerStep(100);
-  theCerenkovProcess->SetMaxBetaChangePerStep(10.0);
-  theCerenkovProcess->SetTrackSecondariesFirst(true);
-
-  // theScintillationProcess->SetScintillationYieldFactor(1.);
-  // theScintillationProcess->SetTrackSecondariesFirst(true);
-
-  // Use Birks Correction in the Scintillation process
+  }
+  else
+  {
+    SetupSteppingAction(steppingAction_);
+  }
 
-  // G4EmSaturation* emSaturation = G4LossTableManager::Instance()->EmSaturation();
-  // theScintillationProcess->AddSaturation(emSaturation);
+  // before the shower libraries, they use the subsystem regions as envelopes
+  if (InitRegions())
+  {
+    gSystem->Exit(1);
+  }
+  if (InitShowerLibraries())
+  {
+    gSystem->Exit(1);
+  }
 
-  G4ParticleTable *theParticleTable = G4ParticleTable::GetParticleTable();
-  G4ParticleTable::G4PTblDicIterator *_theParticleIterator;
-  _theParticleIterator = theParticleTable->GetIterator();
-  _theParticleIterator->reset();
-  while ((*_theParticleIterator)())
+  // add cerenkov and optical photon processes, the worker threads add their own (PHG4CerenkovPhysics)
+  if (!subevents_)
   {
-    G4ParticleDefinition *particle = _theParticleIterator->value();
-    G4String particleName = particle->GetParticleName();
-    G4ProcessManager *pmanager = particle->GetProcessManager();
-    if (theCerenkovProcess->IsApplicable(*particle))
-    {
-      pmanager->AddProcess(theCerenkovProcess);
-      pmanager->SetProcessOrdering(theCerenkovProcess, idxPostStep);
-    }
-    // if (theScintillationProcess->IsApplicable(*particle))
-    // {
-    //   pmanager->AddProcess(theScintillationProcess);
-    //   pmanager->SetProcessOrderingToLast(theScintillationProcess, idxAtRest);
-    //   pmanager->SetProcessOrderingToLast(theScintillationProcess, idxPostStep);
-    // }
-  }
-  G4ProcessManager *pmanager = G4OpticalPhoton::OpticalPhoton()->GetProcessManager();
-  // G4cout << " AddDiscreteProcess to OpticalPhoton " << G4endl;
-  pmanager->AddDiscreteProcess(new G4OpAbsorption());
-  pmanager->AddDiscreteProcess(new G4OpRayleigh());
-  pmanager->AddDiscreteProcess(new G4OpMieHG());
-  pmanager->AddDiscreteProcess(new G4OpBoundaryProcess());
-  pmanager->AddDiscreteProcess(new G4OpWLS());
-  pmanager->AddDiscreteProcess(new G4PhotoElectricEffect());
-  // pmanager->DumpInfo();
+    PHG4CerenkovPhysics::AddOpticalProcesses();
+  }
 
   // needs large amount of memory which kills central hijing events
   // store generated trajectories
@@ -522,7 +585,10 @@ int PHG4Reco::process_event(PHCompositeNode *topNode)
   TThread::Lock();
   // make sure Actions and subsystems have the relevant pointers set
   PHG4InEvent *ineve = findNode::getClass<PHG4InEvent>(topNode, "PHG4INEVENT");
-  generatorAction_->SetInEvent(ineve);
+  if (generatorAction_)
+  {
+    generatorAction_->SetInEvent(ineve);
+  }
 
   BOOST_FOREACH (SubsysReco *reco, subsystems_)
   {
@@ -552,7 +618,23 @@ int PHG4Reco::process_event(PHCompositeNode *topNode)
          << "run one event :" << endl;
     ineve->identify();
   }
-  runManager_->BeamOn(1);
+  {
+    PHTRACE_ZONE("PHG4Reco BeamOn");
+    if (subevents_)
+    {
+      // the G4 event id is the sub event, merged in sub event order
+      const int nsub = subevents_->Split(ineve);
+      if (nsub > 0)
+      {
+        runManager_->BeamOn(nsub);
+      }
+      subevents_->Merge(topNode);
+    }
+    else
+    {
+      runManager_->BeamOn(1);
+    }
+  }
   _timer.get()->stop();
 
   BOOST_FOREACH (PHG4Subsystem *g4sub, subsystems_)
@@ -588,9 +670,227 @@ int PHG4Reco::ResetEvent(PHCompositeNode *topNode)
 //_________________________________________________________________
 int PHG4Reco::End(PHCompositeNode *)
 {
+  if (verbosity > 0)
+  {
+    BOOST_FOREACH (PHG4ShowerLibraryModel *model, showerlibmodels)
+    {
+      model->PrintStats();
+    }
+  }
+  // the step counts are the measure for the cuts and kill thresholds
+  if (verbosity > 0 || time_window > 0 || passive_ekin > 0)
+  {
+    if (subevents_)
+    {
+      for (unsigned int i = 0; i < actionInit_->size(); i++)
+      {
+        cout << Name() << " worker thread " << i << ":" << endl;
+        actionInit_->GetSteppingAction(i)->PrintSummary();
+      }
+    }
+    else
+    {
+      steppingAction_->PrintSummary();
+    }
+  }
   return 0;
 }
 
+int PHG4Reco::InitRegions()
+{
+  BOOST_FOREACH (SubsysReco *reco, subsystems_)
+  {
+    PHG4Subsystem *g4sub = dynamic_cast<PHG4Subsystem *>(reco);
+    if (!g4sub || !g4sub->GetDetector() || g4sub->GetRangeCut() <= 0)
+    {
+      continue;
+    }
+    const vector<G4LogicalVolume *> &volumes = detector_->GetTopVolumes(g4sub->GetDetector());
+    if (volumes.empty())
+    {
+      cout << PHWHERE << " " << g4sub->Name() << " has no volumes for a range cut" << endl;
+      return -1;
+    }
+    G4Region *region = new G4Region(g4sub->Name() + "_REGION");
+    G4ProductionCuts *cuts = new G4ProductionCuts();
+    cuts->SetProductionCut(g4sub->GetRangeCut() * cm);
+    region->SetProductionCuts(cuts);
+    BOOST_FOREACH (G4LogicalVolume *logvol, volumes)
+    {
+      // detectors which make their own region keep it
+      if (logvol->IsRootRegion())
+      {
+        cout << "PHG4Reco::InitRegions - " << logvol->GetName() << " is already in region "
+             << logvol->GetRegion()->GetName() << ", range cut of " << g4sub->Name() << " not applied" << endl;
+        continue;
+      }
+      region->AddRootLogicalVolume(logvol);
+    }
+    if (verbosity > 0)
+    {
+      cout << "PHG4Reco::InitRegions - " << region->GetName() << " with range cut "
+           << g4sub->GetRangeCut() << " cm" << endl;
+    }
+  }
+  return 0;
+}
+
+void PHG4Reco::ShowerLibrary(const string &envelope, const string &libraryfile, const double emax)
+{
+  ShowerLibrarySetup setup;
+  setup.envelope = envelope;
+  setup.libraryfile = libraryfile;
+  setup.emax = emax;
+  showerlibsetups.push_back(setup);
+  return;
+}
+
+int PHG4Reco::InitShowerLibraries()
+{
+  if (showerlibsetups.empty())
+  {
+    return 0;
+  }
+  set<int> pids;
+  BOOST_FOREACH (const ShowerLibrarySetup &setup, showerlibsetups)
+  {
+    PHG4ShowerLibrary *&library = showerlibraries[setup.libraryfile];
+    if (!library)
+    {
+      library = new PHG4ShowerLibrary();
+      if (library->Read(setup.libraryfile))
+      {
+        return -1;
+      }
+      if (verbosity > 0)
+      {
+        library->Print();
+      }
+    }
+    G4LogicalVolume *envelope = G4LogicalVolumeStore::GetInstance()->GetVolume(setup.envelope, false);
+    if (!envelope)
+    {
+      cout << PHWHERE << " no logical volume " << setup.envelope << " for the shower library" << endl;
+      return -1;
+    }
+    // the region is propagated to the daughters of the envelope at the start of the first run
+    G4Region *region = envelope->GetRegion();
+    if (!region || !envelope->IsRootRegion())
+    {
+      region = new G4Region(setup.envelope + "_SHOWERLIBRARY");
+      region->AddRootLogicalVolume(envelope);
+    }
+    PHG4ShowerLibraryModel *model = new PHG4ShowerLibraryModel(setup.envelope + "_ShowerLibraryModel", region, library, steppingAction_, setup.emax * GeV);
+    model->Verbosity(verbosity);
+    showerlibmodels.push_back(model);
+    vector<int> libpids;
+    library->GetSpecies(libpids);
+    pids.insert(libpids.begin(), libpids.end());
+    cout << "PHG4Reco::InitShowerLibraries - particles entering " << setup.envelope
+         << " below " << setup.emax << " GeV are replaced by showers from " << setup.libraryfile << endl;
+  }
+  // one fast simulation process is shared by all particles like the cerenkov process
+  G4FastSimulationManagerProcess *fastsimprocess = new G4FastSimulationManagerProcess();
+  BOOST_FOREACH (int pid, pids)
+  {
+    G4ParticleDefinition *particle = G4ParticleTable::GetParticleTable()->FindParticle(pid);
+    if (!particle)
+    {
+      cout << PHWHERE << " no particle with pdg code " << pid << " in the shower library" << endl;
+      continue;
+    }
+    particle->GetProcessManager()->AddDiscreteProcess(fastsimprocess);
+  }
+  return 0;
+}
+
+bool PHG4Reco::UseWorkerThreads() const
+{
+#ifndef G4MULTITHREADED
+  cout << Name() << " - geant4 is built without multithreading, no worker threads" << endl;
+  return false;
+#else
+  bool ok = true;
+  if (!showerlibsetups.empty())
+  {
+    cout << Name() << " - shower libraries are not supported with worker threads" << endl;
+    ok = false;
+  }
+  BOOST_FOREACH (PHG4Subsystem *g4sub, subsystems_)
+  {
+    if (!g4sub->SupportsWorkerThreads())
+    {
+      cout << Name() << " - " << g4sub->Name() << " does not support worker threads" << endl;
+      ok = false;
+    }
+  }
+  return ok;
+#endif
+}
+
+void PHG4Reco::InitWorkerThreads(PHCompositeNode *topNode)
+{
+  subevents_->CreateNodes(topNode);
+
+  // every worker gets its own field map, they cache the last lookup
+  PHFieldConfig *fieldconfig = PHFieldUtility::GetFieldConfigNode(nullptr, topNode, Verbosity());
+  assert(fieldconfig);
+
+  // the worker run managers own the actions after PHG4ActionInitialization::Build
+  actionInit_ = new PHG4ActionInitialization();
+  for (int i = 0; i < nthreads; i++)
+  {
+    PHG4WorkerGeneratorAction *generatoraction = new PHG4WorkerGeneratorAction(subevents_);
+    PHG4PhenixEventAction *eventaction = new PHG4PhenixEventAction();
+    PHG4PhenixSteppingAction *steppingaction = new PHG4PhenixSteppingAction();
+    PHG4PhenixTrackingAction *trackingaction = new PHG4PhenixTrackingAction();
+    vector<PHG4TrackingAction *> subsystemtracking;
+    BOOST_FOREACH (PHG4Subsystem *g4sub, subsystems_)
+    {
+      PHG4EventAction *evtact = nullptr;
+      PHG4SteppingAction *stepact = nullptr;
+      PHG4TrackingAction *trkact = nullptr;
+      g4sub->MakeWorkerActions(evtact, stepact, trkact);
+      if (evtact)
+      {
+        eventaction->AddAction(evtact);
+        generatoraction->AddAction(evtact);
+      }
+      if (stepact)
+      {
+        steppingaction->AddAction(stepact);
+        generatoraction->AddAction(stepact);
+      }
+      if (trkact)
+      {
+        trackingaction->AddAction(trkact);
+        generatoraction->AddAction(trkact);
+        subsystemtracking.push_back(trkact);
+      }
+    }
+    actionInit_->AddWorker(generatoraction, eventaction, steppingaction, trackingaction, subsystemtracking,
+                           PHFieldUtility::BuildFieldMap(fieldconfig, Verbosity()));
+  }
+  runManager_->SetUserInitialization(actionInit_);
+  return;
+}
+
+void PHG4Reco::SetupSteppingAction(PHG4PhenixSteppingAction *action)
+{
+  action->Verbosity(verbosity);
+  action->DispatchSteps(dispatch_steps);
+  action->BuildDispatchTable();
+  if (time_window > 0)
+  {
+    action->SetTimeWindow(time_window * ns);
+  }
+  if (passive_ekin > 0)
+  {
+    action->SetPassiveKillEnergy(passive_ekin * GeV);
+  }
+  return;
+}
+
 void PHG4Reco::Print(const std::string &what) const
 {
   BOOST_FOREACH (SubsysReco *reco, subsystems_)
@@ -618,13 +918,22 @@ int PHG4Reco::setupInputEventNodeReader(PHCompositeNode *topNode)
     PHDataNode<PHObject> *newNode = new PHDataNode<PHObject>(ineve, "PHG4INEVENT", "PHObject");
     dstNode->addNode(newNode);
   }
-  generatorAction_ = new PHG4PrimaryGeneratorAction();
-  runManager_->SetUserAction(generatorAction_);
+  // the worker threads have their own generator actions (InitWorkerThreads)
+  if (!subevents_)
+  {
+    generatorAction_ = new PHG4PrimaryGeneratorAction();
+    runManager_->SetUserAction(generatorAction_);
+  }
   return 0;
 }
 
 void PHG4Reco::setGeneratorAction(G4VUserPrimaryGeneratorAction *action)
 {
+  if (subevents_)
+  {
+    cout << PHWHERE << " user generator actions are not supported with G4 worker threads" << endl;
+    return;
+  }
   if (runManager_)
   {
     runManager_->SetUserAction(action);
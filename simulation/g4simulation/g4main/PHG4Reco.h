@@ -10,6 +10,8 @@
 #include <phool/PHTimeServer.h>
 
 #include <list>
+#include <map>
+#include <vector>
 
 // Forward declerations
 class PHCompositeNode;
@@ -24,6 +26,10 @@ class PHG4EventGenerator;
 class G4TBMagneticFieldSetup;
 class G4VUserPrimaryGeneratorAction;
 class PHG4UIsession;
+class PHG4ShowerLibrary;
+class PHG4ShowerLibraryModel;
+class PHG4SubEvents;
+class PHG4ActionInitialization;
 
 // for the G4 cmd interface and the graphics
 class G4UImanager;
@@ -129,9 +135,58 @@ class PHG4Reco : public SubsysReco
   void Dump_GDML(const std::string &filename);
 
   void G4Verbosity(const int i);
+
+  /*!
+    fast simulation of a calorimeter: particles of the species in the library
+    which enter the logical volume envelope (e.g. the CEMC cylinder, Hcal_envelope,
+    OuterHcal_envelope) with a kinetic energy below emax (GeV) are replaced by
+    showers from the library file (written by PHG4ShowerLibraryMaker)
+  */
+  void ShowerLibrary(const std::string &envelope, const std::string &libraryfile, const double emax);
+
+  /*!
+    geometry snapshots: detectors which support it (PHG4Detector::GetVolumeTags) are
+    loaded from dir/<subsystem>_v<version>_g4<version>_<hash>.gdml instead of being
+    constructed, missing snapshots are written after the construction. The name holds the
+    parameter hash, the construction code version of the detector
+    (PHG4Detector::GetGeometryVersion) and the geant4 version. Supported are the
+    cylinders and the inner and outer hcal, the spacal is always constructed
+  */
+  void GeometrySnapshot(const std::string &dir) { snapshotdir = dir; }
+
+  //! default production range cut (cm) outside of the subsystem regions (PHG4DetectorSubsystem::SetRangeCut)
+  void SetDefaultRangeCut(const double cut) { rangecut = cut; }
+  //! tracks are killed once their global time exceeds this (ns)
+  void SetTimeWindow(const double t) { time_window = t; }
+  //! tracks below this kinetic energy (GeV) are killed in volumes a subsystem marks passive (e.g. inactive hcal absorbers)
+  void SetPassiveKillEnergy(const double e) { passive_ekin = e; }
+  //! false: every stepping action gets every step as without the dispatch table (macros/SteppingDispatch_Benchmark.C)
+  void DispatchSteps(const bool b) { dispatch_steps = b; }
+
+  /*!
+    simulate every event with n worker threads of a G4MTRunManager (set before Init,
+    needs a geant4 built with multithreading). The primaries of the event are split
+    into subevents sub events (default n), blocks of consecutive primaries in vertex
+    order, which the threads simulate as separate G4 events. Every sub event has its
+    own hit and truth containers, they are merged into the nodes of the event in sub
+    event order, the ids of the later sub events are appended (PHG4SubEvents).
+    Subsystems have to make the actions of the threads (PHG4Subsystem::MakeWorkerActions),
+    without that or with shower libraries the sequential run manager is used
+  */
+  void G4Threads(const int n, const int subevents = 0)
+  {
+    nthreads = n;
+    nsubevents = subevents;
+  }
+
  protected:
   int InitUImanager();
+  int InitRegions();
+  int InitShowerLibraries();
   void DefineMaterials();
+  bool UseWorkerThreads() const;
+  void InitWorkerThreads(PHCompositeNode *topNode);
+  void SetupSteppingAction(PHG4PhenixSteppingAction *action);
   float magfield;
   float magfield_rescale;
   double WorldSize[3];
@@ -173,6 +228,7 @@ class PHG4Reco : public SubsysReco
   std::string worldshape;
   std::string worldmaterial;
   std::string physicslist;
+  std::string snapshotdir;
 
   // settings for the external Pythia6 decayer
   bool active_decayer_;          //< turn on/off decayer
@@ -181,6 +237,28 @@ class PHG4Reco : public SubsysReco
 
   bool save_DST_geometry_;
 
+  double rangecut;
+  double time_window;
+  double passive_ekin;
+  bool dispatch_steps;
+
+  // shower library fast simulation
+  struct ShowerLibrarySetup
+  {
+    std::string envelope;
+    std::string libraryfile;
+    double emax;
+  };
+  std::vector<ShowerLibrarySetup> showerlibsetups;
+  std::map<std::string, PHG4ShowerLibrary *> showerlibraries;  // by file
+  std::vector<PHG4ShowerLibraryModel *> showerlibmodels;
+
+  // multi threaded mode, subevents_ is null in the sequential mode
+  int nthreads;
+  int nsubevents;
+  PHG4SubEvents *subevents_;
+  PHG4ActionInitialization *actionInit_;  // owned by the run manager
+
   //! module timer.
   PHTimeServer::timer _timer;
 };
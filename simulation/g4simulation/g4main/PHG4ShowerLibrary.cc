@@ -0,0 +1,355 @@
+#include "PHG4ShowerLibrary.h"
+
+#include <phool/phool.h>
+
+#include <Geant4/G4AffineTransform.hh>
+#include <Geant4/G4LogicalVolume.hh>
+#include <Geant4/G4VPhysicalVolume.hh>
+#include <Geant4/G4VSolid.hh>
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+namespace
+{
+  // cell keys pack the eta, phi and angle bin numbers into 16 bits each
+  const long CELLOFFSET = 1 << 15;
+}
+
+PHG4ShowerLibrary::PHG4ShowerLibrary():
+  eta_bin(0.05),
+  phi_bin(2 * M_PI / 256.),
+  angle_bin(0.05),
+  nphibins(256)
+{}
+
+void
+PHG4ShowerLibrary::SetBinning(const double etabin, const double phibin, const double anglebin)
+{
+  if (!showers.empty())
+    {
+      cout << PHWHERE << " binning has to be set before showers are added" << endl;
+      exit(1);
+    }
+  eta_bin = etabin;
+  phi_bin = phibin;
+  angle_bin = anglebin;
+  nphibins = ceil(2 * M_PI / phi_bin - 1e-6);
+  return;
+}
+
+long
+PHG4ShowerLibrary::CellKey(const double eta, const double phi, const double angle) const
+{
+  long ieta = floor(eta / eta_bin) + CELLOFFSET;
+  long iphi = floor((phi + M_PI) / phi_bin);
+  long iangle = floor(angle / angle_bin);
+  ieta = min(max(ieta, 0L), 2 * CELLOFFSET - 1);
+  iphi = min(max(iphi, 0L), static_cast<long>(nphibins - 1));
+  iangle = min(max(iangle, 0L), 2 * CELLOFFSET - 1);
+  return (ieta << 32) | (iphi << 16) | iangle;
+}
+
+void
+PHG4ShowerLibrary::AddShower(const int pid, const double energy, const double eta, const double phi, const double angle, const vector<Deposit> &deps)
+{
+  Shower shower;
+  shower.energy = energy;
+  shower.first = deposits.size();
+  shower.ndeps = deps.size();
+  deposits.insert(deposits.end(), deps.begin(), deps.end());
+  unsigned int index = showers.size();
+  showers.push_back(shower);
+  shower_pid.push_back(pid);
+  shower_eta.push_back(eta);
+  shower_phi.push_back(phi);
+  shower_angle.push_back(angle);
+
+  // the generated energies are discrete, showers within 0.1% share the energy point
+  Species &spec = species[pid];
+  vector<double>::iterator iter = lower_bound(spec.energies.begin(), spec.energies.end(), energy * 0.999);
+  if (iter == spec.energies.end() || *iter > energy * 1.001)
+    {
+      unsigned int pos = iter - spec.energies.begin();
+      spec.energies.insert(iter, energy);
+      spec.cells.insert(spec.cells.begin() + pos, CellMap());
+      iter = spec.energies.begin() + pos;
+    }
+  spec.cells[iter - spec.energies.begin()][CellKey(eta, phi, angle)].push_back(index);
+  return;
+}
+
+void
+PHG4ShowerLibrary::GetSpecies(vector<int> &pids) const
+{
+  pids.clear();
+  for (map<int, Species>::const_iterator iter = species.begin(); iter != species.end(); ++iter)
+    {
+      pids.push_back(iter->first);
+    }
+  return;
+}
+
+const vector<unsigned int> &
+PHG4ShowerLibrary::ClosestCell(const CellMap &cellmap, const long key) const
+{
+  CellMap::const_iterator found = cellmap.find(key);
+  if (found != cellmap.end())
+    {
+      return found->second;
+    }
+  // libraries have O(100) filled cells per energy point, a scan is cheap
+  // compared to the shower it replaces
+  long ieta = key >> 32;
+  long iphi = (key >> 16) & 0xFFFF;
+  long iangle = key & 0xFFFF;
+  long best = -1;
+  found = cellmap.begin();
+  for (CellMap::const_iterator iter = cellmap.begin(); iter != cellmap.end(); ++iter)
+    {
+      long deta = (iter->first >> 32) - ieta;
+      long dphi = labs(((iter->first >> 16) & 0xFFFF) - iphi);
+      dphi = min(dphi, nphibins - dphi);
+      long dangle = (iter->first & 0xFFFF) - iangle;
+      long dist = deta * deta + dphi * dphi + dangle * dangle;
+      if (best < 0 || dist < best)
+	{
+	  best = dist;
+	  found = iter;
+	}
+    }
+  return found->second;
+}
+
+unsigned int
+PHG4ShowerLibrary::Sample(const int pid, const double energy, const double eta, const double phi, const double angle,
+			  const double rnd1, const double rnd2, const Deposit *&first, double &escale) const
+{
+  map<int, Species>::const_iterator spiter = species.find(pid);
+  if (spiter == species.end())
+    {
+      return 0;
+    }
+  const Species &spec = spiter->second;
+  unsigned int ipoint = lower_bound(spec.energies.begin(), spec.energies.end(), energy) - spec.energies.begin();
+  if (ipoint == spec.energies.size())
+    {
+      ipoint--;
+    }
+  else if (ipoint > 0)
+    {
+      // take the lower energy point with the probability of being closer in log(E)
+      double frac = log(energy / spec.energies[ipoint - 1]) / log(spec.energies[ipoint] / spec.energies[ipoint - 1]);
+      if (rnd1 >= frac)
+	{
+	  ipoint--;
+	}
+    }
+  const vector<unsigned int> &cell = ClosestCell(spec.cells[ipoint], CellKey(eta, phi, angle));
+  unsigned int ishower = min(static_cast<unsigned int>(rnd2 * cell.size()), static_cast<unsigned int>(cell.size() - 1));
+  const Shower &shower = showers[cell[ishower]];
+  first = &deposits[shower.first];
+  escale = energy;
+  return shower.ndeps;
+}
+
+void
+PHG4ShowerLibrary::ShowerFrame(const G4ThreeVector &dir, G4ThreeVector &u, G4ThreeVector &v)
+{
+  u = G4ThreeVector(0, 0, 1).cross(dir);
+  if (u.mag2() < 1e-12)
+    {
+      u = dir.orthogonal();
+    }
+  u = u.unit();
+  v = dir.cross(u);
+  return;
+}
+
+bool
+PHG4ShowerLibrary::EntryPoint(const G4VPhysicalVolume *envelope, const G4ThreeVector &pos, const G4ThreeVector &dir, G4ThreeVector &entry)
+{
+  G4AffineTransform tolocal = G4AffineTransform(envelope->GetRotation(), envelope->GetTranslation()).Inverse();
+  G4ThreeVector localpos = tolocal.TransformPoint(pos);
+  G4ThreeVector localdir = tolocal.TransformAxis(dir);
+  const G4VSolid *solid = envelope->GetLogicalVolume()->GetSolid();
+  if (solid->Inside(localpos) != kOutside)
+    {
+      return false;
+    }
+  double dist = solid->DistanceToIn(localpos, localdir);
+  if (dist == kInfinity)
+    {
+      return false;
+    }
+  entry = pos + dist * dir;
+  return true;
+}
+
+int
+PHG4ShowerLibrary::Read(const string &filename)
+{
+  unique_ptr<TFile> f(TFile::Open(filename.c_str()));
+  if (!f || f->IsZombie())
+    {
+      cout << PHWHERE << " could not open shower library " << filename << endl;
+      return -1;
+    }
+  TTree *binning = dynamic_cast<TTree *>(f->Get("binning"));
+  TTree *tree = dynamic_cast<TTree *>(f->Get("showers"));
+  if (!binning || !tree)
+    {
+      cout << PHWHERE << " " << filename << " is not a shower library" << endl;
+      return -1;
+    }
+  double etabin, phibin, anglebin;
+  binning->SetBranchAddress("eta_bin", &etabin);
+  binning->SetBranchAddress("phi_bin", &phibin);
+  binning->SetBranchAddress("angle_bin", &anglebin);
+  binning->GetEntry(0);
+  deposits.clear();
+  showers.clear();
+  species.clear();
+  shower_pid.clear();
+  shower_eta.clear();
+  shower_phi.clear();
+  shower_angle.clear();
+  SetBinning(etabin, phibin, anglebin);
+
+  int pid;
+  float energy, eta, phi, angle;
+  vector<float> *l = nullptr;
+  vector<float> *u = nullptr;
+  vector<float> *v = nullptr;
+  vector<float> *e = nullptr;
+  vector<float> *eion = nullptr;
+  vector<float> *ly = nullptr;
+  tree->SetBranchAddress("pid", &pid);
+  tree->SetBranchAddress("energy", &energy);
+  tree->SetBranchAddress("eta", &eta);
+  tree->SetBranchAddress("phi", &phi);
+  tree->SetBranchAddress("angle", &angle);
+  tree->SetBranchAddress("l", &l);
+  tree->SetBranchAddress("u", &u);
+  tree->SetBranchAddress("v", &v);
+  tree->SetBranchAddress("e", &e);
+  tree->SetBranchAddress("eion", &eion);
+  tree->SetBranchAddress("ly", &ly);
+  vector<Deposit> deps;
+  for (Long64_t i = 0; i < tree->GetEntries(); i++)
+    {
+      tree->GetEntry(i);
+      deps.resize(e->size());
+      for (unsigned int j = 0; j < e->size(); j++)
+	{
+	  deps[j].l = (*l)[j];
+	  deps[j].u = (*u)[j];
+	  deps[j].v = (*v)[j];
+	  deps[j].e = (*e)[j];
+	  deps[j].eion = (*eion)[j];
+	  deps[j].ly = (*ly)[j];
+	}
+      AddShower(pid, energy, eta, phi, angle, deps);
+    }
+  tree->ResetBranchAddresses();
+  delete l;
+  delete u;
+  delete v;
+  delete e;
+  delete eion;
+  delete ly;
+  return 0;
+}
+
+int
+PHG4ShowerLibrary::Write(const string &filename) const
+{
+  TFile f(filename.c_str(), "RECREATE");
+  if (f.IsZombie())
+    {
+      cout << PHWHERE << " could not open " << filename << endl;
+      return -1;
+    }
+  TTree *binning = new TTree("binning", "shower library binning");
+  double etabin = eta_bin;
+  double phibin = phi_bin;
+  double anglebin = angle_bin;
+  binning->Branch("eta_bin", &etabin, "eta_bin/D");
+  binning->Branch("phi_bin", &phibin, "phi_bin/D");
+  binning->Branch("angle_bin", &anglebin, "angle_bin/D");
+  binning->Fill();
+
+  TTree *tree = new TTree("showers", "shower library");
+  int pid;
+  float energy, eta, phi, angle;
+  vector<float> l, u, v, e, eion, ly;
+  tree->Branch("pid", &pid, "pid/I");
+  tree->Branch("energy", &energy, "energy/F");
+  tree->Branch("eta", &eta, "eta/F");
+  tree->Branch("phi", &phi, "phi/F");
+  tree->Branch("angle", &angle, "angle/F");
+  tree->Branch("l", &l);
+  tree->Branch("u", &u);
+  tree->Branch("v", &v);
+  tree->Branch("e", &e);
+  tree->Branch("eion", &eion);
+  tree->Branch("ly", &ly);
+  for (unsigned int i = 0; i < showers.size(); i++)
+    {
+      pid = shower_pid[i];
+      energy = showers[i].energy;
+      eta = shower_eta[i];
+      phi = shower_phi[i];
+      angle = shower_angle[i];
+      l.clear();
+      u.clear();
+      v.clear();
+      e.clear();
+      eion.clear();
+      ly.clear();
+      for (unsigned int j = showers[i].first; j < showers[i].first + showers[i].ndeps; j++)
+	{
+	  l.push_back(deposits[j].l);
+	  u.push_back(deposits[j].u);
+	  v.push_back(deposits[j].v);
+	  e.push_back(deposits[j].e);
+	  eion.push_back(deposits[j].eion);
+	  ly.push_back(deposits[j].ly);
+	}
+      tree->Fill();
+    }
+  f.Write();
+  f.Close();
+  return 0;
+}
+
+void
+PHG4ShowerLibrary::Print(const string &what) const
+{
+  cout << "Shower library: " << showers.size() << " showers, " << deposits.size() << " deposits" << endl;
+  cout << "bins: eta " << eta_bin << ", phi " << phi_bin << " rad, angle " << angle_bin << " rad" << endl;
+  for (map<int, Species>::const_iterator iter = species.begin(); iter != species.end(); ++iter)
+    {
+      cout << "pid " << iter->first << ":";
+      for (unsigned int i = 0; i < iter->second.energies.size(); i++)
+	{
+	  unsigned int nshowers = 0;
+	  for (CellMap::const_iterator citer = iter->second.cells[i].begin(); citer != iter->second.cells[i].end(); ++citer)
+	    {
+	      nshowers += citer->second.size();
+	    }
+	  cout << " " << iter->second.energies[i] << " GeV (" << nshowers << " showers in "
+	       << iter->second.cells[i].size() << " bins)";
+	}
+      cout << endl;
+    }
+  return;
+}
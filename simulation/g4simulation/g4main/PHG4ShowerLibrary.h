@@ -0,0 +1,109 @@
+#ifndef PHG4SHOWERLIBRARY_H
+#define PHG4SHOWERLIBRARY_H
+
+#include <Geant4/G4ThreeVector.hh>
+
+#include <map>
+#include <string>
+#include <vector>
+
+class G4VPhysicalVolume;
+
+/*!
+  library of pre-simulated showers used by PHG4ShowerLibraryModel.
+  Showers are stored per species (pdg code) for the generated kinetic
+  energies and are binned in impact eta, phi and angle (between the
+  direction and the radial direction at the impact point).
+  Every deposit is kept relative to the impact point in the frame of
+  ShowerFrame() as fraction of the kinetic energy of the shower, with
+  the ionization and visible (birks corrected) parts of the hit it came
+  from, so the replay does not depend on the particle of the step.
+  The impact point is where the straight line from the vertex enters the
+  envelope solid (EntryPoint()), which is the surface the model triggers on.
+  The library is written by PHG4ShowerLibraryMaker into a root file
+  (trees "showers" and "binning")
+*/
+class PHG4ShowerLibrary
+{
+ public:
+  struct Deposit
+  {
+    float l; // along the direction of the particle (cm)
+    float u; // azimuthal direction (cm)
+    float v; // third axis (cm)
+    float e; // fraction of the kinetic energy
+    float eion; // ionization part, fraction of the kinetic energy
+    float ly; // visible energy (light yield), fraction of the kinetic energy
+  };
+
+  PHG4ShowerLibrary();
+  virtual ~PHG4ShowerLibrary() {}
+
+  int Read(const std::string &filename);
+  int Write(const std::string &filename) const;
+
+  //! add a shower, the deposits are copied
+  void AddShower(const int pid, const double energy, const double eta, const double phi, const double angle, const std::vector<Deposit> &deps);
+
+  //! bin widths in eta, phi (rad) and impact angle (rad)
+  void SetBinning(const double etabin, const double phibin, const double anglebin);
+
+  bool HasSpecies(const int pid) const {return species.find(pid) != species.end();}
+  void GetSpecies(std::vector<int> &pids) const;
+  unsigned int size() const {return showers.size();}
+
+  /*!
+    pick a shower for this species, kinetic energy (GeV), eta, phi and angle.
+    The energy point is chosen between the two neighbouring generated energies
+    (linear in log(E)), the shower randomly from the closest filled eta/phi/angle
+    bin. Needs two uniform random numbers, returns the number of deposits,
+    first points to them and escale is the factor to get the deposited energy (GeV)
+    from the fraction.
+  */
+  unsigned int Sample(const int pid, const double energy, const double eta, const double phi, const double angle,
+		      const double rnd1, const double rnd2, const Deposit *&first, double &escale) const;
+
+  void Print(const std::string &what = "ALL") const;
+
+  //! axes of the deposit frame for a particle going in dir
+  static void ShowerFrame(const G4ThreeVector &dir, G4ThreeVector &u, G4ThreeVector &v);
+
+  //! where the straight line from pos along dir enters the envelope (a daughter of the world), false if it misses
+  static bool EntryPoint(const G4VPhysicalVolume *envelope, const G4ThreeVector &pos, const G4ThreeVector &dir, G4ThreeVector &entry);
+
+ protected:
+  struct Shower
+  {
+    float energy;
+    unsigned int first;
+    unsigned int ndeps;
+  };
+
+  // showers by eta/phi/angle bin for one energy point
+  typedef std::map<long, std::vector<unsigned int> > CellMap;
+
+  struct Species
+  {
+    std::vector<double> energies; // sorted
+    std::vector<CellMap> cells; // parallel to energies
+  };
+
+  long CellKey(const double eta, const double phi, const double angle) const;
+  const std::vector<unsigned int> &ClosestCell(const CellMap &cellmap, const long key) const;
+
+  std::vector<Deposit> deposits;
+  std::vector<Shower> showers;
+  std::map<int, Species> species;
+  double eta_bin;
+  double phi_bin;
+  double angle_bin;
+  int nphibins;
+
+  // kept for writing the library
+  std::vector<int> shower_pid;
+  std::vector<float> shower_eta;
+  std::vector<float> shower_phi;
+  std::vector<float> shower_angle;
+};
+
+#endif
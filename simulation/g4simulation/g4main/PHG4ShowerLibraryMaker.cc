@@ -0,0 +1,170 @@
+#include "PHG4ShowerLibraryMaker.h"
+#include "PHG4Hit.h"
+#include "PHG4HitContainer.h"
+#include "PHG4Particle.h"
+#include "PHG4ShowerLibrary.h"
+#include "PHG4TruthInfoContainer.h"
+#include "PHG4VtxPoint.h"
+
+#include <fun4all/Fun4AllReturnCodes.h>
+
+#include <phool/getClass.h>
+#include <phool/phool.h>
+
+#include <Geant4/G4LogicalVolume.hh>
+#include <Geant4/G4Navigator.hh>
+#include <Geant4/G4SystemOfUnits.hh>
+#include <Geant4/G4TransportationManager.hh>
+#include <Geant4/G4VPhysicalVolume.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iterator>
+
+using namespace std;
+
+PHG4ShowerLibraryMaker::PHG4ShowerLibraryMaker(const string &name):
+  SubsysReco(name),
+  outfile("showerlibrary.root"),
+  envelope(nullptr),
+  library(new PHG4ShowerLibrary())
+{}
+
+PHG4ShowerLibraryMaker::~PHG4ShowerLibraryMaker()
+{
+  delete library;
+}
+
+void
+PHG4ShowerLibraryMaker::SetBinning(const double etabin, const double phibin, const double anglebin)
+{
+  library->SetBinning(etabin, phibin, anglebin);
+}
+
+int
+PHG4ShowerLibraryMaker::InitRun(PHCompositeNode *topNode)
+{
+  if (envelope_name.empty())
+    {
+      cout << PHWHERE << " no envelope set (SetEnvelope)" << endl;
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
+  // the envelopes of the calorimeters are placed in the world
+  G4VPhysicalVolume *world = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking()->GetWorldVolume();
+  envelope = nullptr;
+  for (int i = 0; world && i < world->GetLogicalVolume()->GetNoDaughters(); i++)
+    {
+      G4VPhysicalVolume *daughter = world->GetLogicalVolume()->GetDaughter(i);
+      if (daughter->GetLogicalVolume()->GetName() == envelope_name)
+	{
+	  envelope = daughter;
+	  break;
+	}
+    }
+  if (!envelope)
+    {
+      cout << PHWHERE << " no placement of " << envelope_name << " in the world" << endl;
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
+  if (hitnodes.empty())
+    {
+      cout << PHWHERE << " no hit nodes added (AddNode)" << endl;
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+int
+PHG4ShowerLibraryMaker::process_event(PHCompositeNode *topNode)
+{
+  PHG4TruthInfoContainer *truth = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
+  if (!truth)
+    {
+      cout << PHWHERE << " no G4TruthInfo node" << endl;
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
+  PHG4TruthInfoContainer::ConstRange primaries = truth->GetPrimaryParticleRange();
+  if (primaries.first == primaries.second || distance(primaries.first, primaries.second) > 1)
+    {
+      if (verbosity > 0)
+	{
+	  cout << Name() << ": skipping event without exactly one primary" << endl;
+	}
+      return Fun4AllReturnCodes::EVENT_OK;
+    }
+  PHG4Particle *particle = primaries.first->second;
+  PHG4VtxPoint *vtx = truth->GetPrimaryVtx(particle->get_vtx_id());
+  double px = particle->get_px();
+  double py = particle->get_py();
+  double pz = particle->get_pz();
+  double p = sqrt(px * px + py * py + pz * pz);
+  double mass = sqrt(max(particle->get_e() * particle->get_e() - p * p, 0.));
+  double ekin = particle->get_e() - mass;
+  if (!vtx || p <= 0 || ekin <= 0)
+    {
+      return Fun4AllReturnCodes::EVENT_OK;
+    }
+
+  // straight line from the vertex into the envelope, in G4 units
+  G4ThreeVector direction(px / p, py / p, pz / p);
+  G4ThreeVector vertex(vtx->get_x() * cm, vtx->get_y() * cm, vtx->get_z() * cm);
+  G4ThreeVector entry;
+  if (!PHG4ShowerLibrary::EntryPoint(envelope, vertex, direction, entry))
+    {
+      return Fun4AllReturnCodes::EVENT_OK;
+    }
+  entry /= cm;
+  G4ThreeVector u;
+  G4ThreeVector v;
+  PHG4ShowerLibrary::ShowerFrame(direction, u, v);
+  G4ThreeVector radial(entry.x(), entry.y(), 0);
+  double angle = direction.angle(radial);
+
+  vector<PHG4ShowerLibrary::Deposit> deps;
+  for (vector<string>::const_iterator iter = hitnodes.begin(); iter != hitnodes.end(); ++iter)
+    {
+      PHG4HitContainer *hits = findNode::getClass<PHG4HitContainer>(topNode, *iter);
+      if (!hits)
+	{
+	  cout << PHWHERE << " no hit node " << *iter << endl;
+	  return Fun4AllReturnCodes::ABORTRUN;
+	}
+      PHG4HitContainer::ConstRange range = hits->getHits();
+      for (PHG4HitContainer::ConstIterator hiter = range.first; hiter != range.second; ++hiter)
+	{
+	  const PHG4Hit *hit = hiter->second;
+	  if (hit->get_edep() <= 0)
+	    {
+	      continue;
+	    }
+	  G4ThreeVector point = G4ThreeVector(hit->get_avg_x(), hit->get_avg_y(), hit->get_avg_z()) - entry;
+	  PHG4ShowerLibrary::Deposit dep;
+	  dep.l = point.dot(direction);
+	  dep.u = point.dot(u);
+	  dep.v = point.dot(v);
+	  dep.e = hit->get_edep() / ekin;
+	  // steps in passive volumes do not record eion or light yield
+	  dep.eion = hit->has_property(PHG4Hit::prop_eion) ? hit->get_eion() / ekin : dep.e;
+	  dep.ly = hit->has_property(PHG4Hit::prop_light_yield) ? hit->get_light_yield() / ekin : 0;
+	  deps.push_back(dep);
+	}
+    }
+  library->AddShower(particle->get_pid(), ekin, entry.eta(), entry.phi(), angle, deps);
+  return Fun4AllReturnCodes::EVENT_OK;
+}
+
+int
+PHG4ShowerLibraryMaker::End(PHCompositeNode *topNode)
+{
+  if (verbosity > 0)
+    {
+      library->Print();
+    }
+  if (library->Write(outfile))
+    {
+      return Fun4AllReturnCodes::ABORTRUN;
+    }
+  cout << Name() << ": wrote " << library->size() << " showers to " << outfile << endl;
+  return Fun4AllReturnCodes::EVENT_OK;
+}
@@ -0,0 +1,54 @@
+#ifndef PHG4SHOWERLIBRARYMAKER_H
+#define PHG4SHOWERLIBRARYMAKER_H
+
+#include <fun4all/SubsysReco.h>
+
+#include <string>
+#include <vector>
+
+class G4VPhysicalVolume;
+class PHG4ShowerLibrary;
+
+/*!
+  writes a shower library for PHG4Reco::ShowerLibrary() from full
+  simulation. Run single particles at the library energies from the
+  vertex with the magnetic field off (the impact point is where the
+  straight line extrapolation of the primary enters the envelope, the
+  same surface PHG4ShowerLibraryModel triggers on) and add the hit
+  nodes of the calorimeter (active and absorber), e.g.
+
+    PHG4ShowerLibraryMaker *maker = new PHG4ShowerLibraryMaker();
+    maker->AddNode("G4HIT_CEMC");
+    maker->AddNode("G4HIT_ABSORBER_CEMC");
+    maker->SetEnvelope("CEMC");
+    maker->SetOutputFile("cemc_showers.root");
+
+  The hit light yield is stored as is, so libraries for the hcals have
+  to be made without the light balance correction (the stepping action
+  applies it again when the shower is replayed)
+*/
+class PHG4ShowerLibraryMaker: public SubsysReco
+{
+ public:
+  PHG4ShowerLibraryMaker(const std::string &name = "PHG4ShowerLibraryMaker");
+  virtual ~PHG4ShowerLibraryMaker();
+  int InitRun(PHCompositeNode *topNode);
+  int process_event(PHCompositeNode *topNode);
+  int End(PHCompositeNode *topNode);
+
+  void AddNode(const std::string &hitnode) {hitnodes.push_back(hitnode);}
+  //! logical volume of the envelope, the same name as in PHG4Reco::ShowerLibrary()
+  void SetEnvelope(const std::string &name) {envelope_name = name;}
+  //! bin widths in eta, phi (rad) and impact angle (rad) of the library
+  void SetBinning(const double etabin, const double phibin, const double anglebin);
+  void SetOutputFile(const std::string &filename) {outfile = filename;}
+
+ protected:
+  std::vector<std::string> hitnodes;
+  std::string outfile;
+  std::string envelope_name;
+  G4VPhysicalVolume *envelope;
+  PHG4ShowerLibrary *library;
+};
+
+#endif
@@ -0,0 +1,170 @@
+#include "PHG4ShowerLibraryModel.h"
+#include "PHG4ShowerLibrary.h"
+#include "PHG4PhenixSteppingAction.h"
+#include "PHG4ShowerLibraryTrackInfo.h"
+
+#include <Geant4/G4DynamicParticle.hh>
+#include <Geant4/G4FastStep.hh>
+#include <Geant4/G4FastTrack.hh>
+#include <Geant4/G4LogicalVolume.hh>
+#include <Geant4/G4Navigator.hh>
+#include <Geant4/G4ParticleDefinition.hh>
+#include <Geant4/G4Region.hh>
+#include <Geant4/G4Step.hh>
+#include <Geant4/G4SystemOfUnits.hh>
+#include <Geant4/G4TouchableHistory.hh>
+#include <Geant4/G4Track.hh>
+#include <Geant4/G4TransportationManager.hh>
+#include <Geant4/G4VPhysicalVolume.hh>
+#include <Geant4/G4VSolid.hh>
+#include <Geant4/Randomize.hh>
+
+#include <iostream>
+
+using namespace std;
+
+PHG4ShowerLibraryModel::PHG4ShowerLibraryModel(const G4String &name, G4Region *envelope, const PHG4ShowerLibrary *lib, PHG4PhenixSteppingAction *action, const double e):
+  G4VFastSimulationModel(name, envelope),
+  library(lib),
+  steppingaction(action),
+  region(envelope),
+  navigator(nullptr),
+  emax(e),
+  verbosity(0),
+  nshowers(0),
+  nlost(0)
+{}
+
+PHG4ShowerLibraryModel::~PHG4ShowerLibraryModel()
+{
+  delete navigator;
+}
+
+void
+PHG4ShowerLibraryModel::PrintStats() const
+{
+  cout << GetName() << ": " << nshowers << " showers from the library, "
+       << nlost << " deposits outside of the envelope dropped" << endl;
+  return;
+}
+
+G4bool
+PHG4ShowerLibraryModel::IsApplicable(const G4ParticleDefinition &particle)
+{
+  return library->HasSpecies(particle.GetPDGEncoding());
+}
+
+G4bool
+PHG4ShowerLibraryModel::ModelTrigger(const G4FastTrack &fastTrack)
+{
+  if (fastTrack.GetPrimaryTrack()->GetKineticEnergy() >= emax)
+    {
+      return false;
+    }
+  // the library showers start at the surface, particles produced inside
+  // the envelope (including the ones from library showers we did not
+  // replace) are simulated in full
+  if (fastTrack.OnTheBoundaryButExiting())
+    {
+      return false;
+    }
+  return fastTrack.GetEnvelopeSolid()->Inside(fastTrack.GetPrimaryTrackLocalPosition()) == kSurface;
+}
+
+void
+PHG4ShowerLibraryModel::DoIt(const G4FastTrack &fastTrack, G4FastStep &fastStep)
+{
+  const G4Track *track = fastTrack.GetPrimaryTrack();
+  G4ThreeVector pos = track->GetPosition();
+  G4ThreeVector dir = track->GetMomentumDirection();
+  double ekin = track->GetKineticEnergy();
+
+  // the deposits replace the energy of the track, the fast step itself
+  // must not leave any (it would end up in the envelope)
+  fastStep.KillPrimaryTrack();
+  fastStep.ProposePrimaryTrackPathLength(0.0);
+  fastStep.ProposeTotalEnergyDeposited(0.0);
+
+  G4ThreeVector radial(pos.x(), pos.y(), 0);
+  double angle = (radial.mag2() > 0) ? dir.angle(radial) : 0;
+  const PHG4ShowerLibrary::Deposit *deps = nullptr;
+  double escale = 0;
+  unsigned int ndeps = library->Sample(track->GetDefinition()->GetPDGEncoding(), ekin / GeV, pos.eta(), pos.phi(), angle,
+				       G4UniformRand(), G4UniformRand(), deps, escale);
+  nshowers++;
+  if (!ndeps)
+    {
+      return;
+    }
+
+  if (!navigator)
+    {
+      navigator = new G4Navigator();
+      navigator->SetWorldVolume(G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking()->GetWorldVolume());
+    }
+  G4ThreeVector u;
+  G4ThreeVector v;
+  PHG4ShowerLibrary::ShowerFrame(dir, u, v);
+
+  // every deposit is a step of a stand in for the killed track which starts and
+  // ends on a boundary at the deposit point, so the stepping actions make one hit
+  // from it. The ionization part and the visible energy are the ones recorded in
+  // full simulation, the stand in has the wrong species and step length for birks.
+  // The visible energy goes with the stand in's user information, a copy of the
+  // one of the killed track (truth keep flag, shower). The stand in shares the track id
+  PHG4TrackUserInfoV1 *userinfo = dynamic_cast<PHG4TrackUserInfoV1 *>(track->GetUserInformation());
+  PHG4ShowerLibraryTrackInfo *replayinfo = userinfo ? new PHG4ShowerLibraryTrackInfo(*userinfo) : new PHG4ShowerLibraryTrackInfo();
+  G4Track proxy(new G4DynamicParticle(*track->GetDynamicParticle()), track->GetGlobalTime(), pos);
+  proxy.SetTrackID(track->GetTrackID());
+  proxy.SetParentID(track->GetParentID());
+  proxy.SetUserInformation(replayinfo); // owned by the stand in
+  G4Step step;
+  step.SetTrack(&proxy);
+  proxy.SetStep(&step);
+  G4StepPoint *prePoint = step.GetPreStepPoint();
+  G4StepPoint *postPoint = step.GetPostStepPoint();
+  prePoint->SetStepStatus(fGeomBoundary);
+  postPoint->SetStepStatus(fGeomBoundary);
+  prePoint->SetGlobalTime(track->GetGlobalTime());
+  postPoint->SetGlobalTime(track->GetGlobalTime());
+  prePoint->SetMomentumDirection(dir);
+  postPoint->SetMomentumDirection(dir);
+  for (unsigned int i = 0; i < ndeps; i++)
+    {
+      const PHG4ShowerLibrary::Deposit &dep = deps[i];
+      G4ThreeVector point = pos + (dep.l * dir + dep.u * u + dep.v * v) * cm;
+      G4VPhysicalVolume *volume = navigator->LocateGlobalPointAndSetup(point, nullptr, false, true);
+      if (!volume || volume->GetLogicalVolume()->GetRegion() != region)
+	{
+	  nlost++;
+	  continue;
+	}
+      G4TouchableHandle touch = navigator->CreateTouchableHistory();
+      G4LogicalVolume *logvol = volume->GetLogicalVolume();
+      prePoint->SetPosition(point);
+      postPoint->SetPosition(point);
+      prePoint->SetTouchableHandle(touch);
+      postPoint->SetTouchableHandle(touch);
+      prePoint->SetMaterial(logvol->GetMaterial());
+      postPoint->SetMaterial(logvol->GetMaterial());
+      prePoint->SetMaterialCutsCouple(logvol->GetMaterialCutsCouple());
+      postPoint->SetMaterialCutsCouple(logvol->GetMaterialCutsCouple());
+      proxy.SetPosition(point);
+      proxy.SetTouchableHandle(touch);
+      step.SetStepLength(0);
+      step.SetTotalEnergyDeposit(dep.e * escale * GeV);
+      step.SetNonIonizingEnergyDeposit((dep.e - dep.eion) * escale * GeV);
+      replayinfo->SetVisibleEnergy(dep.ly * escale);
+      steppingaction->DispatchStep(&step);
+    }
+  // the stepping actions may have flagged the track for the truth record
+  if (userinfo)
+    {
+      *userinfo = *replayinfo;
+    }
+  else if (!track->GetUserInformation())
+    {
+      track->SetUserInformation(new PHG4TrackUserInfoV1(*replayinfo));
+    }
+  return;
+}
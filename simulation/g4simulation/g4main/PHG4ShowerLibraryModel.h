@@ -0,0 +1,43 @@
+#ifndef PHG4SHOWERLIBRARYMODEL_H
+#define PHG4SHOWERLIBRARYMODEL_H
+
+#include <Geant4/G4VFastSimulationModel.hh>
+
+class G4Navigator;
+class PHG4PhenixSteppingAction;
+class PHG4ShowerLibrary;
+
+/*!
+  fast simulation model for calorimeter envelopes. Particles of the
+  species in the library which enter the envelope with a kinetic energy
+  below the threshold are killed and replaced by the deposits of a shower
+  from the library. Every deposit is located in the geometry and handed
+  as a step of the killed track to the stepping actions owning the volume
+  (PHG4PhenixSteppingAction::DispatchStep), so the subsystems make their
+  ordinary hits. The time window and passive kill do not apply to them
+*/
+class PHG4ShowerLibraryModel: public G4VFastSimulationModel
+{
+ public:
+  PHG4ShowerLibraryModel(const G4String &name, G4Region *envelope, const PHG4ShowerLibrary *lib, PHG4PhenixSteppingAction *action, const double emax);
+  virtual ~PHG4ShowerLibraryModel();
+
+  G4bool IsApplicable(const G4ParticleDefinition &particle);
+  G4bool ModelTrigger(const G4FastTrack &fastTrack);
+  void DoIt(const G4FastTrack &fastTrack, G4FastStep &fastStep);
+
+  void Verbosity(const int i) {verbosity = i;}
+  void PrintStats() const;
+
+ protected:
+  const PHG4ShowerLibrary *library;
+  PHG4PhenixSteppingAction *steppingaction;
+  G4Region *region;
+  G4Navigator *navigator;
+  double emax;
+  int verbosity;
+  unsigned long nshowers;
+  unsigned long nlost; // deposits outside the envelope
+};
+
+#endif
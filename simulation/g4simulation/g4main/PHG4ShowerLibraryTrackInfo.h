@@ -0,0 +1,28 @@
+#ifndef PHG4ShowerLibraryTrackInfo_H__
+#define PHG4ShowerLibraryTrackInfo_H__
+
+#include "PHG4TrackUserInfoV1.h"
+
+// User information of the stand in track PHG4ShowerLibraryModel hands to the
+// stepping actions for every replayed deposit. It carries a copy of the user
+// information of the killed track (truth flags, shower) which is copied back
+// after the replay, and the visible energy recorded in full simulation for the
+// current deposit which PHG4SteppingAction::GetVisibleEnergyDeposition returns
+// instead of the birks calculation for the stand in
+
+class PHG4ShowerLibraryTrackInfo : public PHG4TrackUserInfoV1
+{
+public:
+  PHG4ShowerLibraryTrackInfo() : visible_energy(0) {}
+  explicit PHG4ShowerLibraryTrackInfo(const PHG4TrackUserInfoV1 &info) : PHG4TrackUserInfoV1(info), visible_energy(0) {}
+  virtual ~PHG4ShowerLibraryTrackInfo() {}
+
+  //! visible energy of the current deposit (GeV)
+  void SetVisibleEnergy(const double e) {visible_energy = e;}
+  double GetVisibleEnergy() const {return visible_energy;}
+
+private:
+  double visible_energy;
+};
+
+#endif
@@ -8,6 +8,7 @@
 
 #include "PHG4SteppingAction.h"
 #include "PHG4Hit.h"
+#include "PHG4ShowerLibraryTrackInfo.h"
 
 #include <Geant4/G4Step.hh>
 #include <Geant4/G4Material.hh>
@@ -94,6 +95,10 @@ PHG4SteppingAction::GetScintLightYield(const G4Step* step)
 double
 PHG4SteppingAction::GetVisibleEnergyDeposition(const G4Step* step)
 {
+  if (const PHG4ShowerLibraryTrackInfo *replay = dynamic_cast<const PHG4ShowerLibraryTrackInfo *>(step->GetTrack()->GetUserInformation()))
+    {
+      return replay->GetVisibleEnergy();
+    }
 
   G4EmSaturation* emSaturation = G4LossTableManager::Instance()->EmSaturation();
   if (emSaturation)
@@ -6,6 +6,7 @@
 #include <string>
 
 class G4Step;
+class G4VPhysicalVolume;
 class PHCompositeNode;
 class PHG4Hit;
 
@@ -29,6 +30,23 @@ class PHG4SteppingAction
   */
   virtual bool UserSteppingAction(const G4Step* step, bool was_used ) = 0;
 
+  //! return values of IsInDetector
+  /*!
+  VOLUME_PASSIVE: the volume belongs to the detector but nothing is recorded
+  in it, the action is not called for its steps and tracks below the passive
+  kill energy are killed there
+  */
+  enum {VOLUME_UNKNOWN = -1, VOLUME_OTHER = 0, VOLUME_OWNED = 1, VOLUME_PASSIVE = 2};
+
+  //! does this action process steps which start in the given volume
+  /*!
+  used by PHG4PhenixSteppingAction to only call the actions owning the volume
+  of a step. The answer is cached per volume after the geometry is constructed,
+  so it must only depend on the volume. Actions which keep the default
+  VOLUME_UNKNOWN are called for every step
+  */
+  virtual int IsInDetector(G4VPhysicalVolume*) const {return VOLUME_UNKNOWN;}
+
   virtual void Verbosity(const int i) {verbosity = i;}
   int Verbosity() const {return verbosity;}
 
@@ -38,6 +56,7 @@ class PHG4SteppingAction
   virtual double GetScintLightYield(const G4Step* step);
 
   //! get amount of energy that can make scintillation light, in Unit of GeV.
+  //! Deposits replayed by PHG4ShowerLibraryModel return the visible energy recorded in full simulation
   virtual double GetVisibleEnergyDeposition(const G4Step* step);
 
   //! Extract local coordinate of the hit and save to PHG4Hit
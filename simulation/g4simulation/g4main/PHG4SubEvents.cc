@@ -0,0 +1,328 @@
+#include "PHG4SubEvents.h"
+
+#include "PHG4Hit.h"
+#include "PHG4HitContainer.h"
+#include "PHG4InEvent.h"
+#include "PHG4Particlev1.h"
+#include "PHG4Shower.h"
+#include "PHG4TruthInfoContainer.h"
+#include "PHG4VtxPoint.h"
+
+#include <phool/PHCompositeNode.h>
+#include <phool/PHDataNode.h>
+#include <phool/PHIODataNode.h>
+#include <phool/PHNodeIterator.h>
+#include <phool/PHNodeReset.h>
+#include <phool/PHPointerListIterator.h>
+#include <phool/getClass.h>
+
+#include <climits>
+#include <iostream>
+#include <map>
+#include <set>
+
+using namespace std;
+
+namespace
+{
+  // positive ids (primaries) are appended above the ids in the main container,
+  // negative ones (secondaries) below, 0 (no parent) and INT_MIN (not set) stay
+  int Shift(const int id, const int up, const int down)
+  {
+    if (id > 0)
+    {
+      return id + up;
+    }
+    if (id < 0 && id != INT_MIN)
+    {
+      return id + down;
+    }
+    return id;
+  }
+}
+
+PHG4SubEvents::PHG4SubEvents(const int n)
+  : topnodes(n, nullptr)
+  , nsubevents(0)
+  , verbosity(0)
+{
+}
+
+PHG4SubEvents::~PHG4SubEvents()
+{
+  while (!topnodes.empty())
+  {
+    delete topnodes.back();
+    topnodes.pop_back();
+  }
+}
+
+void PHG4SubEvents::CreateNodes(PHCompositeNode *topNode)
+{
+  PHNodeIterator iter(topNode);
+  PHCompositeNode *dstNode = dynamic_cast<PHCompositeNode *>(iter.findFirst("PHCompositeNode", "DST"));
+  hitnodes.clear();
+  FindHitNodes(dstNode, hitnodes);
+  PHG4TruthInfoContainer *truth = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
+  for (vector<PHCompositeNode *>::iterator topiter = topnodes.begin(); topiter != topnodes.end(); ++topiter)
+  {
+    delete *topiter;
+    PHCompositeNode *subtop = new PHCompositeNode("TOP");
+    PHCompositeNode *subdst = new PHCompositeNode("DST");
+    subtop->addNode(subdst);
+    subdst->addNode(new PHDataNode<PHObject>(new PHG4InEvent(), "PHG4INEVENT", "PHObject"));
+    if (truth)
+    {
+      subdst->addNode(new PHIODataNode<PHObject>(new PHG4TruthInfoContainer(), "G4TruthInfo", "PHObject"));
+    }
+    for (vector<string>::const_iterator name = hitnodes.begin(); name != hitnodes.end(); ++name)
+    {
+      PHG4HitContainer *hits = findNode::getClass<PHG4HitContainer>(dstNode, *name);
+      PHG4HitContainer *subhits = new PHG4HitContainer(*name);
+      pair<PHG4HitContainer::LayerIter, PHG4HitContainer::LayerIter> layers = hits->getLayers();
+      for (PHG4HitContainer::LayerIter layer = layers.first; layer != layers.second; ++layer)
+      {
+        subhits->AddLayer(*layer);
+      }
+      subhits->Recycle(hits->Recycle());
+      subdst->addNode(new PHIODataNode<PHObject>(subhits, name->c_str(), "PHObject"));
+    }
+    *topiter = subtop;
+  }
+  if (verbosity > 0)
+  {
+    cout << "PHG4SubEvents::CreateNodes - " << topnodes.size() << " sub events with "
+         << hitnodes.size() << " hit nodes" << (truth ? " and G4TruthInfo" : "") << endl;
+  }
+}
+
+int PHG4SubEvents::Split(const PHG4InEvent *ineve)
+{
+  Reset();
+  nsubevents = 0;
+  if (!ineve)
+  {
+    return 0;
+  }
+  pair<map<int, PHG4VtxPoint *>::const_iterator, map<int, PHG4VtxPoint *>::const_iterator> vtxrange = ineve->GetVertices();
+  const map<int, PHG4VtxPoint *> vertices(vtxrange.first, vtxrange.second);
+  pair<multimap<int, PHG4Particle *>::const_iterator, multimap<int, PHG4Particle *>::const_iterator> range = ineve->GetParticles();
+  const int nparticles = distance(range.first, range.second);
+  nsubevents = min((int) topnodes.size(), nparticles);
+  // consecutive blocks in vertex order, the particles of a vertex (a pileup collision)
+  // stay together as far as possible
+  vector<PHG4InEvent *> subevents;
+  for (int i = 0; i < nsubevents; i++)
+  {
+    subevents.push_back(findNode::getClass<PHG4InEvent>(topnodes[i], "PHG4INEVENT"));
+  }
+  int iparticle = 0;
+  int lastsub = -1;
+  int lastvtx = 0;
+  for (multimap<int, PHG4Particle *>::const_iterator iter = range.first; iter != range.second; ++iter, ++iparticle)
+  {
+    const int isub = iparticle * nsubevents / nparticles;
+    PHG4InEvent *subevent = subevents[isub];
+    if (isub != lastsub || iter->first != lastvtx)
+    {
+      map<int, PHG4VtxPoint *>::const_iterator vtx = vertices.find(iter->first);
+      subevent->AddVtxHepMC(iter->first, vtx->second->get_x(), vtx->second->get_y(), vtx->second->get_z(), vtx->second->get_t());
+      lastsub = isub;
+      lastvtx = iter->first;
+    }
+    PHG4Particle *particle = new PHG4Particlev1(iter->second);
+    subevent->AddParticle(iter->first, particle);
+    const int embed = ineve->isEmbeded(iter->second);
+    if (embed)
+    {
+      subevent->AddEmbeddedParticle(particle, embed);
+    }
+  }
+  if (verbosity > 1)
+  {
+    cout << "PHG4SubEvents::Split - " << nparticles << " primaries in " << nsubevents << " sub events" << endl;
+  }
+  return nsubevents;
+}
+
+void PHG4SubEvents::Merge(PHCompositeNode *topNode)
+{
+  PHG4TruthInfoContainer *truth = findNode::getClass<PHG4TruthInfoContainer>(topNode, "G4TruthInfo");
+  // the primaries of a vertex get the same truth vertex in every sub event, in the
+  // sequential mode it is one vertex (PHG4TruthTrackingAction::VertexMap)
+  map<vector<double>, int> primaryvtx;
+  for (int i = 0; i < nsubevents; i++)
+  {
+    PHCompositeNode *subtop = topnodes[i];
+    int trkup = 0;
+    int trkdown = 0;
+    PHG4TruthInfoContainer::ShowerMap showers;
+    PHG4TruthInfoContainer *subtruth = findNode::getClass<PHG4TruthInfoContainer>(subtop, "G4TruthInfo");
+    if (truth && subtruth)
+    {
+      trkup = truth->maxtrkindex();
+      trkdown = truth->mintrkindex();
+      const int vtxup = truth->maxvtxindex();
+      const int vtxdown = truth->minvtxindex();
+
+      pair<map<int, int>::const_iterator, map<int, int>::const_iterator> embedrange = subtruth->GetEmbeddedTrkIds();
+      const map<int, int> embedtrk(embedrange.first, embedrange.second);
+      embedrange = subtruth->GetEmbeddedVtxIds();
+      const map<int, int> embedvtx(embedrange.first, embedrange.second);
+      PHG4TruthInfoContainer::Map particles;
+      PHG4TruthInfoContainer::VtxMap vertices;
+      subtruth->Release(particles, vertices, showers);
+
+      map<int, int> vtxids;
+      for (PHG4TruthInfoContainer::VtxIterator iter = vertices.begin(); iter != vertices.end(); ++iter)
+      {
+        PHG4VtxPoint *vtx = iter->second;
+        int newid = Shift(iter->first, vtxup, vtxdown);
+        if (iter->first > 0)
+        {
+          vector<double> pos = {vtx->get_x(), vtx->get_y(), vtx->get_z(), vtx->get_t()};
+          map<vector<double>, int>::const_iterator found = primaryvtx.find(pos);
+          if (found != primaryvtx.end())
+          {
+            vtxids[iter->first] = found->second;
+            delete vtx;
+            continue;
+          }
+          primaryvtx[pos] = newid;
+        }
+        vtxids[iter->first] = newid;
+        truth->AddVertex(newid, vtx);
+      }
+      for (PHG4TruthInfoContainer::Iterator iter = particles.begin(); iter != particles.end(); ++iter)
+      {
+        PHG4Particle *particle = iter->second;
+        const int newid = Shift(iter->first, trkup, trkdown);
+        particle->set_track_id(newid);
+        particle->set_parent_id(Shift(particle->get_parent_id(), trkup, trkdown));
+        particle->set_primary_id(Shift(particle->get_primary_id(), trkup, trkdown));
+        particle->set_vtx_id(vtxids[particle->get_vtx_id()]);
+        truth->AddParticle(newid, particle);
+      }
+      for (map<int, int>::const_iterator iter = embedtrk.begin(); iter != embedtrk.end(); ++iter)
+      {
+        truth->AddEmbededTrkId(Shift(iter->first, trkup, trkdown), iter->second);
+      }
+      for (map<int, int>::const_iterator iter = embedvtx.begin(); iter != embedvtx.end(); ++iter)
+      {
+        truth->AddEmbededVtxId(vtxids[iter->first], iter->second);
+      }
+      for (PHG4TruthInfoContainer::ShowerIterator iter = showers.begin(); iter != showers.end(); ++iter)
+      {
+        PHG4Shower *shower = iter->second;
+        shower->set_parent_particle_id(Shift(shower->get_parent_particle_id(), trkup, trkdown));
+        shower->set_parent_shower_id(Shift(shower->get_parent_shower_id(), trkup, trkdown));
+        set<int> ids(shower->begin_g4particle_id(), shower->end_g4particle_id());
+        shower->clear_g4particle_id();
+        for (set<int>::const_iterator id = ids.begin(); id != ids.end(); ++id)
+        {
+          shower->add_g4particle_id(Shift(*id, trkup, trkdown));
+        }
+        ids = set<int>(shower->begin_g4vertex_id(), shower->end_g4vertex_id());
+        shower->clear_g4vertex_id();
+        for (set<int>::const_iterator id = ids.begin(); id != ids.end(); ++id)
+        {
+          shower->add_g4vertex_id(vtxids[*id]);
+        }
+        // the shower id is the track id of its primary
+        truth->AddShower(Shift(iter->first, trkup, trkdown), shower);
+      }
+    }
+
+    // new hit ids by container id, for the showers
+    map<int, map<PHG4HitDefs::keytype, PHG4HitDefs::keytype> > hitids;
+    for (vector<string>::const_iterator name = hitnodes.begin(); name != hitnodes.end(); ++name)
+    {
+      PHG4HitContainer *hits = findNode::getClass<PHG4HitContainer>(topNode, *name);
+      PHG4HitContainer *subhits = findNode::getClass<PHG4HitContainer>(subtop, *name);
+      if (!hits || !subhits)
+      {
+        continue;
+      }
+      map<PHG4HitDefs::keytype, PHG4HitDefs::keytype> &newids = hitids[hits->GetID()];
+      hits->MoveHits(subhits, newids);
+      for (map<PHG4HitDefs::keytype, PHG4HitDefs::keytype>::const_iterator iter = newids.begin(); iter != newids.end(); ++iter)
+      {
+        PHG4Hit *hit = hits->findHit(iter->second);
+        hit->set_trkid(Shift(hit->get_trkid(), trkup, trkdown));
+        hit->set_shower_id(Shift(hit->get_shower_id(), trkup, trkdown));
+      }
+    }
+    for (PHG4TruthInfoContainer::ShowerIterator iter = showers.begin(); iter != showers.end(); ++iter)
+    {
+      PHG4Shower *shower = iter->second;
+      for (PHG4Shower::HitIdIter volume = shower->begin_g4hit_id(); volume != shower->end_g4hit_id(); ++volume)
+      {
+        map<int, map<PHG4HitDefs::keytype, PHG4HitDefs::keytype> >::const_iterator newids = hitids.find(volume->first);
+        if (newids == hitids.end())
+        {
+          continue;
+        }
+        set<PHG4HitDefs::keytype> ids;
+        for (set<PHG4HitDefs::keytype>::const_iterator id = volume->second.begin(); id != volume->second.end(); ++id)
+        {
+          map<PHG4HitDefs::keytype, PHG4HitDefs::keytype>::const_iterator newid = newids->second.find(*id);
+          if (newid != newids->second.end())
+          {
+            ids.insert(newid->second);
+          }
+        }
+        volume->second.swap(ids);
+      }
+    }
+  }
+  if (verbosity > 1)
+  {
+    cout << "PHG4SubEvents::Merge - merged " << nsubevents << " sub events" << endl;
+  }
+  nsubevents = 0;
+}
+
+PHCompositeNode *PHG4SubEvents::TopNode(const int i) const
+{
+  if (i < 0 || i >= (int) topnodes.size())
+  {
+    return nullptr;
+  }
+  return topnodes[i];
+}
+
+void PHG4SubEvents::Reset()
+{
+  PHNodeReset reset;
+  for (vector<PHCompositeNode *>::const_iterator iter = topnodes.begin(); iter != topnodes.end(); ++iter)
+  {
+    if (*iter)
+    {
+      PHNodeIterator nodeiter(*iter);
+      nodeiter.forEach(reset);
+    }
+  }
+}
+
+void PHG4SubEvents::FindHitNodes(PHCompositeNode *startNode, vector<string> &names)
+{
+  // same selection as PHG4TruthEventAction::SearchNode
+  PHNodeIterator nodeiter(startNode);
+  PHPointerListIterator<PHNode> iter(nodeiter.ls());
+  PHNode *thisNode;
+  while ((thisNode = iter()))
+  {
+    if (thisNode->getType() == "PHCompositeNode")
+    {
+      FindHitNodes(static_cast<PHCompositeNode *>(thisNode), names);
+    }
+    else if (thisNode->getType() == "PHIODataNode" && thisNode->getName().find("G4HIT_") == 0)
+    {
+      PHIODataNode<PHObject> *DNode = static_cast<PHIODataNode<PHObject> *>(thisNode);
+      if (dynamic_cast<PHG4HitContainer *>(DNode->getData()))
+      {
+        names.push_back(thisNode->getName());
+      }
+    }
+  }
+}
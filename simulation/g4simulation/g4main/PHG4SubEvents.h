@@ -0,0 +1,51 @@
+#ifndef PHG4SubEvents_H__
+#define PHG4SubEvents_H__
+
+#include <string>
+#include <vector>
+
+class PHCompositeNode;
+class PHG4InEvent;
+
+// Sub events of the multi threaded mode of PHG4Reco (PHG4Reco::G4Threads).
+// The primaries of the PHG4INEVENT node are split into sub events which the
+// G4MTRunManager simulates in its worker threads as separate G4 events, the
+// G4 event id is the index of the sub event. Every sub event has its own node
+// tree (TOP/DST) with a PHG4INEVENT, a G4TruthInfo and empty copies of the
+// G4HIT_ containers of the main tree, the actions of the worker which
+// simulates it write there. After the run Merge() moves truth and hits into
+// the main tree in the order of the sub events, so the result does not depend
+// on which thread got which sub event
+
+class PHG4SubEvents
+{
+ public:
+  //! at most n sub events per event
+  explicit PHG4SubEvents(const int n);
+  virtual ~PHG4SubEvents();
+
+  //! creates the sub event trees for the truth and hit nodes of the main tree (after the InitRun of the subsystems)
+  void CreateNodes(PHCompositeNode *topNode);
+
+  //! distributes the primaries of ineve over the sub events, returns the number of sub events to simulate
+  int Split(const PHG4InEvent *ineve);
+
+  //! moves truth and hits of the simulated sub events into the containers of the main tree
+  void Merge(PHCompositeNode *topNode);
+
+  //! node tree of sub event i (the G4 event id), nullptr if it does not exist
+  PHCompositeNode *TopNode(const int i) const;
+
+  void Verbosity(const int i) { verbosity = i; }
+
+ private:
+  void Reset();
+  static void FindHitNodes(PHCompositeNode *startNode, std::vector<std::string> &names);
+
+  std::vector<PHCompositeNode *> topnodes;
+  std::vector<std::string> hitnodes;  // G4HIT_ nodes of the main tree
+  int nsubevents;                     // simulated in the current event
+  int verbosity;
+};
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <fun4all/SubsysReco.h>
 
+#include <cstddef>
 #include <iostream>
 #include <string>
 
@@ -44,6 +45,23 @@ overlapcheck(false)
   virtual PHG4TrackingAction* GetTrackingAction( void ) const
   { return 0; }
 
+  //! true if the subsystem makes the actions for the worker threads of PHG4Reco::G4Threads()
+  virtual bool SupportsWorkerThreads() const
+  { return false; }
+
+  //! new actions for one worker thread, called after InitRun. They get the node tree of
+  //! the sub event the thread simulates via SetInterfacePointers and belong to the worker
+  virtual void MakeWorkerActions(PHG4EventAction *&eventaction, PHG4SteppingAction *&steppingaction, PHG4TrackingAction *&trackingaction) const
+  { return; }
+
+  //! hash of everything the geometry depends on, 0: unknown (no geometry snapshot)
+  virtual size_t GetGeometryHash() const
+  { return 0; }
+
+  //! production range cut (cm) for the region of the detector, negative: global cut
+  virtual double GetRangeCut() const
+  { return -1; }
+
   void OverlapCheck(const bool chk = true) {overlapcheck = chk;}
 
   bool CheckOverlap() const {return overlapcheck;}
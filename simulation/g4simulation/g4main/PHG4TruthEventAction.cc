@@ -8,6 +8,7 @@
 
 #include "PHG4TruthInfoContainer.h"
 #include "PHG4HitContainer.h"
+#include "PHG4HitDefs.h"
 #include "PHG4Hit.h"
 
 #include <phool/getClass.h>
@@ -65,6 +66,13 @@ void PHG4TruthEventAction::EndOfEventAction(const G4Event* evt) {
   
   std::set<G4int> savelist;
   std::set<int> savevtxlist;
+
+  // tracks which only left hits in collapsed nodes are not saved on their own,
+  // they are removed after the showers are summarized
+  std::set<G4int> collapsed;
+  if (!collapsedNodes_.empty()) {
+    FindCollapsedTracks(collapsed);
+  }
    
   for (std::set<G4int>::const_iterator write_iter = writeList_.begin();
        write_iter != writeList_.end();
@@ -75,6 +83,9 @@ void PHG4TruthEventAction::EndOfEventAction(const G4Event* evt) {
     
     // usertrackid
     G4int mytrkid = *write_iter;
+    if (collapsed.find(mytrkid) != collapsed.end()) {
+      continue;
+    }
     PHG4Particle *particle = truthInfoList_->GetParticle(mytrkid);
 
     // if track is already in save list, nothing needs to be done
@@ -110,6 +121,13 @@ void PHG4TruthEventAction::EndOfEventAction(const G4Event* evt) {
   
   // the save lists are filled now, except primary track which never
   // made it into any active volume and their vertex
+
+  // collapsed tracks which are ancestors of saved tracks stay, the hits of
+  // the others are attributed to their closest ancestor which stays
+  std::map<G4int,G4int> ancestor;
+  if (!collapsed.empty()) {
+    FindAncestors(savelist, collapsed, ancestor);
+  }
   
   // loop over particles in truth list and remove them if they are not
   // in the save list and are not primary particles (parent_id == 0)
@@ -130,7 +148,8 @@ void PHG4TruthEventAction::EndOfEventAction(const G4Event* evt) {
       // tracks from a previous geant pass will not be recorded as leaving
       // hit in the sim, so we exclude this range from the removal
       // for regular sims, that range is zero to zero
-      if (((trackid < prev_existing_lower_key)||(trackid > prev_existing_upper_key)) && ((truthiter->second)->get_parent_id() != 0)) {
+      if (((trackid < prev_existing_lower_key)||(trackid > prev_existing_upper_key)) && ((truthiter->second)->get_parent_id() != 0) &&
+	  collapsed.find(trackid) == collapsed.end()) {
 	truthInfoList_->delete_particle(truthiter++);
 	removed[1]++;
       } else {
@@ -184,6 +203,10 @@ void PHG4TruthEventAction::EndOfEventAction(const G4Event* evt) {
 
   PruneShowers();
   ProcessShowers();
+
+  if (!collapsed.empty()) {
+    CollapseTracks(collapsed, ancestor);
+  }
   
   return;
 }
@@ -193,6 +216,11 @@ void PHG4TruthEventAction::AddTrackidToWritelist(const G4int trackid) {
    writeList_.insert(trackid);
 }
 
+//___________________________________________________
+void PHG4TruthEventAction::AddCollapsedNode(const std::string &nodename) {
+  collapsedNodes_.insert(PHG4HitDefs::get_volume_id(nodename));
+}
+
 //___________________________________________________
 void PHG4TruthEventAction::SetInterfacePointers(PHCompositeNode* topNode) {
   
@@ -476,3 +504,126 @@ void PHG4TruthEventAction::ProcessShowers() {
     // shower->identify();
   }
 }
+
+void PHG4TruthEventAction::FindCollapsedTracks(std::set<G4int> &collapsed) {
+
+  // secondaries of this event with hits in collapsed nodes but in no other node
+  std::set<G4int> others;
+  for (std::map<int,PHG4HitContainer*>::const_iterator iter = hitmap_.begin();
+       iter != hitmap_.end();
+       ++iter) {
+    std::set<G4int> &ids = (collapsedNodes_.find(iter->first) != collapsedNodes_.end()) ? collapsed : others;
+    PHG4HitContainer::ConstRange range = iter->second->getHits();
+    for (PHG4HitContainer::ConstIterator hiter = range.first; hiter != range.second; ++hiter) {
+      ids.insert(hiter->second->get_trkid());
+    }
+  }
+
+  for (std::set<G4int>::iterator iter = collapsed.begin(); iter != collapsed.end(); ) {
+    int trackid = *iter;
+    PHG4Particle* particle = truthInfoList_->GetParticle(trackid);
+    if (!particle ||
+	particle->get_parent_id() == 0 ||
+	(trackid >= prev_existing_lower_key && trackid <= prev_existing_upper_key) ||
+	others.find(trackid) != others.end()) {
+      collapsed.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+void PHG4TruthEventAction::FindAncestors(const std::set<G4int> &savelist, std::set<G4int> &collapsed, std::map<G4int,G4int> &ancestor) {
+
+  for (std::set<G4int>::iterator iter = collapsed.begin(); iter != collapsed.end(); ) {
+    if (savelist.find(*iter) != savelist.end()) {
+      collapsed.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+
+  // parents are tracked before their daughters and have larger ids,
+  // going down the ids finds the ancestors of the parents first
+  for (std::set<G4int>::const_reverse_iterator iter = collapsed.rbegin(); iter != collapsed.rend(); ++iter) {
+    G4int id = truthInfoList_->GetParticle(*iter)->get_parent_id();
+    while (savelist.find(id) == savelist.end() &&
+	   (id < prev_existing_lower_key || id > prev_existing_upper_key)) {
+      std::map<G4int,G4int>::const_iterator found = ancestor.find(id);
+      if (found != ancestor.end()) {
+	id = found->second;
+	break;
+      }
+      PHG4Particle* particle = truthInfoList_->GetParticle(id);
+      if (!particle || particle->get_parent_id() == 0) {
+	break;
+      }
+      id = particle->get_parent_id();
+    }
+    ancestor[*iter] = id;
+  }
+}
+
+void PHG4TruthEventAction::CollapseTracks(const std::set<G4int> &collapsed, const std::map<G4int,G4int> &ancestor) {
+
+  // the hits keep pointing to a particle in the record, so the truth
+  // queries (primary particle, shower) still work
+  for (std::set<int>::const_iterator iter = collapsedNodes_.begin(); iter != collapsedNodes_.end(); ++iter) {
+    std::map<int,PHG4HitContainer*>::const_iterator mapiter = hitmap_.find(*iter);
+    if (mapiter == hitmap_.end()) {
+      continue;
+    }
+    PHG4HitContainer::ConstRange range = mapiter->second->getHits();
+    for (PHG4HitContainer::ConstIterator hiter = range.first; hiter != range.second; ++hiter) {
+      std::map<G4int,G4int>::const_iterator found = ancestor.find(hiter->second->get_trkid());
+      if (found != ancestor.end()) {
+	hiter->second->set_trkid(found->second);
+      }
+    }
+  }
+
+  // drop the collapsed particles, from the showers as well
+  PHG4TruthInfoContainer::Range truth_range = truthInfoList_->GetSecondaryParticleRange();
+  PHG4TruthInfoContainer::Iterator truthiter = truth_range.first;
+  while (truthiter != truth_range.second) {
+    if (collapsed.find(truthiter->first) != collapsed.end()) {
+      truthInfoList_->delete_particle(truthiter++);
+    } else {
+      ++truthiter;
+    }
+  }
+
+  PHG4TruthInfoContainer::ShowerRange range = truthInfoList_->GetShowerRange();
+  for (PHG4TruthInfoContainer::ShowerIterator iter = range.first;
+       iter != range.second;
+       ++iter) {
+    PHG4Shower* shower = iter->second;
+    std::vector<int> remove_ids;
+    for (PHG4Shower::ParticleIdIter jter = shower->begin_g4particle_id();
+     	 jter != shower->end_g4particle_id();
+     	 ++jter) {
+      if (collapsed.find(*jter) != collapsed.end()) {
+	remove_ids.push_back(*jter);
+      }
+    }
+    for (std::vector<int>::const_iterator jter = remove_ids.begin(); jter != remove_ids.end(); ++jter) {
+      shower->remove_g4particle_id(*jter);
+    }
+  }
+
+  // vertices which only the collapsed particles used
+  std::set<int> savevtxlist;
+  truth_range = truthInfoList_->GetParticleRange();
+  for (truthiter = truth_range.first; truthiter != truth_range.second; ++truthiter) {
+    savevtxlist.insert(truthiter->second->get_vtx_id());
+  }
+  PHG4TruthInfoContainer::VtxRange vtxrange = truthInfoList_->GetVtxRange();
+  PHG4TruthInfoContainer::VtxIterator vtxiter = vtxrange.first;
+  while (vtxiter != vtxrange.second) {
+    if (savevtxlist.find(vtxiter->first) == savevtxlist.end()) {
+      truthInfoList_->delete_vtx(vtxiter++);
+    } else {
+      ++vtxiter;
+    }
+  }
+}
@@ -8,6 +8,7 @@
 
 #include <set>
 #include <map>
+#include <string>
 
 class PHG4HitContainer;
 class PHG4TruthInfoContainer;
@@ -36,11 +37,17 @@ public:
   //! add id into track list
   void AddTrackidToWritelist( const G4int trackid);
 
+  //! secondaries which only leave hits in this node are collapsed into the shower summaries
+  void AddCollapsedNode( const std::string &nodename );
+
  private:
 
   void SearchNode(PHCompositeNode* topNode);
   void PruneShowers();
   void ProcessShowers();
+  void FindCollapsedTracks(std::set<G4int> &collapsed);
+  void FindAncestors(const std::set<G4int> &savelist, std::set<G4int> &collapsed, std::map<G4int,G4int> &ancestor);
+  void CollapseTracks(const std::set<G4int> &collapsed, const std::map<G4int,G4int> &ancestor);
   
   //! set of track ids to be written out
   std::set<G4int> writeList_;
@@ -52,6 +59,9 @@ public:
   int prev_existing_upper_key;
 
   std::map<int,PHG4HitContainer*> hitmap_;
+
+  //! PHG4HitDefs::get_volume_id of the collapsed hit nodes
+  std::set<int> collapsedNodes_;
 };
 
 
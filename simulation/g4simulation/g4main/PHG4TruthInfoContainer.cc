@@ -48,6 +48,21 @@ void PHG4TruthInfoContainer::Reset() {
   return;
 }
 
+void PHG4TruthInfoContainer::Release(Map &particles, VtxMap &vertices, ShowerMap &showers) {
+
+  particles.insert(particlemap.begin(), particlemap.end());
+  particlemap.clear();
+  vertices.insert(vtxmap.begin(), vtxmap.end());
+  vtxmap.clear();
+  showers.insert(showermap.begin(), showermap.end());
+  showermap.clear();
+
+  particle_embed_flags.clear();
+  vertex_embed_flags.clear();
+
+  return;
+}
+
 void PHG4TruthInfoContainer::identify(ostream& os) const {
 
   cout << "---particlemap--------------------------" << endl;
@@ -36,6 +36,11 @@ public:
   virtual ~PHG4TruthInfoContainer();
 
   void Reset();
+
+  //! hands the particles, vertices and showers over to the caller, who deletes them,
+  //! and empties the container (for moving them into another container)
+  void Release(Map &particles, VtxMap &vertices, ShowerMap &showers);
+
   void identify(std::ostream& os = std::cout) const;
 
   // --- particle storage ------------------------------------------------------
@@ -47,18 +47,41 @@ int PHG4TruthSubsystem::InitRun( PHCompositeNode* topNode )
       dstNode->addNode( new PHIODataNode<PHObject>( truthInfoList, "G4TruthInfo", "PHObject" ));
     }
 
-  // event action
-  eventAction_ = new PHG4TruthEventAction();
-
   // create stepping action
   //steppingAction_ = new PHG4TruthSteppingAction( eventAction_ );
 
-  // create tracking action
-  trackingAction_ = new PHG4TruthTrackingAction( eventAction_ );
+  // event and tracking action
+  MakeActions(eventAction_, trackingAction_);
 
   return 0;
 }
 
+//_______________________________________________________________________
+void PHG4TruthSubsystem::MakeActions( PHG4TruthEventAction *&eventaction, PHG4TruthTrackingAction *&trackingaction ) const
+{
+  // event action
+  eventaction = new PHG4TruthEventAction();
+
+  // create tracking action
+  trackingaction = new PHG4TruthTrackingAction( eventaction );
+
+  for (vector<string>::const_iterator iter = collapsedNodes_.begin(); iter != collapsedNodes_.end(); ++iter)
+    {
+      eventaction->AddCollapsedNode(*iter);
+    }
+  trackingaction->PruneLeaves(!collapsedNodes_.empty());
+}
+
+//_______________________________________________________________________
+void PHG4TruthSubsystem::MakeWorkerActions( PHG4EventAction *&eventaction, PHG4SteppingAction *&, PHG4TrackingAction *&trackingaction ) const
+{
+  PHG4TruthEventAction *evtact = NULL;
+  PHG4TruthTrackingAction *trkact = NULL;
+  MakeActions(evtact, trkact);
+  eventaction = evtact;
+  trackingaction = trkact;
+}
+
 //_______________________________________________________________________
 int
 PHG4TruthSubsystem::process_event( PHCompositeNode* topNode )
@@ -3,6 +3,7 @@
 
 #include "PHG4Subsystem.h"
 #include <string>
+#include <vector>
 
 class PHG4TruthSteppingAction;
 class PHG4TruthTrackingAction;
@@ -37,17 +38,37 @@ class PHG4TruthSubsystem: public PHG4Subsystem
   virtual PHG4SteppingAction* GetSteppingAction( void ) const;
   virtual PHG4TrackingAction* GetTrackingAction( void ) const;
 
+  //! worker threads of PHG4Reco::G4Threads(), the truth of every sub event is recorded separately
+  virtual bool SupportsWorkerThreads() const {return true;}
+  virtual void MakeWorkerActions(PHG4EventAction *&eventaction, PHG4SteppingAction *&steppingaction, PHG4TrackingAction *&trackingaction) const;
+
   //! only save the G4 truth information that is associated with the embedded particle
   void SetSaveOnlyEmbeded(bool b = true){saveOnlyEmbeded_ = b;};
 
+  /*!
+    truth pruning for calorimeters: secondaries which only leave hits in this node
+    (e.g. G4HIT_CEMC, G4HIT_ABSORBER_CEMC) are dropped from the record unless they are
+    ancestors of kept particles. Their energy stays summarized in the PHG4Shower of
+    their primary and their hits point to the closest ancestor left in the record.
+    Primaries, particles with hits in other nodes (tracking layers) and their
+    ancestors are kept. Also drops secondaries without hits and daughters as soon as
+    they are tracked to keep the record small during the event
+  */
+  void CollapseShowersInNode(const std::string &hitnode) {collapsedNodes_.push_back(hitnode);}
+
   private:
 
+  //! event and tracking action with the pruning settings
+  void MakeActions(PHG4TruthEventAction *&eventaction, PHG4TruthTrackingAction *&trackingaction) const;
+
   PHG4TruthEventAction* eventAction_;
   PHG4TruthSteppingAction* steppingAction_;
   PHG4TruthTrackingAction* trackingAction_;
 
   //! only save the G4 truth information that is associated with the embedded particle
   bool saveOnlyEmbeded_;
+
+  std::vector<std::string> collapsedNodes_;
 };
 
 #endif
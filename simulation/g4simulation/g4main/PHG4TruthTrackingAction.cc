@@ -19,6 +19,8 @@
 #include <Geant4/G4PrimaryParticle.hh>
 #include <Geant4/G4VUserPrimaryParticleInformation.hh>
 
+#include <algorithm>
+
 using namespace std;
 
 const int VERBOSE = 0;
@@ -26,7 +28,9 @@ const int VERBOSE = 0;
 //________________________________________________________
 PHG4TruthTrackingAction::PHG4TruthTrackingAction( PHG4TruthEventAction* eventAction ) :
   eventAction_( eventAction ), 
-  truthInfoList_( NULL )
+  truthInfoList_( NULL ),
+  pruneLeaves_( false ),
+  minTrackId_( 0 )
 {}
 
 void PHG4TruthTrackingAction::PreUserTrackingAction( const G4Track* track) {
@@ -34,7 +38,8 @@ void PHG4TruthTrackingAction::PreUserTrackingAction( const G4Track* track) {
   int trackid = 0;
   if (track->GetParentID()) {
     // secondaries get negative user ids and increment downward between geant subevents
-    trackid = truthInfoList_->mintrkindex() - 1;
+    trackid = min(truthInfoList_->mintrkindex(), minTrackId_) - 1;
+    minTrackId_ = trackid;
   } else {
     // primaries get positive user ids and increment upward between geant subevents
     trackid = truthInfoList_->maxtrkindex() + 1;
@@ -148,6 +153,7 @@ void PHG4TruthTrackingAction::PreUserTrackingAction( const G4Track* track) {
 
 void PHG4TruthTrackingAction::PostUserTrackingAction(const G4Track* track) {
 
+  bool leaf = false;
   if (fpTrackingManager) {
 
     int trackid = track->GetTrackID();
@@ -168,12 +174,25 @@ void PHG4TruthTrackingAction::PostUserTrackingAction(const G4Track* track) {
 	PHG4TrackUserInfo::SetShower(const_cast<G4Track *> (secondary), shower);
       }
     }
+    leaf = !secondaries || secondaries->empty();
   }
   
   if ( PHG4TrackUserInfoV1* p = dynamic_cast<PHG4TrackUserInfoV1*>(track->GetUserInformation()) ) {
     if ( p->GetKeep() ) {
       int trackid = p->GetUserTrackId();
       eventAction_->AddTrackidToWritelist( trackid );
+    } else if ( pruneLeaves_ && leaf && track->GetParentID() ) {
+      // nothing can refer to a secondary without hits and daughters, the end of event
+      // pruning would drop it anyway. No other track started since this one, so it is
+      // the lowest id in the record
+      int trackid = p->GetUserTrackId();
+      PHG4TruthInfoContainer::Range range = truthInfoList_->GetSecondaryParticleRange();
+      if (range.first != range.second && range.first->first == trackid) {
+	truthInfoList_->delete_particle(range.first);
+	if (p->GetShower()) {
+	  p->GetShower()->remove_g4particle_id(trackid);
+	}
+      }
     }
   }
 }
@@ -194,5 +213,6 @@ int
 PHG4TruthTrackingAction::ResetEvent(PHCompositeNode *)
 {
   VertexMap.clear();
+  minTrackId_ = 0;
   return 0;
 }
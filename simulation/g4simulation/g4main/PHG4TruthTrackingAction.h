@@ -30,6 +30,9 @@ public:
 
   int ResetEvent(PHCompositeNode *);
 
+  //! drop secondaries without hits and without daughters right after they are tracked
+  void PruneLeaves(const bool b = true) {pruneLeaves_ = b;}
+
 private:
 
   std::map<G4ThreeVector,int> VertexMap;
@@ -39,6 +42,11 @@ private:
 
   //! pointer to truth information container
   PHG4TruthInfoContainer* truthInfoList_;
+
+  bool pruneLeaves_;
+
+  //! lowest secondary id handed out in this event, ids of pruned secondaries are not reused
+  int minTrackId_;
 };
 
 
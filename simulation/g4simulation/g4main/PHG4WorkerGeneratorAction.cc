@@ -0,0 +1,44 @@
+#include "PHG4WorkerGeneratorAction.h"
+
+#include "PHG4EventAction.h"
+#include "PHG4InEvent.h"
+#include "PHG4SteppingAction.h"
+#include "PHG4SubEvents.h"
+#include "PHG4TrackingAction.h"
+
+#include <phool/getClass.h>
+#include <phool/phool.h>
+
+#include <Geant4/G4Event.hh>
+
+#include <iostream>
+
+using namespace std;
+
+void PHG4WorkerGeneratorAction::GeneratePrimaries(G4Event *anEvent)
+{
+  PHCompositeNode *topNode = subevents->TopNode(anEvent->GetEventID());
+  if (!topNode)
+  {
+    cout << PHWHERE << " no sub event " << anEvent->GetEventID() << endl;
+    SetInEvent(nullptr);
+    return;
+  }
+  for (vector<PHG4EventAction *>::const_iterator iter = eventactions.begin(); iter != eventactions.end(); ++iter)
+  {
+    (*iter)->ResetEvent(topNode);
+    (*iter)->SetInterfacePointers(topNode);
+  }
+  for (vector<PHG4TrackingAction *>::const_iterator iter = trackingactions.begin(); iter != trackingactions.end(); ++iter)
+  {
+    (*iter)->ResetEvent(topNode);
+    (*iter)->SetInterfacePointers(topNode);
+  }
+  for (vector<PHG4SteppingAction *>::const_iterator iter = steppingactions.begin(); iter != steppingactions.end(); ++iter)
+  {
+    (*iter)->SetInterfacePointers(topNode);
+  }
+  SetInEvent(findNode::getClass<PHG4InEvent>(topNode, "PHG4INEVENT"));
+  PHG4PrimaryGeneratorAction::GeneratePrimaries(anEvent);
+  return;
+}
@@ -0,0 +1,42 @@
+#ifndef PHG4WorkerGeneratorAction_H__
+#define PHG4WorkerGeneratorAction_H__
+
+#include "PHG4PrimaryGeneratorAction.h"
+
+#include <vector>
+
+class PHG4EventAction;
+class PHG4SteppingAction;
+class PHG4SubEvents;
+class PHG4TrackingAction;
+
+// generator action of a worker thread in the multi threaded mode of PHG4Reco
+// (PHG4Reco::G4Threads). The G4 events are the sub events of PHG4SubEvents,
+// before the primaries of a sub event are generated the subsystem actions of
+// the worker are reset and pointed to the node tree of the sub event, which
+// is what PHG4Reco::process_event and ResetEvent do in the sequential mode
+
+class PHG4WorkerGeneratorAction : public PHG4PrimaryGeneratorAction
+{
+ public:
+  explicit PHG4WorkerGeneratorAction(const PHG4SubEvents *sub)
+    : subevents(sub)
+  {}
+
+  virtual ~PHG4WorkerGeneratorAction() {}
+
+  virtual void GeneratePrimaries(G4Event *anEvent);
+
+  //! subsystem actions of the worker (owned by its PHG4Phenix*Action)
+  void AddAction(PHG4EventAction *action) { eventactions.push_back(action); }
+  void AddAction(PHG4SteppingAction *action) { steppingactions.push_back(action); }
+  void AddAction(PHG4TrackingAction *action) { trackingactions.push_back(action); }
+
+ private:
+  const PHG4SubEvents *subevents;
+  std::vector<PHG4EventAction *> eventactions;
+  std::vector<PHG4SteppingAction *> steppingactions;
+  std::vector<PHG4TrackingAction *> trackingactions;
+};
+
+#endif
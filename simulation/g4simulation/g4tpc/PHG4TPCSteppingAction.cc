@@ -70,6 +70,17 @@ PHG4TPCSteppingAction::~PHG4TPCSteppingAction()
   // legal to delete (it results in a no operation)
   delete hit;
 }
+//____________________________________________________________________________..
+int PHG4TPCSteppingAction::IsInDetector(G4VPhysicalVolume* volume) const
+{
+  // same check as at the start of UserSteppingAction
+  if (detector_->IsInTPC(volume))
+  {
+    return VOLUME_OWNED;
+  }
+  return VOLUME_OTHER;
+}
+
 //____________________________________________________________________________..
 bool PHG4TPCSteppingAction::UserSteppingAction(const G4Step* aStep, bool)
 {
@@ -147,7 +158,9 @@ bool PHG4TPCSteppingAction::UserSteppingAction(const G4Step* aStep, bool)
     // and we have to make a new one
     if (!hit)
     {
-      hit = new PHG4Hitv1();
+      // take the hit from the container it will be saved in (recycles hits if enabled)
+      PHG4HitContainer *hitpool = (whichactive > 0) ? hits_ : absorberhits_;
+      hit = (hitpool ? hitpool->NewHit() : new PHG4Hitv1());
     }
     hit->set_layer(layer_id);
     //here we set the entrance values in cm